@@ -0,0 +1,207 @@
+#include <CppUTest/TestHarness.h>
+
+#include <math.h>
+
+extern "C" {
+#include <aversive/trajectory_manager/trajectory_path.h>
+}
+
+TEST_GROUP (ATrajectoryPath) {
+    struct trajectory_path path;
+
+    double distance_to_path(point_t pt)
+    {
+        double min = INFINITY;
+        for (int i = 0; i < path.len; i++) {
+            min = fmin(min, hypot(path.x[i] - pt.x, path.y[i] - pt.y));
+        }
+        return min;
+    }
+};
+
+TEST(ATrajectoryPath, needsAtLeastTwoDistinctPoints)
+{
+    point_t points[] = {{100, 100}, {100, 100}};
+
+    CHECK_EQUAL(-1, trajectory_path_fit(&path, points, 1));
+    CHECK_EQUAL(-1, trajectory_path_fit(&path, points, 2));
+}
+
+TEST(ATrajectoryPath, rejectsTooManyPoints)
+{
+    point_t points[TRAJECTORY_PATH_MAX_POINTS + 1];
+    for (int i = 0; i < TRAJECTORY_PATH_MAX_POINTS + 1; i++) {
+        points[i] = {100.f * i, 0};
+    }
+
+    CHECK_EQUAL(-1, trajectory_path_fit(&path, points, TRAJECTORY_PATH_MAX_POINTS + 1));
+    CHECK_EQUAL(0, trajectory_path_fit(&path, points, TRAJECTORY_PATH_MAX_POINTS));
+}
+
+TEST(ATrajectoryPath, twoPointsMakeAStraightLine)
+{
+    point_t points[] = {{0, 0}, {300, 400}};
+
+    CHECK_EQUAL(0, trajectory_path_fit(&path, points, 2));
+
+    CHECK_EQUAL(TRAJECTORY_PATH_SAMPLES, path.len);
+    DOUBLES_EQUAL(500, trajectory_path_length(&path), 1e-2);
+    for (int i = 0; i < path.len; i++) {
+        DOUBLES_EQUAL(0, path.curvature[i], 1e-6);
+        DOUBLES_EQUAL(path.x[i] * 4. / 3., path.y[i], 1e-2);
+    }
+}
+
+TEST(ATrajectoryPath, goesThroughAllWaypoints)
+{
+    point_t points[] = {{0, 0}, {500, 200}, {1000, 0}, {1500, 600}};
+
+    CHECK_EQUAL(0, trajectory_path_fit(&path, points, 4));
+
+    DOUBLES_EQUAL(0, path.x[0], 1e-6);
+    DOUBLES_EQUAL(0, path.y[0], 1e-6);
+    DOUBLES_EQUAL(1500, path.x[path.len - 1], 1e-6);
+    DOUBLES_EQUAL(600, path.y[path.len - 1], 1e-6);
+
+    /* intermediate points fall between two samples */
+    double step = trajectory_path_length(&path) / (path.len - 1);
+    CHECK(distance_to_path(points[1]) < step);
+    CHECK(distance_to_path(points[2]) < step);
+}
+
+TEST(ATrajectoryPath, ignoresDuplicatePoints)
+{
+    point_t points[] = {{0, 0}, {0, 0}, {500, 0}, {500, 0}};
+
+    CHECK_EQUAL(0, trajectory_path_fit(&path, points, 4));
+    DOUBLES_EQUAL(500, trajectory_path_length(&path), 1e-2);
+}
+
+TEST(ATrajectoryPath, curvatureMatchesACircle)
+{
+    const double radius = 500;
+    point_t points[9];
+    for (int i = 0; i < 9; i++) {
+        points[i] = {(float)(radius * cos(i * M_PI / 8)), (float)(radius * sin(i * M_PI / 8))};
+    }
+
+    CHECK_EQUAL(0, trajectory_path_fit(&path, points, 9));
+
+    /* natural ends of the spline are straight, check in the middle */
+    for (int i = path.len / 4; i < 3 * path.len / 4; i++) {
+        DOUBLES_EQUAL(1. / radius, path.curvature[i], 0.05 / radius);
+    }
+}
+
+TEST_GROUP (ATrajectoryPathSpeedProfile) {
+    struct trajectory_path path;
+    const double speed_max = 500;
+    const double angular_speed_max = 3;
+    const double acc_max = 1500;
+
+    void setup()
+    {
+        point_t points[] = {{0, 0}, {800, 0}, {800, 800}, {1600, 800}};
+        trajectory_path_fit(&path, points, 4);
+        trajectory_path_speed_profile(&path, speed_max, angular_speed_max, acc_max, 0, 0);
+    }
+};
+
+TEST(ATrajectoryPathSpeedProfile, startsAndEndsAtGivenSpeeds)
+{
+    DOUBLES_EQUAL(0, path.speed[0], 1e-6);
+    DOUBLES_EQUAL(0, path.speed[path.len - 1], 1e-6);
+
+    trajectory_path_speed_profile(&path, speed_max, angular_speed_max, acc_max, 100, speed_max);
+    DOUBLES_EQUAL(100, path.speed[0], 1e-6);
+    CHECK(path.speed[path.len - 1] > 100);
+}
+
+TEST(ATrajectoryPathSpeedProfile, respectsSpeedLimits)
+{
+    for (int i = 0; i < path.len; i++) {
+        double k = fabs(path.curvature[i]);
+        CHECK(path.speed[i] <= speed_max + 1e-3);
+        CHECK(path.speed[i] * k <= angular_speed_max + 1e-3);
+        CHECK(path.speed[i] * path.speed[i] * k <= acc_max + 1e-3);
+    }
+}
+
+TEST(ATrajectoryPathSpeedProfile, respectsAccelerationLimit)
+{
+    for (int i = 1; i < path.len; i++) {
+        double ds = path.s[i] - path.s[i - 1];
+        double dv2 = path.speed[i] * path.speed[i] - path.speed[i - 1] * path.speed[i - 1];
+        CHECK(fabs(dv2) <= 2 * acc_max * ds + 1e-2);
+    }
+}
+
+TEST(ATrajectoryPathSpeedProfile, carriesSpeedThroughWaypoints)
+{
+    int closest = 0;
+    for (int i = 0; i < path.len; i++) {
+        if (hypot(path.x[i] - 800, path.y[i]) < hypot(path.x[closest] - 800, path.y[closest])) {
+            closest = i;
+        }
+    }
+
+    CHECK(path.speed[closest] > 0.1 * speed_max);
+}
+
+TEST(ATrajectoryPathSpeedProfile, isFasterThanStoppingAtEachWaypoint)
+{
+    /* three segments of 800 mm, each with a trapezoidal profile */
+    double stop_and_go = 3 * (800 / speed_max + speed_max / acc_max);
+    double duration = trajectory_path_duration(&path);
+
+    CHECK(duration > trajectory_path_length(&path) / speed_max);
+    CHECK(duration < stop_and_go);
+}
+
+TEST_GROUP (ATrajectoryPathSearch) {
+    struct trajectory_path path;
+
+    void setup()
+    {
+        /* a loop crossing itself around (500, 0) */
+        point_t points[] = {{0, 0}, {1000, 0}, {1000, 500}, {500, 500}, {500, -500}};
+        trajectory_path_fit(&path, points, 5);
+    }
+};
+
+TEST(ATrajectoryPathSearch, startsAtTheBeginning)
+{
+    point_t robot = {0, 0};
+
+    CHECK_EQUAL(0, trajectory_path_closest(&path, &robot, 200));
+}
+
+TEST(ATrajectoryPathSearch, movesForward)
+{
+    point_t robot = {105, 0};
+
+    uint16_t index = trajectory_path_closest(&path, &robot, 200);
+
+    CHECK(index > 0);
+    DOUBLES_EQUAL(105, path.x[index], trajectory_path_length(&path) / path.len);
+    CHECK_EQUAL(index, path.index);
+}
+
+TEST(ATrajectoryPathSearch, doesNotJumpToTheEndWhenCrossing)
+{
+    point_t robot = {500, 0};
+
+    uint16_t index = trajectory_path_closest(&path, &robot, 600);
+
+    CHECK(path.s[index] < 600);
+}
+
+TEST(ATrajectoryPathSearch, neverGoesBack)
+{
+    point_t robot = {400, 0};
+    trajectory_path_closest(&path, &robot, 600);
+    uint16_t index = path.index;
+
+    robot = {0, 0};
+    CHECK_EQUAL(index, trajectory_path_closest(&path, &robot, 600));
+}
@@ -0,0 +1,229 @@
+#include <CppUTest/TestHarness.h>
+
+#include <math.h>
+#include <stdio.h>
+
+extern "C" {
+#include <aversive/control_system_manager/control_system_manager.h>
+#include <aversive/position_manager/position_manager.h>
+#include <aversive/robot_system/robot_system.h>
+#include <aversive/trajectory_manager/trajectory_manager.h>
+#include <aversive/trajectory_manager/trajectory_manager_core.h>
+#include <aversive/trajectory_manager/trajectory_manager_utils.h>
+#include <quadramp/quadramp.h>
+}
+
+/* Robot whose wheels follow the filtered consigns perfectly, so that the
+ * time to goal only depends on the trajectories. */
+struct simulated_robot {
+    int32_t distance;
+    int32_t angle;
+};
+
+static int32_t simulated_left_encoder(void* p)
+{
+    auto robot = static_cast<simulated_robot*>(p);
+    return robot->distance - robot->angle;
+}
+
+static int32_t simulated_right_encoder(void* p)
+{
+    auto robot = static_cast<simulated_robot*>(p);
+    return robot->distance + robot->angle;
+}
+
+TEST_GROUP (ATrajectoryPathFollowing) {
+    /* Same as the robot config, with the fast speed settings */
+    const double cs_hz = 100;
+    const double track_mm = 202.75;
+    const double imp_per_mm = 162.97;
+    const double distance_window_mm = 100;
+    const double angle_window_deg = 40;
+    const double angle_start_deg = 40;
+    const double path_advance_mm = 100;
+    const int timeout = 60 * 100;
+
+    struct trajectory traj;
+    struct cs distance_cs, angle_cs;
+    struct quadramp_filter distance_qr, angle_qr;
+    struct robot_position pos;
+    struct robot_system rs;
+    simulated_robot robot;
+
+    void setup()
+    {
+        robot = {0, 0};
+
+        quadramp_init(&angle_qr);
+        quadramp_init(&distance_qr);
+
+        cs_init(&distance_cs);
+        cs_init(&angle_cs);
+        cs_set_consign_filter(&distance_cs, quadramp_do_filter, &distance_qr);
+        cs_set_consign_filter(&angle_cs, quadramp_do_filter, &angle_qr);
+        cs_set_process_out(&distance_cs, rs_get_distance, &rs);
+        cs_set_process_out(&angle_cs, rs_get_angle, &rs);
+
+        rs_init(&rs);
+        rs_set_flags(&rs, RS_USE_EXT);
+        rs_set_left_ext_encoder(&rs, simulated_left_encoder, &robot, 1.);
+        rs_set_right_ext_encoder(&rs, simulated_right_encoder, &robot, 1.);
+
+        position_init(&pos);
+        position_set_physical_params(&pos, track_mm, imp_per_mm);
+        position_set_related_robot_system(&pos, &rs);
+        position_use_ext(&pos);
+
+        trajectory_manager_init(&traj, cs_hz);
+        trajectory_set_cs(&traj, &distance_cs, &angle_cs);
+        trajectory_set_robot_params(&traj, &rs, &pos);
+        trajectory_set_windows(&traj, distance_window_mm, angle_window_deg, angle_start_deg);
+        trajectory_set_speed(&traj, speed_mm2imp(&traj, 500), speed_rd2imp(&traj, 3.));
+        trajectory_set_acc(&traj, acc_mm2imp(&traj, 1500), acc_rd2imp(&traj, 10.));
+    }
+
+    void start_at(point_t start)
+    {
+        position_set(&pos, start.x, start.y, 0);
+    }
+
+    /* One period of the base control loop */
+    void step()
+    {
+        rs_update(&rs);
+        position_manage(&pos);
+        trajectory_manager_manage(&traj);
+        cs_manage(&distance_cs);
+        cs_manage(&angle_cs);
+
+        robot.distance = cs_get_filtered_consign(&distance_cs);
+        robot.angle = cs_get_filtered_consign(&angle_cs);
+    }
+
+    double distance_to(point_t pt)
+    {
+        return hypot(position_get_x_double(&pos) - pt.x, position_get_y_double(&pos) - pt.y);
+    }
+
+    /* Former strategy: one waypoint at a time, going to the next one as soon
+     * as the robot is in the distance window of the current one. Returns the
+     * time to goal in seconds. */
+    double run_waypoints(const point_t* points, int num_points)
+    {
+        int ticks = 0;
+
+        for (int i = 0; i < num_points; i++) {
+            trajectory_goto_xy_abs(&traj, points[i].x, points[i].y);
+            do {
+                step();
+                ticks++;
+            } while (ticks < timeout && !(i < num_points - 1 ? trajectory_nearly_finished(&traj) : trajectory_finished(&traj)));
+        }
+
+        return ticks / cs_hz;
+    }
+
+    /* Whole path at once, also returns the largest distance between the
+     * robot and an intermediate waypoint. */
+    double run_path(const point_t* points, int num_points, double* max_waypoint_error)
+    {
+        double errors[TRAJECTORY_PATH_MAX_POINTS];
+        int ticks = 0;
+
+        for (int i = 0; i < num_points; i++) {
+            errors[i] = INFINITY;
+        }
+
+        CHECK_EQUAL(0, trajectory_goto_path_abs(&traj, points, num_points, path_advance_mm));
+        do {
+            step();
+            ticks++;
+            for (int i = 0; i < num_points; i++) {
+                errors[i] = fmin(errors[i], distance_to(points[i]));
+            }
+        } while (ticks < timeout && !trajectory_finished(&traj));
+
+        *max_waypoint_error = 0;
+        for (int i = 0; i < num_points - 1; i++) {
+            *max_waypoint_error = fmax(*max_waypoint_error, errors[i]);
+        }
+
+        return ticks / cs_hz;
+    }
+};
+
+TEST(ATrajectoryPathFollowing, reachesTheEndOfAStraightPath)
+{
+    point_t points[] = {{1500, 300}};
+    double error;
+    start_at({300, 300});
+
+    run_path(points, 1, &error);
+
+    CHECK_EQUAL(RUNNING_PATH, traj.state);
+    CHECK_FALSE(traj.scheduled);
+    CHECK(distance_to(points[0]) < 5);
+}
+
+TEST(ATrajectoryPathFollowing, rejectsPathWithoutMovement)
+{
+    point_t points[] = {{300, 300}};
+    start_at({300, 300});
+
+    CHECK_EQUAL(-1, trajectory_goto_path_abs(&traj, points, 1, path_advance_mm));
+    CHECK_EQUAL(-1, trajectory_goto_path_abs(&traj, points, 0, path_advance_mm));
+}
+
+TEST(ATrajectoryPathFollowing, isNearlyFinishedInTheEndWindow)
+{
+    point_t points[] = {{1000, 300}, {1000, 1000}};
+    start_at({300, 300});
+    trajectory_goto_path_abs(&traj, points, 2, path_advance_mm);
+
+    CHECK_FALSE(trajectory_nearly_finished(&traj));
+
+    position_set(&pos, 1000, 950, 90);
+    CHECK_TRUE(trajectory_nearly_finished(&traj));
+}
+
+/* Compares the time to goal of typical avoidance paths on the table when
+ * running them one waypoint at a time and as a single path. */
+TEST(ATrajectoryPathFollowing, Benchmark)
+{
+    struct {
+        const char* name;
+        point_t start;
+        point_t points[4];
+        int num_points;
+    } paths[] = {
+        {"around an obstacle", {250, 1000}, {{800, 700}, {1400, 700}, {2000, 1000}}, 3},
+        {"L turn", {300, 1700}, {{1500, 1700}, {1500, 500}}, 2},
+        {"zigzag", {300, 300}, {{900, 900}, {1500, 300}, {2100, 900}, {2700, 300}}, 4},
+        {"detour", {400, 1000}, {{1000, 1400}, {1800, 1400}, {2600, 1000}}, 3},
+    };
+
+    for (auto& path : paths) {
+        double error;
+
+        setup();
+        start_at(path.start);
+        double waypoints_s = run_waypoints(path.points, path.num_points);
+        point_t waypoints_end = {(float)position_get_x_double(&pos), (float)position_get_y_double(&pos)};
+
+        setup();
+        start_at(path.start);
+        double path_s = run_path(path.points, path.num_points, &error);
+
+        char report[128];
+        snprintf(report, sizeof(report), "%s: waypoints %.2f s, path %.2f s, %.0f mm from waypoints",
+                 path.name, waypoints_s, path_s, error);
+        UT_PRINT(report);
+
+        CHECK(path_s < waypoints_s);
+        CHECK(error < path_advance_mm);
+        CHECK(distance_to(path.points[path.num_points - 1]) < 5);
+        CHECK(hypot(waypoints_end.x - path.points[path.num_points - 1].x,
+                    waypoints_end.y - path.points[path.num_points - 1].y)
+              < 5);
+    }
+}
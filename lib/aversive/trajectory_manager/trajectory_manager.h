@@ -44,6 +44,7 @@ extern "C" {
 #include <aversive/math/geometry/vect_base.h>
 #include <aversive/math/geometry/lines.h>
 #include <aversive/robot_system/robot_system.h>
+#include <aversive/trajectory_manager/trajectory_path.h>
 
 /** State of the trajectory manager. */
 enum trajectory_state {
@@ -74,6 +75,9 @@ enum trajectory_state {
     /* clitoid */
     RUNNING_CLITOID_LINE, /**< Running a clitoid (line->circle->line) in the line part. */
     RUNNING_CLITOID_CURVE, /**< Running a clitoid in the curve part. */
+
+    /* path */
+    RUNNING_PATH, /**< Following a smooth path through several waypoints. */
 };
 
 /** Movement target when running on a circle. */
@@ -115,6 +119,9 @@ struct trajectory {
         struct line_target line; /**< target, if it is a line */
     } target; /**< Target of the movement. */
 
+    struct trajectory_path path; /**< Path to follow, when running a path. */
+    double path_advance; /**< Lookahead distance on the path, in mm. */
+
     double d_win; /**<< distance window (for END_NEAR) */
     double a_win_rad; /**<< angle window (for END_NEAR) */
     double a_start_rad; /**<< in xy consigns, start to move in distance
@@ -317,6 +317,10 @@ uint8_t trajectory_in_window(struct trajectory* traj, double d_win, double a_win
         case RUNNING_AD:
             return is_robot_in_dist_window(traj, d_win) && is_robot_in_angle_window(traj, a_win_rad);
 
+        case RUNNING_PATH:
+            /* if robot coordinates are near the end of the path */
+            return is_robot_in_xy_window(traj, d_win);
+
         case RUNNING_XY_START:
         case RUNNING_XY_F_START:
         case RUNNING_XY_B_START:
@@ -616,6 +620,78 @@ static void trajectory_manager_line_event(struct trajectory* traj)
     }
 }
 
+/* trajectory event for paths */
+static void trajectory_manager_path_event(struct trajectory* traj)
+{
+    struct trajectory_path* path = &traj->path;
+    double x = position_get_x_double(traj->position);
+    double y = position_get_y_double(traj->position);
+    double a = position_get_a_rad_double(traj->position);
+    double remaining, speed;
+    point_t robot;
+    uint16_t next, target;
+    int32_t d_consign = 0, a_consign = 0;
+    vect2_cart v2cart_pos;
+    vect2_pol v2pol_target;
+
+    robot.x = x;
+    robot.y = y;
+
+    /* the next sample is always in front of the closest one */
+    trajectory_path_closest(path, &robot, 2 * traj->path_advance);
+    next = path->index + 1;
+    if (next >= path->len) {
+        next = path->len - 1;
+    }
+
+    /* target point is further on the path */
+    target = next;
+    while (target < path->len - 1 && path->s[target] - path->s[path->index] < traj->path_advance) {
+        target++;
+    }
+
+    /* target vector */
+    v2cart_pos.x = path->x[target] - x;
+    v2cart_pos.y = path->y[target] - y;
+    vect2_cart2pol(&v2cart_pos, &v2pol_target);
+    v2pol_target.theta = simple_modulo_2pi(v2pol_target.theta - a);
+
+    /* the profile already slows down for the curves, only drive along
+     * the heading error here, and turn first if it is too large */
+    speed = speed_mm2imp(traj, path->speed[next]);
+    if (fabs(v2pol_target.theta) > traj->a_start_rad) {
+        set_quadramp_speed(traj, 0, traj->a_speed);
+    } else {
+        set_quadramp_speed(traj, speed * cos(v2pol_target.theta), traj->a_speed);
+    }
+
+    /* position consign is the end of the path, so that the quadramp
+     * brakes in time for it */
+    if (next == path->len - 1) {
+        remaining = v2pol_target.r;
+    } else {
+        remaining = path->s[path->len - 1] - path->s[next];
+        remaining += xy_norm(x, y, path->x[next], path->y[next]);
+    }
+    d_consign = pos_mm2imp(traj, remaining);
+    d_consign += rs_get_distance(traj->robot);
+
+    /* angle consign (1.1 to avoid oscillations) */
+    a_consign = pos_rd2imp(traj, v2pol_target.theta) / 1.1;
+    a_consign += rs_get_angle(traj->robot);
+
+    EVT_DEBUG("index=%d target=%d, a_consign=%d, d_consign=%d",
+              path->index, target, a_consign, d_consign);
+
+    cs_set_consign(traj->csm_angle, a_consign);
+    cs_set_consign(traj->csm_distance, d_consign);
+
+    /* we reached the end of the path */
+    if (is_robot_in_xy_window(traj, traj->d_win)) {
+        delete_event(traj);
+    }
+}
+
 /* trajectory manage events */
 void trajectory_manager_manage(struct trajectory* traj)
 {
@@ -642,6 +718,10 @@ void trajectory_manager_manage(struct trajectory* traj)
                 trajectory_manager_line_event(traj);
                 break;
 
+            case RUNNING_PATH:
+                trajectory_manager_path_event(traj);
+                break;
+
             default:
                 break;
         }
@@ -999,3 +1079,52 @@ int8_t trajectory_clitoid(struct trajectory* traj,
     schedule_event(traj);
     return 0;
 }
+
+/*********** *PATH */
+
+int8_t trajectory_goto_path_abs(struct trajectory* traj,
+                                const point_t* points,
+                                int num_points,
+                                double advance)
+{
+    point_t path_points[TRAJECTORY_PATH_MAX_POINTS];
+    double d_speed, a_speed, d_acc;
+    int i;
+
+    if (num_points < 1 || num_points >= TRAJECTORY_PATH_MAX_POINTS) {
+        DEBUG("%s() invalid number of points %d", __FUNCTION__, num_points);
+        return -1;
+    }
+
+    /* the path starts from the current position */
+    path_points[0].x = position_get_x_double(traj->position);
+    path_points[0].y = position_get_y_double(traj->position);
+    for (i = 0; i < num_points; i++) {
+        path_points[i + 1] = points[i];
+    }
+
+    delete_event(traj);
+
+    if (trajectory_path_fit(&traj->path, path_points, num_points + 1) < 0) {
+        DEBUG("%s() path has no length", __FUNCTION__);
+        return -1;
+    }
+
+    /* The quadramp already ramps up at the start and brakes at the end,
+     * the profile only needs to slow down for the curves. */
+    d_speed = speed_imp2mm(traj, traj->d_speed);
+    a_speed = speed_imp2rd(traj, traj->a_speed);
+    d_acc = acc_imp2mm(traj, traj->d_acc);
+    trajectory_path_speed_profile(&traj->path, d_speed, a_speed, d_acc, d_speed, d_speed);
+
+    traj->path_advance = advance;
+    traj->target.cart.x = points[num_points - 1].x;
+    traj->target.cart.y = points[num_points - 1].y;
+
+    DEBUG("Path through %d points, length=%2.2f",
+          num_points, trajectory_path_length(&traj->path));
+
+    traj->state = RUNNING_PATH;
+    schedule_event(traj);
+    return 0;
+}
@@ -152,6 +152,21 @@ int8_t trajectory_clitoid(struct trajectory* traj,
                           double R_mm,
                           double d_inter_mm);
 
+/* Follow a smooth path going from the current position through all the
+ * given points (absolute x,y in mm), without stopping at them. The
+ * robot only drives forward, and the speed is lowered in the curves
+ * according to the current speed and acceleration consigns.
+ *
+ * - advance: distance in mm of the point the robot aims at on the path
+ *
+ * return 0 if the path can be loaded, then it is processed in
+ * background. Returns -1 if there are too many points (see
+ * TRAJECTORY_PATH_MAX_POINTS) or no movement at all. */
+int8_t trajectory_goto_path_abs(struct trajectory* traj,
+                                const point_t* points,
+                                int num_points,
+                                double advance);
+
 #ifdef __cplusplus
 }
 #endif
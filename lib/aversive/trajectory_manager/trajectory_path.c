@@ -0,0 +1,206 @@
+#include <math.h>
+#include <string.h>
+
+#include <aversive/trajectory_manager/trajectory_path.h>
+
+/* Second derivatives of a natural cubic spline going through values v at
+ * parameters t, computed with the tridiagonal (Thomas) algorithm. */
+static void spline_second_derivatives(const double* t, const double* v, double* m, int n)
+{
+    double c[TRAJECTORY_PATH_MAX_POINTS];
+    double d[TRAJECTORY_PATH_MAX_POINTS];
+    int i;
+
+    m[0] = 0;
+    m[n - 1] = 0;
+    if (n < 3) {
+        return;
+    }
+
+    c[0] = 0;
+    d[0] = 0;
+    for (i = 1; i < n - 1; i++) {
+        double h0 = t[i] - t[i - 1];
+        double h1 = t[i + 1] - t[i];
+        double rhs = 6. * ((v[i + 1] - v[i]) / h1 - (v[i] - v[i - 1]) / h0);
+        double denom = 2. * (h0 + h1) - h0 * c[i - 1];
+
+        c[i] = h1 / denom;
+        d[i] = (rhs - h0 * d[i - 1]) / denom;
+    }
+
+    for (i = n - 2; i > 0; i--) {
+        m[i] = d[i] - c[i] * m[i + 1];
+    }
+}
+
+/* Value, first and second derivatives of the spline segment [t0, t1] */
+static void spline_eval(double t0, double t1, double v0, double v1, double m0, double m1,
+                        double t, double* v, double* dv, double* ddv)
+{
+    double h = t1 - t0;
+    double a = t1 - t;
+    double b = t - t0;
+    double c0 = v0 / h - m0 * h / 6.;
+    double c1 = v1 / h - m1 * h / 6.;
+
+    *v = m0 * a * a * a / (6. * h) + m1 * b * b * b / (6. * h) + c0 * a + c1 * b;
+    *dv = -m0 * a * a / (2. * h) + m1 * b * b / (2. * h) - c0 + c1;
+    *ddv = (m0 * a + m1 * b) / h;
+}
+
+int8_t trajectory_path_fit(struct trajectory_path* path, const point_t* points, int num_points)
+{
+    double t[TRAJECTORY_PATH_MAX_POINTS];
+    double px[TRAJECTORY_PATH_MAX_POINTS], py[TRAJECTORY_PATH_MAX_POINTS];
+    double mx[TRAJECTORY_PATH_MAX_POINTS], my[TRAJECTORY_PATH_MAX_POINTS];
+    int i, n = 0, segment = 0;
+
+    if (num_points > TRAJECTORY_PATH_MAX_POINTS) {
+        return -1;
+    }
+
+    /* chord length parametrization, skipping duplicate points */
+    for (i = 0; i < num_points; i++) {
+        if (n > 0) {
+            double chord = hypot(points[i].x - px[n - 1], points[i].y - py[n - 1]);
+            if (chord < 1e-3) {
+                continue;
+            }
+            t[n] = t[n - 1] + chord;
+        } else {
+            t[n] = 0;
+        }
+        px[n] = points[i].x;
+        py[n] = points[i].y;
+        n++;
+    }
+
+    if (n < 2) {
+        return -1;
+    }
+
+    spline_second_derivatives(t, px, mx, n);
+    spline_second_derivatives(t, py, my, n);
+
+    memset(path, 0, sizeof(struct trajectory_path));
+    path->len = TRAJECTORY_PATH_SAMPLES;
+
+    for (i = 0; i < TRAJECTORY_PATH_SAMPLES; i++) {
+        double u = t[n - 1] * i / (TRAJECTORY_PATH_SAMPLES - 1);
+        double x, dx, ddx, y, dy, ddy, norm;
+
+        while (segment < n - 2 && u > t[segment + 1]) {
+            segment++;
+        }
+
+        spline_eval(t[segment], t[segment + 1], px[segment], px[segment + 1],
+                    mx[segment], mx[segment + 1], u, &x, &dx, &ddx);
+        spline_eval(t[segment], t[segment + 1], py[segment], py[segment + 1],
+                    my[segment], my[segment + 1], u, &y, &dy, &ddy);
+
+        path->x[i] = x;
+        path->y[i] = y;
+
+        norm = hypot(dx, dy);
+        if (norm > 1e-6) {
+            path->curvature[i] = (dx * ddy - dy * ddx) / (norm * norm * norm);
+        }
+
+        if (i > 0) {
+            path->s[i] = path->s[i - 1] + hypot(x - path->x[i - 1], y - path->y[i - 1]);
+        }
+    }
+
+    /* The samples must end exactly on the waypoints */
+    path->x[0] = px[0];
+    path->y[0] = py[0];
+    path->x[path->len - 1] = px[n - 1];
+    path->y[path->len - 1] = py[n - 1];
+
+    return 0;
+}
+
+void trajectory_path_speed_profile(struct trajectory_path* path,
+                                   double speed_max,
+                                   double angular_speed_max,
+                                   double acc_max,
+                                   double start_speed,
+                                   double end_speed)
+{
+    int i;
+
+    /* curvature limits: angular speed and centripetal acceleration */
+    for (i = 0; i < path->len; i++) {
+        double k = fabs(path->curvature[i]);
+        double v = speed_max;
+
+        if (k > 1e-9) {
+            v = fmin(v, angular_speed_max / k);
+            v = fmin(v, sqrt(acc_max / k));
+        }
+        path->speed[i] = v;
+    }
+
+    /* forward pass: acceleration from the start speed */
+    path->speed[0] = fmin(path->speed[0], start_speed);
+    for (i = 1; i < path->len; i++) {
+        double ds = path->s[i] - path->s[i - 1];
+        double v_prev = path->speed[i - 1];
+        path->speed[i] = fmin(path->speed[i], sqrt(v_prev * v_prev + 2. * acc_max * ds));
+    }
+
+    /* backward pass: braking before the curves and the end */
+    path->speed[path->len - 1] = fmin(path->speed[path->len - 1], end_speed);
+    for (i = path->len - 2; i >= 0; i--) {
+        double ds = path->s[i + 1] - path->s[i];
+        double v_next = path->speed[i + 1];
+        path->speed[i] = fmin(path->speed[i], sqrt(v_next * v_next + 2. * acc_max * ds));
+    }
+}
+
+double trajectory_path_length(const struct trajectory_path* path)
+{
+    return path->s[path->len - 1];
+}
+
+double trajectory_path_duration(const struct trajectory_path* path)
+{
+    double duration = 0;
+    int i;
+
+    for (i = 1; i < path->len; i++) {
+        double ds = path->s[i] - path->s[i - 1];
+        double v = (path->speed[i - 1] + path->speed[i]) / 2.;
+
+        if (v <= 0) {
+            return INFINITY;
+        }
+        duration += ds / v;
+    }
+
+    return duration;
+}
+
+uint16_t trajectory_path_closest(struct trajectory_path* path, const point_t* pt, double search_mm)
+{
+    uint16_t i, best = path->index;
+    double best_dist = hypot(path->x[best] - pt->x, path->y[best] - pt->y);
+
+    for (i = path->index + 1; i < path->len; i++) {
+        double dist;
+
+        if (path->s[i] - path->s[path->index] > search_mm) {
+            break;
+        }
+
+        dist = hypot(path->x[i] - pt->x, path->y[i] - pt->y);
+        if (dist < best_dist) {
+            best_dist = dist;
+            best = i;
+        }
+    }
+
+    path->index = best;
+    return best;
+}
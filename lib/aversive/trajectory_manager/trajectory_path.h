@@ -0,0 +1,98 @@
+/** @file trajectory_path.h
+ *
+ * @brief Smooth paths through a list of waypoints.
+ *
+ * A path is a natural cubic spline going through all the waypoints,
+ * parametrized by the length of the chords between them. Its curvature is
+ * continuous, which means the robot can follow it without stopping at the
+ * waypoints. The spline is sampled once when the path is created, and a
+ * velocity profile is computed on the samples so that the robot slows down
+ * before the curves and carries its speed through the waypoints.
+ *
+ * This module does not depend on the rest of the trajectory manager, all
+ * lengths are in mm and all times in seconds.
+ */
+
+#ifndef TRAJECTORY_PATH_H
+#define TRAJECTORY_PATH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <aversive/math/geometry/vect_base.h>
+
+/** Maximum number of waypoints of a path, including the starting point. */
+#define TRAJECTORY_PATH_MAX_POINTS 16
+
+/** Number of samples of a path. */
+#define TRAJECTORY_PATH_SAMPLES 128
+
+/** A sampled path and its velocity profile. */
+struct trajectory_path {
+    uint16_t len; /**< Number of samples. */
+    uint16_t index; /**< Sample the robot is currently closest to. */
+    float x[TRAJECTORY_PATH_SAMPLES]; /**< Position of the samples, in mm. */
+    float y[TRAJECTORY_PATH_SAMPLES];
+    float s[TRAJECTORY_PATH_SAMPLES]; /**< Path length from the start, in mm. */
+    float curvature[TRAJECTORY_PATH_SAMPLES]; /**< Signed curvature, in 1/mm. */
+    float speed[TRAJECTORY_PATH_SAMPLES]; /**< Speed profile, in mm/s. */
+};
+
+/** @brief Fits a smooth path through the given waypoints and samples it.
+ *
+ * Consecutive duplicate waypoints are ignored.
+ *
+ * @param [out] path The path to fill. Its speed profile is left empty.
+ * @param [in] points The waypoints, the first one being the starting point.
+ * @param [in] num_points The number of waypoints.
+ *
+ * @return 0 on success, -1 if there are less than two distinct waypoints or
+ * more than TRAJECTORY_PATH_MAX_POINTS.
+ */
+int8_t trajectory_path_fit(struct trajectory_path* path, const point_t* points, int num_points);
+
+/** @brief Computes the speed profile of a path.
+ *
+ * The speed at each sample is limited by the maximum speed, by the maximum
+ * angular speed and the maximum acceleration in the curves, then by the
+ * acceleration needed to get to it from the previous samples and to brake
+ * for the next ones.
+ *
+ * @param [in, out] path A sampled path.
+ * @param [in] speed_max The maximum speed, in mm/s.
+ * @param [in] angular_speed_max The maximum angular speed, in rad/s.
+ * @param [in] acc_max The maximum acceleration, in mm/s^2.
+ * @param [in] start_speed The speed at the start of the path, in mm/s.
+ * @param [in] end_speed The speed at the end of the path, in mm/s.
+ */
+void trajectory_path_speed_profile(struct trajectory_path* path,
+                                   double speed_max,
+                                   double angular_speed_max,
+                                   double acc_max,
+                                   double start_speed,
+                                   double end_speed);
+
+/** Returns the length of the path, in mm. */
+double trajectory_path_length(const struct trajectory_path* path);
+
+/** Returns the time needed to run the speed profile, in seconds. */
+double trajectory_path_duration(const struct trajectory_path* path);
+
+/** @brief Finds the sample closest to the given point.
+ *
+ * The search starts from the last sample found and only goes forward, up to
+ * the given distance along the path, so that a path crossing itself is
+ * followed in order. The result is stored in path->index.
+ *
+ * @return The index of the closest sample.
+ */
+uint16_t trajectory_path_closest(struct trajectory_path* path, const point_t* pt, double search_mm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRAJECTORY_PATH_H */
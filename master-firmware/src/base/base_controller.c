@@ -1,8 +1,10 @@
 #include <ch.h>
+#include <hal.h>
 
 #include <math.h>
 
 #include <error/error.h>
+#include <timestamp/timestamp.h>
 
 #include <aversive/trajectory_manager/trajectory_manager.h>
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
@@ -13,12 +15,20 @@
 #include "priorities.h"
 
 #include "rs_port.h"
+#include "encoder.h"
+#include "pose_fusion.h"
 #include "base_controller.h"
+#include "control_loop_stats.h"
+#include "robot_helpers/trajectory_helpers.h"
 #include "protobuf/position.pb.h"
+#include "protobuf/control_loop.pb.h"
+#include "protobuf/beacons.pb.h"
+#include "protobuf/collision.pb.h"
 
-#define BASE_CONTROLLER_STACKSIZE 1024
-#define POSITION_MANAGER_STACKSIZE 1024
-#define TRAJECTORY_MANAGER_STACKSIZE 2048
+#define BASE_CONTROLLER_STACKSIZE 2048
+
+/* Wheel currents older than this are not used for collision detection */
+#define COLLISION_MAX_CURRENT_AGE_US 50000
 
 struct _robot robot;
 
@@ -110,157 +120,391 @@ void robot_init(void)
                        acc_rd2imp(&robot.traj, 30.));
 }
 
-static THD_FUNCTION(base_ctrl_thd, arg)
+/* The control loop is clocked by TIM6, so that it does not drift and keeps
+ * a fixed phase. Each cycle runs the whole chain in order, so that the
+ * controllers always act on the odometry and trajectory of the same cycle. */
+#define BASE_CTRL_TIMER GPTD6
+#define BASE_CTRL_TIMER_FREQUENCY 1000000
+#define BASE_CTRL_PERIOD_US (BASE_CTRL_TIMER_FREQUENCY / ASSERV_FREQUENCY)
+#define BASE_CTRL_TICK_EVENT EVENT_MASK(0)
+
+static thread_t* base_ctrl_thread;
+static volatile uint32_t base_ctrl_ticks;
+
+static void base_ctrl_timer_cb(GPTDriver* gptp)
 {
-    (void)arg;
-    chRegSetThreadName(__FUNCTION__);
+    (void)gptp;
+    chSysLockFromISR();
+    base_ctrl_ticks++;
+    chEvtSignalI(base_ctrl_thread, BASE_CTRL_TICK_EVENT);
+    chSysUnlockFromISR();
+}
 
-    parameter_namespace_t* control_params = parameter_namespace_find(&master_config, "aversive/control");
-    parameter_namespace_t* odometry_params = parameter_namespace_find(&master_config, "odometry");
-    while (1) {
-        rs_update(&robot.rs);
-
-        /* Control system manage */
-        if (robot.mode != BOARD_MODE_SET_PWM) {
-            if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_ANGLE_ONLY) {
-                cs_manage(&robot.angle_cs);
-            } else {
-                rs_set_angle(&robot.rs, 0); // Sets angle PWM to zero
-            }
-
-            if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_DISTANCE_ONLY) {
-                cs_manage(&robot.distance_cs);
-            } else {
-                rs_set_distance(&robot.rs, 0); // Sets distance PWM to zero
-            }
-        }
+static const GPTConfig base_ctrl_timer_config = {
+    .frequency = BASE_CTRL_TIMER_FREQUENCY,
+    .callback = base_ctrl_timer_cb,
+    .cr2 = 0,
+    .dier = 0,
+};
+
+struct pid_params {
+    parameter_t* kp;
+    parameter_t* ki;
+    parameter_t* kd;
+    parameter_t* i_limit;
+};
+
+/* Parameters used by the control loop, looked up once at startup. */
+struct base_ctrl_params {
+    parameter_namespace_t* control;
+    parameter_namespace_t* odometry;
+    parameter_namespace_t* trajectories;
+
+    struct pid_params angle_pid;
+    struct pid_params distance_pid;
+
+    parameter_t* left_wheel_correction_factor;
+    parameter_t* right_wheel_correction_factor;
+    parameter_t* external_track_mm;
+    parameter_t* external_encoder_ticks_per_mm;
+
+    parameter_t* window_distance;
+    parameter_t* window_angle;
+    parameter_t* window_angle_start;
+
+    parameter_t* collision_enabled;
+    parameter_t* residual_threshold;
+    parameter_t* current_threshold;
+    parameter_t* collision_cycles;
+    parameter_t* opponent_distance;
+    parameter_t* opponent_gain;
+
+    speed_profile_table_t speed_profiles;
+};
+
+static TOPIC_DECL(collision_topic, Collision);
+
+static void pid_params_find(struct pid_params* p, parameter_namespace_t* ns)
+{
+    p->kp = parameter_find(ns, "kp");
+    p->ki = parameter_find(ns, "ki");
+    p->kd = parameter_find(ns, "kd");
+    p->i_limit = parameter_find(ns, "i_limit");
+}
+
+static void pid_params_apply(struct pid_params* p, cs_pid_t* pid)
+{
+    pid_set_gains(&pid->pid,
+                  parameter_scalar_get(p->kp),
+                  parameter_scalar_get(p->ki),
+                  parameter_scalar_get(p->kd));
+    pid_set_integral_limit(&pid->pid, parameter_scalar_get(p->i_limit));
+}
 
-        /* Blocking detection manage */
-        bd_manage(&robot.angle_bd, abs(cs_get_error(&robot.angle_cs)));
-        bd_manage(&robot.distance_bd, abs(cs_get_error(&robot.distance_cs)));
+static void collision_params_get(struct base_ctrl_params* params, collision_detector_params_t* p)
+{
+    p->residual_threshold = parameter_scalar_get(params->residual_threshold);
+    p->current_threshold = parameter_scalar_get(params->current_threshold);
+    p->cycles = parameter_integer_get(params->collision_cycles);
+    p->opponent_distance = parameter_scalar_get(params->opponent_distance);
+    p->opponent_gain = parameter_scalar_get(params->opponent_gain);
+}
 
-        /* Collision detected */
-        if (bd_get(&robot.distance_bd)) {
-            WARNING("Collision detected in distance !");
-        }
-        if (bd_get(&robot.angle_bd)) {
-            WARNING("Collision detected in angle !");
-        }
+static void base_ctrl_params_init(struct base_ctrl_params* params)
+{
+    params->control = parameter_namespace_find(&master_config, "aversive/control");
+    params->odometry = parameter_namespace_find(&master_config, "odometry");
+    params->trajectories = parameter_namespace_find(&master_config, "aversive/trajectories");
+
+    pid_params_find(&params->angle_pid, parameter_namespace_find(params->control, "angle"));
+    pid_params_find(&params->distance_pid, parameter_namespace_find(params->control, "distance"));
+
+    params->left_wheel_correction_factor = parameter_find(params->odometry, "left_wheel_correction_factor");
+    params->right_wheel_correction_factor = parameter_find(params->odometry, "right_wheel_correction_factor");
+    params->external_track_mm = parameter_find(params->odometry, "external_track_mm");
+    params->external_encoder_ticks_per_mm = parameter_find(params->odometry, "external_encoder_ticks_per_mm");
+
+    params->window_distance = parameter_find(params->trajectories, "windows/distance");
+    params->window_angle = parameter_find(params->trajectories, "windows/angle");
+    params->window_angle_start = parameter_find(params->trajectories, "windows/angle_start");
+
+    params->collision_enabled = parameter_find(params->control, "collision/enabled");
+    params->residual_threshold = parameter_find(params->control, "collision/residual_threshold");
+    params->current_threshold = parameter_find(params->control, "collision/current_threshold");
+    params->collision_cycles = parameter_find(params->control, "collision/cycles");
+    params->opponent_distance = parameter_find(params->control, "collision/opponent_distance");
+    params->opponent_gain = parameter_find(params->control, "collision/opponent_gain");
+
+    collision_detector_params_t collision;
+    collision_params_get(params, &collision);
+    collision_detector_init(&robot.collision, &collision);
+
+    if (!speed_profile_table_init(&params->speed_profiles, params->trajectories)) {
+        ERROR("Missing trajectory speed parameters");
+    }
+    speed_profile_table_update(&params->speed_profiles, &robot.traj);
+}
+
+/* Largest difference between the speed asked to a wheel by the trajectory
+ * and its measured speed, in mm/s. It must be called every cycle, before the
+ * regulation computes the next command. */
+static float base_velocity_residual(void)
+{
+    static int32_t previous_distance, previous_angle;
+    int32_t distance = rs_get_ext_distance(&robot.rs);
+    int32_t angle = rs_get_ext_angle(&robot.rs);
+
+    /* The ramps hold the speed they asked for during the last cycle */
+    float distance_residual = robot.distance_qr.previous_var - (distance - previous_distance);
+    float angle_residual = robot.angle_qr.previous_var - (angle - previous_angle);
 
-        if (parameter_namespace_contains_changed(control_params)) {
-            float kp, ki, kd, ilim;
-            pid_get_gains(&robot.angle_pid.pid, &kp, &ki, &kd);
-            kp = parameter_scalar_get(parameter_find(control_params, "angle/kp"));
-            ki = parameter_scalar_get(parameter_find(control_params, "angle/ki"));
-            kd = parameter_scalar_get(parameter_find(control_params, "angle/kd"));
-            ilim = parameter_scalar_get(parameter_find(control_params, "angle/i_limit"));
-            pid_set_gains(&robot.angle_pid.pid, kp, ki, kd);
-            pid_set_integral_limit(&robot.angle_pid.pid, ilim);
-
-            pid_get_gains(&robot.distance_pid.pid, &kp, &ki, &kd);
-            kp = parameter_scalar_get(parameter_find(control_params, "distance/kp"));
-            ki = parameter_scalar_get(parameter_find(control_params, "distance/ki"));
-            kd = parameter_scalar_get(parameter_find(control_params, "distance/kd"));
-            ilim = parameter_scalar_get(parameter_find(control_params, "distance/i_limit"));
-            pid_set_gains(&robot.distance_pid.pid, kp, ki, kd);
-            pid_set_integral_limit(&robot.distance_pid.pid, ilim);
+    previous_distance = distance;
+    previous_angle = angle;
+
+    if (robot.mode == BOARD_MODE_DISTANCE_ONLY) {
+        angle_residual = 0;
+    } else if (robot.mode == BOARD_MODE_ANGLE_ONLY) {
+        distance_residual = 0;
+    }
+
+    /* Each wheel moves by the distance plus or minus the angle */
+    float residual_imp = fabsf(distance_residual) + fabsf(angle_residual);
+    return residual_imp * ASSERV_FREQUENCY / robot.pos.phys.distance_imp_per_mm;
+}
+
+/* Largest absolute wheel current in A, NAN if the wheels do not stream it */
+static float base_wheel_current(void)
+{
+    static motor_driver_t* wheels[2];
+    static const char* wheel_names[2] = {"left-wheel", "right-wheel"};
+    float current = 0;
+
+    for (int i = 0; i < 2; i++) {
+        motor_driver_stream_sample_t sample;
+
+        if (wheels[i] == NULL) {
+            wheels[i] = bus_enumerator_get_driver(motor_manager.bus_enumerator, wheel_names[i]);
         }
-        if (parameter_namespace_contains_changed(odometry_params)) {
-            rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, NULL,
-                                    config_get_scalar("master/odometry/left_wheel_correction_factor"));
-            rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, NULL,
-                                     config_get_scalar("master/odometry/right_wheel_correction_factor"));
-
-            position_set_physical_params(&robot.pos,
-                                         config_get_scalar("master/odometry/external_track_mm"),
-                                         config_get_scalar("master/odometry/external_encoder_ticks_per_mm"));
+        if (wheels[i] == NULL
+            || !motor_driver_get_stream_sample(wheels[i], MOTOR_STREAM_CURRENT, &sample)
+            || sample.count == 0
+            || timestamp_duration_us(sample.timestamp, timestamp_get()) > COLLISION_MAX_CURRENT_AGE_US) {
+            return NAN;
         }
+        current = fmaxf(current, fabsf(sample.value));
+    }
 
-        switch (robot.base_speed) {
-            case BASE_SPEED_INIT:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/init")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/init")));
-
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/init")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/init")));
-                break;
-
-            case BASE_SPEED_SLOW:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/slow")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/slow")));
-
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/slow")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/slow")));
-                break;
-
-            case BASE_SPEED_FAST:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/fast")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/fast")));
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/fast")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/fast")));
-                break;
-            default:
-                WARNING("Unknown speed type, going back to safe!");
-                robot.base_speed = BASE_SPEED_SLOW;
-                break;
-        }
+    return current;
+}
 
-        /* Wait until next regulation loop */
-        chThdSleepMilliseconds(1000 / ASSERV_FREQUENCY);
+/* Distance to the opponent seen by the beacon in m, INFINITY if none */
+static float base_opponent_distance(void)
+{
+    static messagebus_topic_t* topic;
+    BeaconSignal beacon_signal;
+
+    if (topic == NULL) {
+        topic = messagebus_find_topic(&bus, "/proximity_beacon");
+    }
+
+    if (topic
+        && messagebus_topic_read(topic, &beacon_signal, sizeof(beacon_signal))
+        && timestamp_duration_s(beacon_signal.timestamp.us, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION) {
+        return beacon_signal.range.range.distance;
     }
+
+    return INFINITY;
 }
 
-void base_controller_start(void)
+static void collision_publish(collision_t collision)
 {
-    static THD_WORKING_AREA(base_ctrl_thd_wa, BASE_CONTROLLER_STACKSIZE);
-    chThdCreateStatic(base_ctrl_thd_wa, sizeof(base_ctrl_thd_wa), BASE_CONTROLLER_PRIO, base_ctrl_thd, NULL);
+    Collision msg = Collision_init_zero;
+
+    msg.timestamp.us = timestamp_get();
+    msg.cause = collision == COLLISION_OPPONENT ? Collision_Cause_OPPONENT : Collision_Cause_BLOCKED;
+    msg.x = position_get_x_float(&robot.pos);
+    msg.y = position_get_y_float(&robot.pos);
+    msg.a = position_get_a_rad_float(&robot.pos);
+    msg.velocity_residual = robot.collision.residual;
+    msg.current = robot.collision.current;
+    msg.opponent_distance = robot.collision.opponent_distance;
+
+    messagebus_topic_publish(&collision_topic.topic, &msg, sizeof(msg));
 }
 
-static THD_FUNCTION(position_manager_thd, arg)
+/* Stops the trajectory in the cycle a collision is detected, before the
+ * regulation acts on it. The collision is kept until the next trajectory
+ * starts, so that it is reported as its end reason. Code watching the end of
+ * a trajectory for collisions resets the detector when starting it, the reset
+ * here covers the other ones. */
+static void base_collision_manage(struct base_ctrl_params* params)
+{
+    static bool was_running;
+    float residual = base_velocity_residual();
+
+    /* The state of a finished goto stays RUNNING_XY_ANGLE_OK, while the xy
+     * events are scheduled until the goal is reached */
+    bool running = robot.traj.scheduled || !trajectory_finished(&robot.traj);
+
+    if (running && !was_running) {
+        collision_detector_reset(&robot.collision);
+    }
+    was_running = running;
+
+    if (!running || robot.mode == BOARD_MODE_SET_PWM || !parameter_boolean_get(params->collision_enabled)) {
+        return;
+    }
+
+    collision_t collision = collision_detector_update(&robot.collision,
+                                                      residual,
+                                                      base_wheel_current(),
+                                                      base_opponent_distance());
+    if (collision != COLLISION_NONE) {
+        trajectory_hardstop(&robot.traj);
+        collision_publish(collision);
+        WARNING("Collision detected, stopping (%.0f mm/s, %.2f A)", robot.collision.residual, robot.collision.current);
+    }
+}
+
+static void base_ctrl_cycle(struct base_ctrl_params* params)
+{
+    /* Read the encoders, then update odometry and trajectory with them */
+    rs_update(&robot.rs);
+    encoder_publish();
+    position_manage(&robot.pos);
+    pose_fusion_update(&robot.pos);
+    trajectory_manager_manage(&robot.traj);
+    base_collision_manage(params);
+
+    /* Control system manage */
+    if (robot.mode != BOARD_MODE_SET_PWM) {
+        if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_ANGLE_ONLY) {
+            cs_manage(&robot.angle_cs);
+        } else {
+            rs_set_angle(&robot.rs, 0); // Sets angle PWM to zero
+        }
+
+        if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_DISTANCE_ONLY) {
+            cs_manage(&robot.distance_cs);
+        } else {
+            rs_set_distance(&robot.rs, 0); // Sets distance PWM to zero
+        }
+    }
+
+    /* Blocking detection manage */
+    bd_manage(&robot.angle_bd, abs(cs_get_error(&robot.angle_cs)));
+    bd_manage(&robot.distance_bd, abs(cs_get_error(&robot.distance_cs)));
+
+    /* Collision detected */
+    if (bd_get(&robot.distance_bd)) {
+        WARNING("Collision detected in distance !");
+    }
+    if (bd_get(&robot.angle_bd)) {
+        WARNING("Collision detected in angle !");
+    }
+
+    if (parameter_namespace_contains_changed(params->control)) {
+        pid_params_apply(&params->angle_pid, &robot.angle_pid);
+        pid_params_apply(&params->distance_pid, &robot.distance_pid);
+
+        collision_detector_params_t collision;
+        collision_params_get(params, &collision);
+        collision_detector_set_params(&robot.collision, &collision);
+    }
+
+    /* The speed profiles depend on the odometry too */
+    if (parameter_namespace_contains_changed(params->odometry)
+        || parameter_namespace_contains_changed(params->trajectories)) {
+        rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, NULL,
+                                parameter_scalar_get(params->left_wheel_correction_factor));
+        rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, NULL,
+                                 parameter_scalar_get(params->right_wheel_correction_factor));
+
+        position_set_physical_params(&robot.pos,
+                                     parameter_scalar_get(params->external_track_mm),
+                                     parameter_scalar_get(params->external_encoder_ticks_per_mm));
+
+        trajectory_set_windows(&robot.traj,
+                               parameter_scalar_get(params->window_distance),
+                               parameter_scalar_get(params->window_angle),
+                               parameter_scalar_get(params->window_angle_start));
+
+        speed_profile_table_update(&params->speed_profiles, &robot.traj);
+    }
+
+    const speed_profile_t* profile = speed_profile_get(&params->speed_profiles, robot.base_speed);
+    if (profile == NULL) {
+        WARNING("Unknown speed type, going back to safe!");
+        robot.base_speed = BASE_SPEED_SLOW;
+        profile = speed_profile_get(&params->speed_profiles, robot.base_speed);
+    }
+    speed_profile_apply(profile, &robot.traj);
+}
+
+static THD_FUNCTION(base_ctrl_thd, arg)
 {
     (void)arg;
     chRegSetThreadName(__FUNCTION__);
 
     static TOPIC_DECL(position_topic, RobotPosition);
+    static TOPIC_DECL(loop_stats_topic, ControlLoopStats);
 
     messagebus_advertise_topic(&bus, &position_topic.topic, "/position");
+    messagebus_advertise_topic(&bus, &loop_stats_topic.topic, "/base/loop_stats");
+    messagebus_advertise_topic(&bus, &collision_topic.topic, "/collision");
+
+    static struct base_ctrl_params params;
+    base_ctrl_params_init(&params);
+    pose_fusion_init();
 
     RobotPosition pos = RobotPosition_init_zero;
+    ControlLoopStats loop_stats = ControlLoopStats_init_zero;
+    control_loop_stats_t stats;
+    control_loop_stats_init(&stats, BASE_CTRL_PERIOD_US);
+
+    uint32_t last_tick = 0;
+
+    base_ctrl_thread = chThdGetSelfX();
+    gptStart(&BASE_CTRL_TIMER, &base_ctrl_timer_config);
+    gptStartContinuous(&BASE_CTRL_TIMER, BASE_CTRL_PERIOD_US);
 
     while (1) {
-        position_manage(&robot.pos);
+        chEvtWaitAny(BASE_CTRL_TICK_EVENT);
+
+        /* The timer restarts from zero at every tick, its counter is the
+         * time elapsed since then. */
+        uint32_t latency = gptGetCounterX(&BASE_CTRL_TIMER);
+        uint32_t tick = base_ctrl_ticks;
+        timestamp_t start = timestamp_get();
+
+        base_ctrl_cycle(&params);
+
         pos.x = position_get_x_float(&robot.pos);
         pos.y = position_get_y_float(&robot.pos);
         pos.a = position_get_a_rad_float(&robot.pos);
+        pose_fusion_get_covariance(&pos.variance_x, &pos.variance_y, &pos.variance_a, &pos.covariance_xy);
+        pos.has_variance_x = pos.has_variance_y = pos.has_variance_a = pos.has_covariance_xy = true;
         messagebus_topic_publish(&position_topic.topic, &pos, sizeof(pos));
-        chThdSleepMilliseconds(1000 / ODOM_FREQUENCY);
-    }
-}
-
-void position_manager_start(void)
-{
-    static THD_WORKING_AREA(position_thd_wa, POSITION_MANAGER_STACKSIZE);
-    chThdCreateStatic(position_thd_wa, sizeof(position_thd_wa), POSITION_MANAGER_PRIO, position_manager_thd, NULL);
-}
-
-void trajectory_manager_thd(void* param)
-{
-    struct trajectory* traj = (struct trajectory*)param;
 
-    while (1) {
-        trajectory_manager_manage(traj);
-        chThdSleepMilliseconds(1000 / TRAJECTORY_EVENT_FREQUENCY);
+        uint32_t exec_time = timestamp_duration_us(start, timestamp_get());
+        control_loop_stats_record(&stats, latency, exec_time, tick - last_tick - 1);
+        last_tick = tick;
+
+        if (stats.window_cycles == ASSERV_FREQUENCY) {
+            loop_stats.cycles = stats.cycles;
+            loop_stats.overruns = stats.overruns;
+            loop_stats.latency_mean = control_loop_stats_latency_mean(&stats);
+            loop_stats.latency_max = stats.latency_max_us;
+            loop_stats.exec_time_mean = control_loop_stats_exec_time_mean(&stats);
+            loop_stats.exec_time_max = stats.exec_time_max_us;
+            messagebus_topic_publish(&loop_stats_topic.topic, &loop_stats, sizeof(loop_stats));
+            control_loop_stats_window_reset(&stats);
+        }
     }
 }
 
-void trajectory_manager_start(void)
+void base_controller_start(void)
 {
-    static THD_WORKING_AREA(trajectory_thd_wa, TRAJECTORY_MANAGER_STACKSIZE);
-    chThdCreateStatic(trajectory_thd_wa, sizeof(trajectory_thd_wa), TRAJECTORY_MANAGER_PRIO, trajectory_manager_thd, &(robot.traj));
+    static THD_WORKING_AREA(base_ctrl_thd_wa, BASE_CONTROLLER_STACKSIZE);
+    chThdCreateStatic(base_ctrl_thd_wa, sizeof(base_ctrl_thd_wa), BASE_CONTROLLER_PRIO, base_ctrl_thd, NULL);
 }
@@ -10,15 +10,16 @@
 #include <aversive/trajectory_manager/trajectory_manager.h>
 
 #include "cs_port.h"
+#include "speed_profile.h"
+#include "collision_detector.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/** Frequency of the regulation loop and odometry loop (in Hz) */
+/** Frequency of the base control loop (in Hz). Odometry, trajectory and
+ * regulation run in sequence in each cycle. */
 #define ASSERV_FREQUENCY 100
-#define ODOM_FREQUENCY 100
-#define TRAJECTORY_EVENT_FREQUENCY 100
 
 /**
  @brief Type of the regulators
@@ -44,12 +45,6 @@ enum direction_t {
     DIRECTION_FORWARD = 1,
 };
 
-enum base_speed_t {
-    BASE_SPEED_INIT,
-    BASE_SPEED_SLOW,
-    BASE_SPEED_FAST
-};
-
 /**
  @brief contains all global vars.
 
@@ -71,6 +66,7 @@ struct _robot {
     struct trajectory traj; // Trivial trajectory manager
     struct blocking_detection angle_bd; // Angle blocking detection manager
     struct blocking_detection distance_bd; // Distance blocking detection manager
+    collision_detector_t collision; // Stops the trajectory when the robot runs into something
 
     enum board_mode_t mode; // The current board mode
 
@@ -88,12 +84,10 @@ void robot_init(void);
 void robot_trajectory_windows_set_coarse(void);
 void robot_trajectory_windows_set_fine(void);
 
+/** Starts the base control loop, which updates odometry, trajectory and
+ * regulation, and publishes /position, /base/loop_stats and /collision. */
 void base_controller_start(void);
 
-void position_manager_start(void);
-
-void trajectory_manager_start(void);
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,64 @@
+#include <math.h>
+#include <string.h>
+
+#include "collision_detector.h"
+
+void collision_detector_init(collision_detector_t* detector, const collision_detector_params_t* params)
+{
+    memset(detector, 0, sizeof(*detector));
+    detector->params = *params;
+}
+
+void collision_detector_set_params(collision_detector_t* detector, const collision_detector_params_t* params)
+{
+    detector->params = *params;
+}
+
+collision_t collision_detector_update(collision_detector_t* detector,
+                                      float residual,
+                                      float current,
+                                      float opponent_distance)
+{
+    const collision_detector_params_t* params = &detector->params;
+
+    if (detector->collision != COLLISION_NONE) {
+        return COLLISION_NONE;
+    }
+
+    bool opponent_near = opponent_distance < params->opponent_distance;
+    float scale = opponent_near ? params->opponent_gain : 1.f;
+    uint16_t cycles = opponent_near ? 1 : params->cycles;
+
+    bool blocked = fabsf(residual) > scale * params->residual_threshold;
+    if (!isnan(current)) {
+        blocked = blocked && fabsf(current) > scale * params->current_threshold;
+    }
+
+    if (!blocked) {
+        detector->count = 0;
+        return COLLISION_NONE;
+    }
+
+    detector->count++;
+    if (detector->count < cycles) {
+        return COLLISION_NONE;
+    }
+
+    detector->collision = opponent_near ? COLLISION_OPPONENT : COLLISION_BLOCKED;
+    detector->residual = residual;
+    detector->current = current;
+    detector->opponent_distance = opponent_distance;
+
+    return detector->collision;
+}
+
+collision_t collision_detector_get(const collision_detector_t* detector)
+{
+    return detector->collision;
+}
+
+void collision_detector_reset(collision_detector_t* detector)
+{
+    detector->count = 0;
+    detector->collision = COLLISION_NONE;
+}
@@ -0,0 +1,80 @@
+#ifndef COLLISION_DETECTOR_H
+#define COLLISION_DETECTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Detection of the robot running into something.
+ *
+ * Every control cycle, the speed asked by the trajectory is compared with the
+ * measured one. A blocked robot keeps getting commands it cannot follow, and
+ * its wheel motors draw more current while pushing. The robot is blocked when
+ * both are over their thresholds for enough consecutive cycles. When the
+ * currents are not measured, the speed residual alone is used.
+ *
+ * When an opponent is seen closer than a given distance, contact is expected:
+ * the thresholds are scaled down and a single cycle is enough, so that the
+ * robot can be stopped on the first sign of it.
+ *
+ * A detected collision is kept until the detector is reset.
+ */
+typedef struct {
+    float residual_threshold; ///< Difference between command and measured speed, in mm/s
+    float current_threshold; ///< Wheel current of a pushing robot, in A
+    uint16_t cycles; ///< Consecutive cycles over the thresholds to trigger
+    float opponent_distance; ///< Opponent distance below which contact is expected, in m
+    float opponent_gain; ///< Scale of the thresholds when contact is expected
+} collision_detector_params_t;
+
+typedef enum {
+    COLLISION_NONE = 0,
+    COLLISION_BLOCKED, ///< Blocked without an opponent around, by a wall or a game element
+    COLLISION_OPPONENT, ///< Blocked with an opponent close by
+} collision_t;
+
+typedef struct {
+    collision_detector_params_t params;
+    uint16_t count; ///< Consecutive cycles over the thresholds
+    collision_t collision; ///< Detected collision, kept until reset
+
+    float residual; ///< Speed residual at the detection, in mm/s
+    float current; ///< Wheel current at the detection, in A
+    float opponent_distance; ///< Opponent distance at the detection, in m
+} collision_detector_t;
+
+void collision_detector_init(collision_detector_t* detector, const collision_detector_params_t* params);
+
+/** Changes the thresholds, keeping the detection state. */
+void collision_detector_set_params(collision_detector_t* detector, const collision_detector_params_t* params);
+
+/** Updates the detector with the measurements of one control cycle.
+ *
+ * @param [in] residual Difference between the commanded and the measured
+ * speed of the robot, in mm/s.
+ * @param [in] current Largest absolute wheel current in A, NAN if it is not
+ * measured.
+ * @param [in] opponent_distance Distance to the closest opponent in m,
+ * INFINITY if none is seen.
+ *
+ * @return The collision detected during this cycle, COLLISION_NONE if there is
+ * none or if it was already detected before.
+ */
+collision_t collision_detector_update(collision_detector_t* detector,
+                                      float residual,
+                                      float current,
+                                      float opponent_distance);
+
+/** Collision detected since the last reset, COLLISION_NONE if there is none. */
+collision_t collision_detector_get(const collision_detector_t* detector);
+
+void collision_detector_reset(collision_detector_t* detector);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COLLISION_DETECTOR_H */
@@ -0,0 +1,59 @@
+#include <string.h>
+#include "control_loop_stats.h"
+
+void control_loop_stats_init(control_loop_stats_t* stats, uint32_t period_us)
+{
+    memset(stats, 0, sizeof(control_loop_stats_t));
+    stats->period_us = period_us;
+}
+
+void control_loop_stats_record(control_loop_stats_t* stats,
+                               uint32_t latency_us,
+                               uint32_t exec_time_us,
+                               uint32_t missed_ticks)
+{
+    stats->cycles++;
+    stats->overruns += missed_ticks;
+
+    /* The cycle must end before the next tick to keep its phase. */
+    if (latency_us + exec_time_us > stats->period_us) {
+        stats->overruns++;
+    }
+
+    stats->window_cycles++;
+    stats->latency_sum_us += latency_us;
+    stats->exec_time_sum_us += exec_time_us;
+
+    if (latency_us > stats->latency_max_us) {
+        stats->latency_max_us = latency_us;
+    }
+
+    if (exec_time_us > stats->exec_time_max_us) {
+        stats->exec_time_max_us = exec_time_us;
+    }
+}
+
+float control_loop_stats_latency_mean(const control_loop_stats_t* stats)
+{
+    if (stats->window_cycles == 0) {
+        return 0.f;
+    }
+    return (float)stats->latency_sum_us / stats->window_cycles;
+}
+
+float control_loop_stats_exec_time_mean(const control_loop_stats_t* stats)
+{
+    if (stats->window_cycles == 0) {
+        return 0.f;
+    }
+    return (float)stats->exec_time_sum_us / stats->window_cycles;
+}
+
+void control_loop_stats_window_reset(control_loop_stats_t* stats)
+{
+    stats->window_cycles = 0;
+    stats->latency_sum_us = 0;
+    stats->latency_max_us = 0;
+    stats->exec_time_sum_us = 0;
+    stats->exec_time_max_us = 0;
+}
@@ -0,0 +1,53 @@
+#ifndef CONTROL_LOOP_STATS_H
+#define CONTROL_LOOP_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Timing statistics of a periodic loop.
+ *
+ * Totals are kept since initialization, the latency and execution time
+ * statistics over a window which is restarted by the user, usually after
+ * publishing them.
+ */
+typedef struct {
+    uint32_t period_us;
+    uint32_t cycles; ///< Total number of cycles
+    uint32_t overruns; ///< Total number of cycles which ended after the next tick
+
+    uint32_t window_cycles;
+    uint32_t latency_sum_us; ///< Sum of the timer tick to cycle start delays
+    uint32_t latency_max_us;
+    uint32_t exec_time_sum_us; ///< Sum of the cycle durations
+    uint32_t exec_time_max_us;
+} control_loop_stats_t;
+
+void control_loop_stats_init(control_loop_stats_t* stats, uint32_t period_us);
+
+/** Records one cycle of the loop.
+ *
+ * @param [in] latency_us Delay between the timer tick and the start of the cycle.
+ * @param [in] exec_time_us Duration of the cycle.
+ * @param [in] missed_ticks Number of ticks which were not served since the
+ * previous cycle. They are counted as overruns too.
+ */
+void control_loop_stats_record(control_loop_stats_t* stats,
+                               uint32_t latency_us,
+                               uint32_t exec_time_us,
+                               uint32_t missed_ticks);
+
+/** Mean values over the current window, zero if it is empty. */
+float control_loop_stats_latency_mean(const control_loop_stats_t* stats);
+float control_loop_stats_exec_time_mean(const control_loop_stats_t* stats);
+
+/** Starts a new statistics window, totals are kept. */
+void control_loop_stats_window_reset(control_loop_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_LOOP_STATS_H */
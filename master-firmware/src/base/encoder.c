@@ -1,16 +1,27 @@
 #include <ch.h>
 #include <hal.h>
+#include <timestamp/timestamp.h>
 #include "msgbus/messagebus.h"
 #include "main.h"
-#include "priorities.h"
 #include "encoder.h"
+#include "encoder_velocity.h"
 #include "protobuf/encoders.pb.h"
 
-#define ENCODER_STACKSIZE 512
-
 #define MAX_16BIT 65535
 #define MAX_16BIT_DIV2 32767
 
+/* The timers count both edges of both channels, and capture the rising
+ * edges of channel 1, so there are 4 ticks between two captures. */
+#define ENCODER_TICKS_PER_EDGE 4
+
+/* Below this speed, only a few ticks are counted per control cycle and the
+ * velocity is measured from the edge periods. */
+#define ENCODER_LOW_SPEED_TICKS_PER_S 2000.f
+
+/* Less urgent than the timestamp timer interrupt, which must be able to
+ * preempt the capture to read the time */
+#define ENCODER_CAPTURE_IRQ_PRIORITY 7
+
 static void setup_timer(stm32_tim_t* tmr);
 
 uint32_t encoder_get_left(void)
@@ -42,16 +53,71 @@ int encoder_tick_diff(uint32_t enc_old, uint32_t enc_new)
     }
 }
 
-static THD_FUNCTION(encoders_thd, arg)
+/* Counter value and time of the first edge after the capture was armed */
+struct edge_capture {
+    volatile bool done;
+    volatile uint32_t counter;
+    volatile timestamp_t time;
+};
+
+static struct edge_capture left_capture, right_capture;
+
+static TOPIC_DECL(encoders_topic, WheelEncoders);
+static WheelEncoders encoders_values = WheelEncoders_init_zero;
+static uint32_t left_old, right_old;
+static encoder_velocity_t left_velocity, right_velocity;
+
+/* The capture interrupt disables itself, so that there is at most one per
+ * wheel and control cycle whatever the speed. */
+static void capture_irq(stm32_tim_t* tmr, struct edge_capture* capture)
 {
-    (void)arg;
-    chRegSetThreadName(__FUNCTION__);
+    if (tmr->SR & STM32_TIM_SR_CC1IF) {
+        capture->time = timestamp_get();
+        capture->counter = tmr->CCR[0]; // also clears the flag
+        capture->done = true;
+        tmr->DIER &= ~STM32_TIM_DIER_CC1IE;
+    }
+    tmr->SR = 0;
+}
 
-    /* Setup and advertise encoders topic */
-    static TOPIC_DECL(encoders_topic, WheelEncodersPulse);
+CH_IRQ_HANDLER(STM32_TIM4_HANDLER)
+{
+    CH_IRQ_PROLOGUE();
+    capture_irq(STM32_TIM4, &left_capture);
+    CH_IRQ_EPILOGUE();
+}
 
-    messagebus_advertise_topic(&bus, &encoders_topic.topic, "/encoders");
+CH_IRQ_HANDLER(STM32_TIM3_HANDLER)
+{
+    CH_IRQ_PROLOGUE();
+    capture_irq(STM32_TIM3, &right_capture);
+    CH_IRQ_EPILOGUE();
+}
+
+static void capture_arm(stm32_tim_t* tmr, struct edge_capture* capture)
+{
+    capture->done = false;
+    tmr->SR = ~STM32_TIM_SR_CC1IF;
+    tmr->DIER |= STM32_TIM_DIER_CC1IE;
+}
+
+/* Feeds the last captured edge to the velocity estimator, then rearms the
+ * capture for the next cycle. */
+static void capture_process(stm32_tim_t* tmr,
+                            struct edge_capture* capture,
+                            encoder_velocity_t* velocity,
+                            int32_t ticks,
+                            uint32_t counter)
+{
+    if (capture->done) {
+        int32_t edge_ticks = ticks - encoder_tick_diff(capture->counter, counter);
+        encoder_velocity_capture(velocity, edge_ticks, capture->time);
+    }
+    capture_arm(tmr, capture);
+}
 
+void encoder_init(void)
+{
     /* Configure encoder timers */
     rccEnableTIM4(FALSE);
     rccResetTIM4();
@@ -61,27 +127,54 @@ static THD_FUNCTION(encoders_thd, arg)
     rccResetTIM3();
     setup_timer(STM32_TIM3);
 
-    uint32_t left_old, right_old;
-    WheelEncodersPulse values = WheelEncodersPulse_init_zero;
-
     left_old = encoder_get_left();
     right_old = encoder_get_right();
 
-    while (1) {
-        uint32_t left, right;
+    timestamp_t now = timestamp_get();
+    encoder_velocity_init(&left_velocity, ENCODER_LOW_SPEED_TICKS_PER_S, ENCODER_TICKS_PER_EDGE, 0, now);
+    encoder_velocity_init(&right_velocity, ENCODER_LOW_SPEED_TICKS_PER_S, ENCODER_TICKS_PER_EDGE, 0, now);
+
+    nvicEnableVector(STM32_TIM4_NUMBER, ENCODER_CAPTURE_IRQ_PRIORITY);
+    nvicEnableVector(STM32_TIM3_NUMBER, ENCODER_CAPTURE_IRQ_PRIORITY);
+    capture_arm(STM32_TIM4, &left_capture);
+    capture_arm(STM32_TIM3, &right_capture);
+
+    messagebus_advertise_topic(&bus, &encoders_topic.topic, "/encoders");
+}
+
+void encoder_publish(void)
+{
+    uint32_t left, right;
+    timestamp_t now;
 
-        left = encoder_get_left();
-        right = encoder_get_right();
+    left = encoder_get_left();
+    right = encoder_get_right();
+    now = timestamp_get();
 
-        values.left += encoder_tick_diff(left_old, left);
-        values.right += encoder_tick_diff(right_old, right);
+    encoders_values.left += encoder_tick_diff(left_old, left);
+    encoders_values.right += encoder_tick_diff(right_old, right);
 
-        messagebus_topic_publish(&encoders_topic.topic, &values, sizeof(values));
+    capture_process(STM32_TIM4, &left_capture, &left_velocity, encoders_values.left, left);
+    capture_process(STM32_TIM3, &right_capture, &right_velocity, encoders_values.right, right);
 
-        left_old = left;
-        right_old = right;
-        chThdSleepMilliseconds(10);
-    }
+    encoders_values.timestamp.us = now;
+    encoders_values.left_velocity = encoder_velocity_update(&left_velocity, encoders_values.left, now);
+    encoders_values.right_velocity = encoder_velocity_update(&right_velocity, encoders_values.right, now);
+
+    messagebus_topic_publish(&encoders_topic.topic, &encoders_values, sizeof(encoders_values));
+
+    left_old = left;
+    right_old = right;
+}
+
+float encoder_get_left_velocity(void)
+{
+    return left_velocity.velocity;
+}
+
+float encoder_get_right_velocity(void)
+{
+    return right_velocity.velocity;
 }
 
 static void setup_timer(stm32_tim_t* tmr)
@@ -94,13 +187,7 @@ static void setup_timer(stm32_tim_t* tmr)
     tmr->CCMR1 = STM32_TIM_CCMR1_CC1S(1); // CC1 channel is input, IC1 is mapped on TI1
     tmr->CCMR1 |= STM32_TIM_CCMR1_CC2S(1); // CC2 channel is input, IC2 is mapped on TI2
     tmr->CCMR1 |= STM32_TIM_CCMR1_IC1F(3); // Activate some input filtering
-    tmr->CCER = 0;
+    tmr->CCER = STM32_TIM_CCER_CC1E; // capture the counter on rising edges of TI1
     tmr->ARR = 0xFFFF;
     tmr->CR1 = 1; // start
 }
-
-void encoder_start(void)
-{
-    static THD_WORKING_AREA(encoders_thd_wa, ENCODER_STACKSIZE);
-    chThdCreateStatic(encoders_thd_wa, sizeof(encoders_thd_wa), ENCODER_PRIO, encoders_thd, NULL);
-}
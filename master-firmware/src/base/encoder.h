@@ -8,13 +8,21 @@ extern "C" {
 #endif
 
 /* Encoders use Timer 3 & 4 */
-void encoder_start(void);
+void encoder_init(void);
 uint32_t encoder_get_left(void);
 uint32_t encoder_get_right(void);
 
 /* Returns the minimal signed difference considering an overflow or underflow. */
 int encoder_tick_diff(uint32_t enc_old, uint32_t enc_new);
 
+/* Publishes the cumulative ticks and the wheel speeds on /encoders, called
+ * by the base control loop. */
+void encoder_publish(void);
+
+/* Wheel speeds in ticks/s, as of the last call to encoder_publish. */
+float encoder_get_left_velocity(void);
+float encoder_get_right_velocity(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,71 @@
+#include <math.h>
+#include "encoder_velocity.h"
+
+static float ticks_per_second(int32_t ticks, int32_t duration_us)
+{
+    return ticks * 1e6f / duration_us;
+}
+
+void encoder_velocity_init(encoder_velocity_t* enc,
+                           float low_speed,
+                           int32_t ticks_per_edge,
+                           int32_t ticks,
+                           uint32_t time_us)
+{
+    enc->low_speed = low_speed;
+    enc->ticks_per_edge = ticks_per_edge;
+    enc->ticks = ticks;
+    enc->time_us = time_us;
+    enc->has_edge = false;
+    enc->new_edge = false;
+    enc->velocity = 0;
+}
+
+void encoder_velocity_capture(encoder_velocity_t* enc, int32_t ticks, uint32_t time_us)
+{
+    enc->previous_edge_ticks = enc->edge_ticks;
+    enc->previous_edge_time_us = enc->edge_time_us;
+    enc->edge_ticks = ticks;
+    enc->edge_time_us = time_us;
+
+    /* The first edge gives no period */
+    if (enc->has_edge) {
+        enc->new_edge = true;
+    }
+    enc->has_edge = true;
+}
+
+float encoder_velocity_update(encoder_velocity_t* enc, int32_t ticks, uint32_t time_us)
+{
+    int32_t duration_us = (int32_t)(time_us - enc->time_us);
+
+    if (duration_us <= 0) {
+        return enc->velocity;
+    }
+
+    float count_velocity = ticks_per_second(ticks - enc->ticks, duration_us);
+
+    if (fabsf(count_velocity) >= enc->low_speed || !enc->has_edge) {
+        enc->velocity = count_velocity;
+    } else if (enc->new_edge) {
+        int32_t period_us = (int32_t)(enc->edge_time_us - enc->previous_edge_time_us);
+        if (period_us > 0) {
+            enc->velocity = ticks_per_second(enc->edge_ticks - enc->previous_edge_ticks, period_us);
+        } else {
+            enc->velocity = count_velocity;
+        }
+    } else {
+        /* The next edge is at least one period away, which bounds the speed */
+        int32_t since_edge_us = (int32_t)(time_us - enc->edge_time_us);
+        if (since_edge_us > 0) {
+            float max = ticks_per_second(enc->ticks_per_edge, since_edge_us);
+            enc->velocity = fmaxf(-max, fminf(enc->velocity, max));
+        }
+    }
+
+    enc->new_edge = false;
+    enc->ticks = ticks;
+    enc->time_us = time_us;
+
+    return enc->velocity;
+}
@@ -0,0 +1,53 @@
+#ifndef ENCODER_VELOCITY_H
+#define ENCODER_VELOCITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Velocity estimation of a quadrature encoder.
+ *
+ * At high speed, the velocity is the number of ticks counted since the
+ * previous update divided by the elapsed time. At low speed, only a few ticks
+ * are counted per update and this becomes very noisy, so the velocity is
+ * computed from the time between the last captured encoder edges instead.
+ * When no edge comes, the velocity decays as the time since the last one
+ * grows, down to zero for a stopped wheel.
+ */
+typedef struct {
+    float low_speed; ///< Speed below which edge periods are used, in ticks/s
+    int32_t ticks_per_edge; ///< Ticks between two edges in the same direction
+
+    int32_t ticks; ///< Count at the last update
+    uint32_t time_us; ///< Time of the last update
+
+    bool has_edge; ///< An edge was captured since the initialization
+    bool new_edge; ///< An edge was captured since the last update
+    int32_t edge_ticks; ///< Count at the last captured edge
+    uint32_t edge_time_us;
+    int32_t previous_edge_ticks;
+    uint32_t previous_edge_time_us;
+
+    float velocity; ///< Last estimate, in ticks/s
+} encoder_velocity_t;
+
+void encoder_velocity_init(encoder_velocity_t* enc,
+                           float low_speed,
+                           int32_t ticks_per_edge,
+                           int32_t ticks,
+                           uint32_t time_us);
+
+/** Records an encoder edge, with the count and time at which it occured. */
+void encoder_velocity_capture(encoder_velocity_t* enc, int32_t ticks, uint32_t time_us);
+
+/** Updates the estimate with the current count, returns it in ticks/s. */
+float encoder_velocity_update(encoder_velocity_t* enc, int32_t ticks, uint32_t time_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENCODER_VELOCITY_H */
@@ -0,0 +1,59 @@
+#include "odometry_history.h"
+
+#define ENTRY(history, age) ((history)->entries[((history)->next + ODOMETRY_HISTORY_LEN - 1 - (age)) % ODOMETRY_HISTORY_LEN])
+
+void odometry_history_init(odometry_history_t* history)
+{
+    history->next = 0;
+    history->count = 0;
+}
+
+void odometry_history_push(odometry_history_t* history, uint32_t time_us, float dx, float dy)
+{
+    float x = 0, y = 0;
+    if (history->count > 0) {
+        x = ENTRY(history, 0).x;
+        y = ENTRY(history, 0).y;
+    }
+
+    history->entries[history->next].time_us = time_us;
+    history->entries[history->next].x = x + dx;
+    history->entries[history->next].y = y + dy;
+
+    history->next = (history->next + 1) % ODOMETRY_HISTORY_LEN;
+    if (history->count < ODOMETRY_HISTORY_LEN) {
+        history->count++;
+    }
+}
+
+bool odometry_history_motion_since(const odometry_history_t* history, uint32_t time_us, float* dx, float* dy)
+{
+    if (history->count == 0) {
+        return false;
+    }
+
+    /* Nothing recorded yet since then */
+    if ((int32_t)(time_us - ENTRY(history, 0).time_us) >= 0) {
+        *dx = 0;
+        *dy = 0;
+        return true;
+    }
+
+    for (unsigned age = 1; age < history->count; age++) {
+        if ((int32_t)(time_us - ENTRY(history, age).time_us) >= 0) {
+            const float older_x = ENTRY(history, age).x;
+            const float older_y = ENTRY(history, age).y;
+            const uint32_t older_us = ENTRY(history, age).time_us;
+            const float newer_x = ENTRY(history, age - 1).x;
+            const float newer_y = ENTRY(history, age - 1).y;
+            const uint32_t newer_us = ENTRY(history, age - 1).time_us;
+            const float t = (float)(time_us - older_us) / (float)(newer_us - older_us);
+
+            *dx = ENTRY(history, 0).x - (older_x + t * (newer_x - older_x));
+            *dy = ENTRY(history, 0).y - (older_y + t * (newer_y - older_y));
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef ODOMETRY_HISTORY_H
+#define ODOMETRY_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ODOMETRY_HISTORY_LEN 32
+
+/** Short history of the distance travelled according to the odometry.
+ *
+ * Fixes which come from sensors with some latency were measured at a past
+ * position of the robot. The motion since then is added to them to get the
+ * current position. Only the odometry increments are recorded, so that the
+ * corrections of the pose do not count as motion.
+ */
+typedef struct {
+    struct {
+        uint32_t time_us;
+        float x, y; ///< Travelled since the initialization, in mm
+    } entries[ODOMETRY_HISTORY_LEN];
+    unsigned next; ///< Index of the next entry to write
+    unsigned count;
+} odometry_history_t;
+
+void odometry_history_init(odometry_history_t* history);
+
+/** Records the odometry increment of the last update, in mm. */
+void odometry_history_push(odometry_history_t* history, uint32_t time_us, float dx, float dy);
+
+/** Computes the motion since the given time, interpolated between the
+ * updates.
+ *
+ * @returns false if the time is older than the history.
+ */
+bool odometry_history_motion_since(const odometry_history_t* history, uint32_t time_us, float* dx, float* dy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ODOMETRY_HISTORY_H */
@@ -0,0 +1,93 @@
+#include <cmath>
+#include "pose_estimator.hpp"
+
+static float wrap_angle(float a)
+{
+    return std::atan2(std::sin(a), std::cos(a));
+}
+
+PoseEstimator::PoseEstimator()
+    : state(State::Zero())
+    , covariance(Covariance::Zero())
+    , distanceVariance(0.5f)
+    , angleVariance(0.001f)
+    , gate(13.8f)
+{
+}
+
+void PoseEstimator::reset(float x, float y, float a, float position_variance, float angle_variance)
+{
+    state << x, y, wrap_angle(a);
+    covariance = Covariance::Zero();
+    covariance(0, 0) = position_variance;
+    covariance(1, 1) = position_variance;
+    covariance(2, 2) = angle_variance;
+}
+
+void PoseEstimator::predict(float distance, float angle)
+{
+    /* The arc is approximated by a straight move at its mean heading */
+    const float heading = state(2) + angle / 2;
+    const float c = std::cos(heading);
+    const float s = std::sin(heading);
+
+    state(0) += distance * c;
+    state(1) += distance * s;
+    state(2) = wrap_angle(state(2) + angle);
+
+    Covariance G = Covariance::Identity();
+    G(0, 2) = -distance * s;
+    G(1, 2) = distance * c;
+
+    /* Odometry noise grows with the motion, projected from the
+     * (distance, angle) input space. */
+    Eigen::Matrix<float, 3, 2> V;
+    V << c, -distance * s / 2,
+        s, distance * c / 2,
+        0, 1;
+    Eigen::Vector2f input_variance(distanceVariance * std::fabs(distance),
+                                   angleVariance * std::fabs(angle));
+
+    covariance = G * covariance * G.transpose() + V * input_variance.asDiagonal() * V.transpose();
+}
+
+bool PoseEstimator::correctPosition(float x, float y, float variance)
+{
+    Eigen::Matrix<float, 2, 3> H = Eigen::Matrix<float, 2, 3>::Zero();
+    H(0, 0) = 1;
+    H(1, 1) = 1;
+
+    Eigen::Vector2f innovation(x - state(0), y - state(1));
+    Eigen::Matrix2f S = H * covariance * H.transpose() + variance * Eigen::Matrix2f::Identity();
+    Eigen::Matrix2f S_inv = S.inverse();
+
+    if (innovation.dot(S_inv * innovation) > gate) {
+        return false;
+    }
+
+    Eigen::Matrix<float, 3, 2> K = covariance * H.transpose() * S_inv;
+    state += K * innovation;
+    state(2) = wrap_angle(state(2));
+    covariance = (Covariance::Identity() - K * H) * covariance;
+    covariance = (covariance + covariance.transpose()) / 2;
+
+    return true;
+}
+
+bool PoseEstimator::correctHeading(float a, float variance)
+{
+    const float innovation = wrap_angle(a - state(2));
+    const float S = covariance(2, 2) + variance;
+
+    if (innovation * innovation / S > gate) {
+        return false;
+    }
+
+    State K = covariance.col(2) / S;
+    state += K * innovation;
+    state(2) = wrap_angle(state(2));
+    covariance -= K * covariance.row(2);
+    covariance = (covariance + covariance.transpose()) / 2;
+
+    return true;
+}
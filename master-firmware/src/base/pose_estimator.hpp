@@ -0,0 +1,55 @@
+#ifndef POSE_ESTIMATOR_HPP
+#define POSE_ESTIMATOR_HPP
+
+#include <Eigen/Dense>
+
+/** Extended Kalman filter on the pose of the robot.
+ *
+ * The prediction is driven by the odometry increments, and absolute position
+ * (UWB) or heading (IMU) measurements correct it. Measurements too far from
+ * the prediction, given both uncertainties, are rejected.
+ */
+class PoseEstimator {
+public:
+    /** Position in mm followed by heading in radians. */
+    typedef Eigen::Matrix<float, 3, 1> State;
+    typedef Eigen::Matrix<float, 3, 3> Covariance;
+
+    State state;
+    Covariance covariance;
+
+    /** Variance added to the distance per mm travelled, in mm^2 / mm. */
+    float distanceVariance;
+
+    /** Variance added to the heading per radian turned, in rad^2 / rad. */
+    float angleVariance;
+
+    /** Squared Mahalanobis distance above which a measurement is rejected. */
+    float gate;
+
+    PoseEstimator();
+
+    /** Restarts from a known pose, with the given variances in mm^2 and
+     * rad^2. */
+    void reset(float x, float y, float a, float position_variance, float angle_variance);
+
+    /** Moves the pose by an odometry increment, along an arc of the given
+     * length in mm and angle in radians. */
+    void predict(float distance, float angle);
+
+    /** Fuses an absolute position measurement, in mm, with the given
+     * variance in mm^2.
+     *
+     * @returns false if the measurement was rejected.
+     */
+    bool correctPosition(float x, float y, float variance);
+
+    /** Fuses an absolute heading measurement, in radians, with the given
+     * variance in rad^2.
+     *
+     * @returns false if the measurement was rejected.
+     */
+    bool correctHeading(float a, float variance);
+};
+
+#endif
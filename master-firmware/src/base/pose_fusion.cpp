@@ -0,0 +1,195 @@
+#include <ch.h>
+#include <cmath>
+#include <error/error.h>
+#include <timestamp/timestamp.h>
+
+#include "main.h"
+#include "base/pose_estimator.hpp"
+#include "base/pose_fusion.h"
+#include "base/odometry_history.h"
+#include "protobuf/localization.pb.h"
+
+/* Uncertainty of a pose set by calibration or by the strategy */
+#define POSE_SET_POSITION_VARIANCE 25.f
+#define POSE_SET_ANGLE_VARIANCE 1e-4f
+
+static struct {
+    parameter_namespace_t* ns;
+    parameter_t* distance_variance;
+    parameter_t* angle_variance;
+    parameter_t* gate;
+    parameter_t* use_uwb;
+    parameter_t* uwb_std_dev;
+    parameter_t* uwb_latency;
+    parameter_t* uwb_max_age;
+    parameter_t* use_imu;
+    parameter_t* imu_std_dev;
+} params;
+
+static PoseEstimator estimator;
+
+/* Pose of the position manager after the last update */
+static float odometry_x, odometry_y, odometry_a;
+static bool started = false;
+
+/* The UWB fixes are received some time after being measured */
+static odometry_history_t history;
+
+/* Set by pose_fusion_reset, possibly from another thread */
+static volatile bool reset_requested = false;
+
+static messagebus_topic_t* uwb_topic;
+static messagebus_topic_t* imu_topic;
+static uint32_t last_uwb_us, last_imu_us;
+
+/* The IMU heading is relative to its power up orientation */
+static bool imu_offset_known = false;
+static float imu_offset;
+
+static float wrap_angle(float a)
+{
+    return std::atan2(std::sin(a), std::cos(a));
+}
+
+static void params_apply(void)
+{
+    estimator.distanceVariance = parameter_scalar_get(params.distance_variance);
+    estimator.angleVariance = parameter_scalar_get(params.angle_variance);
+    estimator.gate = parameter_scalar_get(params.gate);
+}
+
+void pose_fusion_init(void)
+{
+    params.ns = parameter_namespace_find(&master_config, "pose_estimator");
+    params.distance_variance = parameter_find(params.ns, "distance_variance");
+    params.angle_variance = parameter_find(params.ns, "angle_variance");
+    params.gate = parameter_find(params.ns, "gate");
+    params.use_uwb = parameter_find(params.ns, "use_uwb");
+    params.uwb_std_dev = parameter_find(params.ns, "uwb_std_dev");
+    params.uwb_latency = parameter_find(params.ns, "uwb_latency");
+    params.uwb_max_age = parameter_find(params.ns, "uwb_max_age");
+    params.use_imu = parameter_find(params.ns, "use_imu");
+    params.imu_std_dev = parameter_find(params.ns, "imu_std_dev");
+
+    if (!params.distance_variance || !params.angle_variance || !params.gate
+        || !params.use_uwb || !params.uwb_std_dev || !params.uwb_latency || !params.uwb_max_age
+        || !params.use_imu || !params.imu_std_dev) {
+        ERROR("Missing pose estimator parameters");
+    }
+
+    params_apply();
+}
+
+static void odometry_save(struct robot_position* pos)
+{
+    odometry_x = position_get_x_float(pos);
+    odometry_y = position_get_y_float(pos);
+    odometry_a = position_get_a_rad_float(pos);
+}
+
+static void estimator_restart(struct robot_position* pos)
+{
+    odometry_save(pos);
+    estimator.reset(odometry_x, odometry_y, odometry_a,
+                    POSE_SET_POSITION_VARIANCE, POSE_SET_ANGLE_VARIANCE);
+    odometry_history_init(&history);
+    imu_offset_known = false;
+}
+
+/* Returns true and fills the fix if a new one was published since the
+ * last call. */
+template <typename T>
+static bool fix_read(messagebus_topic_t** topic, const char* name, uint32_t* last_us, T* fix)
+{
+    if (*topic == NULL) {
+        *topic = messagebus_find_topic(&bus, name);
+        if (*topic == NULL) {
+            return false;
+        }
+    }
+
+    if (!messagebus_topic_read(*topic, fix, sizeof(T)) || fix->timestamp.us == *last_us) {
+        return false;
+    }
+
+    *last_us = fix->timestamp.us;
+    return true;
+}
+
+void pose_fusion_update(struct robot_position* pos)
+{
+    if (parameter_namespace_contains_changed(params.ns)) {
+        params_apply();
+    }
+
+    if (!started || reset_requested) {
+        reset_requested = false;
+        estimator_restart(pos);
+        started = true;
+        return;
+    }
+
+    const float dx = position_get_x_float(pos) - odometry_x;
+    const float dy = position_get_y_float(pos) - odometry_y;
+    const float da = wrap_angle(position_get_a_rad_float(pos) - odometry_a);
+
+    const float heading = odometry_a + da / 2;
+    estimator.predict(dx * std::cos(heading) + dy * std::sin(heading), da);
+
+    const uint32_t now_us = timestamp_get();
+    odometry_history_push(&history, now_us, dx, dy);
+
+    bool corrected = false;
+
+    PositionFix position_fix;
+    if (fix_read(&uwb_topic, "/uwb/position", &last_uwb_us, &position_fix)
+        && parameter_boolean_get(params.use_uwb)) {
+        /* The fix is stamped on reception, the tag measured it earlier and
+         * the robot kept moving since then. */
+        const uint32_t latency_us = parameter_scalar_get(params.uwb_latency) * 1000;
+        const uint32_t measured_us = position_fix.timestamp.us - latency_us;
+        const int32_t age_us = now_us - measured_us;
+        float moved_x, moved_y;
+
+        if (age_us <= parameter_scalar_get(params.uwb_max_age) * 1000
+            && odometry_history_motion_since(&history, measured_us, &moved_x, &moved_y)) {
+            float std_dev = parameter_scalar_get(params.uwb_std_dev);
+            corrected |= estimator.correctPosition(position_fix.x + moved_x, position_fix.y + moved_y,
+                                                   std_dev * std_dev);
+        }
+    }
+
+    HeadingFix heading_fix;
+    if (fix_read(&imu_topic, "/imu/heading", &last_imu_us, &heading_fix)
+        && parameter_boolean_get(params.use_imu)) {
+        if (!imu_offset_known) {
+            imu_offset = wrap_angle(estimator.state(2) - heading_fix.a);
+            imu_offset_known = true;
+        } else {
+            float std_dev = parameter_scalar_get(params.imu_std_dev);
+            corrected |= estimator.correctHeading(heading_fix.a + imu_offset, std_dev * std_dev);
+        }
+    }
+
+    if (corrected) {
+        position_set(pos,
+                     std::lround(estimator.state(0)),
+                     std::lround(estimator.state(1)),
+                     estimator.state(2) * 180.f / M_PI);
+    }
+
+    odometry_save(pos);
+}
+
+void pose_fusion_reset(void)
+{
+    reset_requested = true;
+}
+
+void pose_fusion_get_covariance(float* var_x, float* var_y, float* var_a, float* cov_xy)
+{
+    *var_x = estimator.covariance(0, 0);
+    *var_y = estimator.covariance(1, 1);
+    *var_a = estimator.covariance(2, 2);
+    *cov_xy = estimator.covariance(0, 1);
+}
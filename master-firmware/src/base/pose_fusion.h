@@ -0,0 +1,39 @@
+#ifndef POSE_FUSION_H
+#define POSE_FUSION_H
+
+#include <aversive/position_manager/position_manager.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Looks up the pose estimator parameters. Must be called before the first
+ * update. */
+void pose_fusion_init(void);
+
+/** Runs one step of the pose estimator, right after the odometry update.
+ *
+ * The odometry increment drives the prediction, and the /uwb/position and
+ * /imu/heading fixes received since the last call correct it. The UWB fixes
+ * are measured some time before being received, so the odometry travelled
+ * since then is added to them, and they are dropped when older than
+ * pose_estimator/uwb_max_age. When a fix is accepted, the position manager is
+ * moved to the fused pose.
+ */
+void pose_fusion_update(struct robot_position* pos);
+
+/** Restarts the estimator from the pose of the position manager at the next
+ * update. Must be called right after setting the pose from elsewhere than the
+ * estimator (calibration, strategy, shell), otherwise the jump would be taken
+ * for a motion of the robot.
+ */
+void pose_fusion_reset(void);
+
+/** Reads the covariance of the fused pose, in mm^2 and rad^2. */
+void pose_fusion_get_covariance(float* var_x, float* var_y, float* var_a, float* cov_xy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POSE_FUSION_H */
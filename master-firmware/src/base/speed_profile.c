@@ -0,0 +1,64 @@
+#include <stdio.h>
+
+#include <aversive/trajectory_manager/trajectory_manager_utils.h>
+
+#include "speed_profile.h"
+
+static const char* speed_names[BASE_SPEED_COUNT] = {
+    [BASE_SPEED_INIT] = "init",
+    [BASE_SPEED_SLOW] = "slow",
+    [BASE_SPEED_FAST] = "fast",
+};
+
+static parameter_t* find_param(parameter_namespace_t* ns, const char* axis, const char* quantity, const char* name)
+{
+    char id[64];
+    snprintf(id, sizeof(id), "%s/%s/%s", axis, quantity, name);
+    return parameter_find(ns, id);
+}
+
+bool speed_profile_table_init(speed_profile_table_t* table, parameter_namespace_t* trajectories)
+{
+    bool found = true;
+
+    for (int i = 0; i < BASE_SPEED_COUNT; i++) {
+        table->params[i].distance_speed = find_param(trajectories, "distance", "speed", speed_names[i]);
+        table->params[i].angle_speed = find_param(trajectories, "angle", "speed", speed_names[i]);
+        table->params[i].distance_acc = find_param(trajectories, "distance", "acceleration", speed_names[i]);
+        table->params[i].angle_acc = find_param(trajectories, "angle", "acceleration", speed_names[i]);
+
+        found = found && table->params[i].distance_speed && table->params[i].angle_speed
+                && table->params[i].distance_acc && table->params[i].angle_acc;
+
+        table->profiles[i] = (speed_profile_t){0};
+    }
+
+    return found;
+}
+
+void speed_profile_table_update(speed_profile_table_t* table, struct trajectory* traj)
+{
+    for (int i = 0; i < BASE_SPEED_COUNT; i++) {
+        speed_profile_t* profile = &table->profiles[i];
+
+        /* Distances are configured in meters, the conversions take millimeters */
+        profile->distance_speed = 1000 * speed_mm2imp(traj, parameter_scalar_get(table->params[i].distance_speed));
+        profile->angle_speed = speed_rd2imp(traj, parameter_scalar_get(table->params[i].angle_speed));
+        profile->distance_acc = 1000 * acc_mm2imp(traj, parameter_scalar_get(table->params[i].distance_acc));
+        profile->angle_acc = acc_rd2imp(traj, parameter_scalar_get(table->params[i].angle_acc));
+    }
+}
+
+const speed_profile_t* speed_profile_get(const speed_profile_table_t* table, enum base_speed_t speed)
+{
+    if ((unsigned)speed >= BASE_SPEED_COUNT) {
+        return NULL;
+    }
+    return &table->profiles[speed];
+}
+
+void speed_profile_apply(const speed_profile_t* profile, struct trajectory* traj)
+{
+    trajectory_set_speed(traj, profile->distance_speed, profile->angle_speed);
+    trajectory_set_acc(traj, profile->distance_acc, profile->angle_acc);
+}
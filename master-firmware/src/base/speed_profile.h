@@ -0,0 +1,69 @@
+#ifndef SPEED_PROFILE_H
+#define SPEED_PROFILE_H
+
+#include <stdbool.h>
+
+#include <parameter/parameter.h>
+#include <aversive/trajectory_manager/trajectory_manager.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum base_speed_t {
+    BASE_SPEED_INIT,
+    BASE_SPEED_SLOW,
+    BASE_SPEED_FAST,
+    BASE_SPEED_COUNT, ///< Number of speed settings, not a valid setting
+};
+
+/** Speed and acceleration limits of a base speed setting, in the units of
+ * the trajectory manager (impulses per control period). */
+typedef struct {
+    double distance_speed;
+    double angle_speed;
+    double distance_acc;
+    double angle_acc;
+} speed_profile_t;
+
+/** Speed profiles of all base speed settings.
+ *
+ * The profiles are computed from the trajectory parameters and the odometry
+ * only when they change, so that switching between them is a table lookup.
+ */
+typedef struct {
+    struct {
+        parameter_t* distance_speed;
+        parameter_t* angle_speed;
+        parameter_t* distance_acc;
+        parameter_t* angle_acc;
+    } params[BASE_SPEED_COUNT];
+    speed_profile_t profiles[BASE_SPEED_COUNT];
+} speed_profile_table_t;
+
+/** Finds the parameters of each setting in the trajectories namespace, for
+ * example distance/speed/slow or angle/acceleration/fast.
+ *
+ * @returns false if one of them is missing.
+ */
+bool speed_profile_table_init(speed_profile_table_t* table, parameter_namespace_t* trajectories);
+
+/** Recomputes the profiles from the parameters and the physical parameters of
+ * the trajectory manager. Must be called after one of them changed.
+ *
+ * @note Distance speeds are in m/s and accelerations in m/s^2, angular ones
+ * in rad/s and rad/s^2.
+ */
+void speed_profile_table_update(speed_profile_table_t* table, struct trajectory* traj);
+
+/** Returns the profile of the given setting, or NULL if it is invalid. */
+const speed_profile_t* speed_profile_get(const speed_profile_table_t* table, enum base_speed_t speed);
+
+/** Sets the speed and acceleration limits of the trajectory manager. */
+void speed_profile_apply(const speed_profile_t* profile, struct trajectory* traj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPEED_PROFILE_H */
@@ -1,4 +1,5 @@
 
+#include <stdint.h>
 #include <string.h>
 #include "bus_enumerator.h"
 
@@ -30,6 +31,42 @@ static uint16_t index_by_str_id(const bus_enumerator_t* en, const char* str_id)
     return BUS_ENUMERATOR_INDEX_NOT_FOUND;
 }
 
+static bus_enumerator_str_cache_entry_t* str_cache_slot(bus_enumerator_t* en, const char* str_id)
+{
+    uintptr_t addr = (uintptr_t)str_id;
+    return &en->str_cache[(addr ^ (addr >> 5)) & (BUS_ENUMERATOR_STR_CACHE_LEN - 1)];
+}
+
+static void str_cache_clear(bus_enumerator_t* en)
+{
+    memset(en->str_cache, 0, sizeof(en->str_cache));
+}
+
+/* Same as index_by_str_id, but remembers the result for the given string
+ * address. The string content is still compared on a cache hit since the
+ * caller might reuse a buffer for a different ID. A slot written concurrently
+ * by two threads can only be torn into a miss, never into a wrong result. */
+static uint16_t cached_index_by_str_id(bus_enumerator_t* en, const char* str_id)
+{
+    bus_enumerator_str_cache_entry_t* slot = str_cache_slot(en, str_id);
+    uint16_t index = slot->index;
+
+    if (slot->key == str_id
+        && index < en->nb_entries_str_to_can
+        && strcmp(str_id, en->str_to_can[index].str_id) == 0) {
+        return index;
+    }
+
+    index = index_by_str_id(en, str_id);
+
+    if (index != BUS_ENUMERATOR_INDEX_NOT_FOUND) {
+        slot->index = index;
+        slot->key = str_id;
+    }
+
+    return index;
+}
+
 static uint16_t index_by_can_id(const bus_enumerator_t* en, uint8_t can_id)
 {
     uint16_t imin = 0, imax = en->nb_entries_can_to_str, imid;
@@ -58,6 +95,8 @@ void bus_enumerator_init(bus_enumerator_t* en,
     en->buffer_len = buffer_len;
     en->nb_entries_str_to_can = 0;
     en->nb_entries_can_to_str = 0;
+    memset(en->by_can_id, 0, sizeof(en->by_can_id));
+    str_cache_clear(en);
 }
 
 void bus_enumerator_add_node(bus_enumerator_t* en, const char* str_id, void* driver)
@@ -84,6 +123,9 @@ void bus_enumerator_add_node(bus_enumerator_t* en, const char* str_id, void* dri
         en->str_to_can[imin].can_id = BUS_ENUMERATOR_CAN_ID_NOT_SET;
 
         en->nb_entries_str_to_can++;
+
+        // indices in str_to_can were shifted
+        str_cache_clear(en);
     }
 }
 
@@ -119,6 +161,11 @@ void bus_enumerator_update_node_info(bus_enumerator_t* en, const char* str_id, u
                sizeof(bus_enumerator_entry_t));
 
         en->nb_entries_can_to_str++;
+
+        if (can_id < BUS_ENUMERATOR_CAN_ID_TABLE_LEN) {
+            en->by_can_id[can_id].driver = en->str_to_can[index].driver;
+            en->by_can_id[can_id].str_id = en->str_to_can[index].str_id;
+        }
     }
 }
 
@@ -142,7 +189,7 @@ uint16_t bus_enumerator_discovered_nodes_count(bus_enumerator_t* en)
 uint8_t bus_enumerator_get_can_id(bus_enumerator_t* en, const char* str_id)
 {
     uint16_t index;
-    index = index_by_str_id(en, str_id);
+    index = cached_index_by_str_id(en, str_id);
 
     if (index != BUS_ENUMERATOR_INDEX_NOT_FOUND) {
         return en->str_to_can[index].can_id;
@@ -154,7 +201,7 @@ uint8_t bus_enumerator_get_can_id(bus_enumerator_t* en, const char* str_id)
 void* bus_enumerator_get_driver(bus_enumerator_t* en, const char* str_id)
 {
     uint16_t index;
-    index = index_by_str_id(en, str_id);
+    index = cached_index_by_str_id(en, str_id);
 
     if (index != BUS_ENUMERATOR_INDEX_NOT_FOUND) {
         return en->str_to_can[index].driver;
@@ -166,6 +213,11 @@ void* bus_enumerator_get_driver(bus_enumerator_t* en, const char* str_id)
 void* bus_enumerator_get_driver_by_can_id(bus_enumerator_t* en, uint8_t can_id)
 {
     uint16_t index;
+
+    if (can_id < BUS_ENUMERATOR_CAN_ID_TABLE_LEN) {
+        return en->by_can_id[can_id].driver;
+    }
+
     index = index_by_can_id(en, can_id);
 
     if (index != BUS_ENUMERATOR_INDEX_NOT_FOUND) {
@@ -178,6 +230,11 @@ void* bus_enumerator_get_driver_by_can_id(bus_enumerator_t* en, uint8_t can_id)
 const char* bus_enumerator_get_str_id(bus_enumerator_t* en, uint8_t can_id)
 {
     uint16_t index;
+
+    if (can_id < BUS_ENUMERATOR_CAN_ID_TABLE_LEN) {
+        return en->by_can_id[can_id].str_id;
+    }
+
     index = index_by_can_id(en, can_id);
 
     if (index != BUS_ENUMERATOR_INDEX_NOT_FOUND) {
@@ -13,6 +13,12 @@ the motor manager adds nodes using bus_enumerator_add_node() when he needs them
 for a trajectory. The bus enumerator then finds the node on the CAN-bus and
 associates the ID.
 
+Lookups are on the hot path of every feedback stream, so two shortcuts are
+kept next to the sorted tables:
+- a direct-mapped table indexed by CAN ID (UAVCAN node IDs are 7 bit)
+- a small cache indexed by the address of the string ID, so that callers
+  passing the same string (usually a literal) skip the binary search
+
  */
 
 #include <stdint.h>
@@ -25,6 +31,9 @@ extern "C" {
 #define BUS_ENUMERATOR_STRING_ID_NOT_FOUND 0xFE
 #define BUS_ENUMERATOR_INDEX_NOT_FOUND 0xFFFF
 
+#define BUS_ENUMERATOR_CAN_ID_TABLE_LEN 128
+#define BUS_ENUMERATOR_STR_CACHE_LEN 32 // must be a power of two
+
 typedef struct {
     const char* str_id;
     uint8_t can_id;
@@ -38,12 +47,25 @@ struct bus_enumerator_entry_allocator {
     bus_enumerator_entry_t can_to_str;
 };
 
+typedef struct {
+    const char* key; // address of the string used for the lookup
+    uint16_t index; // index in str_to_can
+} bus_enumerator_str_cache_entry_t;
+
 typedef struct {
     bus_enumerator_entry_t* str_to_can;
     bus_enumerator_entry_t* can_to_str;
     uint16_t buffer_len;
     uint16_t nb_entries_str_to_can;
     uint16_t nb_entries_can_to_str;
+
+    // direct-mapped CAN ID -> node, NULL str_id if the CAN ID is unknown
+    struct {
+        const char* str_id;
+        void* driver;
+    } by_can_id[BUS_ENUMERATOR_CAN_ID_TABLE_LEN];
+
+    bus_enumerator_str_cache_entry_t str_cache[BUS_ENUMERATOR_STR_CACHE_LEN];
 } bus_enumerator_t;
 
 void bus_enumerator_init(bus_enumerator_t* en,
@@ -1,5 +1,6 @@
 #include "can_uwb_ip_netif.hpp"
 
+#include <string.h>
 #include <ch.h>
 #include <hal.h>
 
@@ -21,27 +22,96 @@
 #endif
 using DataPacket = cvra::uwb_beacon::DataPacket;
 
-/* Semaphores synchronizing communication between the lwip thread and the
- * UAVCAN thread. */
-static BSEMAPHORE_DECL(sem_tx_ready, true);
-static BSEMAPHORE_DECL(sem_tx_done, true);
+/* Number of packets which can wait in each direction. The beacon sends them
+ * in fragments over UWB, which takes a few milliseconds per packet. */
+#define TX_QUEUE_LEN 4
+#define RX_QUEUE_LEN 4
 
-static DataPacket tx_packet, rx_packet;
+/* Number of remote Ethernet addresses whose beacon address is known. */
+#define NEIGHBOR_TABLE_LEN 8
+
+/* Packets are passed between the lwip thread and the UAVCAN thread through a
+ * pool of free buffers and a queue of ready ones. */
+static DataPacket tx_packets[TX_QUEUE_LEN];
+static msg_t tx_free_buf[TX_QUEUE_LEN], tx_ready_buf[TX_QUEUE_LEN];
+static MAILBOX_DECL(tx_free, tx_free_buf, TX_QUEUE_LEN);
+static MAILBOX_DECL(tx_ready, tx_ready_buf, TX_QUEUE_LEN);
+
+static DataPacket rx_packets[RX_QUEUE_LEN];
+static msg_t rx_free_buf[RX_QUEUE_LEN], rx_ready_buf[RX_QUEUE_LEN];
+static MAILBOX_DECL(rx_free, rx_free_buf, RX_QUEUE_LEN);
+static MAILBOX_DECL(rx_ready, rx_ready_buf, RX_QUEUE_LEN);
 
-static MUTEX_DECL(lock_rx_packet);
-static BSEMAPHORE_DECL(sem_rx_available, true);
 static EVENTSOURCE_DECL(event_rx);
 
+/* Beacon address of the robots we received frames from. Unicast frames to
+ * them are sent to their beacon only, which acknowledges the fragments, and
+ * everything else is broadcast. */
+static struct {
+    uint8_t hwaddr[ETHARP_HWADDR_LEN];
+    uint16_t beacon_addr;
+} neighbors[NEIGHBOR_TABLE_LEN];
+static unsigned neighbor_next;
+static MUTEX_DECL(neighbors_lock);
+
 static uavcan::LazyConstructor<uavcan::Publisher<DataPacket>> data_pub;
 
 static err_t low_level_output(struct netif* netif, struct pbuf* p);
 
+static void neighbor_learn(const DataPacket& msg)
+{
+    if (msg.data.size() < 2 * ETHARP_HWADDR_LEN) {
+        return;
+    }
+
+    uint8_t hwaddr[ETHARP_HWADDR_LEN];
+    for (auto i = 0u; i < ETHARP_HWADDR_LEN; i++) {
+        hwaddr[i] = msg.data[ETHARP_HWADDR_LEN + i];
+    }
+
+    chMtxLock(&neighbors_lock);
+    auto i = 0u;
+    while (i < NEIGHBOR_TABLE_LEN && memcmp(neighbors[i].hwaddr, hwaddr, ETHARP_HWADDR_LEN)) {
+        i++;
+    }
+
+    if (i == NEIGHBOR_TABLE_LEN) {
+        i = neighbor_next;
+        neighbor_next = (neighbor_next + 1) % NEIGHBOR_TABLE_LEN;
+        memcpy(neighbors[i].hwaddr, hwaddr, ETHARP_HWADDR_LEN);
+    }
+    neighbors[i].beacon_addr = msg.src_addr;
+    chMtxUnlock(&neighbors_lock);
+}
+
+static uint16_t neighbor_beacon_addr(const uint8_t* hwaddr)
+{
+    uint16_t addr = DataPacket::MAC_BROADCAST;
+
+    chMtxLock(&neighbors_lock);
+    for (auto i = 0u; i < NEIGHBOR_TABLE_LEN; i++) {
+        if (neighbors[i].beacon_addr != 0 && !memcmp(neighbors[i].hwaddr, hwaddr, ETHARP_HWADDR_LEN)) {
+            addr = neighbors[i].beacon_addr;
+            break;
+        }
+    }
+    chMtxUnlock(&neighbors_lock);
+
+    return addr;
+}
+
 static void data_packet_cb(const uavcan::ReceivedDataStructure<DataPacket>& msg)
 {
-    chMtxLock(&lock_rx_packet);
-    rx_packet = msg;
-    chMtxUnlock(&lock_rx_packet);
-    chBSemSignal(&sem_rx_available);
+    DataPacket* packet;
+
+    /* Drop the packet if lwip is too slow, as a lossy link would. */
+    if (chMBFetchTimeout(&rx_free, (msg_t*)&packet, TIME_IMMEDIATE) != MSG_OK) {
+        return;
+    }
+
+    *packet = msg;
+    neighbor_learn(msg);
+    chMBPostTimeout(&rx_ready, (msg_t)packet, TIME_IMMEDIATE);
 
     /* Wakes up IP thread */
     chEvtBroadcast(&event_rx);
@@ -54,8 +124,8 @@ err_t lwip_uwb_ip_netif_init(struct netif* interface)
     interface->name[0] = 'w';
     interface->name[1] = 'l';
 
-    /* Must be smaller than 1k */
-    interface->mtu = 750;
+    /* The Ethernet frame must fit in a DataPacket (1023 bytes) */
+    interface->mtu = 1000;
     interface->hwaddr_len = ETHARP_HWADDR_LEN;
     interface->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
 
@@ -70,26 +140,41 @@ int can_uwb_ip_netif_init(uavcan::INode& node)
     static uavcan::Subscriber<DataPacket> subscriber(node);
     data_pub.construct<uavcan::INode&>(node);
 
+    for (auto i = 0; i < TX_QUEUE_LEN; i++) {
+        chMBPostTimeout(&tx_free, (msg_t)&tx_packets[i], TIME_IMMEDIATE);
+    }
+
+    for (auto i = 0; i < RX_QUEUE_LEN; i++) {
+        chMBPostTimeout(&rx_free, (msg_t)&rx_packets[i], TIME_IMMEDIATE);
+    }
+
     return subscriber.start(data_packet_cb);
 }
 
 static err_t low_level_output(struct netif* netif, struct pbuf* p)
 {
     (void) netif;
+    DataPacket* packet;
+
+    /* Several packets can be on their way, but do not block the IP thread
+     * if the beacon cannot keep up. */
+    if (chMBFetchTimeout(&tx_free, (msg_t*)&packet, TIME_IMMEDIATE) != MSG_OK) {
+        return ERR_MEM;
+    }
+
     /* First, copy all the data */
-    tx_packet = DataPacket();
+    *packet = DataPacket();
     for (auto q = p; q != NULL; q = q->next) {
         uint8_t* buf = reinterpret_cast<uint8_t*>(q->payload);
         for (auto i = 0u; i < q->len; i++) {
-            tx_packet.data.push_back(buf[i]);
+            packet->data.push_back(buf[i]);
         }
     }
 
-    /* Signal the UAVCAN thread that a DataPacket is ready */
-    chBSemSignal(&sem_tx_ready);
+    packet->dst_addr = neighbor_beacon_addr(reinterpret_cast<uint8_t*>(p->payload));
 
-    /* Finally, wait for the UAVCAN to tell us we are ready. */
-    chBSemSignal(&sem_tx_done);
+    /* Signal the UAVCAN thread that a DataPacket is ready */
+    chMBPostTimeout(&tx_ready, (msg_t)packet, TIME_IMMEDIATE);
 
     return ERR_OK;
 }
@@ -97,26 +182,31 @@ static err_t low_level_output(struct netif* netif, struct pbuf* p)
 bool lwip_uwb_ip_read(struct netif* netif, struct pbuf** pbuf)
 {
     (void) netif;
-    if (chBSemWaitTimeout(&sem_rx_available, TIME_IMMEDIATE) != MSG_OK) {
+    DataPacket* packet;
+
+    if (chMBFetchTimeout(&rx_ready, (msg_t*)&packet, TIME_IMMEDIATE) != MSG_OK) {
         return false;
     }
 
-    chMtxLock(&lock_rx_packet);
-
-    auto len = rx_packet.data.size();
+    auto len = packet->data.size();
     *pbuf = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
 
+    if (*pbuf == NULL) {
+        chMBPostTimeout(&rx_free, (msg_t)packet, TIME_IMMEDIATE);
+        return false;
+    }
+
     auto can_msg_index = 0u;
 
     for (auto q = *pbuf; q != NULL; q = q->next) {
         uint8_t* buf = reinterpret_cast<uint8_t*>(q->payload);
         for (auto j = 0u; j < q->len; j++) {
-            buf[j] = rx_packet.data[can_msg_index];
+            buf[j] = packet->data[can_msg_index];
             can_msg_index++;
         }
     }
 
-    chMtxUnlock(&lock_rx_packet);
+    chMBPostTimeout(&rx_free, (msg_t)packet, TIME_IMMEDIATE);
 
     return true;
 }
@@ -124,12 +214,12 @@ bool lwip_uwb_ip_read(struct netif* netif, struct pbuf** pbuf)
 int can_uwb_ip_netif_spin(uavcan::INode& node)
 {
     (void) node;
-    /* Check if data is available for transmit */
-    if (chBSemWaitTimeout(&sem_tx_ready, TIME_IMMEDIATE) == MSG_OK) {
-        data_pub->broadcast(tx_packet);
+    DataPacket* packet;
 
-        /* Signal the lwip thread that we are done with this. */
-        chBSemSignal(&sem_tx_done);
+    /* Send all the packets ready for transmit */
+    while (chMBFetchTimeout(&tx_ready, (msg_t*)&packet, TIME_IMMEDIATE) == MSG_OK) {
+        data_pub->broadcast(*packet);
+        chMBPostTimeout(&tx_free, (msg_t)packet, TIME_IMMEDIATE);
     }
 
     return 0;
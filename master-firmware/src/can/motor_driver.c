@@ -60,7 +60,10 @@ void motor_driver_init(motor_driver_t* d,
     parameter_scalar_declare_with_default(&d->config.motor_pos_stream, &d->config.stream, "motor_pos", 0);
     parameter_scalar_declare_with_default(&d->config.motor_torque_stream, &d->config.stream, "motor_torque", 0);
 
-    d->stream.change_status = 0;
+    memset(&d->stream, 0, sizeof(d->stream));
+    for (int i = 0; i < MOTOR_FEEDBACK_NB_MESSAGES; i++) {
+        time_sync_latency_reset(&d->stream.latency[i]);
+    }
 }
 
 const char* motor_driver_get_id(motor_driver_t* d)
@@ -100,6 +103,19 @@ void motor_driver_set_voltage(motor_driver_t* d, float voltage)
     chBSemSignal(&d->lock);
 }
 
+void motor_driver_set_trajectory(motor_driver_t* d,
+                                 float position,
+                                 float velocity,
+                                 float acceleration)
+{
+    chBSemWait(&d->lock);
+    d->control_mode = MOTOR_CONTROL_MODE_TRAJECTORY;
+    d->setpt.trajectory.position = position;
+    d->setpt.trajectory.velocity = velocity;
+    d->setpt.trajectory.acceleration = acceleration;
+    chBSemSignal(&d->lock);
+}
+
 void motor_driver_disable(motor_driver_t* d)
 {
     chBSemWait(&d->lock);
@@ -164,36 +180,84 @@ float motor_driver_get_voltage_setpt(motor_driver_t* d)
     return d->setpt.voltage;
 }
 
-void motor_driver_set_stream_value(motor_driver_t* d, uint32_t stream, float value)
+void motor_driver_get_trajectory_setpt(motor_driver_t* d,
+                                       float* position,
+                                       float* velocity,
+                                       float* acceleration)
 {
-    if (stream < MOTOR_STREAMS_NB_VALUES) {
-        motor_driver_lock(d);
+    if (d->control_mode != MOTOR_CONTROL_MODE_TRAJECTORY) {
+        ERROR("motor driver get trajectory wrong setpt mode");
+    }
+    *position = d->setpt.trajectory.position;
+    *velocity = d->setpt.trajectory.velocity;
+    *acceleration = d->setpt.trajectory.acceleration;
+}
+
+static void stream_sample_update(motor_driver_stream_sample_t* sample, float value, timestamp_t timestamp)
+{
+    sample->value = value;
+    sample->timestamp = timestamp;
+    sample->count++;
+}
 
-        d->stream.values[stream] = value;
-        d->stream.change_status |= (1 << stream);
+void motor_driver_set_stream_value(motor_driver_t* d, uint32_t stream, float value)
+{
+    motor_driver_set_stream_sample(d, stream, value, timestamp_get());
+}
 
-        motor_driver_unlock(d);
+void motor_driver_set_stream_sample(motor_driver_t* d,
+                                    uint32_t stream,
+                                    float value,
+                                    timestamp_t timestamp)
+{
+    if (stream < MOTOR_STREAMS_NB_VALUES) {
+        uint32_t seq = d->stream.seq;
+
+        /* Readers switch to copy 1 while copy 0 is modified, then back to
+         * copy 0 while copy 1 is brought up to date. */
+        __atomic_store_n(&d->stream.seq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        stream_sample_update(&d->stream.samples[0][stream], value, timestamp);
+        __atomic_store_n(&d->stream.seq, seq + 2, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        stream_sample_update(&d->stream.samples[1][stream], value, timestamp);
+
+        __atomic_fetch_or(&d->stream.change_status, 1 << stream, __ATOMIC_RELEASE);
     }
 }
 
 uint32_t motor_driver_get_stream_change_status(motor_driver_t* d)
 {
-    return d->stream.change_status;
+    return __atomic_load_n(&d->stream.change_status, __ATOMIC_ACQUIRE);
 }
 
-float motor_driver_get_and_clear_stream_value(motor_driver_t* d, uint32_t stream)
+bool motor_driver_get_stream_sample(motor_driver_t* d,
+                                    uint32_t stream,
+                                    motor_driver_stream_sample_t* sample)
 {
-    float return_value;
+    uint32_t seq;
 
-    if (stream < MOTOR_STREAMS_NB_VALUES) {
-        motor_driver_lock(d);
+    if (stream >= MOTOR_STREAMS_NB_VALUES) {
+        return false;
+    }
+
+    __atomic_fetch_and(&d->stream.change_status, ~(1 << stream), __ATOMIC_ACQUIRE);
+
+    do {
+        seq = __atomic_load_n(&d->stream.seq, __ATOMIC_ACQUIRE);
+        *sample = d->stream.samples[seq & 1][stream];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (seq != __atomic_load_n(&d->stream.seq, __ATOMIC_RELAXED));
 
-        d->stream.change_status &= ~(1 << stream);
-        return_value = d->stream.values[stream];
+    return true;
+}
 
-        motor_driver_unlock(d);
+float motor_driver_get_and_clear_stream_value(motor_driver_t* d, uint32_t stream)
+{
+    motor_driver_stream_sample_t sample;
 
-        return return_value;
+    if (motor_driver_get_stream_sample(d, stream, &sample)) {
+        return sample.value;
     } else {
         return 0.;
     }
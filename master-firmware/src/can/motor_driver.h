@@ -3,7 +3,9 @@
 
 #include <ch.h>
 #include <parameter/parameter.h>
+#include <timestamp/timestamp.h>
 #include "unix_timestamp.h"
+#include "time_sync.h"
 
 #define MOTOR_ID_MAX_LEN 24
 #define MOTOR_ID_MAX_LEN_WITH_NUL (MOTOR_ID_MAX_LEN + 1) // terminated C string buffer
@@ -13,6 +15,7 @@
 #define MOTOR_CONTROL_MODE_VELOCITY 2
 #define MOTOR_CONTROL_MODE_TORQUE 3
 #define MOTOR_CONTROL_MODE_VOLTAGE 4
+#define MOTOR_CONTROL_MODE_TRAJECTORY 5
 
 #define MOTOR_STREAMS_NB_VALUES 10
 #define MOTOR_STREAM_CURRENT 0
@@ -26,6 +29,22 @@
 #define MOTOR_STREAM_MOTOR_ENCODER 8
 #define MOTOR_STREAM_MOTOR_TORQUE 9
 
+/* Stamped feedback messages. Latency is tracked per message, as the ones
+ * taking two CAN frames arrive later than the single frame ones. */
+#define MOTOR_FEEDBACK_CURRENT_PID 0
+#define MOTOR_FEEDBACK_VELOCITY_PID 1
+#define MOTOR_FEEDBACK_POSITION_PID 2
+#define MOTOR_FEEDBACK_INDEX 3
+#define MOTOR_FEEDBACK_MOTOR_POSITION 4
+#define MOTOR_FEEDBACK_MOTOR_TORQUE 5
+#define MOTOR_FEEDBACK_NB_MESSAGES 6
+
+typedef struct {
+    float value;
+    timestamp_t timestamp; // sampling time on the motor board, in local time
+    uint32_t count; // number of samples received so far on this stream
+} motor_driver_stream_sample_t;
+
 struct pid_parameter_s {
     parameter_namespace_t root;
     parameter_t kp;
@@ -46,6 +65,11 @@ typedef struct {
         float velocity;
         float torque;
         float voltage;
+        struct {
+            float position;
+            float velocity;
+            float acceleration;
+        } trajectory;
     } setpt;
 
     struct {
@@ -79,10 +103,16 @@ typedef struct {
         parameter_t motor_torque_stream;
     } config;
 
+    /* Stream samples are written by the UAVCAN thread only and read without
+     * locking: the writer updates both copies one after the other and
+     * publishes which one is stable through the sequence number, so a reader
+     * never waits on the writer and retries only if it was preempted by it. */
     struct {
         uint32_t change_status;
-        float values[MOTOR_STREAMS_NB_VALUES];
+        uint32_t seq;
+        motor_driver_stream_sample_t samples[2][MOTOR_STREAMS_NB_VALUES];
         uint32_t value_stream_index_update_count;
+        time_sync_latency_t latency[MOTOR_FEEDBACK_NB_MESSAGES]; // sampling to reception delay
     } stream;
 
     void* can_driver;
@@ -108,6 +138,12 @@ void motor_driver_set_position(motor_driver_t* d, float position);
 void motor_driver_set_velocity(motor_driver_t* d, float velocity);
 void motor_driver_set_torque(motor_driver_t* d, float torque);
 void motor_driver_set_voltage(motor_driver_t* d, float voltage);
+// setpoint of a trajectory sampled by the caller, the motor board
+// interpolates it until the next one
+void motor_driver_set_trajectory(motor_driver_t* d,
+                                 float position,
+                                 float velocity,
+                                 float acceleration);
 void motor_driver_disable(motor_driver_t* d);
 
 #define CAN_ID_NOT_SET 0xFFFF
@@ -125,11 +161,31 @@ float motor_driver_get_position_setpt(motor_driver_t* d);
 float motor_driver_get_velocity_setpt(motor_driver_t* d);
 float motor_driver_get_torque_setpt(motor_driver_t* d);
 float motor_driver_get_voltage_setpt(motor_driver_t* d);
+void motor_driver_get_trajectory_setpt(motor_driver_t* d,
+                                       float* position,
+                                       float* velocity,
+                                       float* acceleration);
 
+// must only be called from a single thread (the UAVCAN receive thread)
 void motor_driver_set_stream_value(motor_driver_t* d, uint32_t stream, float value);
+// same as above for a sample taken at the given time instead of now
+void motor_driver_set_stream_sample(motor_driver_t* d,
+                                    uint32_t stream,
+                                    float value,
+                                    timestamp_t timestamp);
 uint32_t motor_driver_get_stream_change_status(motor_driver_t* d);
 float motor_driver_get_and_clear_stream_value(motor_driver_t* d, uint32_t stream);
 
+/** Reads the last sample of a stream without blocking and clears its change
+ * status bit. Returns false if the stream doesn't exist.
+ *
+ * The age of the sample can be computed by comparing sample->timestamp to
+ * timestamp_get(), and missed samples detected using sample->count.
+ */
+bool motor_driver_get_stream_sample(motor_driver_t* d,
+                                    uint32_t stream,
+                                    motor_driver_stream_sample_t* sample);
+
 #ifdef __cplusplus
 }
 #endif
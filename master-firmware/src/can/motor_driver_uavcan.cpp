@@ -8,6 +8,7 @@
 #include <cvra/motor/control/Position.hpp>
 #include <cvra/motor/control/Torque.hpp>
 #include <cvra/motor/control/Voltage.hpp>
+#include <cvra/motor/control/Trajectory.hpp>
 
 #include <error/error.h>
 #include <timestamp/timestamp.h>
@@ -38,6 +39,10 @@ static LazyConstructor<Publisher<control::Velocity>> velocity_pub;
 static LazyConstructor<Publisher<control::Position>> position_pub;
 static LazyConstructor<Publisher<control::Torque>> torque_pub;
 static LazyConstructor<Publisher<control::Voltage>> voltage_pub;
+static LazyConstructor<Publisher<control::Trajectory>> trajectory_pub;
+
+/* Signaled by the trajectory thread once it sampled new setpoints. */
+static BSEMAPHORE_DECL(trajectory_ready, true);
 
 int motor_driver_uavcan_init(INode& node)
 {
@@ -54,6 +59,7 @@ int motor_driver_uavcan_init(INode& node)
     position_pub.construct<INode&>(node);
     torque_pub.construct<INode&>(node);
     voltage_pub.construct<INode&>(node);
+    trajectory_pub.construct<INode&>(node);
 
     /* Setup a timer that will send the config & setpoints to the motor boards
      * periodically.
@@ -81,7 +87,10 @@ int motor_driver_uavcan_init(INode& node)
             }
 
             for (int i = 0; i < drv_list_len; i++) {
-                motor_driver_uavcan_send_setpoint(&drv_list[i]);
+                /* Trajectories are sent as soon as they are sampled */
+                if (motor_driver_get_control_mode(&drv_list[i]) != MOTOR_CONTROL_MODE_TRAJECTORY) {
+                    motor_driver_uavcan_send_setpoint(&drv_list[i]);
+                }
             }
         });
 
@@ -93,6 +102,29 @@ int motor_driver_uavcan_init(INode& node)
     return 0;
 }
 
+void motor_driver_uavcan_trajectory_ready(void)
+{
+    chBSemSignal(&trajectory_ready);
+}
+
+void motor_driver_uavcan_spin(void)
+{
+    if (chBSemWaitTimeout(&trajectory_ready, TIME_IMMEDIATE) != MSG_OK) {
+        return;
+    }
+
+    motor_driver_t* drv_list;
+    uint16_t drv_list_len;
+
+    motor_manager_get_list(&motor_manager, &drv_list, &drv_list_len);
+
+    for (int i = 0; i < drv_list_len; i++) {
+        if (motor_driver_get_control_mode(&drv_list[i]) == MOTOR_CONTROL_MODE_TRAJECTORY) {
+            motor_driver_uavcan_send_setpoint(&drv_list[i]);
+        }
+    }
+}
+
 static void update_motor_can_id(motor_driver_t* d)
 {
     int node_id = motor_driver_get_can_id(d);
@@ -132,6 +164,7 @@ static void motor_driver_uavcan_send_setpoint(motor_driver_t* d)
     control::Velocity velocity_setpoint;
     control::Torque torque_setpoint;
     control::Voltage voltage_setpoint;
+    control::Trajectory trajectory_setpoint;
 
     update_motor_can_id(d);
     int node_id = motor_driver_get_can_id(d);
@@ -165,6 +198,17 @@ static void motor_driver_uavcan_send_setpoint(motor_driver_t* d)
             voltage_pub->broadcast(voltage_setpoint);
         } break;
 
+        case MOTOR_CONTROL_MODE_TRAJECTORY: {
+            float position, velocity, acceleration;
+            motor_driver_get_trajectory_setpt(d, &position, &velocity, &acceleration);
+            trajectory_setpoint.position = position;
+            trajectory_setpoint.velocity = velocity;
+            trajectory_setpoint.acceleration = acceleration;
+            trajectory_setpoint.torque = 0;
+            trajectory_setpoint.node_id = node_id;
+            trajectory_pub->broadcast(trajectory_setpoint);
+        } break;
+
         /* Nothing to do, not sending any setpoint will disable the board. */
         case MOTOR_CONTROL_MODE_DISABLED:
             break;
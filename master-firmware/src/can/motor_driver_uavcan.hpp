@@ -5,4 +5,15 @@
 
 int motor_driver_uavcan_init(uavcan::INode& node);
 
+/** Tells the UAVCAN thread that new trajectory setpoints were sampled.
+ *
+ * The motor boards extrapolate a trajectory setpoint at constant speed until
+ * the next one, so it must go out right after it was sampled.
+ */
+void motor_driver_uavcan_trajectory_ready(void);
+
+/** Sends the trajectory setpoints if new ones are ready. Must be called from
+ * the UAVCAN thread. */
+void motor_driver_uavcan_spin(void);
+
 #endif /* MOTOR_DRIVER_UAVCAN_HPP */
@@ -5,23 +5,45 @@
 #include <cvra/motor/feedback/Index.hpp>
 #include <cvra/motor/feedback/MotorPosition.hpp>
 #include <cvra/motor/feedback/MotorTorque.hpp>
+#include <uavcan_stm32/uavcan_stm32.hpp>
+#include <timestamp/timestamp.h>
 #include "motor_driver.h"
 #include "bus_enumerator.h"
+#include "time_sync.h"
 
 using namespace uavcan;
 using namespace cvra::motor;
 
 static bus_enumerator_t* enumerator;
 
+/* Converts the bus time at which the motor board took the sample to local
+ * time. Falls back to the reception time if the board is not synchronised. */
+static timestamp_t sample_time(motor_driver_t* driver, int message, uint32_t stamp)
+{
+    timestamp_t local_now = timestamp_get();
+    uint32_t bus_now = (uint32_t)uavcan_stm32::clock::getUtc().toUSec();
+    timestamp_t local_stamp;
+    int32_t latency;
+
+    if (time_sync_remote_to_local(stamp, bus_now, local_now, &local_stamp, &latency)) {
+        time_sync_latency_update(&driver->stream.latency[message], latency);
+        return local_stamp;
+    }
+
+    time_sync_latency_reject(&driver->stream.latency[message]);
+    return local_now;
+}
+
 static void current_pid_cb(const ReceivedDataStructure<feedback::CurrentPID>& msg)
 {
     int id = msg.getSrcNodeID().get();
     motor_driver_t* driver;
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_CURRENT, msg.current);
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_CURRENT_SETPT, msg.current_setpoint);
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_MOTOR_VOLTAGE, msg.motor_voltage);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_CURRENT_PID, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_CURRENT, msg.current, t);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_CURRENT_SETPT, msg.current_setpoint, t);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_MOTOR_VOLTAGE, msg.motor_voltage, t);
     }
 }
 
@@ -32,10 +54,12 @@ static void velocity_pid_cb(const ReceivedDataStructure<feedback::VelocityPID>&
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
 
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_VELOCITY, msg.velocity);
-        motor_driver_set_stream_value(driver,
-                                      MOTOR_STREAM_VELOCITY_SETPT,
-                                      msg.velocity_setpoint);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_VELOCITY_PID, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_VELOCITY, msg.velocity, t);
+        motor_driver_set_stream_sample(driver,
+                                       MOTOR_STREAM_VELOCITY_SETPT,
+                                       msg.velocity_setpoint,
+                                       t);
     }
 }
 
@@ -45,10 +69,12 @@ static void position_pid_cb(const ReceivedDataStructure<feedback::PositionPID>&
     motor_driver_t* driver;
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_POSITION, msg.position);
-        motor_driver_set_stream_value(driver,
-                                      MOTOR_STREAM_POSITION_SETPT,
-                                      msg.position_setpoint);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_POSITION_PID, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_POSITION, msg.position, t);
+        motor_driver_set_stream_sample(driver,
+                                       MOTOR_STREAM_POSITION_SETPT,
+                                       msg.position_setpoint,
+                                       t);
     }
 }
 
@@ -58,7 +84,8 @@ static void index_cb(const ReceivedDataStructure<feedback::Index>& msg)
     motor_driver_t* driver;
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_INDEX, msg.position);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_INDEX, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_INDEX, msg.position, t);
         driver->stream.value_stream_index_update_count = msg.update_count;
     }
 }
@@ -69,8 +96,9 @@ static void motor_pos_cb(const ReceivedDataStructure<feedback::MotorPosition>& m
     motor_driver_t* driver;
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_POSITION, msg.position);
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_VELOCITY, msg.velocity);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_MOTOR_POSITION, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_POSITION, msg.position, t);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_VELOCITY, msg.velocity, t);
     }
 }
 
@@ -80,8 +108,9 @@ static void torque_cb(const ReceivedDataStructure<feedback::MotorTorque>& msg)
     motor_driver_t* driver;
     driver = (motor_driver_t*)bus_enumerator_get_driver_by_can_id(enumerator, id);
     if (driver != NULL) {
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_MOTOR_TORQUE, msg.torque);
-        motor_driver_set_stream_value(driver, MOTOR_STREAM_POSITION, msg.position);
+        timestamp_t t = sample_time(driver, MOTOR_FEEDBACK_MOTOR_TORQUE, msg.timestamp);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_MOTOR_TORQUE, msg.torque, t);
+        motor_driver_set_stream_sample(driver, MOTOR_STREAM_POSITION, msg.position, t);
     }
 }
 
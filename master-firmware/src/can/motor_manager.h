@@ -58,6 +58,12 @@ void motor_manager_set_position(motor_manager_t* m,
                                 const char* actuator_id,
                                 float position);
 
+void motor_manager_set_trajectory(motor_manager_t* m,
+                                  const char* actuator_id,
+                                  float position,
+                                  float velocity,
+                                  float acceleration);
+
 #ifdef __cplusplus
 }
 #endif
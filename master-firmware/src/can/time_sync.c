@@ -0,0 +1,66 @@
+#include <string.h>
+#include "time_sync.h"
+
+bool time_sync_remote_to_local(uint32_t remote_stamp,
+                               uint32_t bus_now,
+                               timestamp_t local_now,
+                               timestamp_t* local_stamp,
+                               int32_t* latency_us)
+{
+    /* Masked difference handles the wrap around of the stamps, differences
+     * over half the range are stamps from the future. */
+    uint32_t difference = (bus_now - remote_stamp) & TIME_SYNC_STAMP_MASK;
+
+    if (difference > TIME_SYNC_STAMP_MASK / 2) {
+        return false;
+    }
+
+    int32_t latency = (int32_t)difference;
+
+    if (latency > TIME_SYNC_MAX_LATENCY_US) {
+        return false;
+    }
+
+    *local_stamp = local_now - (uint32_t)latency;
+    *latency_us = latency;
+
+    return true;
+}
+
+void time_sync_latency_reset(time_sync_latency_t* latency)
+{
+    memset(latency, 0, sizeof(time_sync_latency_t));
+}
+
+void time_sync_latency_update(time_sync_latency_t* latency, int32_t latency_us)
+{
+    if (latency->count == 0 || latency_us < latency->min_us) {
+        latency->min_us = latency_us;
+    }
+
+    if (latency->count == 0 || latency_us > latency->max_us) {
+        latency->max_us = latency_us;
+    }
+
+    latency->sum_us += latency_us;
+    latency->count++;
+}
+
+void time_sync_latency_reject(time_sync_latency_t* latency)
+{
+    latency->rejected++;
+}
+
+int32_t time_sync_latency_mean_us(const time_sync_latency_t* latency)
+{
+    if (latency->count == 0) {
+        return 0;
+    }
+
+    return (int32_t)(latency->sum_us / latency->count);
+}
+
+int32_t time_sync_skew_us(const time_sync_latency_t* a, const time_sync_latency_t* b)
+{
+    return a->min_us - b->min_us;
+}
@@ -0,0 +1,78 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+/*
+
+# Bus time synchronisation helpers
+
+The master publishes UAVCAN GlobalTimeSync messages and the other boards lock
+their clock on it. Feedback streams carry the lower 24 bits of the bus time at
+which they were sampled (in microseconds), so that the short ones still fit in
+a single CAN frame. These helpers convert such stamps back to the local timestamp base
+and keep statistics on the observed latency, which tell how well a board is
+synchronised compared to the others.
+
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <timestamp/timestamp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stamps older than this are considered bogus (board not synchronised yet). */
+#define TIME_SYNC_MAX_LATENCY_US 100000
+
+/* Bits of the bus time sent in the stamps, they wrap every 16.7 s. */
+#define TIME_SYNC_STAMP_MASK 0xffffffu
+
+typedef struct {
+    int32_t min_us;
+    int32_t max_us;
+    int64_t sum_us;
+    uint32_t count;
+    uint32_t rejected; // number of stamps which could not be used
+} time_sync_latency_t;
+
+/** Converts a stamp taken on the bus clock to the local timestamp base.
+ *
+ * @param [in] remote_stamp Bus time at which the remote sampled the data,
+ * lower 24 bits.
+ * @param [in] bus_now Current bus time, only the lower 24 bits are used.
+ * @param [in] local_now Local timestamp taken together with bus_now.
+ * @param [out] local_stamp Converted stamp, only written on success.
+ * @param [out] latency_us Time between sampling and now, only written on success.
+ *
+ * @return false if the stamp is in the future or older than
+ * TIME_SYNC_MAX_LATENCY_US, which happens if the remote is not synchronised.
+ */
+bool time_sync_remote_to_local(uint32_t remote_stamp,
+                               uint32_t bus_now,
+                               timestamp_t local_now,
+                               timestamp_t* local_stamp,
+                               int32_t* latency_us);
+
+void time_sync_latency_reset(time_sync_latency_t* latency);
+
+void time_sync_latency_update(time_sync_latency_t* latency, int32_t latency_us);
+
+/** Marks one stamp as unusable. */
+void time_sync_latency_reject(time_sync_latency_t* latency);
+
+/** Returns the average latency, or zero if nothing was recorded. */
+int32_t time_sync_latency_mean_us(const time_sync_latency_t* latency);
+
+/** Timing skew between two boards.
+ *
+ * The transmission time is the same for every board, so the difference of
+ * the minimum latencies is the clock offset between the two boards.
+ */
+int32_t time_sync_skew_us(const time_sync_latency_t* a, const time_sync_latency_t* b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIME_SYNC_H */
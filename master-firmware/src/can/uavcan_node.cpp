@@ -4,6 +4,7 @@
 #include <uavcan_stm32/uavcan_stm32.hpp>
 #include <uavcan/protocol/NodeStatus.hpp>
 #include <uavcan/protocol/node_info_retriever.hpp>
+#include <uavcan/protocol/global_time_sync_master.hpp>
 #include "emergency_stop_handler.hpp"
 #include "motor_feedback_streams_handler.hpp"
 #include "beacon_signal_handler.hpp"
@@ -25,6 +26,7 @@
 #include <errno.h>
 
 #define UAVCAN_SPIN_FREQ 500 // [Hz]
+#define UAVCAN_TIME_SYNC_PERIOD_MS 250
 
 #define UAVCAN_NODE_STACK_SIZE 8192
 
@@ -161,6 +163,17 @@ static void main(void* arg)
         ERROR("electron starter");
     }
 
+    /* The master is the time reference for the whole bus: motor boards lock
+     * their clock on it and stamp their feedback streams with it. Our UTC
+     * clock must be set for the sync messages to carry a time, it starts from
+     * the monotonic one as only the boards' agreement matters. */
+    uavcan_stm32::clock::adjustUtc(uavcan::UtcDuration::fromUSec(uavcan_stm32::clock::getMonotonic().toUSec()));
+    static uavcan::GlobalTimeSyncMaster time_sync_master(node);
+    res = time_sync_master.init();
+    if (res < 0) {
+        ERROR("Time sync master");
+    }
+    uavcan::MonotonicTime last_time_sync = node.getMonotonicTime();
 
     // Mark the node as correctly initialized
     node.getNodeStatusProvider().setModeOperational();
@@ -172,9 +185,20 @@ static void main(void* arg)
             WARNING("UAVCAN spin warning %d", res);
         }
 
+        motor_driver_uavcan_spin();
+
         if (can_uwb_ip_netif_spin(node) < 0) {
             WARNING("UWB canif warning %d", res);
         }
+
+        const uavcan::MonotonicTime now = node.getMonotonicTime();
+        if ((now - last_time_sync).toMSec() >= UAVCAN_TIME_SYNC_PERIOD_MS) {
+            last_time_sync = now;
+            res = time_sync_master.publish();
+            if (res < 0) {
+                WARNING("Time sync publish %d", res);
+            }
+        }
     }
 }
 
@@ -1,5 +1,7 @@
 #include <uavcan/uavcan.hpp>
 #include <cvra/uwb_beacon/TagPosition.hpp>
+#include <uavcan/equipment/ahrs/Solution.hpp>
+#include <cmath>
 #include <aversive/math/geometry/vect_base.h>
 #include <error/error.h>
 #include "main.h"
@@ -7,12 +9,16 @@
 #include "base/base_controller.h"
 #include "control_panel.h"
 #include "protobuf/beacons.pb.h"
+#include "protobuf/localization.pb.h"
 #include "timestamp/timestamp.h"
 
 using TagPosition = cvra::uwb_beacon::TagPosition;
+using AttitudeSolution = uavcan::equipment::ahrs::Solution;
 
 TOPIC_DECL(allied_position_topic, AlliedPosition);
 TOPIC_DECL(last_panel_contact_topic, Timestamp);
+TOPIC_DECL(uwb_position_topic, PositionFix);
+TOPIC_DECL(imu_heading_topic, HeadingFix);
 
 static uavcan::LazyConstructor<uavcan::Publisher<TagPosition>> publisher;
 
@@ -30,13 +36,35 @@ static void position_cb(const uavcan::ReceivedDataStructure<TagPosition>& msg)
         messagebus_topic_publish(&last_panel_contact_topic.topic, &msg, sizeof(msg));
     } else {
         messagebus_topic_publish(&allied_position_topic.topic, &pos, sizeof(pos));
+
+        // The tag estimates its position in meters
+        PositionFix fix;
+        fix.timestamp = pos.timestamp;
+        fix.x = msg.x * 1000.f;
+        fix.y = msg.y * 1000.f;
+        messagebus_topic_publish(&uwb_position_topic.topic, &fix, sizeof(fix));
     }
 }
 
+static void attitude_cb(const uavcan::ReceivedDataStructure<AttitudeSolution>& msg)
+{
+    const float x = msg.orientation_xyzw[0];
+    const float y = msg.orientation_xyzw[1];
+    const float z = msg.orientation_xyzw[2];
+    const float w = msg.orientation_xyzw[3];
+
+    HeadingFix fix;
+    fix.timestamp.us = timestamp_get();
+    fix.a = atan2f(2 * (w * z + x * y), 1 - 2 * (y * y + z * z));
+    messagebus_topic_publish(&imu_heading_topic.topic, &fix, sizeof(fix));
+}
+
 int uwb_position_handler_init(uavcan::INode& node)
 {
     messagebus_advertise_topic(&bus, &allied_position_topic.topic, "/allied_position");
     messagebus_advertise_topic(&bus, &last_panel_contact_topic.topic, "/panel_contact_us");
+    messagebus_advertise_topic(&bus, &uwb_position_topic.topic, "/uwb/position");
+    messagebus_advertise_topic(&bus, &imu_heading_topic.topic, "/imu/heading");
 
     static uavcan::Subscriber<TagPosition> position_sub(node);
     auto res = position_sub.start(position_cb);
@@ -45,14 +73,23 @@ int uwb_position_handler_init(uavcan::INode& node)
         return res;
     }
 
+    static uavcan::Subscriber<AttitudeSolution> attitude_sub(node);
+    res = attitude_sub.start(attitude_cb);
+
+    if (res != 0) {
+        return res;
+    }
+
     publisher.construct<uavcan::INode&>(node);
 
     static uavcan::Timer periodic_timer(node);
     periodic_timer.setCallback([](const uavcan::TimerEvent& event) {
         (void)event;
+        // Only a starting point for the tag estimator, which never sends it
+        // back, so that the fused UWB positions are not our own odometry.
         TagPosition msg;
-        msg.x = position_get_x_double(&robot.pos);
-        msg.y = position_get_y_double(&robot.pos);
+        msg.x = position_get_x_double(&robot.pos) / 1000.;
+        msg.y = position_get_y_double(&robot.pos) / 1000.;
         publisher->broadcast(msg);
     });
 
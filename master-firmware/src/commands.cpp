@@ -26,6 +26,7 @@ extern "C" {
 #include "base/encoder.h"
 #include "base/base_controller.h"
 #include "base/base_helpers.h"
+#include "base/pose_fusion.h"
 #include "base/map_server.h"
 #include "robot_helpers/beacon_helpers.h"
 #include "protobuf/beacons.pb.h"
@@ -48,6 +49,7 @@ extern "C" {
 #include "pca9685_pwm.h"
 #include "protobuf/sensors.pb.h"
 #include "protobuf/encoders.pb.h"
+#include "protobuf/control_loop.pb.h"
 #include "usbconf.h"
 #include "shell_commands.h"
 
@@ -385,12 +387,29 @@ SHELL_COMMAND(encoders, chp, argc, argv)
     (void)argv;
 
     messagebus_topic_t* encoders_topic;
-    WheelEncodersPulse values;
+    WheelEncoders values;
 
     encoders_topic = messagebus_find_topic_blocking(&bus, "/encoders");
     messagebus_topic_wait(encoders_topic, &values, sizeof(values));
 
-    chprintf(chp, "left: %ld\r\nright: %ld\r\n", values.left, values.right);
+    chprintf(chp, "left: %ld (%.0f ticks/s)\r\n", values.left, values.left_velocity);
+    chprintf(chp, "right: %ld (%.0f ticks/s)\r\n", values.right, values.right_velocity);
+}
+
+SHELL_COMMAND(loop_stats, chp, argc, argv)
+{
+    (void)argc;
+    (void)argv;
+
+    messagebus_topic_t* topic;
+    ControlLoopStats stats;
+
+    topic = messagebus_find_topic_blocking(&bus, "/base/loop_stats");
+    messagebus_topic_wait(topic, &stats, sizeof(stats));
+
+    chprintf(chp, "cycles: %lu\r\noverruns: %lu\r\n", stats.cycles, stats.overruns);
+    chprintf(chp, "latency: %.1f us (max %.0f us)\r\n", stats.latency_mean, stats.latency_max);
+    chprintf(chp, "execution time: %.1f us (max %.0f us)\r\n", stats.exec_time_mean, stats.exec_time_max);
 }
 
 /* position */
@@ -417,6 +436,7 @@ SHELL_COMMAND(pos_reset, chp, argc, argv)
         float a = atof(argv[2]);
 
         position_set(&robot.pos, x, y, a);
+        pose_fusion_reset();
 
         chprintf(chp, "New pos x: %f [mm]\r\ny: %f [mm]\r\na: %f [deg]\r\n", x, y, a);
     } else {
@@ -455,6 +475,7 @@ SHELL_COMMAND(forward, chp, argc, argv)
 
         int32_t distance;
         distance = atoi(argv[0]);
+        collision_detector_reset(&robot.collision);
         trajectory_d_rel(&robot.traj, distance);
         int end_reason = trajectory_wait_for_end(
             TRAJ_END_GOAL_REACHED | TRAJ_END_COLLISION | TRAJ_END_OPPONENT_NEAR | TRAJ_END_ALLY_NEAR);
@@ -830,6 +851,46 @@ SHELL_COMMAND(motors, chp, argc, argv)
     }
 }
 
+SHELL_COMMAND(time_sync, chp, argc, argv)
+{
+    (void)argc;
+    (void)argv;
+    motor_driver_t* motors;
+    uint16_t len, i;
+    motor_manager_get_list(&motor_manager, &motors, &len);
+
+    const char* messages[MOTOR_FEEDBACK_NB_MESSAGES] = {
+        "current_pid", "velocity_pid", "position_pid", "index", "motor_pos", "motor_torque"};
+
+    /* Two frame messages arrive later, so boards are only compared on the
+     * same message. */
+    for (int m = 0; m < MOTOR_FEEDBACK_NB_MESSAGES; m++) {
+        time_sync_latency_t* reference = NULL;
+        const char* reference_id = NULL;
+
+        chprintf(chp, "%s latency [us] (min / mean / max), rejected stamps, skew\r\n", messages[m]);
+        for (i = 0; i < len; i++) {
+            time_sync_latency_t* l = &motors[i].stream.latency[m];
+            if (l->count == 0 && l->rejected == 0) {
+                continue;
+            }
+
+            chprintf(chp, "%24s: %6ld / %6ld / %6ld, %lu", motors[i].id,
+                     l->min_us, time_sync_latency_mean_us(l), l->max_us, l->rejected);
+
+            if (l->count == 0) {
+                chprintf(chp, "\r\n");
+            } else if (reference == NULL) {
+                reference = l;
+                reference_id = motors[i].id;
+                chprintf(chp, ", reference\r\n");
+            } else {
+                chprintf(chp, ", %ld us from %s\r\n", time_sync_skew_us(l, reference), reference_id);
+            }
+        }
+    }
+}
+
 SHELL_COMMAND(motor_pos, chp, argc, argv)
 {
     if (argc < 2) {
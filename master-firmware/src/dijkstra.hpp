@@ -1,10 +1,14 @@
 #pragma once
 
 #include <iterator>
-#include <climits>
+#include <cmath>
+#include <cstdint>
 
 namespace pathfinding {
 
+template <typename Node, int Capacity>
+class NodeHeap;
+
 /** Class storing a node in the graph for Dijkstra
  *
  * @parameter Data an application-specific piece of data, such as an arm configuration.
@@ -14,16 +18,24 @@ template <typename Data, int N = 10>
 class Node {
 protected:
     Node<Data>* edges[N];
+    float weights[N];
     int edge_count;
 
     /* Used for dijkstra */
     bool visited;
-    int distance;
+    float distance;
     Node<Data>* parent;
+    int heap_index;
 
 public:
+    template <typename T, int MaxNodes>
+    friend bool shortest_paths(T* nodes, int node_count, T& start);
+    template <typename T, int Capacity>
+    friend class NodeHeap;
     template <typename T>
     friend int dijkstra(T* nodes, int node_count, T& start, T& end);
+    template <int Count>
+    friend class NextHopTable;
 
     Node(Data d)
         : edge_count(0)
@@ -31,9 +43,11 @@ public:
     {
     }
 
-    void connect(Node<Data>& n)
+    /** Adds an edge towards n, with the given cost to go through it. */
+    void connect(Node<Data>& n, float weight = 1)
     {
         edges[edge_count] = &n;
+        weights[edge_count] = weight;
         edge_count += 1;
     }
 
@@ -44,55 +58,158 @@ public:
 /** Connects two nodes in both directions
  */
 template <typename Data>
-void connect_bidirectional(Node<Data>& lhs, Node<Data>& rhs)
+void connect_bidirectional(Node<Data>& lhs, Node<Data>& rhs, float weight = 1)
 {
-    lhs.connect(rhs);
-    rhs.connect(lhs);
+    lhs.connect(rhs, weight);
+    rhs.connect(lhs, weight);
 }
 
-/** Computes the shortest path in the given graph.
+/** Binary min-heap of nodes ordered by distance, without allocation.
  *
- * The path will be stored in the nodes themselves as a linked list. To traverse the path, follow the path_next pointer.
- * Ex:
+ * Each node remembers its place in the heap, so that its distance can be
+ * decreased in place and the heap never holds more than one entry per node.
+ */
+template <typename Node, int Capacity>
+class NodeHeap {
+    Node* heap[Capacity];
+    int size;
+
+    void swap(int i, int j)
+    {
+        Node* tmp = heap[i];
+        heap[i] = heap[j];
+        heap[j] = tmp;
+        heap[i]->heap_index = i;
+        heap[j]->heap_index = j;
+    }
+
+    /* Moves the parents of n down until its place is found */
+    void sift_up(Node* n)
+    {
+        int i = n->heap_index;
+        while (i > 0 && heap[(i - 1) / 2]->distance > n->distance) {
+            heap[i] = heap[(i - 1) / 2];
+            heap[i]->heap_index = i;
+            i = (i - 1) / 2;
+        }
+        heap[i] = n;
+        n->heap_index = i;
+    }
+
+    void sift_down(int i)
+    {
+        while (true) {
+            int smallest = i;
+            for (int child = 2 * i + 1; child <= 2 * i + 2 && child < size; child++) {
+                if (heap[child]->distance < heap[smallest]->distance) {
+                    smallest = child;
+                }
+            }
+            if (smallest == i) {
+                return;
+            }
+            swap(i, smallest);
+            i = smallest;
+        }
+    }
+
+public:
+    NodeHeap()
+        : size(0)
+    {
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    /** Inserts a node, or moves it up if it is already in the heap and its
+     * distance decreased. */
+    void push_or_decrease(Node* n)
+    {
+        if (n->heap_index < 0) {
+            n->heap_index = size;
+            size++;
+        }
+        sift_up(n);
+    }
+
+    Node* pop()
+    {
+        Node* top = heap[0];
+        size--;
+        swap(0, size);
+        top->heap_index = -1;
+        sift_down(0);
+        return top;
+    }
+};
+
+/** Computes the shortest path from start to every node of the graph.
  *
- * for (auto *p = &start; p->path_next != nullptr; p = p->path_next) {
- *   move_to(p.data);
- * }
+ * Each node then points to its parent on the path from start, which is
+ * nullptr for start itself and for unreachable nodes.
  *
- * @returns The path length.
+ * @returns false if the graph has more than MaxNodes nodes.
  */
-template <typename Node>
-int dijkstra(Node* nodes, int node_count, Node& start, Node& end)
+template <typename Node, int MaxNodes = 64>
+bool shortest_paths(Node* nodes, int node_count, Node& start)
 {
+    if (node_count > MaxNodes) {
+        return false;
+    }
+
     for (auto i = 0; i < node_count; i++) {
         nodes[i].visited = false;
-        nodes[i].distance = INT_MAX;
+        nodes[i].distance = INFINITY;
         nodes[i].parent = nullptr;
         nodes[i].path_next = nullptr;
+        nodes[i].heap_index = -1;
     }
 
+    NodeHeap<Node, MaxNodes> queue;
     start.distance = 0;
+    queue.push_or_decrease(&start);
 
-    auto v = &start;
-
-    while (v->visited == false) {
+    while (!queue.empty()) {
+        auto v = queue.pop();
         v->visited = true;
 
         for (auto i = 0; i < v->edge_count; i++) {
-            if (v->edges[i]->distance > v->distance + 1) {
-                v->edges[i]->distance = v->distance + 1;
-                v->edges[i]->parent = v;
+            auto n = v->edges[i];
+            auto distance = v->distance + v->weights[i];
+            if (!n->visited && n->distance > distance) {
+                n->distance = distance;
+                n->parent = v;
+                queue.push_or_decrease(n);
             }
         }
+    }
 
-        int min_distance = INT_MAX;
+    return true;
+}
 
-        for (auto i = 0; i < node_count; i++) {
-            if (!nodes[i].visited && min_distance > nodes[i].distance) {
-                min_distance = nodes[i].distance;
-                v = &nodes[i];
-            }
-        }
+/** Computes the shortest path in the given graph.
+ *
+ * The path will be stored in the nodes themselves as a linked list. To traverse the path, follow the path_next pointer.
+ * Ex:
+ *
+ * for (auto *p = &start; p->path_next != nullptr; p = p->path_next) {
+ *   move_to(p.data);
+ * }
+ *
+ * @returns The path length, or -1 if end cannot be reached.
+ */
+template <typename Node>
+int dijkstra(Node* nodes, int node_count, Node& start, Node& end)
+{
+    if (!shortest_paths(nodes, node_count, start)) {
+        return -1;
+    }
+
+    if (&end != &start && end.parent == nullptr) {
+        return -1;
     }
 
     int len = 0;
@@ -103,5 +220,61 @@ int dijkstra(Node* nodes, int node_count, Node& start, Node& end)
 
     return len;
 }
-} // namespace pathfinding
 
+/** Next node to go to on the shortest path between any two nodes of a graph.
+ *
+ * It is computed once for a fixed graph, after which following a path only
+ * costs one lookup per node on it.
+ *
+ * @parameter Count The number of nodes in the graph.
+ */
+template <int Count>
+class NextHopTable {
+    static_assert(Count <= INT8_MAX, "Node indices must fit in the table");
+
+    int8_t next_hop[Count][Count];
+
+public:
+    /** Runs Dijkstra from every node of the graph. */
+    template <typename Node>
+    void compute(Node* nodes)
+    {
+        for (int from = 0; from < Count; from++) {
+            shortest_paths<Node, Count>(nodes, Count, nodes[from]);
+
+            for (int to = 0; to < Count; to++) {
+                Node* p = &nodes[to];
+                if (to != from && p->parent == nullptr) {
+                    next_hop[from][to] = -1;
+                    continue;
+                }
+                while (p->parent != nullptr && p->parent != &nodes[from]) {
+                    p = p->parent;
+                }
+                next_hop[from][to] = p - nodes;
+            }
+        }
+    }
+
+    /** Index of the node following from on the way to to, to itself if both
+     * are the same, or -1 if to cannot be reached. */
+    int next(int from, int to) const
+    {
+        return next_hop[from][to];
+    }
+
+    /** Number of moves from from to to, or -1 if to cannot be reached. */
+    int length(int from, int to) const
+    {
+        int len = 0;
+        while (from != to) {
+            from = next_hop[from][to];
+            if (from < 0) {
+                return -1;
+            }
+            len++;
+        }
+        return len;
+    }
+};
+} // namespace pathfinding
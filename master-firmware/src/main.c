@@ -246,11 +246,9 @@ int main(void)
     gui_start();
 
     /* Base init */
-    encoder_start();
+    encoder_init();
     robot_init();
     base_controller_start();
-    position_manager_start();
-    trajectory_manager_start();
 
     /* Arms init */
     manipulator_start();
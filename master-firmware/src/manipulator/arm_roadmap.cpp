@@ -0,0 +1,420 @@
+/* Generated by tools/arm_roadmap_generator.cpp with 200 samples, 10 neighbours
+ * and seed 1, do not edit. */
+#include "manipulator/roadmap.h"
+
+namespace manipulator {
+static const Angles nodes[225] = {
+    {{0.00000f, 0.00000f, 0.00000f}},
+    {{1.27050f, 1.50020f, 1.46140f}},
+    {{0.57913f, 1.13071f, 0.00000f}},
+    {{0.35136f, 1.66512f, 1.57080f}},
+    {{0.35136f, 2.16512f, 1.57080f}},
+    {{0.59696f, 2.36765f, 1.57080f}},
+    {{0.59696f, 3.14000f, 1.57080f}},
+    {{-0.19010f, 2.16260f, 1.57000f}},
+    {{0.86740f, 2.16260f, 2.15800f}},
+    {{0.55220f, 2.86530f, 1.56050f}},
+    {{0.26170f, 2.48740f, 1.61140f}},
+    {{0.55593f, 2.29991f, 0.00000f}},
+    {{0.44061f, 2.40560f, 0.00000f}},
+    {{0.15942f, 2.76072f, 0.35512f}},
+    {{-0.14048f, 2.77174f, 0.36614f}},
+    {{-0.35403f, 2.01077f, 0.00000f}},
+    {{-0.18604f, 2.38740f, 0.00000f}},
+    {{-0.42262f, 1.70404f, 0.00000f}},
+    {{-0.44061f, 2.40560f, 0.00000f}},
+    {{-0.69523f, 2.15951f, 0.00000f}},
+    {{-0.98945f, 1.83134f, 0.00000f}},
+    {{-1.26715f, 1.48789f, 0.00000f}},
+    {{-1.49247f, 1.17753f, 0.00000f}},
+    {{-1.29582f, 1.06898f, 0.00000f}},
+    {{-1.16755f, 0.95911f, 0.00000f}},
+    {{-0.34893f, 3.24057f, 1.62878f}},
+    {{1.19767f, -0.09962f, 0.20750f}},
+    {{-0.69300f, 3.24679f, 0.25221f}},
+    {{-0.89173f, 0.20933f, 0.85179f}},
+    {{-1.04122f, 1.19950f, 0.72935f}},
+    {{0.40924f, 1.22917f, 2.14529f}},
+    {{0.01645f, 2.73514f, 0.90607f}},
+    {{-0.66018f, 2.19549f, 1.15892f}},
+    {{-0.98664f, 1.38557f, 2.00748f}},
+    {{-0.91127f, -0.00825f, 1.18259f}},
+    {{0.41140f, 2.96177f, 0.90153f}},
+    {{-0.22839f, 1.77161f, 0.93368f}},
+    {{-1.17884f, 3.04608f, 0.37544f}},
+    {{0.73517f, 2.58249f, 1.61833f}},
+    {{1.30478f, 2.58924f, 0.65222f}},
+    {{-1.32160f, 2.21928f, 1.14357f}},
+    {{1.02917f, 2.79782f, 2.04706f}},
+    {{0.88744f, 0.18490f, 1.89105f}},
+    {{-1.48284f, 0.81472f, 0.30759f}},
+    {{-1.42227f, 2.84178f, 1.50927f}},
+    {{-1.30496f, 1.88677f, 0.91066f}},
+    {{0.41496f, 3.10893f, 0.88829f}},
+    {{-0.00050f, 0.56180f, 1.56051f}},
+    {{0.45950f, 2.52410f, 1.90310f}},
+    {{0.65043f, 1.99050f, 2.27327f}},
+    {{0.38191f, 2.40635f, 0.61639f}},
+    {{-0.75867f, 1.39455f, 1.79427f}},
+    {{-0.93363f, 0.24581f, 0.07607f}},
+    {{-0.25632f, 1.47195f, 2.08063f}},
+    {{-1.31148f, 0.88361f, 2.06809f}},
+    {{0.43651f, 2.97149f, 0.40791f}},
+    {{1.13135f, 0.78958f, 0.61743f}},
+    {{-0.12528f, 1.85770f, 0.02807f}},
+    {{0.09774f, 1.82329f, 1.37345f}},
+    {{-1.15981f, 3.10439f, 1.31433f}},
+    {{-0.81706f, 2.24419f, 0.45444f}},
+    {{-1.29300f, 1.68705f, 0.89373f}},
+    {{1.24981f, 2.22624f, 1.08334f}},
+    {{-0.35746f, 1.71101f, 0.01989f}},
+    {{0.69646f, 1.69525f, 0.00883f}},
+    {{0.39138f, 0.36889f, 1.13573f}},
+    {{0.77721f, 3.06439f, -0.02848f}},
+    {{0.15967f, 2.85847f, 2.06816f}},
+    {{-1.18217f, 2.88866f, 1.83774f}},
+    {{-0.46725f, 1.23222f, 1.19222f}},
+    {{-1.10394f, 2.08520f, 2.12602f}},
+    {{-0.51622f, 1.06502f, 1.27042f}},
+    {{0.65244f, 2.03675f, 1.64240f}},
+    {{-1.22106f, 2.85908f, 1.55649f}},
+    {{0.27102f, 2.06996f, 1.70226f}},
+    {{-0.53818f, 1.06881f, 1.73176f}},
+    {{-0.79022f, 1.09438f, 2.05013f}},
+    {{0.65837f, 1.33411f, 2.01522f}},
+    {{1.29452f, -0.06091f, 1.49226f}},
+    {{-0.10567f, 1.98268f, 0.07710f}},
+    {{-1.25576f, 2.53629f, 2.17877f}},
+    {{-1.40780f, 1.40721f, 0.75274f}},
+    {{0.13517f, 3.05515f, 0.87953f}},
+    {{-0.46059f, 0.69404f, 1.73101f}},
+    {{1.11014f, 2.48484f, 1.27683f}},
+    {{-0.69592f, -0.09038f, 1.75457f}},
+    {{0.25143f, 0.41231f, 0.68395f}},
+    {{0.13590f, 1.66564f, -0.07838f}},
+    {{1.05783f, 2.27529f, 0.75745f}},
+    {{-0.18808f, 2.94359f, 1.73502f}},
+    {{0.27008f, 1.46577f, -0.06203f}},
+    {{-0.79300f, 3.01361f, 1.89606f}},
+    {{0.47269f, 1.74694f, 2.29357f}},
+    {{-1.38976f, 0.47734f, 1.03394f}},
+    {{-1.18859f, 2.38826f, 2.13823f}},
+    {{-1.02413f, 2.23434f, 1.01435f}},
+    {{-1.40200f, 0.67172f, 1.71311f}},
+    {{-0.07526f, 2.42549f, 0.40056f}},
+    {{1.16907f, 0.06517f, 1.60766f}},
+    {{-1.54036f, 1.22765f, -0.03709f}},
+    {{-0.86137f, 0.24215f, 1.96407f}},
+    {{-0.73385f, 1.70508f, 0.45622f}},
+    {{0.05847f, 3.14169f, 1.92087f}},
+    {{-0.76245f, 0.20671f, 1.30582f}},
+    {{0.11020f, 3.14815f, 0.90302f}},
+    {{0.08309f, 1.13227f, -0.05525f}},
+    {{0.83898f, 2.58212f, 0.59542f}},
+    {{-0.90108f, 2.30326f, 1.83705f}},
+    {{0.23884f, 1.19933f, 0.92458f}},
+    {{0.99063f, 2.41877f, 1.69309f}},
+    {{-0.31656f, 1.76340f, 0.92812f}},
+    {{-1.19063f, 1.11238f, 0.04380f}},
+    {{-1.13998f, 0.30650f, 2.14926f}},
+    {{-1.46634f, 2.96997f, 0.15799f}},
+    {{0.74588f, 0.65613f, 1.37919f}},
+    {{0.53897f, 0.02060f, 1.24332f}},
+    {{-1.38408f, 0.88610f, 2.22146f}},
+    {{-0.51756f, 1.80314f, 0.55915f}},
+    {{-0.99012f, 0.14780f, 0.50558f}},
+    {{-1.14359f, 2.39182f, 0.28788f}},
+    {{-1.01371f, 3.04468f, 1.29526f}},
+    {{-0.48660f, 3.14957f, 0.02004f}},
+    {{0.94049f, 2.38220f, 0.47563f}},
+    {{-0.70396f, 1.55413f, 0.39046f}},
+    {{0.25987f, 3.18888f, 1.88955f}},
+    {{1.07906f, 0.42525f, 1.72244f}},
+    {{-1.54427f, 2.08125f, 0.06805f}},
+    {{-1.48095f, 1.52926f, 1.85330f}},
+    {{0.21899f, 2.45462f, 1.26524f}},
+    {{-0.23415f, 0.96316f, 1.17638f}},
+    {{1.36585f, 0.26628f, 1.29139f}},
+    {{-1.16190f, 1.17347f, 1.12109f}},
+    {{0.05284f, 0.62243f, 1.68880f}},
+    {{1.14933f, 2.14193f, 1.00917f}},
+    {{0.69272f, 1.13978f, 0.41056f}},
+    {{-1.31374f, 2.42173f, 0.28929f}},
+    {{-1.40039f, 1.09415f, 0.52476f}},
+    {{-1.31408f, 2.59593f, 0.24383f}},
+    {{-1.01970f, 3.01889f, 1.43471f}},
+    {{0.12975f, 1.65765f, 1.91515f}},
+    {{1.17442f, 1.98803f, 0.53191f}},
+    {{-0.62645f, 0.12097f, 1.64723f}},
+    {{0.60520f, 1.65117f, 1.75323f}},
+    {{0.61043f, 2.94118f, 0.29697f}},
+    {{1.19592f, 2.20165f, -0.06652f}},
+    {{-0.31957f, 0.68511f, 1.64854f}},
+    {{0.25034f, 2.43372f, 2.17764f}},
+    {{-0.40717f, 3.08309f, 2.12048f}},
+    {{0.06996f, 0.58176f, 2.09746f}},
+    {{-1.57599f, 2.04925f, 2.12324f}},
+    {{-0.42998f, 0.88661f, 1.06638f}},
+    {{-1.09915f, 1.92444f, -0.04216f}},
+    {{0.04864f, 1.41421f, 2.12284f}},
+    {{0.82502f, 2.97776f, 0.78410f}},
+    {{-0.41537f, 1.94084f, 2.21183f}},
+    {{0.47956f, 1.59397f, -0.06949f}},
+    {{-1.53543f, 1.43948f, 2.17513f}},
+    {{1.28395f, 2.67084f, 0.70204f}},
+    {{-1.55494f, 1.48148f, 0.32287f}},
+    {{-1.28383f, 1.01241f, 1.10738f}},
+    {{-1.20701f, 2.86706f, 1.84278f}},
+    {{0.00313f, 1.05487f, 0.57554f}},
+    {{1.22032f, 1.08786f, 1.29683f}},
+    {{1.08884f, 2.84409f, 0.47957f}},
+    {{0.93420f, -0.01999f, 2.07294f}},
+    {{1.29718f, 1.44060f, 0.93192f}},
+    {{0.03904f, 1.06007f, 1.81665f}},
+    {{0.13120f, 0.85716f, 0.20366f}},
+    {{-0.12924f, 3.08265f, 1.33786f}},
+    {{-0.65917f, -0.04796f, 2.18679f}},
+    {{0.18044f, 0.63162f, 0.94082f}},
+    {{-0.85390f, 2.60466f, 1.97312f}},
+    {{-0.65427f, 0.68815f, 2.04293f}},
+    {{0.84530f, 1.83582f, 1.20535f}},
+    {{-1.04797f, 0.54072f, 1.79103f}},
+    {{0.16652f, 1.95030f, 0.01553f}},
+    {{-1.45087f, 2.17488f, 0.85860f}},
+    {{1.15581f, 1.83263f, -0.09904f}},
+    {{1.00255f, 3.17214f, 1.78679f}},
+    {{-0.47026f, 0.75325f, 2.23708f}},
+    {{-1.35324f, 1.92580f, 0.27861f}},
+    {{0.88654f, 0.60180f, 1.27931f}},
+    {{-0.34785f, 2.00406f, 0.73446f}},
+    {{-0.74327f, 2.24461f, 1.30840f}},
+    {{0.49253f, 2.41257f, 0.07934f}},
+    {{0.97494f, 0.02217f, 1.71220f}},
+    {{0.76820f, 2.23849f, 2.06127f}},
+    {{0.99344f, -0.08438f, 0.67443f}},
+    {{-0.80739f, 2.14714f, 1.02171f}},
+    {{-0.24738f, 1.10538f, 0.81705f}},
+    {{-0.39556f, 1.68109f, 0.66172f}},
+    {{-1.20942f, 1.98343f, 1.24750f}},
+    {{-0.30926f, 0.46223f, 2.23712f}},
+    {{-0.33678f, 2.17063f, 1.54325f}},
+    {{-1.00429f, 0.81757f, 0.92408f}},
+    {{-1.57000f, 1.05021f, 0.42768f}},
+    {{0.79292f, 0.00705f, 2.01200f}},
+    {{1.20462f, 2.92787f, 1.77702f}},
+    {{0.38816f, 1.63394f, 0.54850f}},
+    {{-1.55061f, 0.74543f, 0.61712f}},
+    {{0.96469f, 1.71141f, 1.16652f}},
+    {{0.97965f, 2.58724f, 0.34427f}},
+    {{0.11747f, 0.17988f, 1.65954f}},
+    {{-1.46718f, 1.63869f, 0.96514f}},
+    {{0.71265f, -0.03528f, 1.26526f}},
+    {{-1.39890f, 1.46013f, 1.84825f}},
+    {{-0.57193f, 2.03157f, 0.06370f}},
+    {{0.71855f, 1.16605f, 1.59364f}},
+    {{-1.36112f, 0.69801f, 2.25876f}},
+    {{0.83558f, 2.79805f, 1.99991f}},
+    {{-1.38063f, 2.20618f, 1.48480f}},
+    {{-0.03314f, 1.46405f, 2.06931f}},
+    {{-0.56448f, 1.49176f, 0.44010f}},
+    {{0.94107f, 1.88491f, 1.91307f}},
+    {{-0.66319f, 0.36659f, 2.09913f}},
+    {{0.02091f, 2.94728f, 1.02100f}},
+    {{-0.10125f, 1.01650f, 1.64861f}},
+    {{-1.57326f, 0.59745f, 1.11311f}},
+    {{-0.85590f, 2.15504f, 1.94401f}},
+    {{-1.43362f, 1.29309f, 0.27819f}},
+    {{0.25006f, 1.92710f, 0.46080f}},
+    {{-0.64233f, 0.24159f, 2.03724f}},
+    {{-0.05243f, 2.54775f, 1.04514f}},
+    {{0.26542f, 2.17947f, 1.20562f}},
+    {{-1.13135f, 2.09136f, 1.12487f}},
+};
+
+static const uint16_t first_edge[226] = {
+    0, 0, 10, 21, 34, 46, 62, 74, 85, 95, 110, 125, 137, 150, 168, 180,
+    191, 204, 217, 229, 242, 253, 264, 274, 285, 297, 308, 318, 328, 335, 347, 358,
+    370, 380, 391, 401, 414, 426, 436, 449, 461, 473, 483, 494, 507, 517, 528, 539,
+    549, 567, 577, 590, 602, 611, 622, 633, 647, 657, 670, 681, 692, 708, 718, 730,
+    744, 755, 767, 777, 788, 800, 812, 824, 835, 850, 862, 877, 890, 903, 913, 925,
+    937, 948, 959, 969, 990, 1001, 1011, 1024, 1038, 1052, 1062, 1073, 1085, 1095, 1105, 1115,
+    1126, 1136, 1148, 1159, 1169, 1184, 1196, 1206, 1214, 1224, 1234, 1248, 1262, 1274, 1287, 1298,
+    1309, 1320, 1330, 1343, 1357, 1367, 1377, 1386, 1397, 1408, 1418, 1434, 1444, 1455, 1466, 1477,
+    1487, 1499, 1513, 1526, 1537, 1548, 1560, 1572, 1582, 1599, 1610, 1620, 1632, 1643, 1654, 1668,
+    1679, 1689, 1704, 1714, 1724, 1734, 1744, 1755, 1766, 1776, 1787, 1797, 1808, 1818, 1828, 1842,
+    1852, 1864, 1875, 1885, 1895, 1905, 1915, 1927, 1937, 1949, 1959, 1970, 1983, 1998, 2010, 2026,
+    2039, 2053, 2063, 2073, 2084, 2096, 2111, 2123, 2135, 2149, 2159, 2171, 2181, 2191, 2204, 2215,
+    2227, 2238, 2249, 2261, 2275, 2285, 2295, 2306, 2319, 2330, 2345, 2357, 2368, 2384, 2394, 2408,
+    2418, 2428, 2442, 2457, 2467, 2478, 2488, 2500, 2512, 2526, 2538, 2548, 2563, 2576, 2588, 2600,
+    2611, 2622,
+};
+
+static const uint16_t edges[2622] = {
+    62, 72, 133, 142, 162, 165, 173, 200, 207, 213, 56, 64, 87, 90, 105, 134,
+    155, 161, 167, 177, 198, 4, 30, 58, 72, 74, 77, 139, 142, 152, 173, 207,
+    211, 223, 3, 5, 7, 10, 48, 58, 72, 74, 128, 142, 146, 223, 4, 9,
+    10, 38, 48, 72, 74, 84, 109, 128, 146, 186, 197, 209, 213, 223, 9, 35,
+    38, 41, 46, 48, 67, 102, 124, 178, 197, 209, 4, 10, 32, 58, 74, 128,
+    154, 183, 193, 222, 223, 41, 48, 49, 72, 92, 109, 146, 186, 209, 213, 5,
+    6, 10, 38, 41, 48, 67, 89, 102, 109, 124, 128, 178, 197, 209, 4, 5,
+    7, 9, 38, 48, 67, 74, 89, 102, 128, 146, 193, 222, 223, 12, 13, 50,
+    64, 66, 122, 144, 175, 177, 184, 201, 220, 11, 13, 16, 50, 66, 97, 122,
+    143, 144, 175, 177, 184, 201, 11, 12, 14, 16, 27, 31, 35, 46, 50, 55,
+    66, 82, 97, 104, 121, 143, 184, 215, 13, 16, 18, 27, 31, 50, 55, 82,
+    97, 104, 121, 215, 16, 17, 18, 19, 57, 63, 79, 87, 97, 175, 206, 12,
+    13, 14, 15, 18, 19, 27, 57, 79, 97, 121, 175, 206, 15, 19, 20, 57,
+    63, 79, 87, 101, 105, 123, 190, 206, 212, 14, 15, 16, 19, 27, 57, 60,
+    63, 79, 97, 121, 206, 15, 16, 17, 18, 20, 60, 63, 119, 121, 135, 137,
+    151, 206, 17, 19, 21, 60, 101, 119, 123, 126, 151, 180, 206, 20, 22, 23,
+    24, 99, 111, 126, 151, 158, 180, 219, 21, 23, 24, 43, 99, 111, 136, 158,
+    195, 219, 21, 22, 24, 43, 52, 99, 111, 136, 158, 195, 219, 21, 22, 23,
+    43, 52, 99, 111, 118, 136, 158, 195, 219, 59, 67, 89, 91, 102, 120, 124,
+    138, 147, 168, 215, 56, 65, 78, 86, 115, 130, 134, 181, 187, 204, 13, 14,
+    16, 18, 37, 60, 113, 119, 121, 137, 34, 52, 93, 118, 194, 199, 217, 61,
+    81, 123, 131, 136, 159, 194, 195, 199, 203, 212, 219, 3, 53, 77, 92, 139,
+    142, 148, 152, 166, 207, 211, 13, 14, 35, 46, 50, 82, 97, 104, 128, 168,
+    215, 222, 7, 36, 95, 110, 182, 183, 188, 191, 193, 224, 51, 53, 54, 70,
+    75, 76, 116, 127, 149, 156, 205, 28, 85, 93, 100, 103, 118, 141, 174, 194,
+    217, 6, 13, 31, 46, 50, 55, 82, 104, 143, 153, 168, 215, 222, 32, 58,
+    69, 108, 110, 117, 182, 189, 190, 198, 212, 220, 27, 59, 60, 113, 119, 120,
+    121, 135, 137, 176, 5, 6, 9, 10, 41, 48, 72, 84, 109, 178, 186, 197,
+    209, 62, 84, 88, 106, 122, 133, 140, 144, 153, 157, 163, 201, 44, 45, 59,
+    61, 95, 176, 183, 188, 191, 203, 210, 224, 6, 8, 9, 38, 48, 109, 178,
+    186, 197, 209, 78, 98, 114, 115, 125, 130, 164, 181, 185, 196, 204, 22, 23,
+    24, 52, 99, 111, 118, 136, 158, 195, 199, 217, 219, 40, 59, 68, 73, 80,
+    91, 120, 138, 160, 210, 40, 61, 81, 95, 176, 180, 188, 191, 203, 210, 224,
+    6, 13, 31, 35, 55, 82, 104, 143, 153, 168, 215, 65, 83, 129, 132, 145,
+    148, 166, 170, 202, 216, 4, 5, 6, 8, 9, 10, 38, 41, 49, 67, 74,
+    102, 124, 146, 178, 186, 197, 209, 8, 48, 72, 74, 77, 92, 142, 146, 186,
+    213, 11, 12, 13, 14, 31, 35, 55, 97, 106, 122, 184, 220, 222, 33, 53,
+    69, 71, 75, 76, 83, 127, 154, 156, 172, 205, 23, 24, 28, 43, 111, 118,
+    136, 195, 199, 30, 33, 51, 75, 76, 139, 152, 154, 166, 211, 216, 33, 76,
+    96, 112, 116, 127, 156, 172, 174, 205, 208, 13, 14, 35, 46, 50, 66, 82,
+    104, 106, 121, 143, 153, 163, 184, 2, 26, 86, 114, 130, 134, 162, 165, 181,
+    187, 15, 16, 17, 18, 63, 79, 87, 90, 105, 155, 175, 206, 220, 3, 4,
+    7, 36, 74, 108, 110, 128, 139, 193, 223, 25, 37, 40, 44, 68, 73, 91,
+    120, 138, 160, 171, 18, 19, 20, 27, 37, 95, 101, 113, 117, 119, 135, 137,
+    151, 182, 188, 206, 29, 40, 45, 81, 95, 131, 176, 191, 203, 224, 1, 39,
+    84, 88, 109, 122, 133, 140, 157, 165, 173, 200, 15, 17, 18, 19, 57, 79,
+    87, 101, 105, 117, 123, 190, 206, 212, 2, 11, 87, 90, 134, 144, 155, 175,
+    177, 198, 220, 26, 47, 86, 114, 115, 129, 132, 170, 181, 187, 202, 204, 11,
+    12, 13, 55, 106, 143, 153, 163, 184, 201, 6, 9, 10, 25, 48, 89, 102,
+    124, 146, 147, 209, 44, 59, 73, 80, 91, 94, 107, 120, 138, 147, 160, 171,
+    36, 51, 71, 75, 108, 110, 129, 131, 150, 189, 190, 216, 33, 80, 94, 107,
+    127, 149, 154, 156, 171, 205, 210, 218, 51, 69, 75, 83, 129, 131, 145, 150,
+    189, 194, 216, 1, 3, 4, 5, 8, 38, 49, 74, 109, 142, 173, 186, 200,
+    213, 223, 44, 59, 68, 80, 91, 94, 107, 120, 138, 160, 171, 210, 3, 4,
+    5, 7, 10, 48, 49, 58, 72, 128, 139, 142, 146, 193, 223, 33, 51, 53,
+    69, 71, 76, 83, 129, 145, 166, 172, 179, 216, 33, 51, 53, 54, 75, 83,
+    116, 156, 172, 174, 179, 205, 208, 3, 30, 49, 92, 139, 142, 152, 207, 211,
+    213, 26, 42, 98, 115, 125, 130, 164, 181, 185, 187, 196, 204, 15, 16, 17,
+    18, 57, 63, 87, 90, 97, 175, 206, 220, 44, 68, 70, 73, 91, 94, 107,
+    149, 160, 171, 218, 29, 45, 61, 131, 136, 158, 159, 195, 199, 203, 219, 13,
+    14, 31, 35, 46, 55, 104, 168, 215, 222, 47, 51, 71, 75, 76, 85, 100,
+    103, 132, 141, 145, 148, 150, 172, 174, 179, 192, 202, 214, 216, 221, 5, 38,
+    39, 62, 88, 109, 133, 157, 173, 178, 197, 34, 83, 100, 103, 112, 141, 169,
+    174, 214, 221, 26, 56, 65, 108, 114, 115, 129, 161, 167, 170, 187, 189, 204,
+    2, 15, 17, 57, 63, 64, 79, 90, 105, 155, 167, 175, 198, 220, 39, 62,
+    84, 106, 122, 133, 140, 144, 157, 163, 165, 173, 200, 201, 9, 10, 25, 67,
+    91, 102, 124, 147, 168, 215, 2, 57, 64, 79, 87, 105, 134, 155, 167, 175,
+    198, 25, 44, 59, 68, 73, 80, 89, 120, 138, 147, 160, 171, 8, 30, 49,
+    77, 139, 142, 152, 186, 211, 213, 28, 34, 96, 103, 118, 131, 159, 194, 199,
+    217, 68, 70, 73, 80, 107, 149, 160, 171, 210, 218, 32, 40, 45, 60, 61,
+    176, 183, 188, 191, 210, 224, 54, 93, 100, 112, 116, 159, 174, 205, 208, 217,
+    12, 13, 14, 15, 16, 18, 31, 50, 79, 121, 182, 220, 42, 78, 115, 125,
+    130, 164, 181, 185, 187, 196, 204, 21, 22, 23, 24, 43, 111, 136, 158, 195,
+    219, 34, 83, 85, 96, 103, 112, 141, 169, 172, 174, 179, 192, 208, 214, 221,
+    17, 20, 60, 63, 110, 117, 123, 151, 182, 190, 206, 212, 6, 9, 10, 25,
+    48, 67, 89, 124, 147, 168, 34, 83, 85, 93, 100, 141, 174, 221, 13, 14,
+    31, 35, 46, 55, 82, 168, 215, 222, 2, 17, 57, 63, 87, 90, 134, 155,
+    161, 167, 39, 50, 55, 66, 88, 122, 133, 140, 143, 153, 157, 163, 184, 201,
+    68, 70, 73, 80, 94, 138, 149, 154, 160, 171, 183, 193, 210, 218, 36, 58,
+    69, 86, 129, 134, 150, 161, 167, 170, 189, 198, 5, 8, 9, 38, 41, 62,
+    72, 84, 178, 186, 197, 209, 213, 32, 36, 58, 69, 101, 117, 182, 188, 189,
+    190, 212, 21, 22, 23, 24, 43, 52, 99, 136, 158, 195, 219, 54, 85, 96,
+    100, 116, 169, 172, 174, 208, 214, 221, 27, 37, 60, 119, 121, 126, 135, 137,
+    176, 180, 42, 56, 65, 86, 115, 125, 130, 162, 170, 181, 196, 204, 207, 26,
+    42, 65, 78, 86, 98, 114, 164, 181, 185, 187, 196, 202, 204, 33, 54, 76,
+    96, 112, 127, 156, 174, 205, 208, 36, 60, 63, 101, 110, 123, 182, 190, 206,
+    212, 24, 28, 34, 43, 52, 93, 194, 199, 217, 19, 20, 27, 37, 60, 113,
+    126, 135, 137, 151, 180, 25, 37, 44, 59, 68, 73, 91, 138, 160, 171, 183,
+    13, 14, 16, 18, 19, 27, 37, 55, 97, 113, 11, 12, 39, 50, 62, 88,
+    106, 133, 140, 144, 153, 157, 163, 177, 184, 201, 17, 20, 29, 63, 101, 117,
+    182, 190, 206, 212, 6, 9, 25, 48, 67, 89, 102, 147, 168, 178, 209, 42,
+    78, 98, 114, 130, 162, 164, 181, 185, 196, 204, 20, 21, 113, 119, 135, 137,
+    151, 158, 176, 180, 219, 33, 51, 54, 70, 116, 149, 156, 191, 205, 210, 4,
+    5, 7, 9, 10, 31, 58, 74, 193, 215, 222, 223, 47, 65, 69, 71, 75,
+    86, 108, 132, 145, 150, 161, 170, 189, 216, 26, 42, 56, 78, 98, 114, 125,
+    162, 164, 181, 185, 187, 204, 29, 61, 69, 71, 81, 93, 136, 159, 194, 203,
+    217, 47, 65, 83, 129, 145, 148, 166, 170, 192, 202, 216, 1, 39, 62, 84,
+    88, 106, 122, 140, 157, 165, 173, 200, 2, 26, 56, 64, 90, 105, 108, 155,
+    161, 165, 167, 198, 19, 37, 60, 113, 119, 126, 137, 151, 176, 180, 22, 23,
+    24, 29, 43, 52, 81, 99, 111, 131, 158, 159, 194, 195, 199, 217, 219, 19,
+    27, 37, 60, 113, 119, 126, 135, 151, 176, 180, 25, 44, 59, 68, 73, 91,
+    107, 120, 160, 171, 3, 30, 53, 58, 74, 77, 92, 142, 152, 154, 166, 211,
+    39, 62, 88, 106, 122, 133, 144, 165, 177, 200, 201, 34, 83, 85, 100, 103,
+    145, 169, 174, 202, 214, 221, 1, 3, 4, 30, 49, 72, 74, 77, 92, 139,
+    173, 200, 207, 213, 12, 13, 35, 46, 55, 66, 106, 153, 163, 184, 201, 11,
+    12, 39, 64, 88, 122, 140, 177, 184, 201, 47, 71, 75, 83, 129, 132, 141,
+    148, 150, 166, 172, 179, 192, 202, 216, 4, 5, 8, 10, 48, 49, 67, 74,
+    186, 209, 25, 67, 68, 89, 91, 102, 124, 160, 168, 171, 30, 47, 83, 132,
+    145, 166, 179, 192, 202, 216, 33, 70, 80, 94, 107, 127, 156, 205, 210, 218,
+    69, 71, 83, 108, 129, 145, 161, 170, 189, 194, 216, 19, 20, 21, 60, 101,
+    119, 126, 135, 137, 180, 206, 3, 30, 53, 77, 92, 139, 154, 166, 211, 216,
+    35, 39, 46, 55, 66, 106, 122, 143, 157, 163, 201, 7, 51, 53, 70, 107,
+    139, 152, 193, 211, 218, 2, 57, 64, 87, 90, 105, 134, 175, 177, 198, 220,
+    33, 51, 54, 70, 76, 116, 127, 149, 205, 208, 39, 62, 84, 88, 106, 122,
+    133, 153, 163, 201, 21, 22, 23, 24, 43, 81, 99, 111, 126, 136, 180, 195,
+    203, 219, 29, 81, 93, 96, 131, 136, 194, 199, 203, 217, 44, 59, 68, 73,
+    80, 91, 94, 107, 120, 138, 147, 171, 2, 86, 105, 108, 129, 134, 150, 167,
+    170, 189, 198, 1, 56, 114, 125, 130, 165, 173, 181, 200, 207, 39, 55, 66,
+    88, 106, 122, 143, 153, 157, 201, 42, 78, 98, 115, 125, 130, 185, 196, 202,
+    204, 1, 56, 62, 88, 133, 134, 140, 162, 173, 200, 30, 47, 53, 75, 132,
+    139, 145, 148, 152, 207, 211, 216, 2, 86, 87, 90, 105, 108, 134, 161, 170,
+    189, 25, 31, 35, 46, 82, 89, 102, 104, 124, 147, 215, 222, 85, 100, 112,
+    141, 172, 174, 179, 192, 214, 221, 47, 65, 86, 108, 114, 129, 132, 150, 161,
+    167, 189, 59, 68, 70, 73, 80, 91, 94, 107, 120, 138, 147, 160, 218, 51,
+    54, 75, 76, 83, 100, 112, 145, 169, 174, 179, 192, 208, 214, 221, 1, 3,
+    62, 72, 84, 88, 133, 142, 162, 165, 200, 223, 34, 54, 76, 83, 85, 96,
+    100, 103, 112, 116, 141, 169, 172, 208, 214, 221, 11, 12, 15, 16, 57, 64,
+    79, 87, 90, 155, 184, 198, 220, 37, 40, 45, 61, 95, 113, 126, 135, 137,
+    180, 191, 203, 210, 224, 2, 11, 12, 64, 122, 140, 144, 155, 184, 201, 6,
+    9, 38, 41, 48, 84, 109, 124, 197, 209, 75, 76, 83, 100, 145, 148, 169,
+    172, 192, 214, 221, 20, 21, 45, 113, 119, 126, 135, 137, 151, 158, 176, 219,
+    26, 42, 56, 65, 78, 98, 114, 115, 125, 130, 162, 185, 187, 204, 207, 32,
+    36, 60, 97, 101, 110, 117, 123, 188, 190, 212, 220, 7, 32, 40, 95, 107,
+    120, 188, 191, 193, 210, 218, 224, 11, 12, 13, 50, 55, 66, 106, 122, 143,
+    144, 175, 177, 201, 220, 42, 78, 98, 115, 125, 130, 164, 181, 196, 204, 5,
+    8, 38, 41, 48, 49, 72, 92, 109, 146, 209, 213, 26, 56, 65, 78, 86,
+    98, 115, 130, 181, 204, 32, 40, 45, 60, 95, 110, 182, 183, 191, 224, 36,
+    69, 71, 86, 108, 110, 129, 150, 161, 167, 170, 190, 212, 17, 36, 63, 69,
+    101, 110, 117, 123, 182, 189, 212, 32, 40, 45, 61, 95, 127, 176, 183, 188,
+    203, 210, 224, 83, 100, 132, 145, 148, 169, 172, 179, 202, 214, 221, 7, 10,
+    32, 58, 74, 107, 128, 154, 183, 218, 222, 28, 29, 34, 71, 93, 118, 131,
+    136, 150, 159, 199, 217, 22, 23, 24, 29, 43, 52, 81, 99, 111, 136, 158,
+    199, 217, 219, 42, 78, 98, 114, 115, 125, 164, 185, 202, 204, 5, 6, 9,
+    38, 41, 48, 84, 109, 178, 209, 2, 36, 64, 87, 90, 108, 134, 155, 161,
+    175, 220, 28, 29, 43, 52, 81, 93, 118, 136, 159, 194, 195, 217, 219, 1,
+    62, 72, 88, 133, 140, 142, 162, 165, 173, 207, 11, 12, 39, 66, 88, 106,
+    122, 140, 143, 144, 153, 157, 163, 177, 184, 47, 65, 83, 115, 132, 141, 145,
+    148, 164, 192, 196, 204, 29, 40, 45, 61, 81, 131, 158, 159, 176, 191, 224,
+    26, 42, 65, 78, 86, 98, 114, 115, 125, 130, 164, 181, 185, 187, 196, 202,
+    33, 51, 54, 70, 76, 96, 116, 127, 149, 156, 15, 16, 17, 18, 19, 20,
+    57, 60, 63, 79, 101, 117, 123, 151, 1, 3, 30, 77, 114, 142, 162, 166,
+    181, 200, 54, 76, 96, 100, 112, 116, 156, 172, 174, 214, 5, 6, 8, 9,
+    38, 41, 48, 67, 109, 124, 146, 178, 186, 197, 40, 44, 45, 70, 73, 94,
+    95, 107, 127, 149, 176, 183, 191, 218, 224, 3, 30, 53, 77, 92, 139, 152,
+    154, 166, 216, 17, 29, 36, 63, 101, 110, 117, 123, 182, 189, 190, 1, 5,
+    8, 49, 72, 77, 92, 109, 142, 186, 83, 85, 100, 112, 141, 169, 172, 174,
+    179, 192, 208, 221, 13, 14, 25, 31, 35, 46, 82, 89, 104, 128, 168, 222,
+    47, 53, 69, 71, 75, 83, 129, 132, 145, 148, 150, 152, 166, 211, 28, 34,
+    43, 93, 96, 118, 131, 136, 159, 194, 195, 199, 70, 80, 94, 107, 149, 154,
+    171, 183, 193, 210, 21, 22, 23, 24, 29, 43, 81, 99, 111, 126, 136, 158,
+    180, 195, 199, 11, 36, 50, 57, 64, 79, 87, 97, 155, 175, 182, 184, 198,
+    83, 85, 100, 103, 112, 141, 169, 172, 174, 179, 192, 214, 7, 10, 31, 35,
+    50, 82, 104, 128, 168, 193, 215, 223, 3, 4, 5, 7, 10, 58, 72, 74,
+    128, 173, 222, 32, 40, 45, 61, 95, 176, 183, 188, 191, 203, 210,
+};
+
+const Roadmap arm_roadmap = {nodes, 225, first_edge, edges};
+} // namespace manipulator
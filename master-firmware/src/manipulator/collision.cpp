@@ -0,0 +1,188 @@
+#include "manipulator/collision.h"
+
+#include <math.h>
+
+namespace manipulator {
+void arm_links(const ArmLengths& lengths, const Angles& angles, Segment* links)
+{
+    float x = 0, y = 0, heading = 0;
+
+    for (size_t i = 0; i < 3; i++) {
+        heading += angles[i];
+        links[i].x1 = x;
+        links[i].y1 = y;
+        x += lengths[i] * cosf(heading);
+        y += lengths[i] * sinf(heading);
+        links[i].x2 = x;
+        links[i].y2 = y;
+    }
+}
+
+static float point_segment_distance(float px, float py, const Segment& s)
+{
+    const float dx = s.x2 - s.x1;
+    const float dy = s.y2 - s.y1;
+    const float length_sq = dx * dx + dy * dy;
+
+    float t = 0;
+    if (length_sq > 0) {
+        t = ((px - s.x1) * dx + (py - s.y1) * dy) / length_sq;
+        t = fminf(fmaxf(t, 0.f), 1.f);
+    }
+
+    return hypotf(px - (s.x1 + t * dx), py - (s.y1 + t * dy));
+}
+
+static float cross(float ax, float ay, float bx, float by)
+{
+    return ax * by - ay * bx;
+}
+
+static bool segments_intersect(const Segment& a, const Segment& b)
+{
+    const float d1 = cross(a.x2 - a.x1, a.y2 - a.y1, b.x1 - a.x1, b.y1 - a.y1);
+    const float d2 = cross(a.x2 - a.x1, a.y2 - a.y1, b.x2 - a.x1, b.y2 - a.y1);
+    const float d3 = cross(b.x2 - b.x1, b.y2 - b.y1, a.x1 - b.x1, a.y1 - b.y1);
+    const float d4 = cross(b.x2 - b.x1, b.y2 - b.y1, a.x2 - b.x1, a.y2 - b.y1);
+
+    return d1 * d2 < 0 && d3 * d4 < 0;
+}
+
+float segment_distance(const Segment& a, const Segment& b)
+{
+    if (segments_intersect(a, b)) {
+        return 0;
+    }
+
+    /* Otherwise the closest points include an end of one of the segments */
+    return fminf(fminf(point_segment_distance(a.x1, a.y1, b), point_segment_distance(a.x2, a.y2, b)),
+                 fminf(point_segment_distance(b.x1, b.y1, a), point_segment_distance(b.x2, b.y2, a)));
+}
+
+float segment_box_distance(const Segment& s, const Box& box)
+{
+    auto inside = [&box](float x, float y) {
+        return x >= box.x_min && x <= box.x_max && y >= box.y_min && y <= box.y_max;
+    };
+
+    if (inside(s.x1, s.y1) || inside(s.x2, s.y2)) {
+        return 0;
+    }
+
+    const Segment sides[4] = {
+        {box.x_min, box.y_min, box.x_max, box.y_min},
+        {box.x_max, box.y_min, box.x_max, box.y_max},
+        {box.x_max, box.y_max, box.x_min, box.y_max},
+        {box.x_min, box.y_max, box.x_min, box.y_min},
+    };
+
+    float distance = INFINITY;
+    for (const auto& side : sides) {
+        distance = fminf(distance, segment_distance(s, side));
+    }
+    return distance;
+}
+
+bool arm_collides(const ArmWorkspace& workspace, const Angles& angles)
+{
+    for (size_t i = 0; i < 3; i++) {
+        if (angles[i] < workspace.min_angles[i] || angles[i] > workspace.max_angles[i]) {
+            return true;
+        }
+    }
+
+    /* The links are stacked on top of each other and cannot collide */
+    Segment links[3];
+    arm_links(workspace.lengths, angles, links);
+
+    for (size_t i = 0; i < workspace.body_count; i++) {
+        /* The shoulder is mounted on the body, so the first link may touch it */
+        for (size_t link = 1; link < 3; link++) {
+            if (segment_box_distance(links[link], workspace.body[i]) < workspace.link_radius) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool arms_collide(const ArmWorkspace& workspace, const Angles& angles, const Angles& other)
+{
+    Segment links[3], other_links[3];
+    arm_links(workspace.lengths, angles, links);
+    arm_links(workspace.lengths, other, other_links);
+
+    for (auto& link : other_links) {
+        link.y1 = -workspace.shoulder_distance - link.y1;
+        link.y2 = -workspace.shoulder_distance - link.y2;
+    }
+
+    for (const auto& link : links) {
+        for (const auto& other_link : other_links) {
+            if (segment_distance(link, other_link) < 2 * workspace.link_radius) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool move_is_free(const ArmWorkspace& workspace, const Angles& from, const Angles& to, const Angles* other)
+{
+    float largest_step = 0;
+    for (size_t i = 0; i < 3; i++) {
+        largest_step = fmaxf(largest_step, fabsf(to[i] - from[i]));
+    }
+    const int steps = ceilf(largest_step / workspace.resolution);
+
+    for (int step = 0; step <= steps; step++) {
+        const float t = steps > 0 ? static_cast<float>(step) / steps : 1.f;
+        Angles angles;
+        for (size_t i = 0; i < 3; i++) {
+            angles[i] = from[i] + t * (to[i] - from[i]);
+        }
+
+        if (arm_collides(workspace, angles)) {
+            return false;
+        }
+        if (other && arms_collide(workspace, angles, *other)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool trajectory_is_free(const ArmWorkspace& workspace, const JointTrajectory& trajectory, const Angles& other, float step)
+{
+    for (float t = 0; t < trajectory.duration() + step; t += step) {
+        const Angles angles = trajectory.sample(t).position;
+        if (arm_collides(workspace, angles) || arms_collide(workspace, angles, other)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool trajectories_are_free(const ArmWorkspace& workspace,
+                           const JointTrajectory& trajectory,
+                           const JointTrajectory& other,
+                           float step)
+{
+    const float duration = fmaxf(trajectory.duration(), other.duration());
+
+    for (float t = 0; t < duration + step; t += step) {
+        const Angles angles = trajectory.sample(t).position;
+        const Angles other_angles = other.sample(t).position;
+        if (arm_collides(workspace, angles) || arm_collides(workspace, other_angles)
+            || arms_collide(workspace, angles, other_angles)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace manipulator
@@ -0,0 +1,68 @@
+#ifndef MANIPULATOR_COLLISION_H
+#define MANIPULATOR_COLLISION_H
+
+#include <cstddef>
+
+#include "manipulator/kinematics.h"
+#include "manipulator/joint_trajectory.h"
+
+namespace manipulator {
+struct Segment {
+    float x1, y1;
+    float x2, y2;
+};
+
+// Axis aligned box the arm must stay out of, in the frame of the arm
+struct Box {
+    float x_min, x_max;
+    float y_min, y_max;
+};
+
+// Geometry of the two arms and of the robot around them
+//
+// Both arms use the same frame convention mirrored about the robot axis: the
+// shoulder of the other arm is at (0, -shoulder_distance), and a point (x, y)
+// in its frame is at (x, -shoulder_distance - y) in ours.
+struct ArmWorkspace {
+    ArmLengths lengths;
+    float link_radius;
+    float shoulder_distance;
+
+    const Box* body;
+    size_t body_count;
+
+    // Region of the joint space the arm is allowed to move in
+    Angles min_angles, max_angles;
+
+    // Largest joint step between two checked configurations of a move
+    float resolution;
+};
+
+// Positions of the three links of the arm, as computed by forward kinematics
+void arm_links(const ArmLengths& lengths, const Angles& angles, Segment* links);
+
+float segment_distance(const Segment& a, const Segment& b);
+float segment_box_distance(const Segment& s, const Box& box);
+
+// Collisions of the arm with the robot body or its joint limits
+bool arm_collides(const ArmWorkspace& workspace, const Angles& angles);
+
+// Collisions between both arms, given the angles of each in its own frame
+bool arms_collide(const ArmWorkspace& workspace, const Angles& angles, const Angles& other);
+
+// Checks a straight move in joint space, at the workspace resolution, against
+// the body and optionally against the other arm standing still
+bool move_is_free(const ArmWorkspace& workspace, const Angles& from, const Angles& to, const Angles* other);
+
+// Checks the trajectory executed by the arm, blends included, sampled every
+// step seconds, against the body and the other arm standing still
+bool trajectory_is_free(const ArmWorkspace& workspace, const JointTrajectory& trajectory, const Angles& other, float step);
+
+// Checks the trajectories of both arms executed at the same time
+bool trajectories_are_free(const ArmWorkspace& workspace,
+                           const JointTrajectory& trajectory,
+                           const JointTrajectory& other,
+                           float step);
+} // namespace manipulator
+
+#endif /* MANIPULATOR_COLLISION_H */
@@ -34,4 +34,19 @@ void System::apply_input(const Angles& angles)
     last_raw = angles;
     last = target;
 }
+
+void System::apply_trajectory(const TrajectorySample& sample)
+{
+    Angles target;
+
+    for (size_t i = 0; i < 3; i++) {
+        target[i] = directions[i] * (sample.position[i] + offsets[i]);
+        motor_manager_set_trajectory(&motor_manager, motors[i], target[i],
+                                     directions[i] * sample.velocity[i],
+                                     directions[i] * sample.acceleration[i]);
+    }
+
+    last_raw = sample.position;
+    last = target;
+}
 } // namespace manipulator
@@ -2,6 +2,7 @@
 #define MANIPULATOR_SYSTEM_H
 
 #include "manipulator/kinematics.h"
+#include "manipulator/joint_trajectory.h"
 
 #include <golem/system.h>
 
@@ -24,6 +25,7 @@ struct System : public golem::System<System, Angles, Angles> {
 
     Angles measure_feedback() const;
     void apply_input(const Angles& angles);
+    void apply_trajectory(const TrajectorySample& sample);
 };
 } // namespace manipulator
 
@@ -0,0 +1,158 @@
+#include "manipulator/joint_trajectory.h"
+
+#include <math.h>
+
+/* Each try stretches the segments where two velocity changes overlap */
+#define JOINT_TRAJECTORY_MAX_TRIES 200
+#define JOINT_TRAJECTORY_STRETCH 1.1f
+
+namespace manipulator {
+JointTrajectory::JointTrajectory()
+    : count(0)
+    , total_duration(0)
+{
+}
+
+void JointTrajectory::compute_profile(size_t joint, const float* segment_durations, const Angles& max_acceleration)
+{
+    velocities[0][joint] = 0;
+    for (size_t k = 0; k + 1 < count; k++) {
+        velocities[k + 1][joint] = (points[k + 1][joint] - points[k][joint]) / segment_durations[k];
+    }
+    velocities[count][joint] = 0;
+
+    for (size_t k = 0; k < count; k++) {
+        blends[k][joint] = fabsf(velocities[k + 1][joint] - velocities[k][joint]) / max_acceleration[joint];
+    }
+}
+
+bool JointTrajectory::plan(const Angles* waypoints,
+                           size_t count,
+                           const Angles& max_velocity,
+                           const Angles& max_acceleration)
+{
+    if (count == 0 || count > MaxPoints) {
+        return false;
+    }
+    for (size_t j = 0; j < 3; j++) {
+        if (!(max_velocity[j] > 0) || !(max_acceleration[j] > 0)) {
+            return false;
+        }
+    }
+
+    this->count = count;
+    for (size_t k = 0; k < count; k++) {
+        points[k] = waypoints[k];
+    }
+
+    /* Start from the fastest each joint could do the segment on its own,
+     * either at full speed or accelerating then braking. */
+    float segment_durations[MaxPoints];
+    for (size_t k = 0; k + 1 < count; k++) {
+        segment_durations[k] = 1e-3f;
+        for (size_t j = 0; j < 3; j++) {
+            float delta = fabsf(points[k + 1][j] - points[k][j]);
+            segment_durations[k] = fmaxf(segment_durations[k], delta / max_velocity[j]);
+            segment_durations[k] = fmaxf(segment_durations[k], sqrtf(delta / max_acceleration[j]));
+        }
+    }
+
+    for (int tries = 0; tries < JOINT_TRAJECTORY_MAX_TRIES; tries++) {
+        for (size_t j = 0; j < 3; j++) {
+            compute_profile(j, segment_durations, max_acceleration);
+        }
+
+        bool overlap = false;
+        for (size_t k = 0; k + 1 < count; k++) {
+            for (size_t j = 0; j < 3; j++) {
+                if ((blends[k][j] + blends[k + 1][j]) / 2 > segment_durations[k] * 1.0001f) {
+                    segment_durations[k] *= JOINT_TRAJECTORY_STRETCH;
+                    overlap = true;
+                    break;
+                }
+            }
+        }
+
+        if (!overlap) {
+            break;
+        }
+    }
+
+    /* Joints share the time of each waypoint, the first one is passed once
+     * the slowest joint has finished accelerating towards it. */
+    times[0] = 0;
+    for (size_t j = 0; j < 3; j++) {
+        times[0] = fmaxf(times[0], blends[0][j] / 2);
+    }
+    for (size_t k = 0; k + 1 < count; k++) {
+        times[k + 1] = times[k] + segment_durations[k];
+    }
+
+    float braking = 0;
+    for (size_t j = 0; j < 3; j++) {
+        braking = fmaxf(braking, blends[count - 1][j] / 2);
+    }
+    total_duration = times[count - 1] + braking;
+
+    return true;
+}
+
+float JointTrajectory::duration() const
+{
+    return total_duration;
+}
+
+float JointTrajectory::line_position(size_t joint, float time) const
+{
+    if (time <= times[0]) {
+        return points[0][joint];
+    }
+    for (size_t k = 0; k + 1 < count; k++) {
+        if (time < times[k + 1]) {
+            return points[k][joint] + velocities[k + 1][joint] * (time - times[k]);
+        }
+    }
+    return points[count - 1][joint];
+}
+
+TrajectorySample JointTrajectory::sample(float time) const
+{
+    TrajectorySample s;
+
+    if (count == 0) {
+        s.position = s.velocity = s.acceleration = {{0.f, 0.f, 0.f}};
+        return s;
+    }
+
+    for (size_t j = 0; j < 3; j++) {
+        s.position[j] = line_position(j, time);
+        s.velocity[j] = 0;
+        s.acceleration[j] = 0;
+
+        for (size_t k = 0; k < count; k++) {
+            if (time < times[k]) {
+                s.velocity[j] = velocities[k][j];
+                break;
+            }
+        }
+
+        /* Parabolic blends replace the lines around waypoints */
+        for (size_t k = 0; k < count; k++) {
+            const float blend = blends[k][j];
+            const float start = times[k] - blend / 2;
+            if (blend > 0 && time > start && time < start + blend) {
+                const float v_in = velocities[k][j];
+                const float acc = (velocities[k + 1][j] - v_in) / blend;
+                const float tau = time - start;
+
+                s.position[j] = line_position(j, start) + v_in * tau + acc * tau * tau / 2;
+                s.velocity[j] = v_in + acc * tau;
+                s.acceleration[j] = acc;
+                break;
+            }
+        }
+    }
+
+    return s;
+}
+} // namespace manipulator
@@ -0,0 +1,67 @@
+#ifndef MANIPULATOR_JOINT_TRAJECTORY_H
+#define MANIPULATOR_JOINT_TRAJECTORY_H
+
+#include <cstddef>
+
+#include "manipulator/kinematics.h"
+
+namespace manipulator {
+struct TrajectorySample {
+    Angles position;
+    Angles velocity;
+    Angles acceleration;
+};
+
+/** Joint space trajectory through a list of waypoints.
+ *
+ * All joints share the time at which they pass each waypoint and move along
+ * straight lines between them at constant velocity. Around each waypoint the
+ * velocity changes at the maximal acceleration of the joint, so the arm does
+ * not stop at intermediate waypoints but goes near them. It starts from rest
+ * at the first waypoint and stops at the last one.
+ */
+class JointTrajectory {
+public:
+    static const size_t MaxPoints = 32;
+
+    JointTrajectory();
+
+    /** Plans a trajectory through the given waypoints, within the velocity
+     * and acceleration limits of each joint.
+     *
+     * @returns false if there are no or too many waypoints, or if a limit is
+     * not strictly positive.
+     */
+    bool plan(const Angles* waypoints,
+              size_t count,
+              const Angles& max_velocity,
+              const Angles& max_acceleration);
+
+    /** Total time taken by the trajectory, in seconds. */
+    float duration() const;
+
+    /** Setpoints at the given time since the start of the trajectory, the
+     * arm stays at the endpoints outside of it. */
+    TrajectorySample sample(float time) const;
+
+private:
+    size_t count;
+    Angles points[MaxPoints];
+
+    /* Time at which the straight lines pass each waypoint */
+    float times[MaxPoints];
+
+    /* Velocity on the line going into each waypoint, the first one is 0 */
+    Angles velocities[MaxPoints + 1];
+
+    /* Duration of the velocity change centered on each waypoint */
+    Angles blends[MaxPoints];
+
+    float total_duration;
+
+    void compute_profile(size_t joint, const float* segment_durations, const Angles& max_acceleration);
+    float line_position(size_t joint, float time) const;
+};
+} // namespace manipulator
+
+#endif /* MANIPULATOR_JOINT_TRAJECTORY_H */
@@ -47,6 +47,36 @@ Angles inverse_kinematics(const ArmLengths& lengths, const Pose2D& pose)
     return angles;
 }
 
+size_t inverse_kinematics(const ArmLengths& lengths, size_t count, const PoseBatch& poses, AnglesBatch& angles)
+{
+    const size_t chunk = 32;
+    float wrist_x[chunk], wrist_y[chunk];
+    shoulder_mode_t modes[chunk];
+    size_t reachable_count = 0;
+
+    for (size_t start = 0; start < count; start += chunk) {
+        const size_t n = count - start < chunk ? count - start : chunk;
+
+        for (size_t i = 0; i < n; i++) {
+            wrist_x[i] = poses.x[start + i] - lengths[2] * cosf(poses.heading[start + i]);
+            wrist_y[i] = poses.y[start + i] - lengths[2] * sinf(poses.heading[start + i]);
+            modes[i] = wrist_y[i] < 0 ? SHOULDER_BACK : SHOULDER_FRONT;
+        }
+
+        reachable_count += scara_compute_joint_angles_batch(n, wrist_x, wrist_y, modes, lengths.data(),
+                                                            &angles.q1[start], &angles.q2[start],
+                                                            &angles.reachable[start]);
+
+        for (size_t i = start; i < start + n; i++) {
+            if (angles.reachable[i]) {
+                angles.q3[i] = poses.heading[i] - (angles.q1[i] + angles.q2[i]);
+            }
+        }
+    }
+
+    return reachable_count;
+}
+
 Angles axes_couple(const Angles& decoupled)
 {
     Angles coupled;
@@ -2,6 +2,7 @@
 #define MANIPULATOR_KINEMATICS_H
 
 #include <array>
+#include <cstddef>
 
 namespace manipulator {
 using Angles = std::array<float, 3>;
@@ -17,6 +18,23 @@ Pose2D operator-(const Pose2D& lhs, const Pose2D& rhs);
 Pose2D forward_kinematics(const ArmLengths& lengths, const Angles& angles);
 Angles inverse_kinematics(const ArmLengths& lengths, const Pose2D& pose);
 
+// Many poses or angles at once, stored as one array per coordinate
+struct PoseBatch {
+    const float* x;
+    const float* y;
+    const float* heading;
+};
+struct AnglesBatch {
+    float* q1;
+    float* q2;
+    float* q3;
+    bool* reachable;
+};
+
+// Solves the inverse kinematics of count poses, returns how many are reachable
+// The angles of unreachable poses are left untouched
+size_t inverse_kinematics(const ArmLengths& lengths, size_t count, const PoseBatch& poses, AnglesBatch& angles);
+
 // Transform back and forth from coupled/decoupled axes
 // Coupled: standard pendulum where we sum angles explicitly [th1, th1 + th2, th1 + th2 + th3]
 // Decoupled: every link has its axes set independently, no sum required
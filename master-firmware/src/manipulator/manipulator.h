@@ -3,6 +3,7 @@
 
 #include "manipulator/controller.h"
 #include "manipulator/hw.h"
+#include "manipulator/joint_trajectory.h"
 #include "manipulator/state_estimator.h"
 #include "manipulator/gripper.h"
 #include "manipulator/path.h"
@@ -18,6 +19,10 @@ struct Point {
         : angles{a, b, c}
     {
     }
+    explicit Point(const float* a)
+        : angles{a[0], a[1], a[2]}
+    {
+    }
 };
 
 template <class LockGuard>
@@ -27,37 +32,63 @@ public:
     manipulator::StateEstimator estimator;
     manipulator::Controller ctrl;
     manipulator::Angles target_tolerance, target_near_window;
+    manipulator::Angles max_velocity = {{0.f, 0.f, 0.f}};
+    manipulator::Angles max_acceleration = {{0.f, 0.f, 0.f}};
     void* mutex;
 
     pathfinding::Node<Point> nodes[MANIPULATOR_COUNT] = {
-        /* MANIPULATOR_INIT */ {{0, 0, 0}},
-        /* MANIPULATOR_DEPLOY_FULLY */ {{1.2705, 1.5002, 1.4614}},
-        /* MANIPULATOR_PICK_HORZ */ {{0.57912659, 1.13070901, 0.0}},
-        /* MANIPULATOR_PICK_VERT */ {{0.35136038, 1.66511662, 1.57079633}},
-        /* MANIPULATOR_LIFT_VERT */ {{0.35136038, 2.16511662, 1.57079633}},
-        /* MANIPULATOR_PICK_GOLDONIUM */ {{0.59695668, 2.36765084, 1.57079633}},
-        /* MANIPULATOR_LIFT_GOLDONIUM */ {{0.59695668, 3.14, 1.57079633}},
-        /* MANIPULATOR_SCALE_INTERMEDIATE */ {{-0.1901, 2.1626, 1.57}},
-        /* MANIPULATOR_SCALE */ {{0.8674, 2.1626, 2.1580}},
-        /* MANIPULATOR_PUT_ACCELERATOR*/ {{0.5522, 2.8653, 1.5605}},
-        /* MANIPULATOR_PUT_ACCELERATOR_DOWN*/ {{0.2617, 2.4874, 1.6114}},
-        /* MANIPULATOR_STORE_FRONT_0 */ {{0.55592904, 2.29990897, 0}},
-        /* MANIPULATOR_STORE_FRONT_1 */ {{0.44061324, 2.40559601, 0}},
-        /* MANIPULATOR_STORE_FRONT_2*/ {{0.15942326, 2.76071548, 0.35511947}},
-        /* MANIPULATOR_STORE_FRONT_STORE*/ {{-0.14048151, 2.77174001, 0.366144}},
-        /* MANIPULATOR_STORE_FRONT_HIGH */ {{-0.35403161, 2.01076878, 0}},
-        /* MANIPULATOR_STORE_FRONT_HIGH_1 */ {{-0.18604025, 2.38740067, 0}},
-        /* MANIPULATOR_STORE_FRONT_LOW */ {{-0.4226222, 1.70403752, 0}},
-        /* MANIPULATOR_STORE_BACK_1 */ {{-0.44061324, 2.40559601, 0}},
-        /* MANIPULATOR_STORE_BACK_2*/ {{-0.69523267, 2.15951152, 0}},
-        /* MANIPULATOR_STORE_BACK_3*/ {{-0.98944966, 1.83134011, 0}},
-        /* MANIPULATOR_STORE_BACK_4*/ {{-1.2671543, 1.48789401, 0}},
-        /* MANIPULATOR_STORE_BACK_STORE*/ {{-1.49246682, 1.17753052, 0}},
-        /* MANIPULATOR_STORE_BACK_HIGH */ {{-1.29581933, 1.06898106, 0}},
-        /* MANIPULATOR_STORE_BACK_LOW */ {{-1.1675452, 0.95911452, 0}},
+        {Point(manipulator_state_angles[MANIPULATOR_INIT])},
+        {Point(manipulator_state_angles[MANIPULATOR_DEPLOY_FULLY])},
+        {Point(manipulator_state_angles[MANIPULATOR_PICK_HORZ])},
+        {Point(manipulator_state_angles[MANIPULATOR_PICK_VERT])},
+        {Point(manipulator_state_angles[MANIPULATOR_LIFT_VERT])},
+        {Point(manipulator_state_angles[MANIPULATOR_PICK_GOLDONIUM])},
+        {Point(manipulator_state_angles[MANIPULATOR_LIFT_GOLDONIUM])},
+        {Point(manipulator_state_angles[MANIPULATOR_SCALE_INTERMEDIATE])},
+        {Point(manipulator_state_angles[MANIPULATOR_SCALE])},
+        {Point(manipulator_state_angles[MANIPULATOR_PUT_ACCELERATOR])},
+        {Point(manipulator_state_angles[MANIPULATOR_PUT_ACCELERATOR_DOWN])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_0])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_1])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_2])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_STORE])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_HIGH])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_HIGH_1])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_FRONT_LOW])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_1])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_2])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_3])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_4])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_STORE])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_HIGH])},
+        {Point(manipulator_state_angles[MANIPULATOR_STORE_BACK_LOW])},
     };
     manipulator_state_t state;
 
+    /** Shortest moves between any two states, the graph never changes */
+    pathfinding::NextHopTable<MANIPULATOR_COUNT> routes;
+
+private:
+    /* Moves are weighted by their distance in joint space, so that the
+     * shortest paths are also the shortest moves. */
+    float joint_distance(manipulator_state_t a, manipulator_state_t b) const
+    {
+        float sum = 0;
+        for (size_t i = 0; i < 3; i++) {
+            float delta = nodes[a].data.angles[i] - nodes[b].data.angles[i];
+            sum += delta * delta;
+        }
+        return sqrtf(sum);
+    }
+    void connect(manipulator_state_t from, manipulator_state_t to)
+    {
+        nodes[from].connect(nodes[to], joint_distance(from, to));
+    }
+    void connect_bidirectional(manipulator_state_t a, manipulator_state_t b)
+    {
+        pathfinding::connect_bidirectional(nodes[a], nodes[b], joint_distance(a, b));
+    }
+
 public:
     manipulator::Gripper gripper;
 
@@ -73,40 +104,42 @@ public:
         , gripper(pumps)
     {
         // from initial position, we can only retract
-        nodes[MANIPULATOR_INIT].connect(nodes[MANIPULATOR_STORE_FRONT_0]);
+        connect(MANIPULATOR_INIT, MANIPULATOR_STORE_FRONT_0);
         //pick Horz
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_PICK_HORZ]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_PICK_HORZ);
         //deploy fully (remove later)
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_DEPLOY_FULLY]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_DEPLOY_FULLY);
         //stock and mixed with things..
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_PICK_VERT]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_PICK_VERT], nodes[MANIPULATOR_LIFT_VERT]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_PICK_VERT);
+        connect_bidirectional(MANIPULATOR_PICK_VERT, MANIPULATOR_LIFT_VERT);
         //stock front
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_STORE_FRONT_1]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_1], nodes[MANIPULATOR_STORE_FRONT_2]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_2], nodes[MANIPULATOR_STORE_FRONT_STORE]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_STORE_FRONT_1);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_1, MANIPULATOR_STORE_FRONT_2);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_2, MANIPULATOR_STORE_FRONT_STORE);
         //stock picking front
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_STORE], nodes[MANIPULATOR_STORE_FRONT_HIGH_1]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_HIGH_1], nodes[MANIPULATOR_STORE_FRONT_HIGH]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_HIGH], nodes[MANIPULATOR_STORE_FRONT_LOW]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_STORE, MANIPULATOR_STORE_FRONT_HIGH_1);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_HIGH_1, MANIPULATOR_STORE_FRONT_HIGH);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_HIGH, MANIPULATOR_STORE_FRONT_LOW);
         //stock back
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_STORE], nodes[MANIPULATOR_STORE_BACK_1]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_1], nodes[MANIPULATOR_STORE_BACK_2]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_2], nodes[MANIPULATOR_STORE_BACK_3]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_3], nodes[MANIPULATOR_STORE_BACK_4]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_4], nodes[MANIPULATOR_STORE_BACK_STORE]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_STORE, MANIPULATOR_STORE_BACK_1);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_1, MANIPULATOR_STORE_BACK_2);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_2, MANIPULATOR_STORE_BACK_3);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_3, MANIPULATOR_STORE_BACK_4);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_4, MANIPULATOR_STORE_BACK_STORE);
         //stock picking front
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_STORE], nodes[MANIPULATOR_STORE_BACK_HIGH]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_BACK_HIGH], nodes[MANIPULATOR_STORE_BACK_LOW]);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_STORE, MANIPULATOR_STORE_BACK_HIGH);
+        connect_bidirectional(MANIPULATOR_STORE_BACK_HIGH, MANIPULATOR_STORE_BACK_LOW);
         //put puck in scale
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_SCALE_INTERMEDIATE]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_SCALE_INTERMEDIATE], nodes[MANIPULATOR_SCALE]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_SCALE_INTERMEDIATE);
+        connect_bidirectional(MANIPULATOR_SCALE_INTERMEDIATE, MANIPULATOR_SCALE);
         //put puck in accelerator
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_PUT_ACCELERATOR]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_PUT_ACCELERATOR], nodes[MANIPULATOR_PUT_ACCELERATOR_DOWN]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_PUT_ACCELERATOR);
+        connect_bidirectional(MANIPULATOR_PUT_ACCELERATOR, MANIPULATOR_PUT_ACCELERATOR_DOWN);
         //Take Goldonium
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_STORE_FRONT_0], nodes[MANIPULATOR_PICK_GOLDONIUM]);
-        pathfinding::connect_bidirectional(nodes[MANIPULATOR_PICK_GOLDONIUM], nodes[MANIPULATOR_LIFT_GOLDONIUM]);
+        connect_bidirectional(MANIPULATOR_STORE_FRONT_0, MANIPULATOR_PICK_GOLDONIUM);
+        connect_bidirectional(MANIPULATOR_PICK_GOLDONIUM, MANIPULATOR_LIFT_GOLDONIUM);
+
+        routes.compute(nodes);
     }
 
     void set_lengths(const std::array<float, 3>& link_lengths)
@@ -135,6 +168,12 @@ public:
         LockGuard lock(mutex);
         target_near_window = tolerances;
     }
+    void set_limits(const Angles& velocity, const Angles& acceleration)
+    {
+        LockGuard lock(mutex);
+        max_velocity = velocity;
+        max_acceleration = acceleration;
+    }
 
     Pose2D update(void)
     {
@@ -152,6 +191,16 @@ public:
         LockGuard lock(mutex);
         return sys.apply(angles);
     }
+    bool plan(JointTrajectory& trajectory, const Angles* waypoints, size_t count) const
+    {
+        LockGuard lock(mutex);
+        return trajectory.plan(waypoints, count, max_velocity, max_acceleration);
+    }
+    void apply(const TrajectorySample& sample)
+    {
+        LockGuard lock(mutex);
+        sys.apply_trajectory(sample);
+    }
 
     Angles angles(void) const
     {
@@ -9,10 +9,11 @@
 #include "priorities.h"
 #include "main.h"
 #include "config.h"
+#include "can/motor_driver_uavcan.hpp"
 
 #include "manipulator/manipulator.h"
 #include "manipulator/manipulator_thread.h"
-#include "dijkstra.hpp"
+#include "manipulator/roadmap.h"
 
 #include "protobuf/manipulator.pb.h"
 
@@ -22,6 +23,9 @@
 #define MANIPULATOR_THREAD_STACKSIZE 2048
 #define MANIPULATOR_TRAJECTORY_THREAD_STACKSIZE 1024
 
+/* Time step when checking that both arms can move at the same time */
+#define MANIPULATOR_COLLISION_CHECK_STEP 0.02f
+
 using manipulator::Angles;
 using manipulator::ArmLengths;
 using manipulator::Pose2D;
@@ -67,15 +71,116 @@ void manipulator_angles(manipulator_side_t side, float* angles)
     }
 }
 
+/* A trajectory streamed to an arm by the trajectory thread, which signals
+ * done once the arm has settled at its end. */
+struct ArmMotion {
+    manipulator::Manipulator<ManipulatorLockGuard>* arm;
+    manipulator::JointTrajectory trajectory;
+    systime_t start;
+    bool running;
+    bool settling;
+    binary_semaphore_t done;
+
+    explicit ArmMotion(manipulator::Manipulator<ManipulatorLockGuard>* a)
+        : arm(a)
+        , start(0)
+        , running(false)
+        , settling(false)
+    {
+    }
+};
+
+MUTEX_DECL(motion_lock);
+static ArmMotion right_motion{&right_arm};
+static ArmMotion left_motion{&left_arm};
+
+static void motion_stop(ArmMotion* motion)
+{
+    chMtxLock(&motion_lock);
+    if (motion->running || motion->settling) {
+        motion->running = false;
+        motion->settling = false;
+        chBSemSignal(&motion->done);
+    }
+    chMtxUnlock(&motion_lock);
+}
+
+/* Starts moving through the given waypoints from the current angles, returns
+ * the duration of the move in milliseconds or -1 if it cannot be done. */
+static int motion_start(ArmMotion* motion, const Angles* waypoints, size_t count)
+{
+    Angles points[manipulator::JointTrajectory::MaxPoints];
+
+    if (count + 1 > manipulator::JointTrajectory::MaxPoints) {
+        return -1;
+    }
+
+    points[0] = motion->arm->angles();
+    std::copy_n(waypoints, count, &points[1]);
+
+    motion_stop(motion);
+
+    chMtxLock(&motion_lock);
+    if (!motion->arm->plan(motion->trajectory, points, count + 1)) {
+        chMtxUnlock(&motion_lock);
+        WARNING("Could not plan the arm trajectory, check its limits");
+        return -1;
+    }
+    chBSemReset(&motion->done, true);
+    motion->start = chVTGetSystemTime();
+    motion->running = true;
+    int duration_ms = motion->trajectory.duration() * 1000;
+    chMtxUnlock(&motion_lock);
+
+    return duration_ms;
+}
+
+static void motion_wait(ArmMotion* motion, int timeout_ms)
+{
+    chBSemWaitTimeout(&motion->done, TIME_MS2I(timeout_ms));
+}
+
+static void motion_update(ArmMotion* motion)
+{
+    chMtxLock(&motion_lock);
+
+    float t = TIME_I2MS(chVTTimeElapsedSinceX(motion->start)) / 1000.f;
+
+    if (motion->running) {
+        auto sample = motion->trajectory.sample(t);
+
+        if (t < motion->trajectory.duration()) {
+            motion->arm->apply(sample);
+        } else {
+            /* Hold the end of the trajectory until the arm gets there */
+            motion->arm->apply(sample.position);
+            motion->running = false;
+            motion->settling = true;
+        }
+    } else if (motion->settling) {
+        float settling_time = t - motion->trajectory.duration();
+        if (motion->arm->reached_target() || settling_time > MANIPULATOR_DEFAULT_TIMEOUT_MS / 1000.f) {
+            motion->settling = false;
+            chBSemSignal(&motion->done);
+        }
+    }
+
+    chMtxUnlock(&motion_lock);
+}
+
 void manipulator_angles_set(manipulator_side_t side, float q1, float q2, float q3)
 {
     Angles input = {q1, q2, q3};
 
-    if (USE_RIGHT(side))
+    if (USE_RIGHT(side)) {
+        motion_stop(&right_motion);
         right_arm.apply(input);
+    }
 
-    if (USE_LEFT(side))
+    if (USE_LEFT(side)) {
+        motion_stop(&left_motion);
         left_arm.apply(input);
+    }
 }
 
 void manipulator_angles_wait_for_traj_end(manipulator_side_t side, uint16_t timeout_ms)
@@ -114,51 +219,175 @@ void manipulator_angles_wait_for_traj_end_near(manipulator_side_t side, uint16_t
 
 void manipulator_angles_goto_timeout(manipulator_side_t side, float q1, float q2, float q3, uint16_t timeout_ms)
 {
-    manipulator_angles_set(side, q1, q2, q3);
-    manipulator_angles_wait_for_traj_end(side, timeout_ms);
+    Angles target = {q1, q2, q3};
+    int right_duration = 0, left_duration = 0;
+
+    if (USE_RIGHT(side))
+        right_duration = motion_start(&right_motion, &target, 1);
+    if (USE_LEFT(side))
+        left_duration = motion_start(&left_motion, &target, 1);
+
+    if (right_duration < 0 || left_duration < 0) {
+        manipulator_angles_set(side, q1, q2, q3);
+        manipulator_angles_wait_for_traj_end(side, timeout_ms);
+        return;
+    }
+
+    /* The timeout is counted from the end of the planned move */
+    if (USE_RIGHT(side))
+        motion_wait(&right_motion, right_duration + timeout_ms);
+    if (USE_LEFT(side))
+        motion_wait(&left_motion, left_duration + timeout_ms);
 }
 
-bool manipulator_goto(manipulator_side_t side, manipulator_state_t target)
+/* Waypoints on the way to the target, without the current state */
+static int route_waypoints(manipulator::Manipulator<ManipulatorLockGuard>& arm,
+                           manipulator_state_t target,
+                           Angles* waypoints)
 {
-    int right_len, left_len;
-    pathfinding::Node<manipulator::Point>* right_node;
-    pathfinding::Node<manipulator::Point>* left_node;
+    int len = arm.routes.length(arm.state, target);
+    int node = arm.state;
+
+    for (int i = 0; i < len; i++) {
+        node = arm.routes.next(node, target);
+        const auto& angles = arm.nodes[node].data.angles;
+        waypoints[i] = {angles[0], angles[1], angles[2]};
+    }
+
+    return len;
+}
+
+static parameter_t* planner_enabled;
+
+/* Planning scratch space, too large for the stacks of the calling threads */
+MUTEX_DECL(planner_lock);
+static manipulator::RoadmapPlanner planner;
+static manipulator::JointTrajectory right_check, left_check;
+
+static Angles state_angles(manipulator_state_t state)
+{
+    const float* angles = manipulator_state_angles[state];
+    return {angles[0], angles[1], angles[2]};
+}
+
+/* Waypoints to the target avoiding the other arm standing still, or -1 */
+static int planned_waypoints(const Angles& start, const Angles& goal, const Angles& other, Angles* waypoints)
+{
+    chMtxLock(&planner_lock);
+    int len = planner.plan(manipulator::arm_roadmap, manipulator::arm_workspace, start, goal, &other,
+                           waypoints, manipulator::JointTrajectory::MaxPoints - 1);
+    chMtxUnlock(&planner_lock);
+    return len;
+}
+
+/* Plans the trajectory an arm would execute through its waypoints */
+static bool plan_check(manipulator::Manipulator<ManipulatorLockGuard>& arm,
+                       manipulator::JointTrajectory& check,
+                       const Angles* waypoints,
+                       int len)
+{
+    Angles points[manipulator::JointTrajectory::MaxPoints];
+
+    points[0] = arm.angles();
+    std::copy_n(waypoints, len, &points[1]);
+    return arm.plan(check, points, len + 1);
+}
+
+/* Checks that both arms can go through their waypoints at the same time */
+static bool moves_are_free(const Angles* right_waypoints, int right_len, const Angles* left_waypoints, int left_len)
+{
+    chMtxLock(&planner_lock);
+    bool free = plan_check(right_arm, right_check, right_waypoints, right_len)
+                && plan_check(left_arm, left_check, left_waypoints, left_len)
+                && manipulator::trajectories_are_free(manipulator::arm_workspace, right_check, left_check,
+                                                      MANIPULATOR_COLLISION_CHECK_STEP);
+    chMtxUnlock(&planner_lock);
+    return free;
+}
+
+/* Checks that the arms can go through their waypoints one after the other.
+ * The planner only checks straight moves, while the executed trajectories
+ * blend around the waypoints. */
+static bool moves_are_free_in_turn(const Angles* right_waypoints,
+                                   int right_len,
+                                   const Angles* left_waypoints,
+                                   int left_len)
+{
+    chMtxLock(&planner_lock);
+    const Angles left_start = left_arm.angles();
+    bool free = plan_check(right_arm, right_check, right_waypoints, right_len)
+                && manipulator::trajectory_is_free(manipulator::arm_workspace, right_check, left_start,
+                                                   MANIPULATOR_COLLISION_CHECK_STEP);
+
+    /* The left arm moves once the right one is at the end of its trajectory */
+    const Angles right_end = right_check.sample(right_check.duration()).position;
+    free = free && plan_check(left_arm, left_check, left_waypoints, left_len)
+           && manipulator::trajectory_is_free(manipulator::arm_workspace, left_check, right_end,
+                                              MANIPULATOR_COLLISION_CHECK_STEP);
+    chMtxUnlock(&planner_lock);
+    return free;
+}
+
+static bool run_motion(ArmMotion* motion, const Angles* waypoints, int len)
+{
+    if (len == 0) {
+        return true;
+    }
+
+    int duration = motion_start(motion, waypoints, len);
+    if (duration < 0) {
+        return false;
+    }
+    motion_wait(motion, duration + MANIPULATOR_DEFAULT_TIMEOUT_MS);
+    return true;
+}
+
+/* Moves the arms around each other with the roadmap planner. Returns false
+ * without moving if no plan is found, so that the caller can fall back to the
+ * routes between arm states. */
+static bool planned_goto(manipulator_side_t side, manipulator_state_t target)
+{
+    Angles right_waypoints[manipulator::JointTrajectory::MaxPoints];
+    Angles left_waypoints[manipulator::JointTrajectory::MaxPoints];
+    int right_len = 0, left_len = 0;
+
+    const Angles goal = state_angles(target);
+    const Angles right_start = right_arm.angles();
+    const Angles left_start = left_arm.angles();
 
     if (USE_RIGHT(side)) {
-        right_len = pathfinding::dijkstra(right_arm.nodes, MANIPULATOR_COUNT, right_arm.nodes[right_arm.state], right_arm.nodes[target]);
-        right_node = &right_arm.nodes[right_arm.state];
+        right_len = planned_waypoints(right_start, goal, left_start, right_waypoints);
     }
     if (USE_LEFT(side)) {
-        left_len = pathfinding::dijkstra(left_arm.nodes, MANIPULATOR_COUNT, left_arm.nodes[left_arm.state], left_arm.nodes[target]);
-        left_node = &left_arm.nodes[left_arm.state];
+        /* When both arms move, the left one avoids where the right one ends */
+        const Angles& right_end = USE_RIGHT(side) ? goal : right_start;
+        left_len = planned_waypoints(left_start, goal, right_end, left_waypoints);
     }
 
-    if ((side == BOTH) && (right_len != left_len))
+    if (right_len < 0 || left_len < 0) {
         return false;
+    }
 
-    int len = USE_RIGHT(side) ? right_len : left_len;
-
-    for (int i = 0; i < len; i++) {
-        if (USE_RIGHT(side)) {
-            right_node = right_node->path_next;
-            manipulator_angles_set(RIGHT, right_node->data.angles[0], right_node->data.angles[1], right_node->data.angles[2]);
+    if (side == BOTH && moves_are_free(right_waypoints, right_len, left_waypoints, left_len)) {
+        int right_duration = motion_start(&right_motion, right_waypoints, right_len);
+        int left_duration = motion_start(&left_motion, left_waypoints, left_len);
+        if (right_duration < 0 || left_duration < 0) {
+            motion_stop(&right_motion);
+            motion_stop(&left_motion);
+            return false;
         }
-        if (USE_LEFT(side)) {
-            left_node = left_node->path_next;
-            manipulator_angles_set(LEFT, left_node->data.angles[0], left_node->data.angles[1], left_node->data.angles[2]);
+        motion_wait(&right_motion, right_duration + MANIPULATOR_DEFAULT_TIMEOUT_MS);
+        motion_wait(&left_motion, left_duration + MANIPULATOR_DEFAULT_TIMEOUT_MS);
+    } else if (moves_are_free_in_turn(right_waypoints, right_len, left_waypoints, left_len)) {
+        /* One after the other, which is what the left plan assumes */
+        if (!run_motion(&right_motion, right_waypoints, right_len)) {
+            return false;
         }
-
-        if (i == (len - 1)) { // last point
-            if (USE_RIGHT(side))
-                manipulator_angles_wait_for_traj_end(RIGHT, MANIPULATOR_DEFAULT_TIMEOUT_MS);
-            if (USE_LEFT(side))
-                manipulator_angles_wait_for_traj_end(LEFT, MANIPULATOR_DEFAULT_TIMEOUT_MS);
-        } else {
-            if (USE_RIGHT(side))
-                manipulator_angles_wait_for_traj_end_near(RIGHT, MANIPULATOR_DEFAULT_TIMEOUT_MS);
-            if (USE_LEFT(side))
-                manipulator_angles_wait_for_traj_end_near(LEFT, MANIPULATOR_DEFAULT_TIMEOUT_MS);
+        if (!run_motion(&left_motion, left_waypoints, left_len)) {
+            return false;
         }
+    } else {
+        return false;
     }
 
     if (USE_RIGHT(side))
@@ -168,6 +397,52 @@ bool manipulator_goto(manipulator_side_t side, manipulator_state_t target)
     return true;
 }
 
+bool manipulator_goto(manipulator_side_t side, manipulator_state_t target)
+{
+    if (planner_enabled && parameter_boolean_get(planner_enabled) && planned_goto(side, target)) {
+        return true;
+    }
+
+    Angles right_waypoints[MANIPULATOR_COUNT], left_waypoints[MANIPULATOR_COUNT];
+    int right_len = 0, left_len = 0;
+
+    if (USE_RIGHT(side)) {
+        right_len = route_waypoints(right_arm, target, right_waypoints);
+    }
+    if (USE_LEFT(side)) {
+        left_len = route_waypoints(left_arm, target, left_waypoints);
+    }
+
+    if (right_len < 0 || left_len < 0)
+        return false;
+
+    /* Both arms move at the same time, each through its own waypoints */
+    int right_duration = 0, left_duration = 0;
+    if (USE_RIGHT(side) && right_len > 0) {
+        right_duration = motion_start(&right_motion, right_waypoints, right_len);
+    }
+    if (USE_LEFT(side) && left_len > 0) {
+        left_duration = motion_start(&left_motion, left_waypoints, left_len);
+    }
+
+    if (right_duration < 0 || left_duration < 0) {
+        motion_stop(&right_motion);
+        motion_stop(&left_motion);
+        return false;
+    }
+
+    if (USE_RIGHT(side) && right_len > 0)
+        motion_wait(&right_motion, right_duration + MANIPULATOR_DEFAULT_TIMEOUT_MS);
+    if (USE_LEFT(side) && left_len > 0)
+        motion_wait(&left_motion, left_duration + MANIPULATOR_DEFAULT_TIMEOUT_MS);
+
+    if (USE_RIGHT(side))
+        right_arm.state = target;
+    if (USE_LEFT(side))
+        left_arm.state = target;
+    return true;
+}
+
 void manipulator_gripper_set(manipulator_side_t side, gripper_state_t state)
 {
     if (state == GRIPPER_ACQUIRE) {
@@ -210,6 +485,17 @@ static void init_arm_parameters(manipulator::Manipulator<ManipulatorLockGuard>*
         parameter_scalar_get(parameter_find(ns, "window/q2")),
         parameter_scalar_get(parameter_find(ns, "window/q3")),
     });
+    arm->set_limits(
+        {
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q1")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q2")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q3")),
+        },
+        {
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q1")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q2")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q3")),
+        });
 }
 
 static void update_arm_parameters(manipulator::Manipulator<ManipulatorLockGuard>* arm, parameter_namespace_t* ns)
@@ -229,6 +515,17 @@ static void update_arm_parameters(manipulator::Manipulator<ManipulatorLockGuard>
         parameter_scalar_get(parameter_find(ns, "window/q2")),
         parameter_scalar_get(parameter_find(ns, "window/q3")),
     });
+    arm->set_limits(
+        {
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q1")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q2")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/velocity/q3")),
+        },
+        {
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q1")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q2")),
+            parameter_scalar_get(parameter_find(ns, "trajectory/acceleration/q3")),
+        });
 
     arm->gripper.configure(parameter_scalar_get(parameter_find(ns, "gripper/release")),
                            parameter_scalar_get(parameter_find(ns, "gripper/acquire")));
@@ -241,6 +538,7 @@ static THD_FUNCTION(manipulator_thd, arg)
 
     parameter_namespace_t* right_arm_params = parameter_namespace_find(&master_config, "arms/right");
     parameter_namespace_t* left_arm_params = parameter_namespace_find(&master_config, "arms/left");
+    planner_enabled = parameter_find(&master_config, "arms/planner/enabled");
 
     /* Setup and advertise manipulator state topic */
     static TOPIC_DECL(manipulator_right_topic, Manipulator);
@@ -305,13 +603,24 @@ static THD_FUNCTION(manipulator_trajectory_thd, arg)
     chRegSetThreadName(__FUNCTION__);
 
     NOTICE("Start manipulator trajectory manager thread");
+
+    /* Samples on a fixed period, as the motor boards extrapolate each one
+     * until the next. */
+    systime_t next = chVTGetSystemTime();
     while (true) {
-        chThdSleepMilliseconds(1000 / MANIPULATOR_TRAJECTORY_FREQUENCY);
+        motion_update(&right_motion);
+        motion_update(&left_motion);
+        motor_driver_uavcan_trajectory_ready();
+
+        next = chThdSleepUntilWindowed(next, chTimeAddX(next, TIME_MS2I(1000 / MANIPULATOR_TRAJECTORY_FREQUENCY)));
     }
 }
 
 void manipulator_start(void)
 {
+    chBSemObjectInit(&right_motion.done, true);
+    chBSemObjectInit(&left_motion.done, true);
+
     static THD_WORKING_AREA(manipulator_thd_wa, MANIPULATOR_THREAD_STACKSIZE);
     chThdCreateStatic(manipulator_thd_wa,
                       sizeof(manipulator_thd_wa),
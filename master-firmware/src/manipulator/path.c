@@ -0,0 +1,29 @@
+#include "manipulator/path.h"
+
+const float manipulator_state_angles[MANIPULATOR_COUNT][3] = {
+    [MANIPULATOR_INIT] = {0, 0, 0},
+    [MANIPULATOR_DEPLOY_FULLY] = {1.2705, 1.5002, 1.4614},
+    [MANIPULATOR_PICK_HORZ] = {0.57912659, 1.13070901, 0.0},
+    [MANIPULATOR_PICK_VERT] = {0.35136038, 1.66511662, 1.57079633},
+    [MANIPULATOR_LIFT_VERT] = {0.35136038, 2.16511662, 1.57079633},
+    [MANIPULATOR_PICK_GOLDONIUM] = {0.59695668, 2.36765084, 1.57079633},
+    [MANIPULATOR_LIFT_GOLDONIUM] = {0.59695668, 3.14, 1.57079633},
+    [MANIPULATOR_SCALE_INTERMEDIATE] = {-0.1901, 2.1626, 1.57},
+    [MANIPULATOR_SCALE] = {0.8674, 2.1626, 2.1580},
+    [MANIPULATOR_PUT_ACCELERATOR] = {0.5522, 2.8653, 1.5605},
+    [MANIPULATOR_PUT_ACCELERATOR_DOWN] = {0.2617, 2.4874, 1.6114},
+    [MANIPULATOR_STORE_FRONT_0] = {0.55592904, 2.29990897, 0},
+    [MANIPULATOR_STORE_FRONT_1] = {0.44061324, 2.40559601, 0},
+    [MANIPULATOR_STORE_FRONT_2] = {0.15942326, 2.76071548, 0.35511947},
+    [MANIPULATOR_STORE_FRONT_STORE] = {-0.14048151, 2.77174001, 0.366144},
+    [MANIPULATOR_STORE_FRONT_HIGH] = {-0.35403161, 2.01076878, 0},
+    [MANIPULATOR_STORE_FRONT_HIGH_1] = {-0.18604025, 2.38740067, 0},
+    [MANIPULATOR_STORE_FRONT_LOW] = {-0.4226222, 1.70403752, 0},
+    [MANIPULATOR_STORE_BACK_1] = {-0.44061324, 2.40559601, 0},
+    [MANIPULATOR_STORE_BACK_2] = {-0.69523267, 2.15951152, 0},
+    [MANIPULATOR_STORE_BACK_3] = {-0.98944966, 1.83134011, 0},
+    [MANIPULATOR_STORE_BACK_4] = {-1.2671543, 1.48789401, 0},
+    [MANIPULATOR_STORE_BACK_STORE] = {-1.49246682, 1.17753052, 0},
+    [MANIPULATOR_STORE_BACK_HIGH] = {-1.29581933, 1.06898106, 0},
+    [MANIPULATOR_STORE_BACK_LOW] = {-1.1675452, 0.95911452, 0},
+};
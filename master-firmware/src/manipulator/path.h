@@ -34,6 +34,9 @@ typedef enum {
     MANIPULATOR_COUNT // Dummy, used for last element
 } manipulator_state_t;
 
+// Joint angles of each arm state, in the frame of the arm
+extern const float manipulator_state_angles[MANIPULATOR_COUNT][3];
+
 #ifdef __cplusplus
 }
 #endif
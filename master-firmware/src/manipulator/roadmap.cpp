@@ -0,0 +1,187 @@
+#include "manipulator/roadmap.h"
+
+#include <math.h>
+
+namespace manipulator {
+/* Geometry from the config, see arms/ and robot_size_x_mm. The x axis of the
+ * arm goes from the shoulder to the alignment border, which is
+ * arms/<side>/lengths/origin away (arm_calib measures the joints from it). The
+ * shoulders are as far from the sides of the robot as from its front. */
+static constexpr float robot_width = 0.26f;
+static constexpr float shoulder_to_border = 0.2428f;
+
+/* The arms stay inside the outline of the robot behind them and beyond the
+ * side of the other arm. The front and their own side are open to reach out
+ * of the robot. */
+static const Box body[] = {
+    {shoulder_to_border, 0.4f, -0.4f, 0.4f}, // alignment border
+    {-0.4f, 0.4f, -0.4f, -shoulder_to_border}, // side of the other arm
+};
+
+const ArmWorkspace arm_workspace = {
+    {{0.132f, 0.097f, 0.072f}}, // lengths, same as arms/*/lengths in the config
+    0.012f, // link_radius
+    2 * shoulder_to_border - robot_width, // shoulder_distance
+    body,
+    sizeof(body) / sizeof(body[0]), // body_count
+    {{-1.6f, -0.1f, -0.1f}}, // min_angles, around the arm states
+    {{1.4f, 3.25f, 2.3f}}, // max_angles
+    0.05f, // resolution
+};
+
+static float joint_distance(const Angles& a, const Angles& b)
+{
+    float sum = 0;
+    for (size_t i = 0; i < 3; i++) {
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return sqrtf(sum);
+}
+
+/* Finds the nearest roadmap nodes reachable in a straight move, nearest first */
+int RoadmapPlanner::link(const Roadmap& roadmap,
+                         const ArmWorkspace& workspace,
+                         const Angles& angles,
+                         const Angles* other,
+                         int* links)
+{
+    float distances[Links];
+    int count = 0;
+
+    for (int i = 0; i < roadmap.node_count; i++) {
+        float distance = joint_distance(angles, roadmap.nodes[i]);
+        if (count == Links && distance >= distances[Links - 1]) {
+            continue;
+        }
+
+        int j = count < Links ? count++ : Links - 1;
+        for (; j > 0 && distances[j - 1] > distance; j--) {
+            distances[j] = distances[j - 1];
+            links[j] = links[j - 1];
+        }
+        distances[j] = distance;
+        links[j] = i;
+    }
+
+    int free_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (move_is_free(workspace, angles, roadmap.nodes[links[i]], other)) {
+            links[free_count++] = links[i];
+        }
+    }
+    return free_count;
+}
+
+int RoadmapPlanner::plan(const Roadmap& roadmap,
+                         const ArmWorkspace& workspace,
+                         const Angles& start,
+                         const Angles& goal,
+                         const Angles* other,
+                         Angles* waypoints,
+                         int max_count)
+{
+    if (max_count < 1 || roadmap.node_count > ROADMAP_MAX_NODES) {
+        return -1;
+    }
+
+    /* Nothing beats going straight */
+    if (move_is_free(workspace, start, goal, other)) {
+        waypoints[0] = goal;
+        return 1;
+    }
+
+    const int start_index = roadmap.node_count;
+    const int goal_index = roadmap.node_count + 1;
+    const int count = roadmap.node_count + 2;
+
+    auto angles = [&](int i) -> const Angles& {
+        return i == start_index ? start : (i == goal_index ? goal : roadmap.nodes[i]);
+    };
+
+    start_link_count = link(roadmap, workspace, start, other, start_links);
+    goal_link_count = link(roadmap, workspace, goal, other, goal_links);
+
+    for (int i = 0; i < count; i++) {
+        vertices[i].distance = INFINITY;
+        vertices[i].heap_index = -1;
+        vertices[i].parent = -1;
+        vertices[i].visited = false;
+    }
+
+    vertices[start_index].distance = 0;
+    queue.push_or_decrease(&vertices[start_index]);
+
+    /* The roadmap moves are free on their own, only the other arm is checked
+     * while searching, and only for moves which would shorten a path. */
+    auto relax = [&](int from, int to, bool checked) {
+        float distance = vertices[from].distance + joint_distance(angles(from), angles(to));
+        if (vertices[to].visited || distance >= vertices[to].distance) {
+            return;
+        }
+        if (!checked && other && !move_is_free(workspace, angles(from), angles(to), other)) {
+            return;
+        }
+        vertices[to].distance = distance;
+        vertices[to].parent = from;
+        queue.push_or_decrease(&vertices[to]);
+    };
+
+    while (!queue.empty()) {
+        const int u = queue.pop() - vertices;
+        vertices[u].visited = true;
+
+        if (u == goal_index) {
+            break;
+        }
+
+        if (u == start_index) {
+            for (int i = 0; i < start_link_count; i++) {
+                relax(u, start_links[i], true);
+            }
+            continue;
+        }
+
+        for (int e = roadmap.first_edge[u]; e < roadmap.first_edge[u + 1]; e++) {
+            relax(u, roadmap.edges[e], false);
+        }
+        for (int i = 0; i < goal_link_count; i++) {
+            if (goal_links[i] == u) {
+                relax(u, goal_index, true);
+            }
+        }
+    }
+
+    while (!queue.empty()) {
+        queue.pop();
+    }
+
+    if (!vertices[goal_index].visited) {
+        return -1;
+    }
+
+    /* Walk the path backwards, skipping the nodes which can be gone past in a
+     * straight move. */
+    int len = 0;
+    int from = goal_index;
+    while (from != start_index) {
+        int to = vertices[from].parent;
+        while (to != start_index && move_is_free(workspace, angles(vertices[to].parent), angles(from), other)) {
+            to = vertices[to].parent;
+        }
+
+        if (len == max_count) {
+            return -1;
+        }
+        waypoints[len++] = angles(from);
+        from = to;
+    }
+
+    for (int i = 0; i < len / 2; i++) {
+        Angles tmp = waypoints[i];
+        waypoints[i] = waypoints[len - 1 - i];
+        waypoints[len - 1 - i] = tmp;
+    }
+
+    return len;
+}
+} // namespace manipulator
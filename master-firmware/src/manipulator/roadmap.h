@@ -0,0 +1,71 @@
+#ifndef MANIPULATOR_ROADMAP_H
+#define MANIPULATOR_ROADMAP_H
+
+#include <cstdint>
+
+#include "manipulator/collision.h"
+#include "manipulator/path.h"
+#include "dijkstra.hpp"
+
+#define ROADMAP_MAX_NODES 256
+
+namespace manipulator {
+// Graph of collision free arm configurations and of the moves between them
+//
+// It is built offline by tools/arm_roadmap_generator.cpp and kept in flash.
+// The first MANIPULATOR_COUNT nodes are the arm states, in order. Edges are
+// stored per node: those of node i are edges[first_edge[i]] up to
+// edges[first_edge[i + 1]].
+struct Roadmap {
+    const Angles* nodes;
+    uint16_t node_count;
+    const uint16_t* first_edge;
+    const uint16_t* edges;
+};
+
+// Workspace and roadmap of the arms, both arms use the same ones as they
+// are mirror images of each other
+extern const ArmWorkspace arm_workspace;
+extern const Roadmap arm_roadmap;
+
+// Finds short collision free moves between two arm configurations
+class RoadmapPlanner {
+public:
+    // Plans from start to goal, while the other arm, if given, stands still
+    //
+    // Writes the configurations to go through after start, ending with goal,
+    // and returns how many there are, or -1 if there is no path or it has more
+    // than max_count configurations.
+    int plan(const Roadmap& roadmap,
+             const ArmWorkspace& workspace,
+             const Angles& start,
+             const Angles& goal,
+             const Angles* other,
+             Angles* waypoints,
+             int max_count);
+
+    // Search state of each node, public for pathfinding::NodeHeap
+    struct Vertex {
+        float distance;
+        int heap_index;
+        int parent;
+        bool visited;
+    };
+
+private:
+    static const int Links = 8;
+
+    Vertex vertices[ROADMAP_MAX_NODES + 2];
+    pathfinding::NodeHeap<Vertex, ROADMAP_MAX_NODES + 2> queue;
+    int start_links[Links], goal_links[Links];
+    int start_link_count, goal_link_count;
+
+    int link(const Roadmap& roadmap,
+             const ArmWorkspace& workspace,
+             const Angles& angles,
+             const Angles* other,
+             int* links);
+};
+} // namespace manipulator
+
+#endif /* MANIPULATOR_ROADMAP_H */
@@ -103,3 +103,69 @@ bool scara_compute_joint_angles(point_t target, shoulder_mode_t mode, const floa
 
     return true;
 }
+
+int scara_compute_joint_angles_batch(int count,
+                                     const float* restrict x,
+                                     const float* restrict y,
+                                     const shoulder_mode_t* restrict mode,
+                                     const float* length,
+                                     float* restrict alpha,
+                                     float* restrict beta,
+                                     bool* restrict reachable)
+{
+    const float l1 = length[0], l2 = length[1];
+    const float min_sq = (l1 - l2) * (l1 - l2) * (1.f - 1e-5f);
+    const float max_sq = (l1 + l2) * (l1 + l2) * (1.f + 1e-5f);
+    int reachable_count = 0;
+
+    /* Reject targets out of reach first, this only compares distances and
+     * vectorizes well. */
+    for (int i = 0; i < count; i++) {
+        const float d_sq = x[i] * x[i] + y[i] * y[i];
+        reachable[i] = (d_sq > 0.f) & (d_sq >= min_sq) & (d_sq <= max_sq);
+        reachable_count += reachable[i];
+    }
+
+    if (reachable_count == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!reachable[i]) {
+            continue;
+        }
+
+        /* The elbow is at the intersection of the circles of radius l1 around
+         * the shoulder and l2 around the target, on either side of the line
+         * going from the shoulder to the target. */
+        const float d_sq = x[i] * x[i] + y[i] * y[i];
+        const float along = (l1 * l1 - l2 * l2 + d_sq) / (2.f * d_sq);
+        const float across = sqrtf(fmaxf(l1 * l1 / d_sq - along * along, 0.f));
+
+        const float e1x = along * x[i] - across * y[i];
+        const float e1y = along * y[i] + across * x[i];
+        const float e2x = along * x[i] + across * y[i];
+        const float e2y = along * y[i] - across * x[i];
+
+        /* Same choice as scara_shoulder_solve, written as selects */
+        bool first;
+        if (x[i] < 0) {
+            first = e1x > e2x;
+        } else if (mode[i] == SHOULDER_BACK) {
+            first = e1y > e2y;
+        } else {
+            first = e1y < e2y;
+        }
+        const float ex = first ? e1x : e2x;
+        const float ey = first ? e1y : e2y;
+
+        /* The elbow angle is relative to the upper arm, which directly gives
+         * it in [-pi, pi]. */
+        const float fx = x[i] - ex;
+        const float fy = y[i] - ey;
+        alpha[i] = atan2f(ey, ex);
+        beta[i] = atan2f(ex * fy - ey * fx, ex * fx + ey * fy);
+    }
+
+    return reachable_count;
+}
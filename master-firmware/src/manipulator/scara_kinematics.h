@@ -42,6 +42,24 @@ float scara_compute_elbow_angle(point_t elbow, point_t hand);
 
 bool scara_compute_joint_angles(point_t target, shoulder_mode_t mode, const float* length, float* alpha, float* beta);
 
+/** Solves scara_compute_joint_angles for many targets at once.
+ *
+ * Targets and results are stored as separate arrays of count elements. Targets
+ * out of reach are rejected before any trigonometry, and their angles are left
+ * untouched.
+ *
+ * @param [out] reachable Whether a solution was found for each target.
+ * @returns The number of reachable targets.
+ */
+int scara_compute_joint_angles_batch(int count,
+                                     const float* x,
+                                     const float* y,
+                                     const shoulder_mode_t* mode,
+                                     const float* length,
+                                     float* alpha,
+                                     float* beta,
+                                     bool* reachable);
+
 #ifdef __cplusplus
 }
 #endif
@@ -128,7 +128,7 @@
 #define STM32_GPT_USE_TIM3 FALSE
 #define STM32_GPT_USE_TIM4 FALSE
 #define STM32_GPT_USE_TIM5 FALSE
-#define STM32_GPT_USE_TIM6 FALSE
+#define STM32_GPT_USE_TIM6 TRUE
 #define STM32_GPT_USE_TIM7 FALSE
 #define STM32_GPT_USE_TIM8 FALSE
 #define STM32_GPT_USE_TIM9 FALSE
@@ -11,9 +11,7 @@
 #define USB_SHELL_PRIO (NORMALPRIO)
 #define UAVCAN_PRIO (NORMALPRIO)
 #define RPC_SERVER_PRIO (NORMALPRIO)
-#define POSITION_MANAGER_PRIO (NORMALPRIO)
-#define BASE_CONTROLLER_PRIO (NORMALPRIO)
-#define TRAJECTORY_MANAGER_PRIO (NORMALPRIO)
+#define BASE_CONTROLLER_PRIO (NORMALPRIO + 2)
 #define MAP_SERVER_PRIO (NORMALPRIO + 1)
 #define COLOR_SEQUENCE_SERVER_PRIO (NORMALPRIO)
 #define ARMS_CONTROLLER_PRIO (NORMALPRIO)
@@ -22,7 +20,6 @@
 #define ARM_TRAJ_MANAGER_PRIO (NORMALPRIO)
 #define STRATEGY_PRIO (NORMALPRIO)
 #define SCORE_COUNTER_PRIO (NORMALPRIO)
-#define ENCODER_PRIO (NORMALPRIO)
 #define STREAM_PRIO (NORMALPRIO)
 
 #define STM32_USB_OTG_THREAD_PRIO LOWPRIO
@@ -12,6 +12,7 @@
 
 #include "strategy_helpers.h"
 #include "base/map_server.h"
+#include "base/pose_fusion.h"
 
 void strategy_auto_position(int32_t x, int32_t y, int32_t heading, enum strat_color_t robot_color)
 {
@@ -29,6 +30,7 @@ void strategy_auto_position(int32_t x, int32_t y, int32_t heading, enum strat_co
         position_set(&robot.pos, MIRROR_X(robot_color, robot.alignement_length), 0,
                      MIRROR_A(robot_color, 180));
     }
+    pose_fusion_reset();
 
     /* Go to desired position in x. */
     trajectory_d_rel(&robot.traj,
@@ -45,6 +47,7 @@ void strategy_auto_position(int32_t x, int32_t y, int32_t heading, enum strat_co
     /* Reset position in y */
     robot.pos.pos_d.y = robot.alignement_length;
     robot.pos.pos_s16.y = robot.alignement_length;
+    pose_fusion_reset();
 
     /* Go to the desired position in y */
     trajectory_set_speed(&robot.traj, speed_mm2imp(&robot.traj, 300),
@@ -69,6 +72,7 @@ void strategy_align_y(int32_t y)
     trajectory_align_with_wall();
     robot.pos.pos_d.y = robot.alignement_length;
     robot.pos.pos_s16.y = robot.alignement_length;
+    pose_fusion_reset();
 
     trajectory_set_speed(&robot.traj, speed_mm2imp(&robot.traj, 300),
                          speed_rd2imp(&robot.traj, 2.5));
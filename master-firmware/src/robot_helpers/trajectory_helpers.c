@@ -39,6 +39,12 @@ int trajectory_wait_for_end(int watched_end_reasons)
 
 int trajectory_has_ended(int watched_end_reasons)
 {
+    /* The base stops on a detected collision, which also looks like the
+     * trajectory ended, so it has to be checked first */
+    if ((watched_end_reasons & TRAJ_END_COLLISION) && collision_detector_get(&robot.collision) != COLLISION_NONE) {
+        return TRAJ_END_COLLISION;
+    }
+
     if ((watched_end_reasons & TRAJ_END_GOAL_REACHED) && trajectory_finished(&robot.traj)) {
         return TRAJ_END_GOAL_REACHED;
     }
@@ -99,6 +105,7 @@ void trajectory_align_with_wall(void)
     robot.mode = BOARD_MODE_DISTANCE_ONLY;
 
     /* Move in direction until we hit a wall */
+    collision_detector_reset(&robot.collision);
     trajectory_d_rel(&robot.traj, robot.calibration_direction * 2000.);
     trajectory_wait_for_end(TRAJ_END_COLLISION);
 
@@ -106,6 +113,7 @@ void trajectory_align_with_wall(void)
     trajectory_hardstop(&robot.traj);
     bd_reset(&robot.distance_bd);
     bd_reset(&robot.angle_bd);
+    collision_detector_reset(&robot.collision);
 
     /* Enable angle control back */
     robot.mode = BOARD_MODE_ANGLE_DISTANCE;
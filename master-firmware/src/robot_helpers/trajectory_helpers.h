@@ -19,6 +19,7 @@ extern "C" {
 #define TRAJ_MIN_DIRECTION_TO_OPPONENT 0.5f // defines cone in which to consider opponents (cone is double the angle in size)
 #define TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION 0.5f // if delay bigger than this, beacon signal is discarded
 #define TRAJ_MAX_TIME_DELAY_ALLY_DETECTION 1.0f // if delay bigger that this, ally position is discarded
+#define TRAJ_PATH_ADVANCE_MM 100.f // lookahead distance when following a path through several waypoints
 
 #define TRAJ_END_GOAL_REACHED (1 << 0)
 #define TRAJ_END_COLLISION (1 << 1)
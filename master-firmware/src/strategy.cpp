@@ -54,6 +54,7 @@ static void strategy_wait_ms(int ms)
 static void strategy_rotate(void* ctx, int relative_angle_deg)
 {
     strategy_context_t* strat = (strategy_context_t*)ctx;
+    collision_detector_reset(&strat->robot->collision);
     trajectory_a_rel(&strat->robot->traj, relative_angle_deg);
     trajectory_wait_for_end(TRAJ_FLAGS_ROTATION);
 }
@@ -61,6 +62,7 @@ static void strategy_rotate(void* ctx, int relative_angle_deg)
 static void strategy_forward(void* ctx, int relative_distance_mm)
 {
     strategy_context_t* strat = (strategy_context_t*)ctx;
+    collision_detector_reset(&strat->robot->collision);
     trajectory_d_rel(&strat->robot->traj, relative_distance_mm);
     trajectory_wait_for_end(TRAJ_FLAGS_SHORT_DISTANCE);
 }
@@ -307,9 +309,11 @@ void strategy_chaos_play_game(strategy_context_t* ctx, RobotState& state)
 
     NOTICE("Moving away from Order...");
 
+    collision_detector_reset(&robot.collision);
     trajectory_a_abs(&robot.traj, -90);
     trajectory_wait_for_end(TRAJ_FLAGS_ROTATION);
 
+    collision_detector_reset(&robot.collision);
     trajectory_d_rel(&robot.traj, -300);
     trajectory_wait_for_end(TRAJ_FLAGS_SHORT_DISTANCE);
 
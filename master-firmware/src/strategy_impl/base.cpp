@@ -3,6 +3,7 @@
 
 #include <aversive/position_manager/position_manager.h>
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
+#include <aversive/trajectory_manager/trajectory_manager_core.h>
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 
 #include "robot_helpers/math_helpers.h"
@@ -70,22 +71,31 @@ bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_de
         return false;
     }
 
-    /* Execute path, one waypoint at a time */
     int end_reason = 0;
 
-    for (int i = 0; i < num_points; i++) {
-        DEBUG("Going to x: %.1fmm y: %.1fmm", points[i].x, points[i].y);
-
-        trajectory_goto_xy_abs(&strat->robot->traj, points[i].x, points[i].y);
-
-        if (i == num_points - 1) /* last point */ {
-            end_reason = trajectory_wait_for_end(traj_end_flags);
-        } else {
-            end_reason = trajectory_wait_for_end(traj_end_flags | TRAJ_END_NEAR_GOAL);
-        }
-
-        if (end_reason != TRAJ_END_GOAL_REACHED && end_reason != TRAJ_END_NEAR_GOAL) {
-            break;
+    /* Execute path as a whole so that the robot does not slow down at each
+     * waypoint. Single points keep going to x,y, which can drive backwards */
+    collision_detector_reset(&strat->robot->collision);
+    if (num_points > 1 && trajectory_goto_path_abs(&strat->robot->traj, points, num_points, TRAJ_PATH_ADVANCE_MM) == 0) {
+        DEBUG("Following path to x: %.1fmm y: %.1fmm", points[num_points - 1].x, points[num_points - 1].y);
+        end_reason = trajectory_wait_for_end(traj_end_flags);
+    } else {
+        /* Execute path, one waypoint at a time */
+        for (int i = 0; i < num_points; i++) {
+            DEBUG("Going to x: %.1fmm y: %.1fmm", points[i].x, points[i].y);
+
+            collision_detector_reset(&strat->robot->collision);
+            trajectory_goto_xy_abs(&strat->robot->traj, points[i].x, points[i].y);
+
+            if (i == num_points - 1) /* last point */ {
+                end_reason = trajectory_wait_for_end(traj_end_flags);
+            } else {
+                end_reason = trajectory_wait_for_end(traj_end_flags | TRAJ_END_NEAR_GOAL);
+            }
+
+            if (end_reason != TRAJ_END_GOAL_REACHED && end_reason != TRAJ_END_NEAR_GOAL) {
+                break;
+            }
         }
     }
 
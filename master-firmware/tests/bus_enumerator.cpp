@@ -1,4 +1,5 @@
 #include "CppUTest/TestHarness.h"
+#include <string.h>
 #include "bus_enumerator.h"
 
 #define SMALL_STR_ID "bar"
@@ -246,3 +247,76 @@ TEST(BusEnumeratorBufferLengthTestGroup, NoBufferOverflow)
 
     STRCMP_EQUAL(SMALL_STR_ID, en.can_to_str[0].str_id);
 }
+
+TEST(BusEnumeratorTestGroup, GetDriverByCanId)
+{
+    bus_enumerator_add_node(&en, LARGE_STR_ID, NULL);
+    bus_enumerator_add_node(&en, MEDIUM_STR_ID, DRIVER_POINTER);
+
+    bus_enumerator_update_node_info(&en, LARGE_STR_ID, SMALL_CAN_ID);
+    bus_enumerator_update_node_info(&en, MEDIUM_STR_ID, MEDIUM_CAN_ID);
+
+    POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver_by_can_id(&en, MEDIUM_CAN_ID));
+    POINTERS_EQUAL(NULL, bus_enumerator_get_driver_by_can_id(&en, SMALL_CAN_ID));
+}
+
+TEST(BusEnumeratorTestGroup, UnknownCanIdHasNoDriver)
+{
+    bus_enumerator_add_node(&en, MEDIUM_STR_ID, DRIVER_POINTER);
+
+    POINTERS_EQUAL(NULL, bus_enumerator_get_driver_by_can_id(&en, MEDIUM_CAN_ID));
+    POINTERS_EQUAL(NULL, bus_enumerator_get_str_id(&en, MEDIUM_CAN_ID));
+    POINTERS_EQUAL(NULL, bus_enumerator_get_driver_by_can_id(&en, 200));
+}
+
+TEST(BusEnumeratorTestGroup, CanIdOutsideOfDirectTableIsFound)
+{
+    const uint8_t can_id = BUS_ENUMERATOR_CAN_ID_TABLE_LEN + 2;
+    bus_enumerator_add_node(&en, MEDIUM_STR_ID, DRIVER_POINTER);
+    bus_enumerator_update_node_info(&en, MEDIUM_STR_ID, can_id);
+
+    POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver_by_can_id(&en, can_id));
+    STRCMP_EQUAL(MEDIUM_STR_ID, bus_enumerator_get_str_id(&en, can_id));
+}
+
+TEST(BusEnumeratorTestGroup, RepeatedStringLookupIsStable)
+{
+    bus_enumerator_add_node(&en, MEDIUM_STR_ID, DRIVER_POINTER);
+    bus_enumerator_add_node(&en, SMALL_STR_ID, NULL);
+
+    for (int i = 0; i < 3; i++) {
+        POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver(&en, MEDIUM_STR_ID));
+        POINTERS_EQUAL(NULL, bus_enumerator_get_driver(&en, SMALL_STR_ID));
+    }
+}
+
+TEST(BusEnumeratorTestGroup, StringLookupSurvivesInsertion)
+{
+    bus_enumerator_add_node(&en, LARGE_STR_ID, DRIVER_POINTER);
+    POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver(&en, LARGE_STR_ID));
+
+    // shifts the entry of LARGE_STR_ID in the sorted table
+    bus_enumerator_add_node(&en, SMALL_STR_ID, NULL);
+
+    POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver(&en, LARGE_STR_ID));
+    POINTERS_EQUAL(NULL, bus_enumerator_get_driver(&en, SMALL_STR_ID));
+}
+
+TEST(BusEnumeratorTestGroup, ReusedStringBufferIsNotMistakenForCachedOne)
+{
+    char name[16];
+    bus_enumerator_add_node(&en, MEDIUM_STR_ID, DRIVER_POINTER);
+    bus_enumerator_add_node(&en, SMALL_STR_ID, NULL);
+    bus_enumerator_update_node_info(&en, MEDIUM_STR_ID, MEDIUM_CAN_ID);
+
+    strcpy(name, MEDIUM_STR_ID);
+    POINTERS_EQUAL(DRIVER_POINTER, bus_enumerator_get_driver(&en, name));
+    CHECK_EQUAL(MEDIUM_CAN_ID, bus_enumerator_get_can_id(&en, name));
+
+    strcpy(name, SMALL_STR_ID);
+    POINTERS_EQUAL(NULL, bus_enumerator_get_driver(&en, name));
+    CHECK_EQUAL(BUS_ENUMERATOR_CAN_ID_NOT_SET, bus_enumerator_get_can_id(&en, name));
+
+    strcpy(name, "unknown");
+    CHECK_EQUAL(BUS_ENUMERATOR_STRING_ID_NOT_FOUND, bus_enumerator_get_can_id(&en, name));
+}
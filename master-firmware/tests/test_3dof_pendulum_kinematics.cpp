@@ -75,3 +75,33 @@ TEST(APendulumWith3Joints, DecouplesAxis)
 
     ANGLES_EQUAL(decoupled, expected);
 }
+
+TEST(APendulumWith3Joints, SolvesManyPosesAtOnce)
+{
+    const Angles original_angles[3] = {
+        {RAD(10.f), RAD(20.f), RAD(30.f)},
+        {RAD(-10.f), RAD(-20.f), RAD(-30.f)},
+        {RAD(90.f), RAD(0.f), RAD(0.f)},
+    };
+    float x[4], y[4], heading[4];
+    for (int i = 0; i < 3; i++) {
+        Pose2D pose = forward_kinematics(lengths, original_angles[i]);
+        x[i] = pose.x;
+        y[i] = pose.y;
+        heading[i] = pose.heading;
+    }
+    x[3] = 3.f, y[3] = 0.f, heading[3] = 0.f;
+
+    float q1[4], q2[4], q3[4];
+    bool reachable[4];
+    PoseBatch poses = {x, y, heading};
+    AnglesBatch angles = {q1, q2, q3, reachable};
+
+    CHECK_EQUAL(3, inverse_kinematics(lengths, 4, poses, angles));
+
+    for (int i = 0; i < 3; i++) {
+        CHECK_TRUE(reachable[i]);
+        ANGLES_EQUAL(original_angles[i], {q1[i], q2[i], q3[i]});
+    }
+    CHECK_FALSE(reachable[3]);
+}
@@ -56,3 +56,78 @@ TEST(ArmPathFindingTestGroup, MoreComplexSituation)
     POINTERS_EQUAL(&nodes[DEPLOY], nodes[RETRACT].path_next);
     POINTERS_EQUAL(&nodes[PICK], nodes[DEPLOY].path_next);
 }
+
+TEST(ArmPathFindingTestGroup, ReportsUnreachableNodes)
+{
+    pathfinding::Node<int> nodes[] = {{0}, {1}, {2}};
+    nodes[0].connect(nodes[1]);
+    nodes[2].connect(nodes[0]);
+
+    CHECK_EQUAL(-1, pathfinding::dijkstra(nodes, 3, nodes[0], nodes[2]));
+    CHECK_EQUAL(0, pathfinding::dijkstra(nodes, 3, nodes[0], nodes[0]));
+}
+
+TEST(ArmPathFindingTestGroup, PrefersCheaperPathOverFewerMoves)
+{
+    enum { A = 0, B, C, D, COUNT };
+    pathfinding::Node<int> nodes[COUNT] = {{A}, {B}, {C}, {D}};
+
+    // Direct but long move from A to D, or three short ones
+    connect_bidirectional(nodes[A], nodes[D], 5);
+    connect_bidirectional(nodes[A], nodes[B], 1);
+    connect_bidirectional(nodes[B], nodes[C], 1);
+    connect_bidirectional(nodes[C], nodes[D], 1);
+
+    CHECK_EQUAL(3, dijkstra(nodes, COUNT, nodes[A], nodes[D]));
+    POINTERS_EQUAL(&nodes[B], nodes[A].path_next);
+    POINTERS_EQUAL(&nodes[C], nodes[B].path_next);
+    POINTERS_EQUAL(&nodes[D], nodes[C].path_next);
+}
+
+TEST_GROUP (ArmNextHopTableTestGroup) {
+    enum { COUNT = 12 };
+    pathfinding::Node<int> nodes[COUNT] = {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}, {10}, {11}};
+    pathfinding::NextHopTable<COUNT> table;
+
+    void setup()
+    {
+        // A ring with a few weighted shortcuts, and a one way dead end
+        for (int i = 0; i < COUNT - 1; i++) {
+            connect_bidirectional(nodes[i], nodes[(i + 1) % (COUNT - 1)], 1 + i % 3);
+        }
+        connect_bidirectional(nodes[0], nodes[5], 2.5);
+        connect_bidirectional(nodes[3], nodes[8], 1.5);
+        nodes[4].connect(nodes[COUNT - 1], 1);
+
+        table.compute(nodes);
+    }
+};
+
+TEST(ArmNextHopTableTestGroup, MatchesDijkstraForAllPairs)
+{
+    for (int from = 0; from < COUNT; from++) {
+        for (int to = 0; to < COUNT; to++) {
+            int len = dijkstra(nodes, COUNT, nodes[from], nodes[to]);
+            CHECK_EQUAL(len, table.length(from, to));
+
+            int current = from;
+            for (auto* p = &nodes[from]; p->path_next != nullptr; p = p->path_next) {
+                current = table.next(current, to);
+                CHECK_EQUAL(p->path_next->data, current);
+            }
+        }
+    }
+}
+
+TEST(ArmNextHopTableTestGroup, StaysInPlaceAtTarget)
+{
+    CHECK_EQUAL(3, table.next(3, 3));
+    CHECK_EQUAL(0, table.length(3, 3));
+}
+
+TEST(ArmNextHopTableTestGroup, ReportsUnreachableNodes)
+{
+    CHECK_EQUAL(-1, table.next(COUNT - 1, 0));
+    CHECK_EQUAL(-1, table.length(COUNT - 1, 0));
+    CHECK_EQUAL(1, table.length(4, COUNT - 1));
+}
@@ -0,0 +1,182 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+
+#include "manipulator/roadmap.h"
+
+using namespace manipulator;
+
+static Angles state(manipulator_state_t s)
+{
+    const float* a = manipulator_state_angles[s];
+    return {{a[0], a[1], a[2]}};
+}
+
+TEST_GROUP (AnArmCollisionChecker) {
+    const Box table = {0.1f, 0.2f, -0.05f, 0.05f};
+    ArmWorkspace workspace = {
+        {{0.1f, 0.1f, 0.05f}}, // lengths
+        0.01f, // link_radius
+        0.3f, // shoulder_distance
+        &table, // body
+        1, // body_count
+        {{-3.f, -3.f, -3.f}}, // min_angles
+        {{3.f, 3.f, 3.f}}, // max_angles
+        0.05f, // resolution
+    };
+};
+
+TEST(AnArmCollisionChecker, ComputesDistanceBetweenSegments)
+{
+    Segment a = {0, 0, 1, 0};
+
+    DOUBLES_EQUAL(1, segment_distance(a, {0, 1, 1, 1}), 1e-6);
+    DOUBLES_EQUAL(0, segment_distance(a, {0.5, -1, 0.5, 1}), 1e-6);
+    DOUBLES_EQUAL(sqrtf(2), segment_distance(a, {2, 1, 3, 2}), 1e-6);
+}
+
+TEST(AnArmCollisionChecker, ComputesDistanceToBox)
+{
+    DOUBLES_EQUAL(0, segment_box_distance({0, 0, 0.15, 0}, table), 1e-6);
+    DOUBLES_EQUAL(0, segment_box_distance({0.15, -1, 0.15, 1}, table), 1e-6);
+    DOUBLES_EQUAL(0.05, segment_box_distance({0, 0, 0, 1}, {0.05, 0.1, 0, 1}), 1e-6);
+}
+
+TEST(AnArmCollisionChecker, RejectsBodyAndJointLimits)
+{
+    CHECK_TRUE(arm_collides(workspace, {{0, 0, 0}}));
+    CHECK_FALSE(arm_collides(workspace, {{M_PI / 2, 0, 0}}));
+    CHECK_TRUE(arm_collides(workspace, {{M_PI / 2, 0, 3.1}}));
+}
+
+TEST(AnArmCollisionChecker, ChecksTheOtherArmInItsMirroredFrame)
+{
+    // Both arms reaching towards each other meet in the middle
+    Angles towards_other = {{-M_PI / 2, 0, 0}};
+    CHECK_TRUE(arms_collide(workspace, towards_other, towards_other));
+
+    // The same angles on the other arm point away from us
+    Angles away = {{M_PI / 2, 0, 0}};
+    CHECK_FALSE(arms_collide(workspace, towards_other, away));
+    CHECK_FALSE(arms_collide(workspace, away, towards_other));
+}
+
+TEST(AnArmCollisionChecker, ChecksEveryStepOfAMove)
+{
+    // Sweeping the arm from one side to the other crosses the table
+    CHECK_FALSE(move_is_free(workspace, {{M_PI / 2, 0, 0}}, {{-M_PI / 2, 0, 0}}, nullptr));
+
+    // Going around the back does not
+    CHECK_TRUE(move_is_free(workspace, {{M_PI / 2, 0, 0}}, {{2.5, 0, 0}}, nullptr));
+}
+
+TEST(AnArmCollisionChecker, ChecksTheBlendsOfATrajectory)
+{
+    const Angles limits = {{3, 3, 3}};
+    const Angles accelerations = {{15, 15, 15}};
+    const Angles away = {{M_PI / 2, 0, 0}};
+    const Angles points[3] = {{{0.7, 0.2, 0}}, {{0.5, 0.7, 0}}, {{0.6, -0.3, 0}}};
+    JointTrajectory trajectory;
+
+    // Both straight moves are free, but the arm cuts the corner into the table
+    CHECK_TRUE(move_is_free(workspace, points[0], points[1], &away));
+    CHECK_TRUE(move_is_free(workspace, points[1], points[2], &away));
+    trajectory.plan(points, 3, limits, accelerations);
+    CHECK_FALSE(trajectory_is_free(workspace, trajectory, away, 0.02f));
+
+    trajectory.plan(points, 2, limits, accelerations);
+    CHECK_TRUE(trajectory_is_free(workspace, trajectory, away, 0.02f));
+}
+
+TEST(AnArmCollisionChecker, ChecksBothTrajectoriesAtTheSameTime)
+{
+    const Angles limits = {{3, 3, 3}};
+    const Angles accelerations = {{15, 15, 15}};
+    const Angles towards_other = {{-M_PI / 2, 0, 0}};
+    const Angles points[2] = {{{M_PI / 2, 0, 0}}, towards_other};
+    JointTrajectory trajectory, other;
+
+    // Without the table, the other arm sweeps towards us from the other side
+    workspace.body_count = 0;
+    trajectory.plan(&towards_other, 1, limits, accelerations);
+    other.plan(points, 2, limits, accelerations);
+
+    CHECK_TRUE(trajectory_is_free(workspace, trajectory, points[0], 0.02f));
+    CHECK_FALSE(trajectories_are_free(workspace, trajectory, other, 0.02f));
+}
+
+TEST_GROUP (AnArmRoadmapPlanner) {
+    RoadmapPlanner planner;
+    Angles waypoints[16];
+
+    void check_path_is_free(const Angles& start, int count, const Angles* other)
+    {
+        CHECK_TRUE(move_is_free(arm_workspace, start, waypoints[0], other));
+        for (int i = 1; i < count; i++) {
+            CHECK_TRUE(move_is_free(arm_workspace, waypoints[i - 1], waypoints[i], other));
+        }
+    }
+};
+
+TEST(AnArmRoadmapPlanner, ArmStatesAreFreeOfCollisions)
+{
+    // MANIPULATOR_INIT is not a pose, it names the arm before its first move
+    for (int i = MANIPULATOR_INIT + 1; i < MANIPULATOR_COUNT; i++) {
+        CHECK_FALSE(arm_collides(arm_workspace, state((manipulator_state_t)i)));
+    }
+}
+
+TEST(AnArmRoadmapPlanner, KeepsTheArmsInsideTheRobot)
+{
+    // Stretched towards the alignment border
+    CHECK_TRUE(arm_collides(arm_workspace, {{0, 0, 0}}));
+
+    // Stretched past the side of the other arm, above it
+    CHECK_TRUE(arm_collides(arm_workspace, {{-1.5, 0, 0}}));
+}
+
+TEST(AnArmRoadmapPlanner, GoesStraightWhenPossible)
+{
+    auto start = state(MANIPULATOR_STORE_FRONT_HIGH);
+    auto goal = state(MANIPULATOR_STORE_FRONT_LOW);
+
+    int count = planner.plan(arm_roadmap, arm_workspace, start, goal, nullptr, waypoints, 16);
+
+    CHECK_EQUAL(1, count);
+    for (int i = 0; i < 3; i++) {
+        DOUBLES_EQUAL(goal[i], waypoints[0][i], 1e-6);
+    }
+}
+
+TEST(AnArmRoadmapPlanner, GoesAroundTheOtherArm)
+{
+    auto start = state(MANIPULATOR_STORE_BACK_HIGH);
+    Angles goal = {{-0.89173, 0.20933, 0.85179}};
+    auto other = state(MANIPULATOR_STORE_FRONT_LOW);
+    CHECK_FALSE(move_is_free(arm_workspace, start, goal, &other));
+
+    int count = planner.plan(arm_roadmap, arm_workspace, start, goal, &other, waypoints, 16);
+
+    CHECK_TRUE(count > 1);
+    for (int i = 0; i < 3; i++) {
+        DOUBLES_EQUAL(goal[i], waypoints[count - 1][i], 1e-6);
+    }
+    check_path_is_free(start, count, &other);
+}
+
+TEST(AnArmRoadmapPlanner, FailsWhenTheGoalIsBlocked)
+{
+    auto start = state(MANIPULATOR_STORE_FRONT_HIGH);
+    Angles goal = {{-M_PI / 2, 0, 0}};
+    Angles other = {{-M_PI / 2, 0, 0}};
+
+    CHECK_EQUAL(-1, planner.plan(arm_roadmap, arm_workspace, start, goal, &other, waypoints, 16));
+}
+
+TEST(AnArmRoadmapPlanner, FailsWhenThePathIsTooLong)
+{
+    auto start = state(MANIPULATOR_STORE_BACK_HIGH);
+    Angles goal = {{-0.89173, 0.20933, 0.85179}};
+    auto other = state(MANIPULATOR_STORE_FRONT_LOW);
+
+    CHECK_EQUAL(-1, planner.plan(arm_roadmap, arm_workspace, start, goal, &other, waypoints, 1));
+}
@@ -0,0 +1,85 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+
+extern "C" {
+#include <base/collision_detector.h>
+}
+
+TEST_GROUP (ACollisionDetector) {
+    collision_detector_t detector;
+    collision_detector_params_t params = {
+        100.f, // residual_threshold
+        2.f, // current_threshold
+        3, // cycles
+        0.5f, // opponent_distance
+        0.5f, // opponent_gain
+    };
+
+    void setup()
+    {
+        collision_detector_init(&detector, &params);
+    }
+};
+
+TEST(ACollisionDetector, startsWithoutCollision)
+{
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_get(&detector));
+}
+
+TEST(ACollisionDetector, needsConsecutiveBlockedCycles)
+{
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_update(&detector, 200.f, 3.f, INFINITY));
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_update(&detector, 200.f, 3.f, INFINITY));
+    CHECK_EQUAL(COLLISION_BLOCKED, collision_detector_update(&detector, 200.f, 3.f, INFINITY));
+    CHECK_EQUAL(COLLISION_BLOCKED, collision_detector_get(&detector));
+}
+
+TEST(ACollisionDetector, restartsCountingAfterAFreeCycle)
+{
+    collision_detector_update(&detector, 200.f, 3.f, INFINITY);
+    collision_detector_update(&detector, 200.f, 3.f, INFINITY);
+    collision_detector_update(&detector, 0.f, 0.f, INFINITY);
+    collision_detector_update(&detector, 200.f, 3.f, INFINITY);
+    collision_detector_update(&detector, 200.f, 3.f, INFINITY);
+
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_get(&detector));
+}
+
+TEST(ACollisionDetector, needsBothResidualAndCurrent)
+{
+    for (int i = 0; i < 10; i++) {
+        collision_detector_update(&detector, 200.f, 1.f, INFINITY);
+        collision_detector_update(&detector, 50.f, 3.f, INFINITY);
+    }
+
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_get(&detector));
+}
+
+TEST(ACollisionDetector, usesResidualAloneWithoutCurrent)
+{
+    for (int i = 0; i < 3; i++) {
+        collision_detector_update(&detector, -200.f, NAN, INFINITY);
+    }
+
+    CHECK_EQUAL(COLLISION_BLOCKED, collision_detector_get(&detector));
+}
+
+TEST(ACollisionDetector, triggersInOneCycleWithLowerThresholdsNearOpponent)
+{
+    CHECK_EQUAL(COLLISION_OPPONENT, collision_detector_update(&detector, 60.f, 1.5f, 0.3f));
+
+    DOUBLES_EQUAL(60.f, detector.residual, 1e-6);
+    DOUBLES_EQUAL(1.5f, detector.current, 1e-6);
+    DOUBLES_EQUAL(0.3f, detector.opponent_distance, 1e-6);
+}
+
+TEST(ACollisionDetector, reportsCollisionOnceUntilReset)
+{
+    collision_detector_update(&detector, 200.f, 3.f, 0.3f);
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_update(&detector, 200.f, 3.f, 0.3f));
+    CHECK_EQUAL(COLLISION_OPPONENT, collision_detector_get(&detector));
+
+    collision_detector_reset(&detector);
+    CHECK_EQUAL(COLLISION_NONE, collision_detector_get(&detector));
+    CHECK_EQUAL(COLLISION_OPPONENT, collision_detector_update(&detector, 200.f, 3.f, 0.3f));
+}
@@ -0,0 +1,61 @@
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include <base/control_loop_stats.h>
+}
+
+TEST_GROUP (AControlLoopStats) {
+    control_loop_stats_t stats;
+
+    void setup()
+    {
+        control_loop_stats_init(&stats, 10000);
+    }
+};
+
+TEST(AControlLoopStats, startsEmpty)
+{
+    CHECK_EQUAL(0, stats.cycles);
+    CHECK_EQUAL(0, stats.overruns);
+    DOUBLES_EQUAL(0., control_loop_stats_latency_mean(&stats), 1e-6);
+    DOUBLES_EQUAL(0., control_loop_stats_exec_time_mean(&stats), 1e-6);
+}
+
+TEST(AControlLoopStats, computesMeanAndMax)
+{
+    control_loop_stats_record(&stats, 10, 1000, 0);
+    control_loop_stats_record(&stats, 30, 3000, 0);
+
+    CHECK_EQUAL(2, stats.cycles);
+    CHECK_EQUAL(0, stats.overruns);
+    DOUBLES_EQUAL(20., control_loop_stats_latency_mean(&stats), 1e-6);
+    DOUBLES_EQUAL(2000., control_loop_stats_exec_time_mean(&stats), 1e-6);
+    CHECK_EQUAL(30, stats.latency_max_us);
+    CHECK_EQUAL(3000, stats.exec_time_max_us);
+}
+
+TEST(AControlLoopStats, cycleEndingAfterNextTickIsAnOverrun)
+{
+    control_loop_stats_record(&stats, 100, 9900, 0);
+    CHECK_EQUAL(0, stats.overruns);
+
+    control_loop_stats_record(&stats, 101, 9900, 0);
+    CHECK_EQUAL(1, stats.overruns);
+}
+
+TEST(AControlLoopStats, missedTicksAreOverruns)
+{
+    control_loop_stats_record(&stats, 10, 1000, 2);
+    CHECK_EQUAL(2, stats.overruns);
+}
+
+TEST(AControlLoopStats, windowResetKeepsTotals)
+{
+    control_loop_stats_record(&stats, 10, 20000, 1);
+    control_loop_stats_window_reset(&stats);
+
+    CHECK_EQUAL(1, stats.cycles);
+    CHECK_EQUAL(2, stats.overruns);
+    CHECK_EQUAL(0, stats.exec_time_max_us);
+    DOUBLES_EQUAL(0., control_loop_stats_exec_time_mean(&stats), 1e-6);
+}
@@ -0,0 +1,104 @@
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include <base/encoder_velocity.h>
+}
+
+TEST_GROUP (AnEncoderVelocity) {
+    const float low_speed = 2000;
+    const int32_t ticks_per_edge = 4;
+    const uint32_t period_us = 10000;
+
+    encoder_velocity_t enc;
+    uint32_t now_us;
+    double position;
+
+    void setup()
+    {
+        now_us = 0;
+        position = 0;
+        encoder_velocity_init(&enc, low_speed, ticks_per_edge, 0, now_us);
+    }
+
+    /* Moves a simulated wheel at the given speed for one update period,
+     * capturing the first edge in the period like the timer does. */
+    float run(double ticks_per_s)
+    {
+        bool captured = false;
+        for (uint32_t t = 1; t <= period_us; t++) {
+            double previous = position;
+            position += ticks_per_s * 1e-6;
+            if (!captured && floor(previous / ticks_per_edge) != floor(position / ticks_per_edge)) {
+                int32_t edge = ticks_per_edge * (int32_t)floor(fmax(previous, position) / ticks_per_edge);
+                encoder_velocity_capture(&enc, edge, now_us + t);
+                captured = true;
+            }
+        }
+        now_us += period_us;
+        return encoder_velocity_update(&enc, (int32_t)floor(position), now_us);
+    }
+};
+
+TEST(AnEncoderVelocity, startsAtRest)
+{
+    DOUBLES_EQUAL(0, encoder_velocity_update(&enc, 0, period_us), 1e-6);
+}
+
+TEST(AnEncoderVelocity, countsTicksAtHighSpeed)
+{
+    float velocity = 0;
+    for (int i = 0; i < 10; i++) {
+        velocity = run(50000);
+    }
+
+    DOUBLES_EQUAL(50000, velocity, 100);
+}
+
+TEST(AnEncoderVelocity, usesEdgePeriodsAtLowSpeed)
+{
+    /* A few ticks per second, counting would give either 0 or 100 ticks/s */
+    for (int i = 0; i < 100; i++) {
+        run(30);
+    }
+
+    for (int i = 0; i < 100; i++) {
+        DOUBLES_EQUAL(30, run(30), 0.1);
+    }
+}
+
+TEST(AnEncoderVelocity, worksBackwards)
+{
+    for (int i = 0; i < 100; i++) {
+        run(-30);
+    }
+
+    DOUBLES_EQUAL(-30, run(-30), 0.1);
+}
+
+TEST(AnEncoderVelocity, decaysToZeroWhenStopping)
+{
+    for (int i = 0; i < 100; i++) {
+        run(100);
+    }
+    DOUBLES_EQUAL(100, run(100), 0.5);
+
+    float velocity = 0;
+    for (int i = 0; i < 100; i++) {
+        velocity = run(0);
+        CHECK(velocity >= 0);
+    }
+
+    CHECK(velocity < 5);
+}
+
+TEST(AnEncoderVelocity, handlesTimestampOverflow)
+{
+    now_us = UINT32_MAX - 50 * period_us;
+    encoder_velocity_init(&enc, low_speed, ticks_per_edge, 0, now_us);
+
+    for (int i = 0; i < 100; i++) {
+        run(30);
+    }
+
+    DOUBLES_EQUAL(30, run(30), 0.1);
+}
@@ -0,0 +1,127 @@
+#include <CppUTest/TestHarness.h>
+
+#include <math.h>
+
+#include "manipulator/joint_trajectory.h"
+
+using manipulator::Angles;
+using manipulator::JointTrajectory;
+using manipulator::TrajectorySample;
+
+namespace {
+void ANGLES_EQUAL(const Angles& lhs, const Angles& rhs, float tolerance)
+{
+    DOUBLES_EQUAL(lhs[0], rhs[0], tolerance);
+    DOUBLES_EQUAL(lhs[1], rhs[1], tolerance);
+    DOUBLES_EQUAL(lhs[2], rhs[2], tolerance);
+}
+
+/* Time needed to go to rest to rest over the given distance */
+float stop_and_go_duration(float distance, float max_velocity, float max_acceleration)
+{
+    if (distance * max_acceleration < max_velocity * max_velocity) {
+        return 2 * sqrtf(distance / max_acceleration);
+    }
+    return distance / max_velocity + max_velocity / max_acceleration;
+}
+} // namespace
+
+TEST_GROUP (AJointTrajectory) {
+    JointTrajectory traj;
+    const Angles max_velocity = {{3.f, 2.f, 4.f}};
+    const Angles max_acceleration = {{20.f, 10.f, 30.f}};
+    const float dt = 1e-3f;
+};
+
+TEST(AJointTrajectory, rejectsInvalidInputs)
+{
+    Angles points[2] = {{{0, 0, 0}}, {{1, 1, 1}}};
+
+    CHECK_FALSE(traj.plan(points, 0, max_velocity, max_acceleration));
+    CHECK_FALSE(traj.plan(points, JointTrajectory::MaxPoints + 1, max_velocity, max_acceleration));
+    CHECK_FALSE(traj.plan(points, 2, {{3.f, 0.f, 4.f}}, max_acceleration));
+    CHECK_FALSE(traj.plan(points, 2, max_velocity, {{20.f, 10.f, -1.f}}));
+}
+
+TEST(AJointTrajectory, singlePointHoldsPosition)
+{
+    Angles point = {{0.1f, 0.2f, 0.3f}};
+    CHECK_TRUE(traj.plan(&point, 1, max_velocity, max_acceleration));
+
+    DOUBLES_EQUAL(0, traj.duration(), 1e-6);
+    ANGLES_EQUAL(point, traj.sample(0.5f).position, 1e-6);
+    ANGLES_EQUAL({{0, 0, 0}}, traj.sample(0.5f).velocity, 1e-6);
+}
+
+TEST(AJointTrajectory, singleSegmentIsATrapezoidOnTheSlowestJoint)
+{
+    Angles points[2] = {{{0, 0, 0}}, {{0.5f, 1.f, -0.2f}}};
+    CHECK_TRUE(traj.plan(points, 2, max_velocity, max_acceleration));
+
+    /* Joint 2 needs 1 / 2 + 2 / 10 seconds at full speed */
+    DOUBLES_EQUAL(0.7, traj.duration(), 1e-3);
+    DOUBLES_EQUAL(max_velocity[1], traj.sample(traj.duration() / 2).velocity[1], 1e-3);
+}
+
+TEST(AJointTrajectory, startsAndEndsAtRestOnTheEndpoints)
+{
+    Angles points[3] = {{{0, 0, 0}}, {{1, -0.5f, 0.3f}}, {{0.2f, 0.5f, 1.f}}};
+    CHECK_TRUE(traj.plan(points, 3, max_velocity, max_acceleration));
+
+    TrajectorySample start = traj.sample(0);
+    ANGLES_EQUAL(points[0], start.position, 1e-6);
+    ANGLES_EQUAL({{0, 0, 0}}, start.velocity, 1e-6);
+
+    TrajectorySample end = traj.sample(traj.duration());
+    ANGLES_EQUAL(points[2], end.position, 1e-5);
+    ANGLES_EQUAL({{0, 0, 0}}, end.velocity, 1e-6);
+
+    ANGLES_EQUAL(points[2], traj.sample(traj.duration() + 1).position, 1e-6);
+}
+
+TEST(AJointTrajectory, isContinuousAndWithinLimits)
+{
+    Angles points[4] = {{{0, 0, 0}}, {{1, -0.5f, 0.3f}}, {{1.2f, 0.5f, 1.f}}, {{-0.3f, 0.6f, 0.f}}};
+    CHECK_TRUE(traj.plan(points, 4, max_velocity, max_acceleration));
+
+    TrajectorySample previous = traj.sample(0);
+    for (float t = dt; t < traj.duration() + 0.1f; t += dt) {
+        TrajectorySample s = traj.sample(t);
+        for (size_t j = 0; j < 3; j++) {
+            CHECK(fabsf(s.velocity[j]) <= max_velocity[j] * 1.001f);
+            CHECK(fabsf(s.acceleration[j]) <= max_acceleration[j] * 1.001f);
+
+            /* The position follows the velocity, which follows the acceleration */
+            DOUBLES_EQUAL(s.position[j], previous.position[j] + dt * (s.velocity[j] + previous.velocity[j]) / 2, 1e-5);
+            CHECK(fabsf(s.velocity[j] - previous.velocity[j]) <= max_acceleration[j] * dt * 1.001f);
+        }
+        previous = s;
+    }
+}
+
+TEST(AJointTrajectory, passesNearIntermediateWaypoints)
+{
+    Angles points[3] = {{{0, 0, 0}}, {{1, 0.5f, 0.f}}, {{1, 1.5f, 1.f}}};
+    CHECK_TRUE(traj.plan(points, 3, max_velocity, max_acceleration));
+
+    float closest = INFINITY;
+    for (float t = 0; t < traj.duration(); t += dt) {
+        Angles p = traj.sample(t).position;
+        float distance = sqrtf(powf(p[0] - points[1][0], 2) + powf(p[1] - points[1][1], 2) + powf(p[2] - points[1][2], 2));
+        closest = fminf(closest, distance);
+    }
+
+    CHECK(closest < 0.1f);
+}
+
+TEST(AJointTrajectory, isFasterThanStoppingAtEachWaypoint)
+{
+    Angles points[3] = {{{0, 0, 0}}, {{1, 0, 0}}, {{2, 0, 0}}};
+    CHECK_TRUE(traj.plan(points, 3, max_velocity, max_acceleration));
+
+    float stop_and_go = 2 * stop_and_go_duration(1, max_velocity[0], max_acceleration[0]);
+
+    /* Going through aligned waypoints costs nothing */
+    DOUBLES_EQUAL(stop_and_go_duration(2, max_velocity[0], max_acceleration[0]), traj.duration(), 1e-3);
+    CHECK(traj.duration() < stop_and_go - 0.1f);
+}
@@ -0,0 +1,75 @@
+#include <CppUTest/TestHarness.h>
+
+extern "C" {
+#include <base/odometry_history.h>
+}
+
+TEST_GROUP (AnOdometryHistory) {
+    odometry_history_t history;
+    float dx, dy;
+
+    void setup()
+    {
+        odometry_history_init(&history);
+    }
+};
+
+TEST(AnOdometryHistory, IsEmptyAfterInit)
+{
+    CHECK_FALSE(odometry_history_motion_since(&history, 0, &dx, &dy));
+}
+
+TEST(AnOdometryHistory, HasNoMotionSinceTheLastUpdate)
+{
+    odometry_history_push(&history, 1000, 10, 20);
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 1000, &dx, &dy));
+    DOUBLES_EQUAL(0, dx, 1e-6);
+    DOUBLES_EQUAL(0, dy, 1e-6);
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 1500, &dx, &dy));
+    DOUBLES_EQUAL(0, dx, 1e-6);
+}
+
+TEST(AnOdometryHistory, AddsTheIncrementsSinceAGivenTime)
+{
+    odometry_history_push(&history, 1000, 1, 0);
+    odometry_history_push(&history, 2000, 2, -1);
+    odometry_history_push(&history, 3000, 4, -2);
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 1000, &dx, &dy));
+    DOUBLES_EQUAL(6, dx, 1e-6);
+    DOUBLES_EQUAL(-3, dy, 1e-6);
+}
+
+TEST(AnOdometryHistory, InterpolatesBetweenUpdates)
+{
+    odometry_history_push(&history, 1000, 0, 0);
+    odometry_history_push(&history, 2000, 10, 20);
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 1250, &dx, &dy));
+    DOUBLES_EQUAL(7.5, dx, 1e-6);
+    DOUBLES_EQUAL(15, dy, 1e-6);
+}
+
+TEST(AnOdometryHistory, RejectsTimesOlderThanTheHistory)
+{
+    for (int i = 0; i < ODOMETRY_HISTORY_LEN + 1; i++) {
+        odometry_history_push(&history, 1000 * (i + 1), 1, 0);
+    }
+
+    // The first update was overwritten
+    CHECK_FALSE(odometry_history_motion_since(&history, 1500, &dx, &dy));
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 2000, &dx, &dy));
+    DOUBLES_EQUAL(ODOMETRY_HISTORY_LEN - 1, dx, 1e-6);
+}
+
+TEST(AnOdometryHistory, WorksAcrossTimestampOverflow)
+{
+    odometry_history_push(&history, UINT32_MAX - 499, 0, 0);
+    odometry_history_push(&history, 500, 10, 0);
+
+    CHECK_TRUE(odometry_history_motion_since(&history, 0, &dx, &dy));
+    DOUBLES_EQUAL(5, dx, 1e-3);
+}
@@ -0,0 +1,161 @@
+#include <CppUTest/TestHarness.h>
+#include <cmath>
+#include <random>
+
+#include "base/pose_estimator.hpp"
+
+TEST_GROUP (APoseEstimator) {
+    PoseEstimator estimator;
+
+    void setup()
+    {
+        estimator.reset(500, 1000, 0, 1, 1e-4);
+    }
+};
+
+TEST(APoseEstimator, startsFromTheGivenPose)
+{
+    DOUBLES_EQUAL(500, estimator.state(0), 1e-3);
+    DOUBLES_EQUAL(1000, estimator.state(1), 1e-3);
+    DOUBLES_EQUAL(0, estimator.state(2), 1e-6);
+    DOUBLES_EQUAL(1, estimator.covariance(0, 0), 1e-6);
+    DOUBLES_EQUAL(1e-4, estimator.covariance(2, 2), 1e-9);
+}
+
+TEST(APoseEstimator, followsOdometry)
+{
+    estimator.predict(100, 0);
+    estimator.predict(0, M_PI / 2);
+    estimator.predict(100, 0);
+
+    DOUBLES_EQUAL(600, estimator.state(0), 1e-2);
+    DOUBLES_EQUAL(1100, estimator.state(1), 1e-2);
+    DOUBLES_EQUAL(M_PI / 2, estimator.state(2), 1e-5);
+}
+
+TEST(APoseEstimator, movingIncreasesUncertaintyMostlyAlongTrack)
+{
+    estimator.predict(1000, 0);
+
+    CHECK(estimator.covariance(0, 0) > 1);
+    CHECK(estimator.covariance(1, 1) > 1);
+
+    /* the heading uncertainty becomes a lateral one */
+    estimator.reset(500, 1000, 0, 1, 1e-2);
+    estimator.predict(1000, 0);
+    CHECK(estimator.covariance(1, 1) > estimator.covariance(0, 0));
+}
+
+TEST(APoseEstimator, wrapsHeading)
+{
+    estimator.reset(0, 0, 3, 1, 1e-4);
+    estimator.predict(0, 0.5);
+
+    DOUBLES_EQUAL(3.5 - 2 * M_PI, estimator.state(2), 1e-5);
+}
+
+TEST(APoseEstimator, positionFixPullsEstimateAndReducesUncertainty)
+{
+    estimator.reset(500, 1000, 0, 100 * 100, 1e-4);
+
+    CHECK_TRUE(estimator.correctPosition(550, 1000, 100 * 100));
+
+    DOUBLES_EQUAL(525, estimator.state(0), 1e-2);
+    DOUBLES_EQUAL(1000, estimator.state(1), 1e-2);
+    DOUBLES_EQUAL(50 * 50 * 2, estimator.covariance(0, 0), 1e-1);
+}
+
+TEST(APoseEstimator, rejectsOutliers)
+{
+    estimator.reset(500, 1000, 0, 10 * 10, 1e-4);
+
+    CHECK_FALSE(estimator.correctPosition(1500, 1000, 50 * 50));
+
+    DOUBLES_EQUAL(500, estimator.state(0), 1e-3);
+    DOUBLES_EQUAL(10 * 10, estimator.covariance(0, 0), 1e-3);
+}
+
+TEST(APoseEstimator, positionFixesCorrectHeadingThroughMotion)
+{
+    /* The robot thinks it goes along x but drifts towards y */
+    estimator.reset(0, 0, 0, 1, 0.01);
+    for (int i = 1; i <= 10; i++) {
+        estimator.predict(100, 0);
+        estimator.correctPosition(100 * i * std::cos(0.1), 100 * i * std::sin(0.1), 10 * 10);
+    }
+
+    DOUBLES_EQUAL(0.1, estimator.state(2), 0.02);
+}
+
+TEST(APoseEstimator, headingFixWrapsAround)
+{
+    estimator.reset(0, 0, M_PI - 0.05, 1, 0.1);
+
+    CHECK_TRUE(estimator.correctHeading(-M_PI + 0.05, 0.1));
+
+    DOUBLES_EQUAL(M_PI, std::fabs(estimator.state(2)), 1e-3);
+    DOUBLES_EQUAL(0.05, estimator.covariance(2, 2), 1e-5);
+}
+
+TEST(APoseEstimator, covarianceStaysSymmetric)
+{
+    estimator.predict(300, 0.3);
+    estimator.correctPosition(790, 1090, 50 * 50);
+    estimator.predict(200, -0.5);
+    estimator.correctHeading(-0.2, 0.01);
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(estimator.covariance(i, i) > 0);
+        for (int j = 0; j < 3; j++) {
+            DOUBLES_EQUAL(estimator.covariance(i, j), estimator.covariance(j, i), 1e-3);
+        }
+    }
+}
+
+/* Drives a square with odometry which overestimates distances and turns, and
+ * noisy UWB fixes at 10 Hz: the fused pose must stay closer to the truth than
+ * dead reckoning. */
+TEST(APoseEstimator, fusionBeatsDeadReckoning)
+{
+    const float uwb_std_dev = 50;
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0, uwb_std_dev);
+
+    PoseEstimator dead_reckoning;
+    float x = 500, y = 500, a = 0;
+    estimator.reset(x, y, a, 1, 1e-4);
+    dead_reckoning.reset(x, y, a, 1, 1e-4);
+
+    float fused_error = 0, odometry_error = 0;
+
+    for (int lap = 0; lap < 3; lap++) {
+        for (int side = 0; side < 4; side++) {
+            /* 1 m at 0.5 m/s, sampled at 100 Hz, then a quarter turn */
+            for (int i = 0; i < 200; i++) {
+                float distance = 5, angle = 0;
+                if (i >= 190) {
+                    distance = 0;
+                    angle = M_PI / 20;
+                }
+
+                x += distance * std::cos(a + angle / 2);
+                y += distance * std::sin(a + angle / 2);
+                a += angle;
+
+                estimator.predict(distance * 1.02f, angle * 1.01f);
+                dead_reckoning.predict(distance * 1.02f, angle * 1.01f);
+
+                if (i % 10 == 0) {
+                    estimator.correctPosition(x + noise(rng), y + noise(rng), uwb_std_dev * uwb_std_dev);
+                }
+            }
+        }
+
+        fused_error = std::hypot(estimator.state(0) - x, estimator.state(1) - y);
+        odometry_error = std::hypot(dead_reckoning.state(0) - x, dead_reckoning.state(1) - y);
+    }
+
+    CHECK(odometry_error > 100);
+    CHECK(fused_error < 3 * uwb_std_dev);
+    CHECK(fused_error < odometry_error / 2);
+}
@@ -176,3 +176,71 @@ TEST(AScaraJointAnglesComputer, wrapsBetaWhenHigherThanMinusPi)
     CHECK_TRUE(solution_found);
     DOUBLES_EQUAL(-0.5 * M_PI, beta, 0.1);
 }
+
+TEST_GROUP (AScaraBatchSolver) {
+    float length[2] = {100, 50};
+    static const int count = 200;
+    float x[count], y[count];
+    float alpha[count], beta[count];
+    bool reachable[count];
+    shoulder_mode_t modes[count];
+
+    void setup()
+    {
+        /* A grid around the arm which never falls on x = 0, where both elbow
+         * positions are equally good. */
+        for (int i = 0; i < count; i++) {
+            x[i] = -175.5f + 17.f * (i % 20);
+            y[i] = -175.f + 35.f * (i / 20);
+            modes[i] = i % 3 ? SHOULDER_BACK : SHOULDER_FRONT;
+            alpha[i] = beta[i] = 42;
+        }
+    }
+};
+
+TEST(AScaraBatchSolver, findsTheSameSolutionsAsTheSingleTargetSolver)
+{
+    int reachable_count = scara_compute_joint_angles_batch(count, x, y, modes, length, alpha, beta, reachable);
+
+    int expected_count = 0;
+    for (int i = 0; i < count; i++) {
+        float expected_alpha, expected_beta;
+        bool expected = scara_compute_joint_angles({x[i], y[i]}, modes[i], length, &expected_alpha, &expected_beta);
+
+        CHECK_EQUAL(expected, reachable[i]);
+        if (expected) {
+            expected_count++;
+            DOUBLES_EQUAL(expected_alpha, alpha[i], 1e-3);
+            DOUBLES_EQUAL(expected_beta, beta[i], 1e-3);
+        }
+    }
+
+    CHECK(expected_count > 0);
+    CHECK_EQUAL(expected_count, reachable_count);
+}
+
+TEST(AScaraBatchSolver, reachesTheTargets)
+{
+    scara_compute_joint_angles_batch(count, x, y, modes, length, alpha, beta, reachable);
+
+    for (int i = 0; i < count; i++) {
+        if (reachable[i]) {
+            point_t hand = scara_forward_kinematics(alpha[i], beta[i], length);
+            DOUBLES_EQUAL(x[i], hand.x, 1e-2);
+            DOUBLES_EQUAL(y[i], hand.y, 1e-2);
+        }
+    }
+}
+
+TEST(AScaraBatchSolver, leavesUnreachableTargetsUntouched)
+{
+    const float far_x[2] = {200, 10}, far_y[2] = {0, 20};
+
+    int reachable_count = scara_compute_joint_angles_batch(2, far_x, far_y, modes, length, alpha, beta, reachable);
+
+    CHECK_EQUAL(0, reachable_count);
+    CHECK_FALSE(reachable[0]);
+    CHECK_FALSE(reachable[1]);
+    DOUBLES_EQUAL(42, alpha[0], 1e-6);
+    DOUBLES_EQUAL(42, beta[1], 1e-6);
+}
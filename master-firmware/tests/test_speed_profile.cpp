@@ -0,0 +1,174 @@
+#include <CppUTest/TestHarness.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+#include <parameter/parameter_port.h>
+#include <aversive/position_manager/position_manager.h>
+#include <aversive/robot_system/robot_system.h>
+#include <aversive/trajectory_manager/trajectory_manager_utils.h>
+#include <base/speed_profile.h>
+}
+
+void parameter_port_lock(void)
+{
+}
+
+void parameter_port_unlock(void)
+{
+}
+
+void parameter_port_assert(int condition)
+{
+    CHECK_TRUE(condition);
+}
+
+void* parameter_port_buffer_alloc(size_t size)
+{
+    return malloc(size);
+}
+
+void parameter_port_buffer_free(void* buffer)
+{
+    free(buffer);
+}
+
+TEST_GROUP (ASpeedProfileTable) {
+    const int ARBITRARY_TRACK_LENGTH_MM = 200;
+    const int ARBITRARY_ENCODER_TICKS_PER_MM = 100;
+    const int ARBITRARY_CONTROL_FREQUENCY = 100;
+
+    struct robot_system rs;
+    struct robot_position pos;
+    struct trajectory traj;
+
+    parameter_namespace_t root, master, aversive, trajectories, distance, angle;
+    parameter_namespace_t distance_speed, distance_acc, angle_speed, angle_acc;
+    parameter_t params[4][BASE_SPEED_COUNT];
+    const char* names[BASE_SPEED_COUNT] = {"init", "slow", "fast"};
+
+    speed_profile_table_t table;
+
+    void setup()
+    {
+        rs_init(&rs);
+        position_init(&pos);
+        position_set_physical_params(&pos, ARBITRARY_TRACK_LENGTH_MM, ARBITRARY_ENCODER_TICKS_PER_MM);
+        trajectory_manager_init(&traj, ARBITRARY_CONTROL_FREQUENCY);
+        trajectory_set_robot_params(&traj, &rs, &pos);
+
+        /* Same layout as the robot config */
+        parameter_namespace_declare(&root, NULL, NULL);
+        parameter_namespace_declare(&master, &root, "master");
+        parameter_namespace_declare(&aversive, &master, "aversive");
+        parameter_namespace_declare(&trajectories, &aversive, "trajectories");
+        parameter_namespace_declare(&distance, &trajectories, "distance");
+        parameter_namespace_declare(&angle, &trajectories, "angle");
+        parameter_namespace_declare(&distance_speed, &distance, "speed");
+        parameter_namespace_declare(&distance_acc, &distance, "acceleration");
+        parameter_namespace_declare(&angle_speed, &angle, "speed");
+        parameter_namespace_declare(&angle_acc, &angle, "acceleration");
+
+        for (int i = 0; i < BASE_SPEED_COUNT; i++) {
+            parameter_scalar_declare_with_default(&params[0][i], &distance_speed, names[i], 0.125 * (i + 1));
+            parameter_scalar_declare_with_default(&params[1][i], &distance_acc, names[i], 0.5 * (i + 1));
+            parameter_scalar_declare_with_default(&params[2][i], &angle_speed, names[i], 1. * (i + 1));
+            parameter_scalar_declare_with_default(&params[3][i], &angle_acc, names[i], 2. * (i + 1));
+        }
+
+        CHECK_TRUE(speed_profile_table_init(&table, &trajectories));
+        speed_profile_table_update(&table, &traj);
+    }
+};
+
+TEST(ASpeedProfileTable, convertsParametersToTrajectoryUnits)
+{
+    auto profile = speed_profile_get(&table, BASE_SPEED_FAST);
+
+    DOUBLES_EQUAL(1000 * speed_mm2imp(&traj, 0.375), profile->distance_speed, 1e-6);
+    DOUBLES_EQUAL(1000 * acc_mm2imp(&traj, 1.5), profile->distance_acc, 1e-6);
+    DOUBLES_EQUAL(speed_rd2imp(&traj, 3.), profile->angle_speed, 1e-6);
+    DOUBLES_EQUAL(acc_rd2imp(&traj, 6.), profile->angle_acc, 1e-6);
+}
+
+TEST(ASpeedProfileTable, consumesParameterChanges)
+{
+    parameter_scalar_set(&params[0][BASE_SPEED_SLOW], 0.25);
+    CHECK_TRUE(parameter_namespace_contains_changed(&root));
+
+    speed_profile_table_update(&table, &traj);
+
+    CHECK_FALSE(parameter_namespace_contains_changed(&root));
+    DOUBLES_EQUAL(1000 * speed_mm2imp(&traj, 0.25), speed_profile_get(&table, BASE_SPEED_SLOW)->distance_speed, 1e-6);
+}
+
+TEST(ASpeedProfileTable, followsOdometryChanges)
+{
+    double before = speed_profile_get(&table, BASE_SPEED_INIT)->angle_speed;
+
+    position_set_physical_params(&pos, 2 * ARBITRARY_TRACK_LENGTH_MM, ARBITRARY_ENCODER_TICKS_PER_MM);
+    speed_profile_table_update(&table, &traj);
+
+    DOUBLES_EQUAL(2 * before, speed_profile_get(&table, BASE_SPEED_INIT)->angle_speed, 1e-6);
+}
+
+TEST(ASpeedProfileTable, appliesProfileToTrajectory)
+{
+    auto profile = speed_profile_get(&table, BASE_SPEED_SLOW);
+
+    speed_profile_apply(profile, &traj);
+
+    DOUBLES_EQUAL(profile->distance_speed, traj.d_speed, 1e-6);
+    DOUBLES_EQUAL(profile->angle_speed, traj.a_speed, 1e-6);
+    DOUBLES_EQUAL(profile->distance_acc, traj.d_acc, 1e-6);
+    DOUBLES_EQUAL(profile->angle_acc, traj.a_acc, 1e-6);
+}
+
+TEST(ASpeedProfileTable, rejectsInvalidSpeed)
+{
+    POINTERS_EQUAL(NULL, speed_profile_get(&table, BASE_SPEED_COUNT));
+}
+
+TEST(ASpeedProfileTable, reportsMissingParameters)
+{
+    parameter_namespace_t empty;
+    parameter_namespace_declare(&empty, NULL, NULL);
+
+    CHECK_FALSE(speed_profile_table_init(&table, &empty));
+}
+
+/* Compares the per cycle cost of the former lookups by path, as done by
+ * config_get_scalar(), with the table. */
+TEST(ASpeedProfileTable, Benchmark)
+{
+    const int cycles = 100000;
+    volatile double sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cycles; i++) {
+        trajectory_set_speed(&traj,
+                             1000 * speed_mm2imp(&traj, parameter_scalar_get(parameter_find(&root, "master/aversive/trajectories/distance/speed/slow"))),
+                             speed_rd2imp(&traj, parameter_scalar_get(parameter_find(&root, "master/aversive/trajectories/angle/speed/slow"))));
+        trajectory_set_acc(&traj,
+                           1000 * acc_mm2imp(&traj, parameter_scalar_get(parameter_find(&root, "master/aversive/trajectories/distance/acceleration/slow"))),
+                           acc_rd2imp(&traj, parameter_scalar_get(parameter_find(&root, "master/aversive/trajectories/angle/acceleration/slow"))));
+        sink = sink + traj.d_speed;
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < cycles; i++) {
+        speed_profile_apply(speed_profile_get(&table, BASE_SPEED_SLOW), &traj);
+        sink = sink + traj.d_speed;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double lookup_ns = std::chrono::duration<double, std::nano>(middle - start).count() / cycles;
+    double table_ns = std::chrono::duration<double, std::nano>(end - middle).count() / cycles;
+
+    char report[128];
+    snprintf(report, sizeof(report), "lookup by path: %.1f ns/cycle, table: %.1f ns/cycle",
+             lookup_ns, table_ns);
+    UT_PRINT(report);
+
+    CHECK(table_ns < lookup_ns);
+}
@@ -9,6 +9,7 @@ extern "C" {
 #include "robot_helpers/math_helpers.h"
 #include "robot_helpers/strategy_helpers.h"
 #include "base/map_server.h"
+#include "base/pose_fusion.h"
 
 TEST_GROUP (ACubePositionComputer) {
     void POINT_EQUAL(point_t lhs, point_t rhs, double tolerance = 0.01)
@@ -97,6 +98,10 @@ void map_server_map_release(struct _map* map_ptr)
     POINTERS_EQUAL(&map, map_ptr);
 }
 
+void pose_fusion_reset(void)
+{
+}
+
 TEST_GROUP (ADistanceToTargetPosition) {
     void setup()
     {
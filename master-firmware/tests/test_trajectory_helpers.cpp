@@ -316,6 +316,15 @@ TEST_GROUP (TrajectoryHasEnded) {
         bd_set_thresholds(&robot.distance_bd, 1, 1);
         bd_set_thresholds(&robot.angle_bd, 1, 1);
 
+        collision_detector_params_t collision = {
+            100., // residual_threshold
+            1., // current_threshold
+            1, // cycles
+            0., // opponent_distance
+            1., // opponent_gain
+        };
+        collision_detector_init(&robot.collision, &collision);
+
         rs_init(&robot.rs);
         position_init(&robot.pos);
         position_set(&robot.pos, 0, 0, 0);
@@ -465,6 +474,19 @@ TEST(TrajectoryHasEnded, DetectsCollisionInAngle)
     CHECK_EQUAL(TRAJ_END_COLLISION, traj_end_reason);
 }
 
+TEST(TrajectoryHasEnded, ReportsStopOnCollisionRatherThanGoalReached)
+{
+    collision_detector_update(&robot.collision, 200., 2., INFINITY);
+    trajectory_hardstop(&robot.traj);
+
+    robot_manage();
+    robot_manage();
+
+    CHECK_TRUE(trajectory_finished(&robot.traj));
+    CHECK_EQUAL(TRAJ_END_COLLISION, trajectory_has_ended(TRAJ_END_GOAL_REACHED | TRAJ_END_COLLISION));
+    CHECK_EQUAL(TRAJ_END_GOAL_REACHED, trajectory_has_ended(TRAJ_END_GOAL_REACHED));
+}
+
 TEST(TrajectoryHasEnded, ReturnsZeroWhenNoReasonSpecifiedEvenIfCollisionInDistance)
 {
     /* Align angle */
@@ -0,0 +1,154 @@
+#include <CppUTest/TestHarness.h>
+#include "time_sync.h"
+
+TEST_GROUP (TimeSyncConversionTestGroup) {
+    timestamp_t local_stamp = 0;
+    int32_t latency = 0;
+};
+
+TEST(TimeSyncConversionTestGroup, ConvertsStampToLocalTime)
+{
+    CHECK_TRUE(time_sync_remote_to_local(1000, 1500, 20000, &local_stamp, &latency));
+
+    CHECK_EQUAL(19500, local_stamp);
+    CHECK_EQUAL(500, latency);
+}
+
+TEST(TimeSyncConversionTestGroup, HandlesStampWrapAround)
+{
+    CHECK_TRUE(time_sync_remote_to_local(0xfffff0, 0x10, 20000, &local_stamp, &latency));
+
+    CHECK_EQUAL(0x20, latency);
+    CHECK_EQUAL(20000 - 0x20, local_stamp);
+}
+
+TEST(TimeSyncConversionTestGroup, IgnoresBusTimeBitsNotInTheStamp)
+{
+    CHECK_TRUE(time_sync_remote_to_local(1000, 0x3000000 + 1500, 20000, &local_stamp, &latency));
+
+    CHECK_EQUAL(500, latency);
+}
+
+TEST(TimeSyncConversionTestGroup, HandlesLocalClockWrapAround)
+{
+    CHECK_TRUE(time_sync_remote_to_local(1000, 1100, 50, &local_stamp, &latency));
+
+    CHECK_EQUAL((timestamp_t)(50 - 100), local_stamp);
+}
+
+TEST(TimeSyncConversionTestGroup, RejectsStampFromTheFuture)
+{
+    local_stamp = 42;
+    CHECK_FALSE(time_sync_remote_to_local(2000, 1000, 20000, &local_stamp, &latency));
+
+    CHECK_EQUAL(42, local_stamp);
+}
+
+TEST(TimeSyncConversionTestGroup, RejectsStaleStamp)
+{
+    CHECK_FALSE(time_sync_remote_to_local(0, TIME_SYNC_MAX_LATENCY_US + 1, 0, &local_stamp, &latency));
+}
+
+TEST_GROUP (TimeSyncLatencyTestGroup) {
+    time_sync_latency_t latency;
+
+    void setup() override
+    {
+        time_sync_latency_reset(&latency);
+    }
+};
+
+TEST(TimeSyncLatencyTestGroup, StartsEmpty)
+{
+    CHECK_EQUAL(0, latency.count);
+    CHECK_EQUAL(0, latency.rejected);
+    CHECK_EQUAL(0, time_sync_latency_mean_us(&latency));
+}
+
+TEST(TimeSyncLatencyTestGroup, KeepsMinMaxAndMean)
+{
+    time_sync_latency_update(&latency, 300);
+    time_sync_latency_update(&latency, 100);
+    time_sync_latency_update(&latency, 200);
+
+    CHECK_EQUAL(100, latency.min_us);
+    CHECK_EQUAL(300, latency.max_us);
+    CHECK_EQUAL(200, time_sync_latency_mean_us(&latency));
+    CHECK_EQUAL(3, latency.count);
+}
+
+TEST(TimeSyncLatencyTestGroup, CountsRejectedStamps)
+{
+    time_sync_latency_reject(&latency);
+
+    CHECK_EQUAL(1, latency.rejected);
+    CHECK_EQUAL(0, latency.count);
+}
+
+TEST_GROUP (TimeSyncSkewTestGroup) {
+    /* Simulates boards sampling at the same bus time, with a given clock
+     * offset and a transmission delay that depends on bus load. */
+    void receive(time_sync_latency_t* latency, int32_t offset_us, uint32_t sample_time, uint32_t delay_us)
+    {
+        timestamp_t local_stamp;
+        int32_t latency_us;
+        uint32_t remote_stamp = sample_time + offset_us;
+        uint32_t bus_now = sample_time + delay_us;
+
+        if (time_sync_remote_to_local(remote_stamp, bus_now, bus_now, &local_stamp, &latency_us)) {
+            time_sync_latency_update(latency, latency_us);
+        } else {
+            time_sync_latency_reject(latency);
+        }
+    }
+};
+
+TEST(TimeSyncSkewTestGroup, MeasuresSkewBetweenBoards)
+{
+    time_sync_latency_t left, right;
+    time_sync_latency_reset(&left);
+    time_sync_latency_reset(&right);
+
+    const uint32_t delays[] = {250, 400, 260, 900, 310};
+
+    for (int i = 0; i < 5; i++) {
+        uint32_t t = 1000000 + 10000 * i;
+        receive(&left, 0, t, delays[i]);
+        receive(&right, -40, t, delays[(i + 2) % 5]);
+    }
+
+    CHECK_EQUAL(-40, time_sync_skew_us(&left, &right));
+    CHECK_EQUAL(0, left.rejected);
+    CHECK_EQUAL(0, right.rejected);
+}
+
+TEST(TimeSyncSkewTestGroup, UnsynchronisedBoardIsRejected)
+{
+    time_sync_latency_t board;
+    time_sync_latency_reset(&board);
+
+    // Board still counts from its own boot instead of the bus time
+    receive(&board, -500000, 1000000, 300);
+
+    CHECK_EQUAL(1, board.rejected);
+}
+
+TEST(TimeSyncSkewTestGroup, MeasuresSkewOnTwoFrameMessages)
+{
+    time_sync_latency_t left, right;
+    time_sync_latency_reset(&left);
+    time_sync_latency_reset(&right);
+
+    // The second frame of a 9 bytes message arrives about 130 us later
+    const uint32_t frame_us = 130;
+    const uint32_t delays[] = {250, 400, 260, 900, 310};
+
+    for (int i = 0; i < 5; i++) {
+        uint32_t t = 1000000 + 10000 * i;
+        receive(&left, 25, t, delays[i] + frame_us);
+        receive(&right, -15, t, delays[(i + 3) % 5] + frame_us);
+    }
+
+    CHECK_EQUAL(-40, time_sync_skew_us(&left, &right));
+    CHECK_EQUAL(250 + frame_us - 25, left.min_us);
+}
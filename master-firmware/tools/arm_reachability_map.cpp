@@ -0,0 +1,83 @@
+/* Heat map of the poses reachable by an arm, for strategy tuning.
+ *
+ * Every cell of a grid around the shoulder is tried with evenly spaced hand
+ * headings, and its shade is the fraction of headings that can be reached.
+ * The map is written as a PGM image on stdout, shoulder at the center and x
+ * pointing right:
+ *
+ *     ./arm_reachability_map [l1 l2 l3 [cell_size [headings]]] > map.pgm
+ *
+ * Lengths default to the ones of the arms in config_order.yaml, in meters. It
+ * is built with the tests when configured with cmake -DBUILD_TOOLS=ON.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "manipulator/kinematics.h"
+
+int main(int argc, char** argv)
+{
+    manipulator::ArmLengths lengths = {{0.132f, 0.097f, 0.072f}};
+    float cell_size = 0.005f;
+    int headings = 72;
+
+    if (argc >= 4) {
+        for (int i = 0; i < 3; i++) {
+            lengths[i] = std::atof(argv[i + 1]);
+        }
+    }
+    if (argc >= 5) {
+        cell_size = std::atof(argv[4]);
+    }
+    if (argc >= 6) {
+        headings = std::atoi(argv[5]);
+    }
+    if (cell_size <= 0 || headings <= 0) {
+        std::fprintf(stderr, "usage: %s [l1 l2 l3 [cell_size [headings]]]\n", argv[0]);
+        return 1;
+    }
+
+    const float reach = lengths[0] + lengths[1] + lengths[2];
+    const int size = 2 * static_cast<int>(std::ceil(reach / cell_size)) + 1;
+
+    /* One row of the map is solved at once */
+    const size_t count = size * headings;
+    std::vector<float> x(count), y(count), heading(count);
+    std::vector<float> q1(count), q2(count), q3(count);
+    std::unique_ptr<bool[]> reachable(new bool[count]);
+
+    manipulator::PoseBatch poses = {x.data(), y.data(), heading.data()};
+    manipulator::AnglesBatch angles = {q1.data(), q2.data(), q3.data(), reachable.get()};
+
+    size_t total_reachable = 0;
+
+    std::printf("P2\n%d %d\n%d\n", size, size, headings);
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            for (int h = 0; h < headings; h++) {
+                const size_t i = col * headings + h;
+                x[i] = (col - size / 2) * cell_size;
+                y[i] = (size / 2 - row) * cell_size;
+                heading[i] = 2 * M_PI * h / headings;
+            }
+        }
+
+        total_reachable += manipulator::inverse_kinematics(lengths, count, poses, angles);
+
+        for (int col = 0; col < size; col++) {
+            int shade = 0;
+            for (int h = 0; h < headings; h++) {
+                shade += reachable[col * headings + h];
+            }
+            std::printf("%d ", shade);
+        }
+        std::printf("\n");
+    }
+
+    std::fprintf(stderr, "%zu of %zu poses reachable\n", total_reachable, static_cast<size_t>(size) * count);
+
+    return 0;
+}
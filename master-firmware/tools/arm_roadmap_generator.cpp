@@ -0,0 +1,160 @@
+/* Builds the probabilistic roadmap of the arms, kept in flash.
+ *
+ * The arm states are the first nodes, followed by random collision free
+ * configurations of the arm workspace. MANIPULATOR_INIT only names the arm
+ * before its first move, so its node is kept but not connected. Each node is connected to its nearest
+ * neighbours it can move to in a straight line. The roadmap is written as C++
+ * source on stdout:
+ *
+ *     ./arm_roadmap_generator [samples [neighbours [seed]]] > src/manipulator/arm_roadmap.cpp
+ *
+ * It must be generated again when the workspace in roadmap.cpp or the arm
+ * states change. It is built with the tests when configured with
+ * cmake -DBUILD_TOOLS=ON.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "manipulator/roadmap.h"
+
+using manipulator::Angles;
+
+static float joint_distance(const Angles& a, const Angles& b)
+{
+    float sum = 0;
+    for (size_t i = 0; i < 3; i++) {
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return std::sqrt(sum);
+}
+
+static int find(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        i = parent[i] = parent[parent[i]];
+    }
+    return i;
+}
+
+int main(int argc, char** argv)
+{
+    int samples = 200;
+    int neighbours = 10;
+    unsigned seed = 1;
+
+    if (argc >= 2) {
+        samples = std::atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        neighbours = std::atoi(argv[2]);
+    }
+    if (argc >= 4) {
+        seed = std::atoi(argv[3]);
+    }
+    if (samples < 0 || neighbours <= 0 || MANIPULATOR_COUNT + samples > ROADMAP_MAX_NODES) {
+        std::fprintf(stderr, "usage: %s [samples [neighbours [seed]]], at most %d nodes\n",
+                     argv[0], ROADMAP_MAX_NODES);
+        return 1;
+    }
+
+    const auto& workspace = manipulator::arm_workspace;
+    std::vector<Angles> nodes;
+
+    for (int i = 0; i < MANIPULATOR_COUNT; i++) {
+        const float* angles = manipulator_state_angles[i];
+        nodes.push_back({{angles[0], angles[1], angles[2]}});
+        if (i != MANIPULATOR_INIT && manipulator::arm_collides(workspace, nodes.back())) {
+            std::fprintf(stderr, "arm state %d is in collision, check the workspace\n", i);
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    while (nodes.size() < static_cast<size_t>(MANIPULATOR_COUNT + samples)) {
+        Angles angles;
+        for (size_t i = 0; i < 3; i++) {
+            angles[i] = workspace.min_angles[i] + uniform(rng) * (workspace.max_angles[i] - workspace.min_angles[i]);
+        }
+        if (!manipulator::arm_collides(workspace, angles)) {
+            nodes.push_back(angles);
+        }
+    }
+
+    const int count = nodes.size();
+    std::vector<std::set<int>> edges(count);
+    std::vector<int> component(count);
+    for (int i = 0; i < count; i++) {
+        component[i] = i;
+    }
+
+    for (int i = MANIPULATOR_INIT + 1; i < count; i++) {
+        std::vector<int> nearest;
+        for (int j = MANIPULATOR_INIT + 1; j < count; j++) {
+            if (j != i) {
+                nearest.push_back(j);
+            }
+        }
+        std::sort(nearest.begin(), nearest.end(), [&](int a, int b) {
+            return joint_distance(nodes[i], nodes[a]) < joint_distance(nodes[i], nodes[b]);
+        });
+        nearest.resize(std::min<size_t>(neighbours, nearest.size()));
+
+        for (int j : nearest) {
+            if (!edges[i].count(j) && manipulator::move_is_free(workspace, nodes[i], nodes[j], nullptr)) {
+                edges[i].insert(j);
+                edges[j].insert(i);
+                component[find(component, i)] = find(component, j);
+            }
+        }
+    }
+
+    for (int i = MANIPULATOR_INIT + 2; i < MANIPULATOR_COUNT; i++) {
+        if (find(component, i) != find(component, MANIPULATOR_INIT + 1)) {
+            std::fprintf(stderr, "warning: arm state %d is not connected to the others\n", i);
+        }
+    }
+
+    std::printf("/* Generated by tools/arm_roadmap_generator.cpp with %d samples, %d neighbours\n"
+                " * and seed %u, do not edit. */\n",
+                samples, neighbours, seed);
+    std::printf("#include \"manipulator/roadmap.h\"\n\n");
+    std::printf("namespace manipulator {\n");
+
+    std::printf("static const Angles nodes[%d] = {\n", count);
+    for (const auto& angles : nodes) {
+        std::printf("    {{%.5ff, %.5ff, %.5ff}},\n", angles[0], angles[1], angles[2]);
+    }
+    std::printf("};\n\n");
+
+    int edge_count = 0;
+    std::printf("static const uint16_t first_edge[%d] = {", count + 1);
+    for (int i = 0; i <= count; i++) {
+        std::printf("%s%d,", i % 16 ? " " : "\n    ", edge_count);
+        if (i < count) {
+            edge_count += edges[i].size();
+        }
+    }
+    std::printf("\n};\n\n");
+
+    std::printf("static const uint16_t edges[%d] = {", edge_count);
+    int printed = 0;
+    for (const auto& node_edges : edges) {
+        for (int j : node_edges) {
+            std::printf("%s%d,", printed++ % 16 ? " " : "\n    ", j);
+        }
+    }
+    std::printf("\n};\n\n");
+
+    std::printf("const Roadmap arm_roadmap = {nodes, %d, first_edge, edges};\n", count);
+    std::printf("} // namespace manipulator\n");
+
+    std::fprintf(stderr, "%d nodes, %d edges\n", count, edge_count / 2);
+
+    return 0;
+}
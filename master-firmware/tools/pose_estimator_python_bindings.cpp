@@ -0,0 +1,44 @@
+#include "base/pose_estimator.hpp"
+
+static PoseEstimator estimator;
+
+extern "C" void estimator_set_noise(float distance_variance, float angle_variance, float gate)
+{
+    estimator.distanceVariance = distance_variance;
+    estimator.angleVariance = angle_variance;
+    estimator.gate = gate;
+}
+
+extern "C" void estimator_reset(float x, float y, float a, float position_variance, float angle_variance)
+{
+    estimator.reset(x, y, a, position_variance, angle_variance);
+}
+
+extern "C" void estimator_predict(float distance, float angle)
+{
+    estimator.predict(distance, angle);
+}
+
+extern "C" bool estimator_correct_position(float x, float y, float variance)
+{
+    return estimator.correctPosition(x, y, variance);
+}
+
+extern "C" bool estimator_correct_heading(float a, float variance)
+{
+    return estimator.correctHeading(a, variance);
+}
+
+extern "C" void estimator_get_state(float state[3])
+{
+    for (int i = 0; i < 3; i++) {
+        state[i] = estimator.state(i);
+    }
+}
+
+extern "C" void estimator_get_covariance(float covariance[9])
+{
+    for (int i = 0; i < 9; i++) {
+        covariance[i] = estimator.covariance(i / 3, i % 3);
+    }
+}
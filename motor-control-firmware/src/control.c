@@ -13,6 +13,7 @@
 #include "motor_protection.h"
 #include "feedback.h"
 #include "setpoint.h"
+#include "observer.h"
 
 #include "control.h"
 
@@ -32,6 +33,9 @@ motor_protection_t control_motor_protection;
 binary_semaphore_t setpoint_interpolation_lock;
 static setpoint_interpolator_t setpoint_interpolation;
 static struct pid_cascade_s ctrl;
+static struct observer_s observer;
+static bool observer_model_valid;
+static float applied_motor_voltage;
 
 /** Control loop parameters */
 static struct {
@@ -48,6 +52,20 @@ static struct {
         struct pid_param_s pid;
     } pos, vel, cur;
 
+    // the position and velocity loops run every n-th control period
+    struct {
+        parameter_t pos;
+        parameter_t vel;
+    } divider;
+
+    struct {
+        parameter_namespace_t ns;
+        parameter_t enabled;
+        parameter_t current_gain;
+        parameter_t position_gain;
+        parameter_t velocity_gain;
+    } observer;
+
     parameter_t mode;
 } control_params;
 
@@ -56,6 +74,10 @@ static struct {
     parameter_namespace_t ns;
     parameter_t torque_cst;
     parameter_t current_offset;
+    parameter_t resistance;
+    parameter_t inductance;
+    parameter_t inertia;
+    parameter_t damping;
 } motor_params;
 
 /* Thermal protection parameters */
@@ -97,6 +119,12 @@ static float ctrl_timeout = DEFAULT_CTRL_TIMEOUT;
 static bool control_request_termination = false;
 static bool control_running = false;
 
+/* Time spent computing each control period */
+static struct {
+    float load; // low-passed fraction of the control period
+    uint32_t max_duration_us;
+} control_cpu;
+
 void control_update_position_setpoint(float pos)
 {
     float current_pos = ctrl.position;
@@ -150,6 +178,16 @@ void control_update_voltage_setpoint(float voltage)
     last_setpoint_update = timestamp_get();
 }
 
+float control_get_cpu_load(void)
+{
+    return control_cpu.load;
+}
+
+uint32_t control_get_max_duration_us(void)
+{
+    return control_cpu.max_duration_us;
+}
+
 float control_get_motor_voltage(void)
 {
     return ctrl.motor_voltage;
@@ -219,6 +257,9 @@ static void set_motor_voltage(float u)
 {
     float u_batt = analog_get_battery_voltage();
     motor_pwm_set(u / u_batt);
+
+    // same saturation as motor_pwm_set, used as the observer input
+    applied_motor_voltage = filter_limit_sym(u, 0.95 * u_batt);
 }
 
 static void pid_param_declare(struct pid_param_s* p, parameter_namespace_t* ns)
@@ -253,16 +294,28 @@ static void declare_parameters(void)
 
     parameter_namespace_declare(&control_params.pos.ns, &control_params.ns, "position");
     pid_param_declare(&control_params.pos.pid, &control_params.pos.ns);
+    parameter_integer_declare_with_default(&control_params.divider.pos, &control_params.pos.ns, "divider", 1);
     parameter_namespace_declare(&control_params.vel.ns, &control_params.ns, "velocity");
     pid_param_declare(&control_params.vel.pid, &control_params.vel.ns);
+    parameter_integer_declare_with_default(&control_params.divider.vel, &control_params.vel.ns, "divider", 1);
     parameter_namespace_declare(&control_params.cur.ns, &control_params.ns, "current");
     pid_param_declare(&control_params.cur.pid, &control_params.cur.ns);
     parameter_integer_declare_with_default(&control_params.mode, &control_params.ns, "mode", 0);
 
+    parameter_namespace_declare(&control_params.observer.ns, &control_params.ns, "observer");
+    parameter_boolean_declare_with_default(&control_params.observer.enabled, &control_params.observer.ns, "enabled", false);
+    parameter_scalar_declare_with_default(&control_params.observer.current_gain, &control_params.observer.ns, "current_gain", 0.1);
+    parameter_scalar_declare_with_default(&control_params.observer.position_gain, &control_params.observer.ns, "position_gain", 0.3);
+    parameter_scalar_declare_with_default(&control_params.observer.velocity_gain, &control_params.observer.ns, "velocity_gain", 60);
+
     /* Motor parameters. */
     parameter_namespace_declare(&motor_params.ns, &parameter_root_ns, "motor");
     parameter_scalar_declare_with_default(&motor_params.torque_cst, &motor_params.ns, "torque_cst", 1.);
     parameter_scalar_declare_with_default(&motor_params.current_offset, &motor_params.ns, "current_offset", 0.);
+    parameter_scalar_declare_with_default(&motor_params.resistance, &motor_params.ns, "resistance", 1.);
+    parameter_scalar_declare_with_default(&motor_params.inductance, &motor_params.ns, "inductance", 0.);
+    parameter_scalar_declare_with_default(&motor_params.inertia, &motor_params.ns, "inertia", INFINITY);
+    parameter_scalar_declare_with_default(&motor_params.damping, &motor_params.ns, "damping", 0.);
 
     /* Thermal */
     parameter_namespace_declare(&thermal_params.ns, &parameter_root_ns, "thermal");
@@ -297,6 +350,14 @@ static void declare_parameters(void)
 
 static void update_parameters(void);
 
+/** Reads a loop divider, which must be at least one. A negative value would
+ * wrap around to a huge unsigned divider. */
+static unsigned int divider_get(parameter_t* p)
+{
+    int32_t divider = parameter_integer_get(p);
+    return divider > 1 ? divider : 1;
+}
+
 void control_init(void)
 {
     declare_parameters();
@@ -305,9 +366,11 @@ void control_init(void)
     pid_init(&ctrl.current_pid);
     pid_init(&ctrl.velocity_pid);
     pid_init(&ctrl.position_pid);
-    pid_set_frequency(&ctrl.current_pid, ANALOG_CONVERSION_FREQUENCY);
-    pid_set_frequency(&ctrl.velocity_pid, ANALOG_CONVERSION_FREQUENCY);
-    pid_set_frequency(&ctrl.position_pid, ANALOG_CONVERSION_FREQUENCY);
+    pid_cascade_set_rates(&ctrl, ANALOG_CONVERSION_FREQUENCY,
+                          divider_get(&control_params.divider.pos),
+                          divider_get(&control_params.divider.vel));
+
+    observer_init(&observer);
 
     setpoint_init(&setpoint_interpolation);
     chBSemObjectInit(&setpoint_interpolation_lock, false);
@@ -332,8 +395,29 @@ void control_init(void)
     update_parameters();
 }
 
+static void observer_update_model(void)
+{
+    float transmission = (float)control_feedback.primary_encoder.transmission_p / control_feedback.primary_encoder.transmission_q;
+    bool valid = observer_set_model(&observer,
+                                    parameter_scalar_get(&motor_params.resistance),
+                                    parameter_scalar_get(&motor_params.inductance),
+                                    parameter_scalar_get(&motor_params.torque_cst) * transmission,
+                                    parameter_scalar_get(&motor_params.inertia),
+                                    parameter_scalar_get(&motor_params.damping),
+                                    1 / (float)ANALOG_CONVERSION_FREQUENCY);
+
+    // an invalid model is ignored, the previous estimation is used instead
+    if (valid != observer_model_valid) {
+        observer_init(&observer);
+    }
+    observer_model_valid = valid;
+}
+
 static void update_parameters(void)
 {
+    // checked before the encoder parameters are read, which clears the flags
+    bool transmission_changed = parameter_namespace_contains_changed(&encoder_params.primary.ns);
+
     control_feedback.input_selection = parameter_integer_get(&control_params.mode);
 
     control_feedback.primary_encoder.transmission_p = parameter_integer_get(&encoder_params.primary.p);
@@ -350,6 +434,11 @@ static void update_parameters(void)
     control_feedback.rpm.phase = parameter_scalar_get(&rpm_params.phase);
 
     if (parameter_namespace_contains_changed(&control_params.ns)) {
+        if (parameter_changed(&control_params.divider.pos) || parameter_changed(&control_params.divider.vel)) {
+            pid_cascade_set_rates(&ctrl, ANALOG_CONVERSION_FREQUENCY,
+                                  divider_get(&control_params.divider.pos),
+                                  divider_get(&control_params.divider.vel));
+        }
         if (parameter_namespace_contains_changed(&control_params.pos.ns)) {
             pid_param_update(&control_params.pos.pid, &ctrl.position_pid);
         }
@@ -377,15 +466,25 @@ static void update_parameters(void)
             setpoint_set_acceleration_limit(&setpoint_interpolation, parameter_scalar_get(&control_params.limits.acc));
             chBSemSignal(&setpoint_interpolation_lock);
         }
+        if (parameter_namespace_contains_changed(&control_params.observer.ns)) {
+            observer_set_gains(&observer,
+                               parameter_scalar_get(&control_params.observer.current_gain),
+                               parameter_scalar_get(&control_params.observer.position_gain),
+                               parameter_scalar_get(&control_params.observer.velocity_gain));
+            if (parameter_changed(&control_params.observer.enabled)) {
+                observer_init(&observer);
+            }
+        }
     }
-    if (parameter_namespace_contains_changed(&motor_params.ns)) {
-        if (parameter_changed(&motor_params.torque_cst)) {
+    if (parameter_namespace_contains_changed(&motor_params.ns) || transmission_changed) {
+        if (parameter_changed(&motor_params.torque_cst) || transmission_changed) {
             float transmission = (float)control_feedback.primary_encoder.transmission_p / control_feedback.primary_encoder.transmission_q;
             ctrl.motor_current_constant = 1.f / (parameter_scalar_get(&motor_params.torque_cst) * transmission);
         }
         if (parameter_changed(&motor_params.current_offset)) {
             ctrl.motor_current_offset = parameter_scalar_get(&motor_params.current_offset);
         }
+        observer_update_model();
     }
     if (parameter_namespace_contains_changed(&thermal_params.ns)) {
         motor_protection_init(&control_motor_protection,
@@ -413,6 +512,8 @@ static THD_FUNCTION(control_loop, arg)
 
     const float delta_t = 1 / (float)ANALOG_CONVERSION_FREQUENCY;
     while (!control_request_termination) {
+        timestamp_t start = timestamp_get();
+
         update_parameters();
 
         // sensor feedback
@@ -425,8 +526,17 @@ static THD_FUNCTION(control_loop, arg)
 
         ctrl.periodic_actuator = control_feedback.output.actuator_is_periodic;
         ctrl.position = control_feedback.output.position;
-        ctrl.velocity = ctrl.velocity * 0.9 + control_feedback.output.velocity * 0.1;
-        ctrl.current = analog_get_motor_current() - ctrl.motor_current_offset;
+
+        float current = analog_get_motor_current() - ctrl.motor_current_offset;
+        if (parameter_boolean_get(&control_params.observer.enabled) && observer_model_valid) {
+            observer_update(&observer, applied_motor_voltage, current,
+                            ctrl.position, ctrl.periodic_actuator);
+            ctrl.velocity = observer.velocity;
+            ctrl.current = observer.current;
+        } else {
+            ctrl.velocity = ctrl.velocity * 0.9 + control_feedback.output.velocity * 0.1;
+            ctrl.current = current;
+        }
         ctrl.torque = ctrl.current / ctrl.motor_current_constant;
         // ctrl.current_limit = motor_protection_update(&control_motor_protection, ctrl.current, delta_t);
 
@@ -453,6 +563,12 @@ static THD_FUNCTION(control_loop, arg)
             }
         }
 
+        uint32_t duration = timestamp_duration_us(start, timestamp_get());
+        control_cpu.load = 0.99f * control_cpu.load + 0.01f * duration / (delta_t * 1e6f);
+        if (duration > control_cpu.max_duration_us) {
+            control_cpu.max_duration_us = duration;
+        }
+
         chEvtWaitAny(CONTROL_WAKEUP_EVENT);
         chEvtGetAndClearFlags(&analog_event_listener);
     }
@@ -24,6 +24,11 @@ void control_update_torque_setpoint(float torque);
 void control_update_trajectory_setpoint(float pos, float vel, float acc, float torque, timestamp_t ts);
 void control_update_voltage_setpoint(float voltage);
 
+/** Fraction of the control period spent in the control loop (low-passed). */
+float control_get_cpu_load(void);
+/** Longest control loop iteration since boot [us]. */
+uint32_t control_get_max_duration_us(void);
+
 float control_get_motor_voltage(void);
 float control_get_vel_ctrl_out(void);
 float control_get_pos_ctrl_out(void);
@@ -0,0 +1,121 @@
+#include <math.h>
+#include "observer.h"
+
+static float wrap_angle_error(float err)
+{
+    err = fmodf(err, 2 * M_PI);
+    if (err > M_PI) {
+        return err - 2 * M_PI;
+    }
+    if (err < -M_PI) {
+        return err + 2 * M_PI;
+    }
+    return err;
+}
+
+static float wrap_angle(float angle)
+{
+    angle = fmodf(angle, 2 * M_PI);
+    if (angle < 0) {
+        angle += 2 * M_PI;
+    }
+    return angle;
+}
+
+void observer_init(struct observer_s* obs)
+{
+    obs->current = 0;
+    obs->velocity = 0;
+    obs->position = 0;
+    obs->initialized = false;
+}
+
+bool observer_set_model(struct observer_s* obs,
+                        float resistance,
+                        float inductance,
+                        float torque_constant,
+                        float inertia,
+                        float damping,
+                        float delta_t)
+{
+    // written so that NaN parameters are rejected as well
+    if (!(resistance >= 0) || !(inductance >= 0) || !(inertia > 0)) {
+        return false;
+    }
+    if (resistance == 0 && inductance == 0) {
+        return false;
+    }
+
+    obs->delta_t = delta_t;
+    obs->torque_constant = torque_constant;
+
+    if (resistance > 0) {
+        // a zero inductance gives a decay of 0, i.e. Ohm's law
+        obs->current_decay = expf(-resistance * delta_t / inductance);
+        obs->current_input_gain = (1 - obs->current_decay) / resistance;
+    } else {
+        // limit of the above for a vanishing resistance
+        obs->current_decay = 1;
+        obs->current_input_gain = delta_t / inductance;
+    }
+
+    if (isinf(inertia)) {
+        obs->velocity_decay = 1;
+        obs->velocity_input_gain = 0;
+    } else if (damping > 0) {
+        obs->velocity_decay = expf(-damping * delta_t / inertia);
+        obs->velocity_input_gain = (1 - obs->velocity_decay) * torque_constant / damping;
+    } else {
+        obs->velocity_decay = 1;
+        obs->velocity_input_gain = torque_constant * delta_t / inertia;
+    }
+
+    return true;
+}
+
+void observer_set_gains(struct observer_s* obs,
+                        float current_gain,
+                        float position_gain,
+                        float velocity_gain)
+{
+    obs->current_gain = current_gain;
+    obs->position_gain = position_gain;
+    obs->velocity_gain = velocity_gain;
+}
+
+void observer_update(struct observer_s* obs,
+                     float voltage,
+                     float current,
+                     float position,
+                     bool periodic)
+{
+    if (!obs->initialized) {
+        obs->current = current;
+        obs->velocity = 0;
+        obs->position = position;
+        obs->initialized = true;
+        return;
+    }
+
+    // prediction
+    float back_emf = obs->torque_constant * obs->velocity;
+    float predicted_current = obs->current_decay * obs->current
+                              + obs->current_input_gain * (voltage - back_emf);
+    float predicted_velocity = obs->velocity_decay * obs->velocity
+                               + obs->velocity_input_gain * obs->current;
+    float predicted_position = obs->position + obs->velocity * obs->delta_t;
+
+    // correction
+    float position_error = position - predicted_position;
+    if (periodic) {
+        position_error = wrap_angle_error(position_error);
+    }
+
+    obs->current = predicted_current + obs->current_gain * (current - predicted_current);
+    obs->velocity = predicted_velocity + obs->velocity_gain * position_error;
+    obs->position = predicted_position + obs->position_gain * position_error;
+
+    if (periodic) {
+        obs->position = wrap_angle(obs->position);
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * Observer
+ * ========
+ *
+ * Luenberger observer of the motor state (current, velocity, position).
+ *
+ * The state is predicted from the voltage applied to the motor (PWM duty cycle
+ * times battery voltage) and the DC motor model, then corrected with the
+ * measured current and the encoder position:
+ *
+ *     L di/dt = u - R i - k w
+ *     J dw/dt = k i - b w
+ *       dp/dt = w
+ *
+ * where k is the torque constant seen at the output shaft (equal to the back
+ * EMF constant in SI units). The electrical and mechanical poles are
+ * discretized exactly, so the prediction is stable for any time step.
+ *
+ * Compared to the averaged ADC current and the low-passed encoder velocity,
+ * the estimates are less noisy and are not delayed by the filters.
+ */
+
+#ifndef OBSERVER_H
+#define OBSERVER_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct observer_s {
+    // state estimate:
+    float current;
+    float velocity;
+    float position;
+
+    // model, computed by observer_set_model:
+    float current_decay; // exp(-R dt / L)
+    float current_input_gain; // (1 - current_decay) / R, dt / L without resistance
+    float velocity_decay; // exp(-b dt / J), 1 without damping
+    float velocity_input_gain; // velocity change per amp during one step
+    float torque_constant; // k
+    float delta_t;
+
+    // correction gains:
+    float current_gain; // fraction of the current innovation applied
+    float position_gain; // fraction of the position innovation applied
+    float velocity_gain; // velocity correction per position innovation, [1/s]
+
+    bool initialized;
+};
+
+/** Sets the state estimate to zero and marks the observer as uninitialized.
+ *
+ * The first update then copies the measurements into the state.
+ */
+void observer_init(struct observer_s* obs);
+
+/** Configures the motor model.
+ *
+ * @param [in] resistance Winding resistance [Ohm], zero for a purely inductive model
+ * @param [in] inductance Winding inductance [H], zero for a purely resistive model
+ * @param [in] torque_constant Output torque per amp [Nm/A]
+ * @param [in] inertia Inertia at the output [kg m^2], INFINITY to disable the
+ * torque based velocity prediction.
+ * @param [in] damping Viscous friction at the output [Nm s/rad]
+ * @param [in] delta_t Time between two updates [s]
+ *
+ * @returns false if the model is invalid (negative resistance or inductance,
+ * both zero, or non positive inertia), in which case it is left unchanged.
+ */
+bool observer_set_model(struct observer_s* obs,
+                        float resistance,
+                        float inductance,
+                        float torque_constant,
+                        float inertia,
+                        float damping,
+                        float delta_t);
+
+/** Sets the correction gains, see struct observer_s for their meaning. */
+void observer_set_gains(struct observer_s* obs,
+                        float current_gain,
+                        float position_gain,
+                        float velocity_gain);
+
+/** Runs one prediction and correction step.
+ *
+ * @param [in] voltage Voltage applied to the motor during the last period [V]
+ * @param [in] current Measured current [A]
+ * @param [in] position Measured position [rad]
+ * @param [in] periodic True if the position wraps between 0 and 2*PI
+ */
+void observer_update(struct observer_s* obs,
+                     float voltage,
+                     float current,
+                     float position,
+                     bool periodic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OBSERVER_H */
@@ -14,11 +14,42 @@ float periodic_error(float err)
     return err;
 }
 
+static bool loop_should_run(unsigned int tick, unsigned int divider)
+{
+    return divider <= 1 || tick % divider == 0;
+}
+
+void pid_cascade_set_rates(struct pid_cascade_s* ctrl,
+                           float frequency,
+                           unsigned int position_divider,
+                           unsigned int velocity_divider)
+{
+    if (position_divider < 1) {
+        position_divider = 1;
+    }
+    if (velocity_divider < 1) {
+        velocity_divider = 1;
+    }
+
+    ctrl->position_divider = position_divider;
+    ctrl->velocity_divider = velocity_divider;
+
+    pid_set_frequency(&ctrl->current_pid, frequency);
+    pid_set_frequency(&ctrl->velocity_pid, frequency / velocity_divider);
+    pid_set_frequency(&ctrl->position_pid, frequency / position_divider);
+}
+
 void pid_cascade_control(struct pid_cascade_s* ctrl)
 {
+    bool run_position = loop_should_run(ctrl->tick, ctrl->position_divider);
+    bool run_velocity = loop_should_run(ctrl->tick, ctrl->velocity_divider);
+    ctrl->tick++;
+
     // position control
     float pos_ctrl_vel;
-    if (ctrl->setpts.position_control_enabled) {
+    if (ctrl->setpts.position_control_enabled && !run_position) {
+        pos_ctrl_vel = ctrl->position_ctrl_out;
+    } else if (ctrl->setpts.position_control_enabled) {
         ctrl->position_setpoint = ctrl->setpts.position_setpt;
         float position_error = ctrl->position - ctrl->setpts.position_setpt;
         if (ctrl->periodic_actuator) {
@@ -30,11 +61,14 @@ void pid_cascade_control(struct pid_cascade_s* ctrl)
     } else {
         pid_reset_integral(&ctrl->position_pid);
         pos_ctrl_vel = 0;
+        ctrl->position_ctrl_out = 0;
     }
 
     // velocity control
     float vel_ctrl_torque;
-    if (ctrl->setpts.velocity_control_enabled) {
+    if (ctrl->setpts.velocity_control_enabled && !run_velocity) {
+        vel_ctrl_torque = ctrl->velocity_ctrl_out;
+    } else if (ctrl->setpts.velocity_control_enabled) {
         float velocity_setpt = ctrl->setpts.velocity_setpt + pos_ctrl_vel;
         velocity_setpt = filter_limit_sym(velocity_setpt, ctrl->velocity_limit);
         ctrl->velocity_setpoint = velocity_setpt;
@@ -44,6 +78,7 @@ void pid_cascade_control(struct pid_cascade_s* ctrl)
     } else {
         pid_reset_integral(&ctrl->velocity_pid);
         vel_ctrl_torque = 0;
+        ctrl->velocity_ctrl_out = 0;
     }
 
     // torque control
@@ -20,6 +20,11 @@ struct pid_cascade_s {
     float velocity_limit;
     float torque_limit;
     float current_limit;
+    // loop rates: the position and velocity loops only run every n-th call,
+    // their output is held in between. The current loop runs on every call.
+    unsigned int position_divider;
+    unsigned int velocity_divider;
+    unsigned int tick;
     // setpoints:
     struct setpoint_s setpts;
     // inputs:
@@ -44,6 +49,20 @@ struct pid_cascade_s {
 // todo this should not be here
 float periodic_error(float err);
 
+/** Sets the rate of each loop.
+ *
+ * @param [in] frequency Rate at which pid_cascade_control is called [Hz]
+ * @param [in] position_divider Position loop runs every position_divider call
+ * @param [in] velocity_divider Velocity loop runs every velocity_divider call
+ *
+ * The PID frequencies are adjusted accordingly. A divider of zero is treated
+ * as one.
+ */
+void pid_cascade_set_rates(struct pid_cascade_s* ctrl,
+                           float frequency,
+                           unsigned int position_divider,
+                           unsigned int velocity_divider);
+
 void pid_cascade_control(struct pid_cascade_s* ctrl);
 
 #ifdef __cplusplus
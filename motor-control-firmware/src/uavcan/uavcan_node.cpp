@@ -5,6 +5,7 @@
 #include <uavcan/uavcan.hpp>
 #include <uavcan_stm32/uavcan_stm32.hpp>
 #include <uavcan/protocol/SoftwareVersion.hpp>
+#include <uavcan/protocol/global_time_sync_slave.hpp>
 
 #include <version/version.h>
 
@@ -21,6 +22,7 @@
 #include "Torque_handler.hpp"
 #include "Voltage_handler.hpp"
 #include "stream.h"
+#include "control.h"
 
 #define CAN_BITRATE 1000000
 
@@ -39,6 +41,13 @@ static int uavcan_node_start(Node& node)
     return node.start();
 }
 
+/* Locks our UTC clock on the master's one, used to timestamp the streams. */
+static int time_sync_slave_start(Node& node)
+{
+    static uavcan::GlobalTimeSyncSlave time_sync_slave(node);
+    return time_sync_slave.start();
+}
+
 /** Start all UAVCAN services. */
 static void uavcan_services_start(Node& node)
 {
@@ -47,6 +56,7 @@ static void uavcan_services_start(Node& node)
         const char* name;
     } services[] = {
         {uavcan_node_start, "Node start"},
+        {time_sync_slave_start, "Time sync slave"},
         {Reboot_handler_start, "Reboot subscriber"},
         {EmergencyStop_handler_start, "Emergency stop subscriber"},
         {Trajectory_handler_start, "cvra::motor::control::Trajectory subscriber"},
@@ -111,6 +121,9 @@ static THD_FUNCTION(uavcan_node, arg)
         }
 
         uavcan_streams_spin(node);
+
+        /* Report the control loop CPU load in per mille. */
+        node.getNodeStatusProvider().setVendorSpecificStatusCode(control_get_cpu_load() * 1000);
     }
 }
 
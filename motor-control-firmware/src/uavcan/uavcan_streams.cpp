@@ -1,4 +1,5 @@
 #include <parameter/parameter.h>
+#include <uavcan_stm32/uavcan_stm32.hpp>
 #include "uavcan_streams.hpp"
 #include "stream.h"
 
@@ -107,10 +108,24 @@ int uavcan_streams_start(Node& node)
     return 0;
 }
 
+/* Time on the bus clock, which is disciplined by the master's GlobalTimeSync
+ * messages. Samples are stamped when they are sent, so the stamp lags the
+ * control loop by at most one control period.
+ *
+ * Only the lower 24 bits are sent, so that the 4 bytes messages still fit in
+ * a single CAN frame. The 6 bytes ones (current PID, index, motor position)
+ * take two frames. */
+static uint32_t synchronised_timestamp(void)
+{
+    return (uint32_t)uavcan_stm32::clock::getUtc().toUSec() & 0xffffff;
+}
+
 void uavcan_streams_spin(Node& node)
 {
     (void)node;
 
+    const uint32_t timestamp = synchronised_timestamp();
+
     if (parameter_namespace_contains_changed(&stream_params.ns)) {
         stream_update_from_parameters(&current_pid_stream_config, &stream_params.current);
         stream_update_from_parameters(&velocity_pid_stream_config, &stream_params.velocity);
@@ -127,6 +142,7 @@ void uavcan_streams_spin(Node& node)
         current_pid.current = control_get_current();
         current_pid.current_setpoint = control_get_current_setpoint();
         current_pid.motor_voltage = control_get_motor_voltage();
+        current_pid.timestamp = timestamp;
         current_pid_pub->broadcast(current_pid);
     }
 
@@ -134,6 +150,7 @@ void uavcan_streams_spin(Node& node)
         cvra::motor::feedback::VelocityPID velocity_pid;
         velocity_pid.velocity = control_get_velocity();
         velocity_pid.velocity_setpoint = control_get_velocity_setpoint();
+        velocity_pid.timestamp = timestamp;
         velocity_pid_pub->broadcast(velocity_pid);
     }
 
@@ -141,12 +158,14 @@ void uavcan_streams_spin(Node& node)
         cvra::motor::feedback::PositionPID position_pid;
         position_pid.position = control_get_position();
         position_pid.position_setpoint = control_get_position_setpoint();
+        position_pid.timestamp = timestamp;
         position_pid_pub->broadcast(position_pid);
     }
 
     if (stream_should_send(&enc_pos_stream_config)) {
         cvra::motor::feedback::MotorEncoderPosition enc_pos;
         enc_pos.raw_encoder_position = encoder_get_secondary();
+        enc_pos.timestamp = timestamp;
         enc_pos_pub->broadcast(enc_pos);
     }
 
@@ -157,6 +176,7 @@ void uavcan_streams_spin(Node& node)
         index_get_position(&index_pos, &update_count);
         index.position = index_pos;
         index.update_count = update_count;
+        index.timestamp = timestamp;
         index_pub->broadcast(index);
     }
 
@@ -164,6 +184,7 @@ void uavcan_streams_spin(Node& node)
         cvra::motor::feedback::MotorPosition motor_pos;
         motor_pos.position = control_get_position();
         motor_pos.velocity = control_get_velocity();
+        motor_pos.timestamp = timestamp;
         motor_pos_pub->broadcast(motor_pos);
     }
 
@@ -171,6 +192,7 @@ void uavcan_streams_spin(Node& node)
         cvra::motor::feedback::MotorTorque motor_torque;
         motor_torque.torque = control_get_torque();
         motor_torque.position = control_get_position();
+        motor_torque.timestamp = timestamp;
         motor_torque_pub->broadcast(motor_torque);
     }
 }
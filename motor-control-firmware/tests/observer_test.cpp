@@ -0,0 +1,225 @@
+#include "CppUTest/TestHarness.h"
+#include <math.h>
+#include <vector>
+
+#include "../src/observer.h"
+
+namespace {
+const float dt = 1 / 2002.f;
+
+// Model of the motor used to generate the traces
+const float resistance = 1.2f; // [Ohm]
+const float inductance = 0.4e-3f; // [H]
+const float torque_constant = 0.05f; // [Nm/A]
+const float inertia = 2e-5f; // [kg m^2]
+const float damping = 2e-5f; // [Nm s/rad]
+const int encoder_ticks_per_rev = 4096;
+
+/** One control period as recorded on the board. */
+struct trace_sample {
+    float voltage; // applied during the previous period
+    float current; // averaged ADC current
+    float position; // encoder position
+    float true_current;
+    float true_velocity;
+};
+
+/** Deterministic noise with zero mean and unit variance (sum of uniforms). */
+struct noise_generator {
+    uint32_t state = 12345;
+
+    float uniform()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / (1 << 24);
+    }
+
+    float normal()
+    {
+        float sum = 0;
+        for (int i = 0; i < 12; i++) {
+            sum += uniform();
+        }
+        return sum - 6;
+    }
+};
+
+/** Simulates the motor with a voltage profile and records what the control
+ * loop would see: noisy current and quantized encoder position. */
+std::vector<trace_sample> generate_trace(float (*voltage_profile)(float), float duration, float current_noise)
+{
+    std::vector<trace_sample> trace;
+    noise_generator noise;
+    const int substeps = 50;
+    float i = 0, w = 0, p = 0;
+
+    for (float t = 0; t < duration; t += dt) {
+        float u = voltage_profile(t);
+        for (int k = 0; k < substeps; k++) {
+            float h = dt / substeps;
+            float di = (u - resistance * i - torque_constant * w) / inductance;
+            float dw = (torque_constant * i - damping * w) / inertia;
+            i += di * h;
+            w += dw * h;
+            p += w * h;
+        }
+
+        trace_sample s;
+        s.voltage = u;
+        s.current = i + current_noise * noise.normal();
+        s.position = floorf(p / (2 * M_PI) * encoder_ticks_per_rev) * 2 * M_PI / encoder_ticks_per_rev;
+        s.true_current = i;
+        s.true_velocity = w;
+        trace.push_back(s);
+    }
+
+    return trace;
+}
+
+float step_profile(float t)
+{
+    return t < 0.05f ? 0.f : 6.f;
+}
+
+float square_profile(float t)
+{
+    return fmodf(t, 0.2f) < 0.1f ? 8.f : -8.f;
+}
+
+struct replay_errors {
+    float current_rms;
+    float velocity_rms;
+};
+
+/** Replays a trace through the observer, skipping the first samples. */
+replay_errors replay_observer(const std::vector<trace_sample>& trace, struct observer_s* obs, size_t skip)
+{
+    double current_err = 0, velocity_err = 0;
+    for (size_t k = 0; k < trace.size(); k++) {
+        observer_update(obs, trace[k].voltage, trace[k].current, trace[k].position, false);
+        if (k >= skip) {
+            current_err += pow(obs->current - trace[k].true_current, 2);
+            velocity_err += pow(obs->velocity - trace[k].true_velocity, 2);
+        }
+    }
+    size_t n = trace.size() - skip;
+    return {(float)sqrt(current_err / n), (float)sqrt(velocity_err / n)};
+}
+
+/** Same as above for the previous estimation: raw averaged current and
+ * low-passed encoder velocity (see control.c). */
+replay_errors replay_reference(const std::vector<trace_sample>& trace, size_t skip)
+{
+    double current_err = 0, velocity_err = 0;
+    float velocity = 0;
+    for (size_t k = 1; k < trace.size(); k++) {
+        float measured_velocity = (trace[k].position - trace[k - 1].position) / dt;
+        velocity = velocity * 0.9 + measured_velocity * 0.1;
+        if (k >= skip) {
+            current_err += pow(trace[k].current - trace[k].true_current, 2);
+            velocity_err += pow(velocity - trace[k].true_velocity, 2);
+        }
+    }
+    size_t n = trace.size() - skip;
+    return {(float)sqrt(current_err / n), (float)sqrt(velocity_err / n)};
+}
+} // namespace
+
+TEST_GROUP (ObserverTestGroup) {
+    struct observer_s obs;
+
+    void setup()
+    {
+        observer_init(&obs);
+        observer_set_model(&obs, resistance, inductance, torque_constant, inertia, damping, dt);
+        observer_set_gains(&obs, 0.1, 0.3, 60);
+    }
+};
+
+TEST(ObserverTestGroup, FirstUpdateCopiesMeasurements)
+{
+    observer_update(&obs, 0, 1.5, 2., false);
+
+    DOUBLES_EQUAL(1.5, obs.current, 1e-6);
+    DOUBLES_EQUAL(2., obs.position, 1e-6);
+    DOUBLES_EQUAL(0., obs.velocity, 1e-6);
+}
+
+TEST(ObserverTestGroup, StaysAtRestWithoutVoltage)
+{
+    for (int i = 0; i < 1000; i++) {
+        observer_update(&obs, 0, 0, 1., false);
+    }
+
+    DOUBLES_EQUAL(0., obs.current, 1e-6);
+    DOUBLES_EQUAL(0., obs.velocity, 1e-6);
+    DOUBLES_EQUAL(1., obs.position, 1e-6);
+}
+
+TEST(ObserverTestGroup, ResistiveModelReachesOhmsLaw)
+{
+    observer_set_model(&obs, 2., 0., torque_constant, INFINITY, 0, dt);
+    observer_set_gains(&obs, 0, 0, 0);
+    observer_update(&obs, 0, 0, 0, false);
+
+    observer_update(&obs, 3., 0, 0, false);
+
+    DOUBLES_EQUAL(1.5, obs.current, 1e-6);
+}
+
+TEST(ObserverTestGroup, InductiveModelIntegratesVoltage)
+{
+    CHECK_TRUE(observer_set_model(&obs, 0., 1e-3, torque_constant, INFINITY, 0, dt));
+    observer_set_gains(&obs, 0, 0, 0);
+    observer_update(&obs, 0, 0, 0, false);
+
+    observer_update(&obs, 2., 0, 0, false);
+    observer_update(&obs, 2., 0, 0, false);
+
+    DOUBLES_EQUAL(2 * 2. * dt / 1e-3, obs.current, 1e-6);
+}
+
+TEST(ObserverTestGroup, RejectsModelsWithoutImpedance)
+{
+    CHECK_FALSE(observer_set_model(&obs, 0., 0., torque_constant, inertia, damping, dt));
+    CHECK_FALSE(observer_set_model(&obs, -1., inductance, torque_constant, inertia, damping, dt));
+    CHECK_FALSE(observer_set_model(&obs, resistance, NAN, torque_constant, inertia, damping, dt));
+    CHECK_FALSE(observer_set_model(&obs, resistance, inductance, torque_constant, 0., damping, dt));
+
+    // the previous model is kept
+    DOUBLES_EQUAL(expf(-resistance * dt / inductance), obs.current_decay, 1e-6);
+    CHECK_FALSE(isnan(obs.current_input_gain));
+}
+
+TEST(ObserverTestGroup, PeriodicPositionWrapsAround)
+{
+    observer_update(&obs, 0, 0, 2 * M_PI - 0.01, true);
+
+    for (int i = 0; i < 100; i++) {
+        observer_update(&obs, 0, 0, 0.01, true);
+    }
+
+    DOUBLES_EQUAL(0.01, obs.position, 1e-3);
+    CHECK(fabs(obs.velocity) < 1);
+}
+
+TEST(ObserverTestGroup, TracksStepResponse)
+{
+    auto trace = generate_trace(step_profile, 0.5, 0.);
+    replay_observer(trace, &obs, 0);
+
+    DOUBLES_EQUAL(trace.back().true_velocity, obs.velocity, 0.5);
+    DOUBLES_EQUAL(trace.back().true_current, obs.current, 0.05);
+}
+
+TEST(ObserverTestGroup, LessNoisyThanAveragedMeasurements)
+{
+    auto trace = generate_trace(square_profile, 1., 0.3);
+    const size_t skip = 200;
+
+    replay_errors observer = replay_observer(trace, &obs, skip);
+    replay_errors reference = replay_reference(trace, skip);
+
+    CHECK(observer.current_rms < 0.5 * reference.current_rms);
+    CHECK(observer.velocity_rms < 0.25 * reference.velocity_rms);
+}
@@ -1,5 +1,6 @@
 #include "CppUTest/TestHarness.h"
 #include <math.h>
+#include <string.h>
 
 extern "C" {
 #include "pid_cascade.c"
@@ -52,3 +53,89 @@ TEST(PeriodicError, LargeNeg)
     DOUBLES_EQUAL(-5 + 2 * M_PI, periodic_error(-5 + -2 * M_PI), 1e-5);
     DOUBLES_EQUAL(-5 + 2 * M_PI, periodic_error(-5 + -4 * M_PI), 1e-5);
 }
+
+TEST_GROUP (PIDCascadeRates) {
+    struct pid_cascade_s ctrl;
+
+    void setup()
+    {
+        memset(&ctrl, 0, sizeof(ctrl));
+        pid_init(&ctrl.current_pid);
+        pid_init(&ctrl.velocity_pid);
+        pid_init(&ctrl.position_pid);
+        ctrl.motor_current_constant = 1;
+        ctrl.velocity_limit = INFINITY;
+        ctrl.torque_limit = INFINITY;
+        ctrl.current_limit = INFINITY;
+        ctrl.setpts.position_control_enabled = true;
+        ctrl.setpts.velocity_control_enabled = true;
+    }
+};
+
+TEST(PIDCascadeRates, SetsPIDFrequencies)
+{
+    pid_cascade_set_rates(&ctrl, 2000, 10, 2);
+
+    DOUBLES_EQUAL(2000, pid_get_frequency(&ctrl.current_pid), 1e-3);
+    DOUBLES_EQUAL(1000, pid_get_frequency(&ctrl.velocity_pid), 1e-3);
+    DOUBLES_EQUAL(200, pid_get_frequency(&ctrl.position_pid), 1e-3);
+}
+
+TEST(PIDCascadeRates, ZeroDividerIsTreatedAsOne)
+{
+    pid_cascade_set_rates(&ctrl, 2000, 0, 0);
+
+    CHECK_EQUAL(1, ctrl.position_divider);
+    CHECK_EQUAL(1, ctrl.velocity_divider);
+    DOUBLES_EQUAL(2000, pid_get_frequency(&ctrl.position_pid), 1e-3);
+}
+
+TEST(PIDCascadeRates, OuterLoopOutputIsHeldBetweenRuns)
+{
+    pid_cascade_set_rates(&ctrl, 2000, 4, 1);
+    pid_set_gains(&ctrl.position_pid, 1, 0, 0);
+    pid_set_gains(&ctrl.velocity_pid, 1, 0, 0);
+    pid_set_gains(&ctrl.current_pid, 1, 0, 0);
+
+    ctrl.position = 1;
+    pid_cascade_control(&ctrl);
+    DOUBLES_EQUAL(-1, ctrl.position_ctrl_out, 1e-6);
+
+    // position changes, but the position loop does not run for 3 periods
+    ctrl.position = 2;
+    for (int i = 0; i < 3; i++) {
+        pid_cascade_control(&ctrl);
+        DOUBLES_EQUAL(-1, ctrl.position_ctrl_out, 1e-6);
+        DOUBLES_EQUAL(-1, ctrl.velocity_setpoint, 1e-6);
+    }
+
+    pid_cascade_control(&ctrl);
+    DOUBLES_EQUAL(-2, ctrl.position_ctrl_out, 1e-6);
+}
+
+TEST(PIDCascadeRates, CurrentLoopRunsEveryPeriod)
+{
+    pid_cascade_set_rates(&ctrl, 2000, 4, 4);
+    pid_set_gains(&ctrl.current_pid, 1, 0, 0);
+
+    pid_cascade_control(&ctrl);
+    ctrl.current = 3;
+    pid_cascade_control(&ctrl);
+
+    DOUBLES_EQUAL(-3, ctrl.motor_voltage, 1e-6);
+}
+
+TEST(PIDCascadeRates, HeldOutputIsClearedWhenLoopIsDisabled)
+{
+    pid_cascade_set_rates(&ctrl, 2000, 4, 4);
+    pid_set_gains(&ctrl.position_pid, 1, 0, 0);
+    ctrl.position = 1;
+    pid_cascade_control(&ctrl);
+
+    ctrl.setpts.position_control_enabled = false;
+    pid_cascade_control(&ctrl);
+    ctrl.setpts.position_control_enabled = true;
+    pid_cascade_control(&ctrl);
+
+    DOUBLES_EQUAL(0, ctrl.position_ctrl_out, 1e-6);
+}
@@ -8,6 +8,8 @@ import os.path
 import argparse
 import socketserver
 import re
+import struct
+import time
 
 from google.protobuf import text_format
 
@@ -37,12 +39,39 @@ def parse_packet(data):
     return header, msg
 
 
+# Each recorded datagram is prefixed by its reception time and its length
+RECORD_HEADER = struct.Struct('<dI')
+
+
+def record_packet(f, timestamp, data):
+    f.write(RECORD_HEADER.pack(timestamp, len(data)))
+    f.write(data)
+
+
+def read_record(f):
+    """
+    Yields the (timestamp, header, msg) of each datagram in a file written
+    with --record.
+    """
+    while True:
+        prefix = f.read(RECORD_HEADER.size)
+        if len(prefix) < RECORD_HEADER.size:
+            return
+
+        timestamp, size = RECORD_HEADER.unpack(prefix)
+        header, msg = parse_packet(f.read(size))
+        yield timestamp, header, msg
+
+
 def parse_args():
     parser = argparse.ArgumentParser(description=__doc__)
     parser.add_argument(
         "--port", "-p", default=10000, help="Port to listen on (10000)")
     parser.add_argument(
         "--filter", "-f", help="Filter regexp to apply on the topic name")
+    parser.add_argument(
+        "--record", "-r", type=argparse.FileType('wb'),
+        help="Also save all the raw packets to this file, for replay")
 
     return parser.parse_args()
 
@@ -58,6 +87,10 @@ def main():
     class Handler(socketserver.BaseRequestHandler):
         def handle(self):
             data = self.request[0]
+
+            if args.record:
+                record_packet(args.record, time.time(), data)
+
             header, msg = parse_packet(data)
 
             if not topic_filter.search(header.name):
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Replays a log recorded with log_udp_protobuf.py --record through the pose
+estimator of the master firmware, and prints the fused pose next to the
+logged one as CSV.
+
+The estimator comes from the python bindings of the master firmware tests
+build (libpose_estimator_python.so), configured with cmake -DBUILD_TOOLS=ON.
+"""
+
+import argparse
+import ctypes
+import os.path
+import sys
+
+from log_udp_protobuf import read_record
+
+
+def parse_args():
+    default_lib = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..',
+                               'master-firmware', 'build', 'libpose_estimator_python.so')
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("log", type=argparse.FileType('rb'), help="Recorded log")
+    parser.add_argument("--lib", default=default_lib,
+                        help="Path to the estimator shared library")
+    parser.add_argument("--ticks-per-mm", type=float, default=162.974661726)
+    parser.add_argument("--track", type=float, default=202.75294494, help="Track in mm")
+    parser.add_argument("--left-factor", type=float, default=1.00038814,
+                        help="Left wheel correction factor")
+    parser.add_argument("--right-factor", type=float, default=-0.99961113,
+                        help="Right wheel correction factor")
+    parser.add_argument("--distance-variance", type=float, default=0.5)
+    parser.add_argument("--angle-variance", type=float, default=0.001)
+    parser.add_argument("--gate", type=float, default=13.8)
+    parser.add_argument("--uwb-std-dev", type=float, default=50.,
+                        help="Standard deviation of the UWB fixes in mm, 0 to ignore them")
+    parser.add_argument("--imu-std-dev", type=float, default=0.,
+                        help="Standard deviation of the IMU heading in rad, 0 to ignore it")
+
+    return parser.parse_args()
+
+
+def load_estimator(path):
+    lib = ctypes.CDLL(path)
+    floats = lambda n: [ctypes.c_float] * n
+
+    lib.estimator_set_noise.argtypes = floats(3)
+    lib.estimator_reset.argtypes = floats(5)
+    lib.estimator_predict.argtypes = floats(2)
+    lib.estimator_correct_position.argtypes = floats(3)
+    lib.estimator_correct_position.restype = ctypes.c_bool
+    lib.estimator_correct_heading.argtypes = floats(2)
+    lib.estimator_correct_heading.restype = ctypes.c_bool
+
+    return lib
+
+
+def get_state(lib):
+    state = (ctypes.c_float * 3)()
+    lib.estimator_get_state(state)
+    return list(state)
+
+
+def main():
+    args = parse_args()
+    lib = load_estimator(args.lib)
+    lib.estimator_set_noise(args.distance_variance, args.angle_variance, args.gate)
+
+    encoders = None
+    logged = None
+    imu_offset = None
+
+    print("time,x,y,a,logged_x,logged_y,logged_a,event")
+
+    for timestamp, header, msg in read_record(args.log):
+        event = None
+
+        if header.name == '/position':
+            logged = (msg.x, msg.y, msg.a)
+            if encoders is None:
+                continue
+        elif encoders is None:
+            # Wait for the first logged pose to start from it
+            if header.name == '/encoders' and logged is not None:
+                encoders = (msg.left, msg.right)
+                lib.estimator_reset(logged[0], logged[1], logged[2], 25., 1e-4)
+            continue
+        elif header.name == '/encoders':
+            left = (msg.left - encoders[0]) * args.left_factor / args.ticks_per_mm
+            right = (msg.right - encoders[1]) * args.right_factor / args.ticks_per_mm
+            encoders = (msg.left, msg.right)
+            lib.estimator_predict((left + right) / 2, (right - left) / args.track)
+        elif header.name == '/uwb/position' and args.uwb_std_dev > 0:
+            accepted = lib.estimator_correct_position(msg.x, msg.y, args.uwb_std_dev ** 2)
+            event = 'uwb' if accepted else 'uwb_rejected'
+        elif header.name == '/imu/heading' and args.imu_std_dev > 0:
+            if imu_offset is None:
+                imu_offset = get_state(lib)[2] - msg.a
+                continue
+            accepted = lib.estimator_correct_heading(msg.a + imu_offset, args.imu_std_dev ** 2)
+            event = 'imu' if accepted else 'imu_rejected'
+        else:
+            continue
+
+        x, y, a = get_state(lib)
+        print("{:.3f},{:.1f},{:.1f},{:.4f},{:.1f},{:.1f},{:.4f},{}".format(
+            timestamp, x, y, a, logged[0], logged[1], logged[2], event or ''))
+
+
+if __name__ == '__main__':
+    main()
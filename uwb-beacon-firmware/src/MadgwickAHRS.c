@@ -145,6 +145,19 @@ void madgwick_filter_update(madgwick_filter_t* f,
     f->q[3] *= recipNorm;
 }
 
+void madgwick_filter_update_batch(madgwick_filter_t* f,
+                                  const madgwick_sample_t* samples,
+                                  unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        const madgwick_sample_t* s = &samples[i];
+        madgwick_filter_update(f,
+                               s->gyro[0], s->gyro[1], s->gyro[2],
+                               s->acc[0], s->acc[1], s->acc[2],
+                               s->mag[0], s->mag[1], s->mag[2]);
+    }
+}
+
 void madgwick_filter_updateIMU(madgwick_filter_t* f,
                                float gx,
                                float gy,
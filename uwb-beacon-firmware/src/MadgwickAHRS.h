@@ -23,6 +23,13 @@ typedef struct {
     float sample_frequency;
 } madgwick_filter_t;
 
+/** A single IMU sample, for batched updates. */
+typedef struct {
+    float gyro[3];
+    float acc[3];
+    float mag[3];
+} madgwick_sample_t;
+
 void madgwick_filter_init(madgwick_filter_t* f);
 
 void madgwick_filter_set_gain(madgwick_filter_t* f, float beta);
@@ -38,6 +45,10 @@ void madgwick_filter_update(madgwick_filter_t* f,
                             float mx,
                             float my,
                             float mz);
+/** Runs one update per sample, oldest first, for IMUs read in bursts. */
+void madgwick_filter_update_batch(madgwick_filter_t* f,
+                                  const madgwick_sample_t* samples,
+                                  unsigned count);
 void madgwick_filter_updateIMU(madgwick_filter_t* f,
                                float gx,
                                float gy,
@@ -3,6 +3,7 @@
 
 #include "main.h"
 #include "MadgwickAHRS.h"
+#include "madgwick_fast.h"
 #include "ahrs_thread.h"
 #include "imu_thread.h"
 #include "board.h"
@@ -22,7 +23,7 @@ static void ahrs_thd(void* p)
 
     messagebus_topic_t* imu_topic;
 
-    imu_topic = messagebus_find_topic_blocking(&bus, "/imu");
+    imu_topic = messagebus_find_topic_blocking(&bus, "/imu/batch");
 
     /* Create the attitude topic. */
     messagebus_topic_t attitude_topic;
@@ -48,13 +49,25 @@ static void ahrs_thd(void* p)
             madgwick_filter_set_gain(&filter, parameter_scalar_get(&ahrs_params.beta));
         }
 
-        imu_msg_t imu;
-        messagebus_topic_wait(imu_topic, &imu, sizeof(imu));
+        /* The IMU is read in bursts, process all the samples at once and
+         * publish only the latest attitude. */
+        static imu_batch_msg_t batch;
+        madgwick_sample_t samples[IMU_BATCH_MAX_SAMPLES];
+        messagebus_topic_wait(imu_topic, &batch, sizeof(batch));
+
+        for (unsigned i = 0; i < batch.count; i++) {
+            samples[i].gyro[0] = batch.samples[i].gyro.x;
+            samples[i].gyro[1] = batch.samples[i].gyro.y;
+            samples[i].gyro[2] = batch.samples[i].gyro.z;
+            samples[i].acc[0] = batch.samples[i].acc.x;
+            samples[i].acc[1] = batch.samples[i].acc.y;
+            samples[i].acc[2] = batch.samples[i].acc.z;
+            samples[i].mag[0] = batch.samples[i].mag.x;
+            samples[i].mag[1] = batch.samples[i].mag.y;
+            samples[i].mag[2] = batch.samples[i].mag.z;
+        }
 
-        madgwick_filter_update(&filter,
-                               imu.gyro.x, imu.gyro.y, imu.gyro.z,
-                               imu.acc.x, imu.acc.y, imu.acc.z,
-                               imu.mag.x, imu.mag.y, imu.mag.z);
+        madgwick_fast_update_batch(&filter, samples, batch.count);
 
         attitude_msg_t msg;
 
@@ -63,7 +76,7 @@ static void ahrs_thd(void* p)
         msg.q.y = filter.q[2];
         msg.q.z = filter.q[3];
 
-        msg.timestamp = imu.timestamp;
+        msg.timestamp = batch.samples[batch.count - 1].timestamp;
 
         messagebus_topic_publish(&attitude_topic, &msg, sizeof(msg));
     }
@@ -84,20 +97,22 @@ void ahrs_calibrate_gyro(void)
     float x_avg = 0, y_avg = 0, z_avg = 0;
     float new_beta;
 
-    topic = messagebus_find_topic_blocking(&bus, "/imu");
+    topic = messagebus_find_topic_blocking(&bus, "/imu/batch");
 
     board_led_set(BOARD_LED_ERROR);
-    for (int i = 0; i < N; i++) {
-        imu_msg_t msg;
-        messagebus_topic_wait(topic, &msg, sizeof(msg));
-
-        x_avg += msg.gyro.x / N;
-        y_avg += msg.gyro.y / N;
-        z_avg += msg.gyro.z / N;
-
-        // Blink the LED during calibration
-        if (i % 50 == 0) {
-            board_led_toggle(BOARD_LED_ERROR);
+    for (int i = 0; i < N;) {
+        static imu_batch_msg_t batch;
+        messagebus_topic_wait(topic, &batch, sizeof(batch));
+
+        for (unsigned j = 0; j < batch.count && i < N; j++, i++) {
+            x_avg += batch.samples[j].gyro.x / N;
+            y_avg += batch.samples[j].gyro.y / N;
+            z_avg += batch.samples[j].gyro.z / N;
+
+            // Blink the LED during calibration
+            if (i % 50 == 0) {
+                board_led_toggle(BOARD_LED_ERROR);
+            }
         }
     }
     board_led_clear(BOARD_LED_ERROR);
@@ -107,3 +122,56 @@ void ahrs_calibrate_gyro(void)
     gain = parameter_find(&parameter_root, "/ahrs/beta");
     parameter_scalar_set(gain, new_beta);
 }
+
+bool ahrs_benchmark(uint32_t* reference_cycles, uint32_t* fast_cycles)
+{
+    const int N = 100;
+    messagebus_topic_t* topic;
+    static imu_batch_msg_t batch;
+    madgwick_filter_t reference, fast;
+    uint32_t start;
+
+    topic = messagebus_find_topic_blocking(&bus, "/imu/batch");
+    messagebus_topic_wait(topic, &batch, sizeof(batch));
+
+    if (batch.count == 0) {
+        return false;
+    }
+
+    madgwick_filter_init(&reference);
+    madgwick_filter_init(&fast);
+
+    /* Enable the cycle counter. */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    *reference_cycles = 0;
+    *fast_cycles = 0;
+
+    for (int i = 0; i < N; i++) {
+        const imu_msg_t* imu = &batch.samples[i % batch.count];
+        madgwick_sample_t sample = {
+            {imu->gyro.x, imu->gyro.y, imu->gyro.z},
+            {imu->acc.x, imu->acc.y, imu->acc.z},
+            {imu->mag.x, imu->mag.y, imu->mag.z},
+        };
+
+        chSysLock();
+        start = DWT->CYCCNT;
+        madgwick_filter_update(&reference,
+                               imu->gyro.x, imu->gyro.y, imu->gyro.z,
+                               imu->acc.x, imu->acc.y, imu->acc.z,
+                               imu->mag.x, imu->mag.y, imu->mag.z);
+        *reference_cycles += DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        madgwick_fast_update(&fast, &sample);
+        *fast_cycles += DWT->CYCCNT - start;
+        chSysUnlock();
+    }
+
+    *reference_cycles /= N;
+    *fast_cycles /= N;
+
+    return true;
+}
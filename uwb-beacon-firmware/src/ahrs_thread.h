@@ -19,6 +19,13 @@ void ahrs_start(void);
 
 void ahrs_calibrate_gyro(void);
 
+/** Measures the mean number of CPU cycles of a filter update on the last IMU
+ * samples, with the reference and the optimised implementations.
+ *
+ * @returns false if the last IMU batch was empty.
+ */
+bool ahrs_benchmark(uint32_t* reference_cycles, uint32_t* fast_cycles);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,7 +4,7 @@
 #include "main.h"
 #include "anchor_position_cache.h"
 
-#define CACHE_ENTRIES 5
+#define CACHE_ENTRIES 16
 
 static cache_t anchor_positions_cache;
 static cache_entry_t anchor_positions_cache_entries[CACHE_ENTRIES];
@@ -28,6 +28,45 @@ static void cmd_reboot(BaseSequentialStream* chp, int argc, char** argv)
     NVIC_SystemReset();
 }
 
+static void cmd_stack(BaseSequentialStream* chp, int argc, char* argv[])
+{
+#if (CH_DBG_FILL_THREADS != TRUE) || (CH_CFG_USE_REGISTRY != TRUE) || (CH_DBG_ENABLE_STACK_CHECK != TRUE)
+#error "Requires: CH_DBG_FILL_THREADS CH_CFG_USE_REGISTRY CH_DBG_ENABLE_STACK_CHECK"
+#endif
+
+    (void)argv;
+    (void)argc;
+
+    const uint32_t STACK_FILL = 0x55555555;
+    uint32_t p, sp, wabase;
+    const char* name;
+    thread_t* tp;
+
+    chprintf(chp, "stackptr  stacktop  stklimit  free   name
+");
+
+    tp = chRegFirstThread();
+    while (tp) {
+        sp = (uint32_t)tp->ctx.sp;
+        wabase = (uint32_t)tp->wabase;
+        name = tp->name == NULL ? "NULL" : tp->name;
+
+        uint32_t limit = wabase + sizeof(thread_t);
+
+        /* Never used stack still holds the fill pattern. */
+        for (p = limit; p < sp; p += 4) {
+            if (STACK_FILL != *(uint32_t*)p) {
+                break;
+            }
+        }
+
+        chprintf(chp, "%08lx  %08lx  %08lx  %5lu  %s
+", sp, p, limit, p - limit, name);
+
+        tp = chRegNextThread(tp);
+    }
+}
+
 static void cmd_topics(BaseSequentialStream* chp, int argc, char* argv[])
 {
     (void)argc;
@@ -142,13 +181,21 @@ static void cmd_temp(BaseSequentialStream* chp, int argc, char** argv)
 static void cmd_ahrs(BaseSequentialStream* chp, int argc, char** argv)
 {
     if (argc < 1) {
-        chprintf(chp, "usage: ahrs cal\r\n");
+        chprintf(chp, "usage: ahrs cal|bench\r\n");
         return;
     }
 
     if (!strcmp(argv[0], "cal")) {
         chprintf(chp, "calibrating gyro, do not move the board...\r\n");
         ahrs_calibrate_gyro();
+    } else if (!strcmp(argv[0], "bench")) {
+        uint32_t reference, fast;
+        if (!ahrs_benchmark(&reference, &fast)) {
+            chprintf(chp, "no IMU samples to run the filters on\r\n");
+            return;
+        }
+        chprintf(chp, "reference: %lu cycles/update\r\n", reference);
+        chprintf(chp, "optimised: %lu cycles/update\r\n", fast);
     }
 }
 
@@ -446,7 +493,7 @@ static void cmd_set_pos(BaseSequentialStream* chp, int argc, char* argv[])
     msg.variance_x = 0.01;
     msg.variance_y = 0.01;
 
-    messagebus_topic_t* topic = messagebus_find_topic(&bus, "/ekf/state");
+    messagebus_topic_t* topic = messagebus_find_topic(&bus, "/ekf/initial_position");
 
     if (!topic) {
         chprintf(chp, "Could not find topic, aborting\r\n");
@@ -494,6 +541,7 @@ static ShellConfig shell_cfg;
 const ShellCommand shell_commands[] = {
     {"reboot", cmd_reboot},
     {"topics", cmd_topics},
+    {"stack", cmd_stack},
     {"trace", cmd_trace},
     {"imu", cmd_imu},
     {"ahrs", cmd_ahrs},
@@ -68,6 +68,29 @@ uint64_t decawave_get_rx_timestamp_u64(void)
     return ts;
 }
 
+void decawave_read_rx_info(decawave_rx_info_t* info)
+{
+    uint8_t rx_time[RX_TIME_LLEN];
+    uint8_t rx_fqual[RX_FQUAL_LEN];
+    int i;
+
+    dwt_readfromdevice(RX_TIME_ID, 0, RX_TIME_LLEN, rx_time);
+    dwt_readfromdevice(RX_FQUAL_ID, 0, RX_FQUAL_LEN, rx_fqual);
+
+    info->timestamp = 0;
+    for (i = RX_TIME_RX_STAMP_LEN - 1; i >= 0; i--) {
+        info->timestamp <<= 8;
+        info->timestamp |= rx_time[RX_TIME_RX_STAMP_OFFSET + i];
+    }
+
+    info->fp_ampl1 = rx_time[RX_TIME_FP_AMPL1_OFFSET] | (rx_time[RX_TIME_FP_AMPL1_OFFSET + 1] << 8);
+
+    /* RX_FQUAL is STD_NOISE, FP_AMPL2, FP_AMPL3 and CIR_PWR, 16 bits each. */
+    info->fp_ampl2 = rx_fqual[2] | (rx_fqual[3] << 8);
+    info->fp_ampl3 = rx_fqual[4] | (rx_fqual[5] << 8);
+    info->cir_power = rx_fqual[6] | (rx_fqual[7] << 8);
+}
+
 void uwb_transmit_frame(uint64_t tx_timestamp, uint8_t* frame, size_t frame_size)
 {
     dwt_writetxdata(frame_size, frame, 0); /* Zero offset in TX buffer. */
@@ -102,6 +125,14 @@ void decawave_start(void)
     res = dwt_initialise(DWT_LOADUCODE);
     chDbgAssert(res == DWT_SUCCESS, "dwm1000 init fail");
 
+    /* The SPI clock is limited to 3 Mhz until the DW1000 has switched to its
+     * PLL during initialisation, after which it can go up to 20 Mhz. Faster
+     * transfers shorten the time between RX and the delayed reply. */
+    spiStop(&SPID1);
+    /* 10.5 Mhz */
+    spi_cfg.cr1 = SPI_CR1_BR_1;
+    spiStart(&SPID1, &spi_cfg);
+
     /* Enable DWM1000 LEDs */
     dwt_setlnapamode(1, 1);
     dwt_setleds(DWT_LEDS_ENABLE | DWT_LEDS_INIT_BLINK);
@@ -7,10 +7,23 @@ extern "C" {
 
 #include <stdint.h>
 
+/** Reception time and first path diagnostics of the last received frame. */
+typedef struct {
+    uint64_t timestamp;
+    uint16_t fp_ampl1;
+    uint16_t fp_ampl2;
+    uint16_t fp_ampl3;
+    uint16_t cir_power;
+} decawave_rx_info_t;
+
 /** Starts the communication interface to the chip. */
 void decawave_start(void);
 uint64_t decawave_get_rx_timestamp_u64(void);
 
+/** Reads the RX timestamp and the first path diagnostics in two SPI
+ * transactions, instead of one per field with the decadriver API. */
+void decawave_read_rx_info(decawave_rx_info_t* info);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,11 +4,15 @@
 #include <msgbus/messagebus.h>
 
 #include "imu_thread.h"
-#include "exti.h"
 #include "mpu9250.h"
 #include "main.h"
 
-#define IMU_INTERRUPT_EVENT (0x01)
+/** Period at which the IMU FIFO is read. At 250 Hz, this gives batches of 5
+ * samples. */
+#define IMU_FIFO_READ_PERIOD_MS 20
+
+/** Time between two IMU samples, see mpu9250_configure(). */
+#define IMU_SAMPLE_PERIOD_US 4000
 
 static void imu_init_hardware(mpu9250_t* mpu)
 {
@@ -41,13 +45,10 @@ static void imu_reader_thd(void* p)
     (void)p;
     mpu9250_t mpu;
 
-    /* Starts waiting for the external interrupt. */
-    event_listener_t imu_int;
-    chEvtRegisterMask(&imu_event, &imu_int, (eventmask_t)IMU_INTERRUPT_EVENT);
-
     imu_init_hardware(&mpu);
 
-    /* Creates the IMU topic */
+    /* Creates the IMU topics. The single sample one carries the most recent
+     * sample of each batch. */
     messagebus_topic_t imu_topic;
     MUTEX_DECL(imu_topic_lock);
     CONDVAR_DECL(imu_topic_condvar);
@@ -57,6 +58,15 @@ static void imu_reader_thd(void* p)
                           &imu_topic_content, sizeof(imu_topic_content));
     messagebus_advertise_topic(&bus, &imu_topic, "/imu");
 
+    messagebus_topic_t imu_batch_topic;
+    MUTEX_DECL(imu_batch_topic_lock);
+    CONDVAR_DECL(imu_batch_topic_condvar);
+    static imu_batch_msg_t imu_batch_topic_content;
+
+    messagebus_topic_init(&imu_batch_topic, &imu_batch_topic_lock, &imu_batch_topic_condvar,
+                          &imu_batch_topic_content, sizeof(imu_batch_topic_content));
+    messagebus_advertise_topic(&bus, &imu_batch_topic, "/imu/batch");
+
     /* Create the temperature topic. */
     messagebus_topic_t temperature_topic;
     MUTEX_DECL(temperature_topic_lock);
@@ -68,40 +78,61 @@ static void imu_reader_thd(void* p)
                           &temperature_topic_content, sizeof(temperature_topic_content));
     messagebus_advertise_topic(&bus, &temperature_topic, "/imu/temperature");
 
+    /* Samples are accumulated by the MPU instead of raising an interrupt
+     * each, which saves a wakeup per sample. */
+    mpu9250_fifo_enable(&mpu);
+
     int temperature_pub_prescaler = 0;
     while (1) {
-        imu_msg_t msg;
+        static imu_batch_msg_t batch;
+        mpu9250_data_t data[IMU_BATCH_MAX_SAMPLES];
 
-        /* Wait for a measurement ready interrupt */
-        chEvtWaitAny(IMU_INTERRUPT_EVENT);
+        chThdSleepMilliseconds(IMU_FIFO_READ_PERIOD_MS);
 
-        /* Read data from the IMU. */
 #if 0
         /* TODO: For some reason the macro ST2US creates an overflow. */
         uint32_t ts = ST2US(chVTGetSystemTime());
 #else
         uint32_t ts = chVTGetSystemTime() * (1000000 / CH_CFG_ST_FREQUENCY);
 #endif
-        mpu9250_gyro_read(&mpu, &msg.gyro.x, &msg.gyro.y, &msg.gyro.z);
-        mpu9250_acc_read(&mpu, &msg.acc.x, &msg.acc.y, &msg.acc.z);
-        mpu9250_mag_read(&mpu, &msg.mag.x, &msg.mag.y, &msg.mag.z);
+        unsigned count = mpu9250_fifo_read(&mpu, data, IMU_BATCH_MAX_SAMPLES);
 
-        msg.timestamp = ts;
+        if (count == 0) {
+            continue;
+        }
+
+        /* The most recent sample was taken at most a sample period before the
+         * read, and the others are evenly spaced before it. */
+        batch.count = count;
+        for (unsigned i = 0; i < count; i++) {
+            imu_msg_t* msg = &batch.samples[i];
+
+            msg->gyro.x = data[i].gyro[0];
+            msg->gyro.y = data[i].gyro[1];
+            msg->gyro.z = data[i].gyro[2];
+            msg->acc.x = data[i].acc[0];
+            msg->acc.y = data[i].acc[1];
+            msg->acc.z = data[i].acc[2];
+            msg->mag.x = data[i].mag[0];
+            msg->mag.y = data[i].mag[1];
+            msg->mag.z = data[i].mag[2];
+
+            msg->timestamp = ts - (count - 1 - i) * IMU_SAMPLE_PERIOD_US;
+        }
 
         /* Publish the data. */
-        messagebus_topic_publish(&imu_topic, &msg, sizeof(msg));
+        messagebus_topic_publish(&imu_batch_topic, &batch, sizeof(batch));
+        messagebus_topic_publish(&imu_topic, &batch.samples[count - 1], sizeof(imu_msg_t));
 
-        /* Read the temperature, but not too often, as its useless. */
-        if (temperature_pub_prescaler++ >= 100) {
+        /* Publish the temperature, but not too often, as its useless. */
+        temperature_pub_prescaler += count;
+        if (temperature_pub_prescaler >= 100) {
             temperature_msg_t msg;
-            msg.temperature = mpu9250_temp_read(&mpu);
+            msg.temperature = data[count - 1].temperature;
             msg.timestamp = ts;
             messagebus_topic_publish(&temperature_topic, &msg, sizeof(msg));
             temperature_pub_prescaler = 0;
         }
-
-        /* Signals the MPU that we are ready for another interrupt. */
-        mpu9250_interrupt_read_and_clear(&mpu);
     }
 }
 
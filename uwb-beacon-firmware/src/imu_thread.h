@@ -24,6 +24,15 @@ typedef struct {
     } mag; /**< Magnetometer data in uT */
 } imu_msg_t;
 
+/** Maximum number of samples in a batch. */
+#define IMU_BATCH_MAX_SAMPLES 8
+
+/** Samples read from the IMU FIFO in one go, oldest first. */
+typedef struct {
+    unsigned count;
+    imu_msg_t samples[IMU_BATCH_MAX_SAMPLES];
+} imu_batch_msg_t;
+
 typedef struct {
     uint32_t timestamp; /**< Timestamp in us since boot. */
     float temperature; /**< Temperature level in degree C. */
@@ -1,6 +1,72 @@
 #include <unistd.h>
 #include "lru_cache.h"
 
+static cache_entry_t** bucket(cache_t* cache, uint32_t key)
+{
+    /* Fibonacci hashing spreads consecutive keys, such as MAC addresses,
+     * evenly across buckets. */
+    uint32_t hash = key * 2654435761u;
+    return &cache->buckets[(hash >> 16) & (CACHE_HASH_BUCKETS - 1)];
+}
+
+static void hash_insert(cache_t* cache, cache_entry_t* entry)
+{
+    cache_entry_t** head = bucket(cache, entry->key);
+    entry->hash_next = *head;
+    *head = entry;
+}
+
+static void hash_remove(cache_t* cache, cache_entry_t* entry)
+{
+    cache_entry_t** cur = bucket(cache, entry->key);
+
+    while (*cur != entry) {
+        cur = &(*cur)->hash_next;
+    }
+
+    *cur = entry->hash_next;
+}
+
+static cache_entry_t* hash_find(cache_t* cache, uint32_t key)
+{
+    cache_entry_t* cur = *bucket(cache, key);
+
+    while (cur != NULL && cur->key != key) {
+        cur = cur->hash_next;
+    }
+
+    return cur;
+}
+
+static void used_list_unlink(cache_t* cache, cache_entry_t* entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->used_list = entry->next;
+    }
+
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->used_list_tail = entry->prev;
+    }
+}
+
+static void used_list_push_front(cache_t* cache, cache_entry_t* entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->used_list;
+
+    if (cache->used_list) {
+        cache->used_list->prev = entry;
+    } else {
+        cache->used_list_tail = entry;
+    }
+
+    cache->used_list = entry;
+}
+
 void cache_init(cache_t* cache, cache_entry_t* entries, unsigned entries_count)
 {
     unsigned i;
@@ -13,11 +79,22 @@ void cache_init(cache_t* cache, cache_entry_t* entries, unsigned entries_count)
     entries[entries_count - 1].next = NULL;
 
     cache->used_list = NULL;
+    cache->used_list_tail = NULL;
+
+    for (i = 0; i < CACHE_HASH_BUCKETS; i++) {
+        cache->buckets[i] = NULL;
+    }
 }
 
 cache_entry_t* cache_entry_allocate(cache_t* cache, uint32_t key)
 {
-    cache_entry_t* ret;
+    cache_entry_t* ret = hash_find(cache, key);
+
+    if (ret != NULL) {
+        used_list_unlink(cache, ret);
+        used_list_push_front(cache, ret);
+        return ret;
+    }
 
     /* First case, we still have unused elements in the cache list */
     if (cache->free_list != NULL) {
@@ -25,45 +102,42 @@ cache_entry_t* cache_entry_allocate(cache_t* cache, uint32_t key)
         cache->free_list = cache->free_list->next;
         /* Otherwise, use the oldest element. */
     } else {
-        cache_entry_t *prev, *cur;
-        cur = cache->used_list;
-        prev = NULL;
-        while (cur->next != NULL) {
-            prev = cur;
-            cur = cur->next;
-        }
-
-        if (prev) {
-            prev->next = NULL;
-        }
-
-        ret = cur;
+        ret = cache->used_list_tail;
+        used_list_unlink(cache, ret);
+        hash_remove(cache, ret);
     }
 
-    ret->next = cache->used_list;
-    cache->used_list = ret;
-
     ret->key = key;
+    hash_insert(cache, ret);
+    used_list_push_front(cache, ret);
+
     return ret;
 }
 
 cache_entry_t* cache_entry_get(cache_t* cache, uint32_t key)
 {
-    cache_entry_t *prev, *current;
-
-    current = cache->used_list;
-    prev = NULL;
-    while (current != NULL && current->key != key) {
-        prev = current;
-        current = current->next;
-    }
+    cache_entry_t* current = hash_find(cache, key);
 
     /* Move the current entry to the beginning of the list */
-    if (current != NULL && prev != NULL) {
-        prev->next = current->next;
-        current->next = cache->used_list;
-        cache->used_list = current;
+    if (current != NULL && current != cache->used_list) {
+        used_list_unlink(cache, current);
+        used_list_push_front(cache, current);
     }
 
     return current;
 }
+
+void cache_entry_remove(cache_t* cache, uint32_t key)
+{
+    cache_entry_t* entry = hash_find(cache, key);
+
+    if (entry == NULL) {
+        return;
+    }
+
+    used_list_unlink(cache, entry);
+    hash_remove(cache, entry);
+
+    entry->next = cache->free_list;
+    cache->free_list = entry;
+}
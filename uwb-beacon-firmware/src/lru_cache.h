@@ -13,27 +13,47 @@ extern "C" {
  * a map, where each key is an integer, but with a fixed number of
  * elements. Once the maximum size is reached, if a new element is created,
  * it will replace the least recently accessed element in memory.
+ *
+ * Entries are found through a hash table and kept in a doubly linked list
+ * sorted by last access, so that get, allocate and evict are all O(1).
+ * No memory is allocated: the entries are provided by the user and the hash
+ * chains are threaded through them.
  */
+
+/** Number of hash buckets, must be a power of two. */
+#define CACHE_HASH_BUCKETS 32
+
 typedef struct cache_entry_s {
-    struct cache_entry_s* next;
+    struct cache_entry_s* next; /**< Next (older) entry in the used or free list. */
+    struct cache_entry_s* prev; /**< Previous (more recent) entry in the used list. */
+    struct cache_entry_s* hash_next; /**< Next entry in the same hash bucket. */
     uint32_t key;
     void* payload;
 } cache_entry_t;
 
 typedef struct {
     cache_entry_t* free_list;
-    cache_entry_t* used_list;
+    cache_entry_t* used_list; /**< Most recently used entry. */
+    cache_entry_t* used_list_tail; /**< Least recently used entry. */
+    cache_entry_t* buckets[CACHE_HASH_BUCKETS];
 } cache_t;
 
 /** Creates a cache controller using the given entry buffer. */
 void cache_init(cache_t* cache, cache_entry_t* entries, unsigned entries_count);
 
-/** Creates a new entry in cache with the given key and returns it. */
+/** Creates a new entry in cache with the given key and returns it.
+ *
+ * @note If the key is already in the cache, its entry is reused.
+ */
 cache_entry_t* cache_entry_allocate(cache_t* cache, uint32_t key);
 
 /** Returns the element indexed by key or NULL otherwise. */
 cache_entry_t* cache_entry_get(cache_t* cache, uint32_t key);
 
+/** Removes the element indexed by key, if any, and returns its entry to the
+ * free list. */
+void cache_entry_remove(cache_t* cache, uint32_t key);
+
 #ifdef __cplusplus
 }
 #endif
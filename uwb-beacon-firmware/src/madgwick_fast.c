@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "madgwick_fast.h"
+
+float madgwick_inv_sqrt(float x)
+{
+#if MADGWICK_INV_SQRT == MADGWICK_INV_SQRT_FAST
+    float y;
+    uint32_t i;
+
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5f3759df - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y;
+#elif MADGWICK_INV_SQRT == MADGWICK_INV_SQRT_FPU && defined(__ARM_FP) && (__ARM_FP & 4)
+    float root;
+    __asm__("vsqrt.f32 %0, %1" : "=t"(root) : "t"(x));
+    return 1.f / root;
+#else
+    return 1.f / sqrtf(x);
+#endif
+}
+
+static float madgwick_sqrt(float x)
+{
+#if MADGWICK_INV_SQRT == MADGWICK_INV_SQRT_FPU && defined(__ARM_FP) && (__ARM_FP & 4)
+    float root;
+    __asm__("vsqrt.f32 %0, %1" : "=t"(root) : "t"(x));
+    return root;
+#else
+    return sqrtf(x);
+#endif
+}
+
+void madgwick_fast_update(madgwick_filter_t* f, const madgwick_sample_t* sample)
+{
+    /* Local copies, so that the compiler does not reload them after every
+     * store through f. */
+    const float q0 = f->q[0], q1 = f->q[1], q2 = f->q[2], q3 = f->q[3];
+    const float gx = sample->gyro[0], gy = sample->gyro[1], gz = sample->gyro[2];
+    float ax = sample->acc[0], ay = sample->acc[1], az = sample->acc[2];
+    float mx = sample->mag[0], my = sample->mag[1], mz = sample->mag[2];
+    const float dt = 1.f / f->sample_frequency;
+
+    // Rate of change of quaternion from gyroscope
+    float qdot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qdot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qdot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qdot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+        float norm = madgwick_inv_sqrt(ax * ax + ay * ay + az * az);
+        ax *= norm;
+        ay *= norm;
+        az *= norm;
+
+        const float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+        const float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+        const float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+        /* Error between the measured and the expected gravity direction. The
+         * reference implementation expands these in every gradient
+         * component. */
+        const float fax = 2.0f * (q1q3 - q0q2) - ax;
+        const float fay = 2.0f * (q0q1 + q2q3) - ay;
+        const float faz = 1.0f - 2.0f * (q1q1 + q2q2) - az;
+
+        // Gradient decent algorithm corrective step
+        float s0 = -2.0f * q2 * fax + 2.0f * q1 * fay;
+        float s1 = 2.0f * q3 * fax + 2.0f * q0 * fay - 4.0f * q1 * faz;
+        float s2 = -2.0f * q0 * fax + 2.0f * q3 * fay - 4.0f * q2 * faz;
+        float s3 = 2.0f * q1 * fax + 2.0f * q2 * fay;
+
+        if (!((mx == 0.0f) && (my == 0.0f) && (mz == 0.0f))) {
+            norm = madgwick_inv_sqrt(mx * mx + my * my + mz * mz);
+            mx *= norm;
+            my *= norm;
+            mz *= norm;
+
+            // Reference direction of Earth's magnetic field
+            const float hx = mx * (q0q0 + q1q1 - q2q2 - q3q3) + 2.0f * my * (q1q2 - q0q3) + 2.0f * mz * (q0q2 + q1q3);
+            const float hy = 2.0f * mx * (q0q3 + q1q2) + my * (q0q0 - q1q1 + q2q2 - q3q3) + 2.0f * mz * (q2q3 - q0q1);
+            const float _2bx = madgwick_sqrt(hx * hx + hy * hy);
+            const float _2bz = 2.0f * mx * (q1q3 - q0q2) + 2.0f * my * (q0q1 + q2q3) + mz * (q0q0 - q1q1 - q2q2 + q3q3);
+            const float _4bx = 2.0f * _2bx;
+            const float _4bz = 2.0f * _2bz;
+
+            // Error between the measured and the expected field direction
+            const float fmx = _2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+            const float fmy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+            const float fmz = _2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz;
+
+            s0 += -_2bz * q2 * fmx + (-_2bx * q3 + _2bz * q1) * fmy + _2bx * q2 * fmz;
+            s1 += _2bz * q3 * fmx + (_2bx * q2 + _2bz * q0) * fmy + (_2bx * q3 - _4bz * q1) * fmz;
+            s2 += (-_4bx * q2 - _2bz * q0) * fmx + (_2bx * q1 + _2bz * q3) * fmy + (_2bx * q0 - _4bz * q2) * fmz;
+            s3 += (-_4bx * q3 + _2bz * q1) * fmx + (-_2bx * q0 + _2bz * q2) * fmy + _2bx * q1 * fmz;
+        }
+
+        // Apply the normalised feedback step
+        norm = f->beta * madgwick_inv_sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+        qdot0 -= norm * s0;
+        qdot1 -= norm * s1;
+        qdot2 -= norm * s2;
+        qdot3 -= norm * s3;
+    }
+
+    // Integrate rate of change of quaternion to yield quaternion
+    const float r0 = q0 + qdot0 * dt;
+    const float r1 = q1 + qdot1 * dt;
+    const float r2 = q2 + qdot2 * dt;
+    const float r3 = q3 + qdot3 * dt;
+
+    // Normalise quaternion
+    const float norm = madgwick_inv_sqrt(r0 * r0 + r1 * r1 + r2 * r2 + r3 * r3);
+    f->q[0] = r0 * norm;
+    f->q[1] = r1 * norm;
+    f->q[2] = r2 * norm;
+    f->q[3] = r3 * norm;
+}
+
+void madgwick_fast_update_batch(madgwick_filter_t* f,
+                                const madgwick_sample_t* samples,
+                                unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) {
+        madgwick_fast_update(f, &samples[i]);
+    }
+}
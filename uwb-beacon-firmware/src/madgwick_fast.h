@@ -0,0 +1,54 @@
+#ifndef MADGWICK_FAST_H
+#define MADGWICK_FAST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "MadgwickAHRS.h"
+
+/** @file madgwick_fast.h
+ *
+ * Optimised version of the Madgwick filter update in MadgwickAHRS.c, giving
+ * the same results within float rounding.
+ *
+ * The error terms of the gradient are computed once instead of once per
+ * quaternion component, the sample period is inverted once per update, the
+ * reference field uses a single precision square root and the quaternion is
+ * kept in registers during the update.
+ *
+ * The inverse square root strategy is chosen at compile time by defining
+ * MADGWICK_INV_SQRT to one of:
+ *  - MADGWICK_INV_SQRT_FPU (default): hardware square root and division. On
+ *    Cortex-M4F this uses the VSQRT instruction directly, without the errno
+ *    handling of sqrtf().
+ *  - MADGWICK_INV_SQRT_FAST: bit level approximation refined by two Newton
+ *    iterations, relative error below 5e-6.
+ *  - MADGWICK_INV_SQRT_LIBM: 1 / sqrtf(), as in the reference implementation.
+ */
+
+#define MADGWICK_INV_SQRT_FPU 0
+#define MADGWICK_INV_SQRT_FAST 1
+#define MADGWICK_INV_SQRT_LIBM 2
+
+#ifndef MADGWICK_INV_SQRT
+#define MADGWICK_INV_SQRT MADGWICK_INV_SQRT_FPU
+#endif
+
+/** Same as madgwick_filter_update(). If the magnetometer sample is all
+ * zeros, only the gyroscope and the accelerometer are used. */
+void madgwick_fast_update(madgwick_filter_t* f, const madgwick_sample_t* sample);
+
+/** Same as madgwick_filter_update_batch(). */
+void madgwick_fast_update_batch(madgwick_filter_t* f,
+                                const madgwick_sample_t* samples,
+                                unsigned count);
+
+/** Inverse square root, with the strategy selected by MADGWICK_INV_SQRT. */
+float madgwick_inv_sqrt(float x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -14,8 +14,14 @@
 
 #define AK8963_MAG_SENSITIVITY (4912.0f / 32760)
 
+/* Number of FIFO samples read in a single SPI transaction. */
+#define MPU9250_FIFO_READ_CHUNK 8
+
 static uint8_t mpu9250_reg_read(mpu9250_t* dev, uint8_t reg);
+static void mpu9250_reg_read_burst(mpu9250_t* dev, uint8_t reg, uint8_t* buf, size_t len);
 static void mpu9250_reg_write(mpu9250_t* dev, uint8_t reg, uint8_t val);
+static void mpu9250_fifo_reset(mpu9250_t* dev);
+static void mpu9250_parse_sample(const uint8_t* buf, mpu9250_data_t* data);
 
 void mpu9250_init(mpu9250_t* dev, SPIDriver* spi_dev)
 {
@@ -94,7 +100,9 @@ void mpu9250_enable_magnetometer(mpu9250_t* dev)
     /* Sets the address with the read bit set. */
     mpu9250_reg_write(dev, MPU9250_REG_I2C_SLV0_ADDR, AK8963_I2C_ADDR | (1 << 7));
 
-    /* Read 6 bytes from the magnetometer starting from the HXL register and store them. */
+    /* Read 7 bytes from the magnetometer starting from the HXL register and
+     * store them: the measurements followed by ST2, which must be read to
+     * get the next measurement. */
     mpu9250_reg_write(dev, MPU9250_REG_I2C_SLV0_REG, AK8963_REG_HXL);
     mpu9250_reg_write(dev, MPU9250_REG_I2C_SLV0_CTRL, (1 << 7) + 0x7);
 }
@@ -179,19 +187,120 @@ void mpu9250_mag_read(mpu9250_t* dev, float* x, float* y, float* z)
     *z = raw_z * AK8963_MAG_SENSITIVITY;
 }
 
+void mpu9250_burst_read(mpu9250_t* dev, mpu9250_data_t* data)
+{
+    /* INT_STATUS, ACCEL_*OUT, TEMP_OUT, GYRO_*OUT and EXT_SENS_DATA_00..06
+     * are contiguous. */
+    uint8_t buf[1 + MPU9250_FIFO_SAMPLE_SIZE];
+
+    mpu9250_reg_read_burst(dev, MPU9250_REG_INT_STATUS, buf, sizeof(buf));
+
+    data->interrupt_status = buf[0];
+    mpu9250_parse_sample(&buf[1], data);
+}
+
+void mpu9250_fifo_enable(mpu9250_t* dev)
+{
+    /* Samples are written in register order, which gives the same layout as
+     * the sensor registers read by mpu9250_burst_read(). */
+    mpu9250_reg_write(dev, MPU9250_REG_FIFO_EN,
+                      MPU9250_REG_FIFO_EN_TEMP_OUT | MPU9250_REG_FIFO_EN_GYRO_XOUT
+                          | MPU9250_REG_FIFO_EN_GYRO_YOUT | MPU9250_REG_FIFO_EN_GYRO_ZOUT
+                          | MPU9250_REG_FIFO_EN_ACCEL_OUT | MPU9250_REG_FIFO_EN_SLV_0);
+
+    mpu9250_reg_write(dev, MPU9250_REG_INT_ENABLE, 0);
+
+    mpu9250_fifo_reset(dev);
+}
+
+unsigned mpu9250_fifo_read(mpu9250_t* dev, mpu9250_data_t* samples, unsigned max_samples)
+{
+    uint8_t buf[MPU9250_FIFO_READ_CHUNK * MPU9250_FIFO_SAMPLE_SIZE];
+    uint8_t count_buf[2];
+    unsigned count, n, i;
+
+    mpu9250_reg_read_burst(dev, MPU9250_REG_FIFO_COUNTH, count_buf, sizeof(count_buf));
+    count = ((count_buf[0] & 0x1f) << 8) | count_buf[1];
+
+    /* The FIFO drops its oldest bytes when full, which is never a whole
+     * number of samples. */
+    if (count % MPU9250_FIFO_SAMPLE_SIZE != 0) {
+        mpu9250_fifo_reset(dev);
+        return 0;
+    }
+
+    count /= MPU9250_FIFO_SAMPLE_SIZE;
+    if (count > max_samples) {
+        count = max_samples;
+    }
+
+    for (n = 0; n < count; n += i) {
+        unsigned chunk = count - n;
+        if (chunk > MPU9250_FIFO_READ_CHUNK) {
+            chunk = MPU9250_FIFO_READ_CHUNK;
+        }
+
+        /* FIFO_R_W does not auto increment, it returns the next byte of the
+         * FIFO on every read. */
+        mpu9250_reg_read_burst(dev, MPU9250_REG_FIFO_R_W, buf, chunk * MPU9250_FIFO_SAMPLE_SIZE);
+
+        for (i = 0; i < chunk; i++) {
+            samples[n + i].interrupt_status = 0;
+            mpu9250_parse_sample(&buf[i * MPU9250_FIFO_SAMPLE_SIZE], &samples[n + i]);
+        }
+    }
+
+    return count;
+}
+
+static void mpu9250_fifo_reset(mpu9250_t* dev)
+{
+    uint8_t ctrl = mpu9250_reg_read(dev, MPU9250_REG_USER_CTRL);
+    mpu9250_reg_write(dev, MPU9250_REG_USER_CTRL, ctrl | MPU9250_REG_USER_CTRL_FIFO_RST);
+}
+
+static void mpu9250_parse_sample(const uint8_t* buf, mpu9250_data_t* data)
+{
+    int16_t raw;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        raw = (buf[2 * i] << 8) | buf[1 + 2 * i];
+        data->acc[i] = raw * MPU9250_ACCEL_SENSITIVITY;
+    }
+
+    raw = (buf[6] << 8) | buf[7];
+    data->temperature = MPU9250_TEMP_OFFSET + raw * MPU9250_TEMP_SENSITIVITY;
+
+    for (i = 0; i < 3; i++) {
+        raw = (buf[8 + 2 * i] << 8) | buf[9 + 2 * i];
+        data->gyro[i] = raw * MPU9250_GYRO_SENSITIVITY;
+    }
+
+    /* The magnetometer is little endian. */
+    for (i = 0; i < 3; i++) {
+        raw = (buf[15 + 2 * i] << 8) | buf[14 + 2 * i];
+        data->mag[i] = raw * AK8963_MAG_SENSITIVITY;
+    }
+}
+
 static uint8_t mpu9250_reg_read(mpu9250_t* dev, uint8_t reg)
 {
     uint8_t ret = 0;
+    mpu9250_reg_read_burst(dev, reg, &ret, 1);
+    return ret;
+}
 
+static void mpu9250_reg_read_burst(mpu9250_t* dev, uint8_t reg, uint8_t* buf, size_t len)
+{
     /* 7th bit indicates read (1) or write (0). */
     reg |= 0x80;
 
+    /* The register address auto increments during the read. */
     spiSelect(dev->spi);
     spiSend(dev->spi, 1, &reg);
-    spiReceive(dev->spi, 1, &ret);
+    spiReceive(dev->spi, len, buf);
     spiUnselect(dev->spi);
-
-    return ret;
 }
 
 static void mpu9250_reg_write(mpu9250_t* dev, uint8_t reg, uint8_t val)
@@ -13,6 +13,15 @@ typedef struct {
     SPIDriver* spi;
 } mpu9250_t;
 
+/** All the sensor data, read in a single SPI transaction. */
+typedef struct {
+    uint8_t interrupt_status;
+    float acc[3]; /**< Acceleration in m/s/s. */
+    float temperature; /**< Temperature in C. */
+    float gyro[3]; /**< Angular rate in rad/s. */
+    float mag[3]; /**< Magnetic field in uT. */
+} mpu9250_data_t;
+
 /** Initializes the given MPU9250 driver instance, but does not configure the
  * actual chip. */
 void mpu9250_init(mpu9250_t* dev, SPIDriver* spi_dev);
@@ -51,6 +60,38 @@ void mpu9250_mag_read(mpu9250_t* dev, float* x, float* y, float* z);
  */
 void mpu9250_acc_read(mpu9250_t* dev, float* x, float* y, float* z);
 
+/** Reads the interrupt status and all the sensors in one burst.
+ *
+ * This is much cheaper than the individual read functions, which need one
+ * SPI transaction per register. Reading the interrupt status clears it.
+ */
+void mpu9250_burst_read(mpu9250_t* dev, mpu9250_data_t* data);
+
+/** Size of a sample in the FIFO, in bytes: accelerometer, temperature,
+ * gyroscope, magnetometer and its ST2 status register. The magnetometer only
+ * latches new data once ST2 has been read, so it is part of every sample. */
+#define MPU9250_FIFO_SAMPLE_SIZE 21
+
+/** Stores every sample in the FIFO instead of signaling it with an interrupt.
+ *
+ * The data ready interrupt is disabled and the FIFO is cleared. The samples
+ * must then be read with mpu9250_fifo_read() often enough to avoid an
+ * overflow: the 512 bytes FIFO holds 24 samples.
+ *
+ * @note Must be called after mpu9250_enable_magnetometer(), as the
+ * magnetometer data is stored in the FIFO too.
+ */
+void mpu9250_fifo_enable(mpu9250_t* dev);
+
+/** Reads up to max_samples samples from the FIFO, oldest first.
+ *
+ * @returns The number of samples read. If the FIFO overflowed, it is cleared
+ * and no samples are returned, as its content is not aligned on samples
+ * anymore.
+ * @note The interrupt_status field of the samples is not set.
+ */
+unsigned mpu9250_fifo_read(mpu9250_t* dev, mpu9250_data_t* samples, unsigned max_samples);
+
 /** Reads temperature data from the MPU.
  *
  * @note result is in C.
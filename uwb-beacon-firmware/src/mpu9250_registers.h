@@ -108,6 +108,7 @@
 #define MPU9250_REG_FIFO_EN_GYRO_YOUT (1 << 5)
 #define MPU9250_REG_FIFO_EN_GYRO_ZOUT (1 << 4)
 #define MPU9250_REG_FIFO_EN_ACCEL_OUT (1 << 3)
+#define MPU9250_REG_FIFO_EN_SLV_0 (1 << 0)
 
 /* INT Pin / Bypass Enable Configuration */
 #define MPU9250_REG_INT_PIN_CFG_ACTIVE_LOW (1 << 7)
@@ -0,0 +1,128 @@
+#include <math.h>
+#include <string.h>
+#include "range_filter.h"
+
+/** Number of accepted ranges before the running variance of an anchor is
+ * trusted. */
+#define RANGE_FILTER_STATS_WARMUP 10
+
+static range_filter_anchor_t* find_anchor(range_filter_t* f, uint16_t addr)
+{
+    for (unsigned i = 0; i < f->anchor_count; i++) {
+        if (f->anchors[i].addr == addr) {
+            return &f->anchors[i];
+        }
+    }
+
+    /* When the table is full, new anchors are checked without statistics. */
+    if (f->anchor_count == RANGE_FILTER_MAX_ANCHORS) {
+        return NULL;
+    }
+
+    range_filter_anchor_t* anchor = &f->anchors[f->anchor_count++];
+    memset(anchor, 0, sizeof(range_filter_anchor_t));
+    anchor->addr = addr;
+
+    return anchor;
+}
+
+static void update_stats(range_filter_t* f, range_filter_anchor_t* anchor, float innovation)
+{
+    if (anchor->count == 0) {
+        anchor->innovation_mean = innovation;
+        anchor->innovation_variance = 0.f;
+    } else {
+        /* Exponentially weighted mean and variance. */
+        float a = f->stats_alpha;
+        float diff = innovation - anchor->innovation_mean;
+        anchor->innovation_mean += a * diff;
+        anchor->innovation_variance = (1 - a) * (anchor->innovation_variance + a * diff * diff);
+    }
+
+    anchor->count++;
+}
+
+void range_filter_init(range_filter_t* f)
+{
+    memset(f, 0, sizeof(range_filter_t));
+    f->gate = 9.f;
+    f->nlos_threshold_db = 0.f;
+    f->stats_alpha = 0.05f;
+    f->max_consecutive_rejections = 20;
+}
+
+range_filter_result_t range_filter_check(range_filter_t* f,
+                                         uint16_t anchor_addr,
+                                         float innovation,
+                                         float innovation_variance,
+                                         float power_ratio_db)
+{
+    range_filter_anchor_t* anchor = find_anchor(f, anchor_addr);
+
+    if (f->nlos_threshold_db > 0 && power_ratio_db > f->nlos_threshold_db) {
+        f->rejected_nlos++;
+        if (anchor) {
+            anchor->rejected++;
+        }
+        return RANGE_FILTER_REJECTED_NLOS;
+    }
+
+    /* Anchors noisier or more biased than what the estimator expects get a
+     * wider gate, based on their mean square innovation. */
+    float variance = innovation_variance;
+    if (anchor && anchor->count >= RANGE_FILTER_STATS_WARMUP) {
+        float mean_square = anchor->innovation_variance + anchor->innovation_mean * anchor->innovation_mean;
+        if (mean_square > variance) {
+            variance = mean_square;
+        }
+    }
+
+    bool outlier = innovation * innovation > f->gate * variance;
+
+    /* After too many rejections in a row, the estimate is more likely to be
+     * wrong than the anchor, let it converge again. */
+    if (outlier && anchor && anchor->consecutive_rejections >= f->max_consecutive_rejections) {
+        outlier = false;
+    }
+
+    if (outlier) {
+        f->rejected_gate++;
+        if (anchor) {
+            anchor->rejected++;
+            anchor->consecutive_rejections++;
+        }
+        return RANGE_FILTER_REJECTED_GATE;
+    }
+
+    f->accepted++;
+    if (anchor) {
+        anchor->consecutive_rejections = 0;
+        update_stats(f, anchor, innovation);
+    }
+
+    return RANGE_FILTER_ACCEPTED;
+}
+
+const range_filter_anchor_t* range_filter_anchor_stats(const range_filter_t* f, uint16_t anchor_addr)
+{
+    for (unsigned i = 0; i < f->anchor_count; i++) {
+        if (f->anchors[i].addr == anchor_addr) {
+            return &f->anchors[i];
+        }
+    }
+
+    return NULL;
+}
+
+float range_filter_power_ratio(uint16_t fp_ampl1, uint16_t fp_ampl2, uint16_t fp_ampl3, uint16_t cir_power)
+{
+    float fp_energy = (float)fp_ampl1 * fp_ampl1 + (float)fp_ampl2 * fp_ampl2 + (float)fp_ampl3 * fp_ampl3;
+
+    if (fp_energy <= 0 || cir_power == 0) {
+        return 0.f;
+    }
+
+    /* Rx power = 10 log10(C * 2^17 / N^2) - A
+     * First path power = 10 log10((F1^2 + F2^2 + F3^2) / N^2) - A */
+    return 10.f * log10f(cir_power * 131072.f / fp_energy);
+}
@@ -0,0 +1,107 @@
+#ifndef RANGE_FILTER_H
+#define RANGE_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @file range_filter.h
+ *
+ * Rejection of reflected and non line of sight ranges before they reach the
+ * position estimator.
+ *
+ * Three checks are applied to every range:
+ *  - The DW1000 receive diagnostics: when the first path is much weaker than
+ *    the total received power, the direct path is likely blocked (optional).
+ *  - Innovation gating: the squared innovation, normalized by its variance
+ *    (Mahalanobis distance), must be below a chi-square threshold.
+ *  - Per anchor running statistics of the innovation, which widen the gate
+ *    of anchors noisier than the filter expects, and let an anchor back in
+ *    after too many consecutive rejections, so that the estimator cannot lock
+ *    itself out after a jump of the robot.
+ */
+
+/** Maximum number of anchors for which statistics are kept. */
+#define RANGE_FILTER_MAX_ANCHORS 16
+
+typedef enum {
+    RANGE_FILTER_ACCEPTED = 0,
+    RANGE_FILTER_REJECTED_GATE,
+    RANGE_FILTER_REJECTED_NLOS,
+} range_filter_result_t;
+
+typedef struct {
+    uint16_t addr;
+    uint32_t count; ///< Number of accepted ranges
+    float innovation_mean; ///< Running mean of the innovation, in meters
+    float innovation_variance; ///< Running variance of the innovation, in m^2
+    uint32_t consecutive_rejections;
+    uint32_t rejected; ///< Total number of rejected ranges
+} range_filter_anchor_t;
+
+typedef struct {
+    /** Chi-square threshold on the normalized innovation squared. 9 keeps
+     * ranges within 3 standard deviations. */
+    float gate;
+
+    /** Ranges whose total received power exceeds the first path power by more
+     * than this are considered NLOS, in dB. Zero or less disables the check. */
+    float nlos_threshold_db;
+
+    /** Weight of a new sample in the running statistics. */
+    float stats_alpha;
+
+    /** Number of consecutive rejections after which an anchor is accepted
+     * again. */
+    uint32_t max_consecutive_rejections;
+
+    range_filter_anchor_t anchors[RANGE_FILTER_MAX_ANCHORS];
+    unsigned anchor_count;
+
+    uint32_t rejected_gate;
+    uint32_t rejected_nlos;
+    uint32_t accepted;
+} range_filter_t;
+
+/** Initializes a filter with the default settings. */
+void range_filter_init(range_filter_t* f);
+
+/** Decides if a range can be given to the estimator.
+ *
+ * @param [in] innovation Measured range minus the predicted one, in meters.
+ * @param [in] innovation_variance Variance of the innovation predicted by the
+ * estimator, in m^2.
+ * @param [in] power_ratio_db Total received power over first path power, as
+ * returned by range_filter_power_ratio(). Ignored if the NLOS check is
+ * disabled.
+ */
+range_filter_result_t range_filter_check(range_filter_t* f,
+                                         uint16_t anchor_addr,
+                                         float innovation,
+                                         float innovation_variance,
+                                         float power_ratio_db);
+
+/** Returns the statistics of the given anchor, or NULL if it was never
+ * seen. */
+const range_filter_anchor_t* range_filter_anchor_stats(const range_filter_t* f, uint16_t anchor_addr);
+
+/** Computes the ratio of total received power to first path power, in dB,
+ * from the DW1000 receive diagnostics.
+ *
+ * The preamble count and the PRF dependent constant of the power formulas in
+ * the DW1000 user manual cancel out in the ratio.
+ *
+ * @param [in] fp_ampl1, fp_ampl2, fp_ampl3 First path amplitudes
+ * (FP_AMPL1..3).
+ * @param [in] cir_power Channel impulse response power (CIR_PWR).
+ */
+float range_filter_power_ratio(uint16_t fp_ampl1, uint16_t fp_ampl2, uint16_t fp_ampl3, uint16_t cir_power);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
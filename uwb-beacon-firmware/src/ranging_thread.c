@@ -1,5 +1,6 @@
 #include <ch.h>
 
+#include <stdio.h>
 #include <string.h>
 
 #include "decadriver/deca_device_api.h"
@@ -9,6 +10,10 @@
 #include "decawave_interface.h"
 #include "ranging_thread.h"
 #include "uwb_protocol.h"
+#include "tdma_scheduler.h"
+#include "range_filter.h"
+#include "uwb_calibration.h"
+#include "uwb_fragmentation.h"
 #include "exti.h"
 #include "state_estimation_thread.h"
 #include "trace_points.h"
@@ -19,17 +24,45 @@
 /* Antenna delay for our UWB board. */
 #define RX_ANT_DLY 32915
 
+/** Number of per anchor range offsets stored in parameters. */
+#define UWB_CALIBRATION_PARAM_ENTRIES 8
+
+/** Converts the DW1000 carrier integrator to a relative clock offset. */
+#define CARRIER_INTEGRATOR_TO_CLOCK_OFFSET (FREQ_OFFSET_MULTIPLIER * HERTZ_TO_PPM_MULTIPLIER_CHAN_5 / 1e6)
+
 #define EVENT_UWB_INT (1 << 0)
 #define EVENT_ADVERTISE_TIMER (1 << 1)
 #define EVENT_ANCHOR_POSITION_TIMER (1 << 2)
 #define EVENT_TAG_POSITION_TIMER (1 << 3)
 #define EVENT_DATA_PACKET_READY (1 << 4)
+#define EVENT_TDMA_BEACON_TIMER (1 << 5)
+#define EVENT_POLL_FINAL_TIMER (1 << 6)
+#define EVENT_DATA_TX_TIMER (1 << 7)
 
 /* TODO: Put this in parameters. */
 #define UWB_ANCHOR_POSITION_TIMER_PERIOD TIME_S2I(1)
 #define UWB_TAG_POSITION_TIMER_PERIOD TIME_MS2I(300)
+#define UWB_TDMA_BEACON_TIMER_PERIOD TIME_S2I(1)
+
+/* Time after which the final frame of a broadcast poll is sent even if the
+ * last anchor did not answer. Covers the reply delay, one response slot per
+ * anchor and the final delay. */
+#define UWB_POLL_FINAL_TIMEOUT_US(anchor_count) (2500 + 520 * (anchor_count))
+
+/* Packets waiting for the current transfer to finish. Matches the transmit
+ * queue of the master board, so that it can hand us a full burst. */
+#define DATA_PACKET_QUEUE_LEN 4
+
+/* Time after which the data link tries again when it had to wait for a
+ * ranging exchange to finish. */
+#define DATA_LINK_RANGING_BACKOFF_US 1000
 
 static uwb_protocol_handler_t handler;
+static tdma_scheduler_t tdma;
+static uwb_calibration_t calibration;
+
+/** Receive quality of the last frame, attached to the ranges it completes. */
+static float last_rx_power_ratio;
 
 static messagebus_topic_t ranging_topic;
 static MUTEX_DECL(ranging_topic_lock);
@@ -51,22 +84,59 @@ static MUTEX_DECL(data_packet_topic_lock);
 static CONDVAR_DECL(data_packet_topic_condvar);
 static data_packet_msg_t data_packet_topic_buffer;
 
+static messagebus_topic_t ranging_stats_topic;
+static MUTEX_DECL(ranging_stats_topic_lock);
+static CONDVAR_DECL(ranging_stats_topic_condvar);
+static ranging_stats_msg_t ranging_stats_topic_buffer;
+
 static EVENTSOURCE_DECL(advertise_timer_event);
 static EVENTSOURCE_DECL(anchor_position_timer_event);
 static EVENTSOURCE_DECL(tag_position_timer_event);
 static EVENTSOURCE_DECL(data_packet_ready_event);
+static EVENTSOURCE_DECL(tdma_beacon_timer_event);
+static EVENTSOURCE_DECL(poll_final_timer_event);
+static EVENTSOURCE_DECL(data_tx_timer_event);
+
+static virtual_timer_t advertise_timer;
+static virtual_timer_t poll_final_timer;
+static virtual_timer_t data_tx_timer;
 
-static BSEMAPHORE_DECL(data_packet_sent, true);
+/** Packets waiting for the current transfer to finish, oldest first. */
 static MUTEX_DECL(data_packet_lock);
-static const uint8_t* data_packet;
-static uint16_t data_packet_dst_mac;
-static size_t data_packet_size;
+static struct {
+    struct {
+        uint16_t dst_mac;
+        size_t size;
+        uint8_t data[UWB_FRAGMENT_MAX_PACKET_SIZE];
+    } packets[DATA_PACKET_QUEUE_LEN];
+    unsigned head;
+    unsigned count;
+    uint32_t dropped; ///< Packets refused because the queue was full
+} data_packet_queue;
+
+/** Fragmented transfers of user packets. */
+static uwb_fragment_tx_t data_tx;
+static uwb_fragment_rx_t data_rx;
+
+/** Set while one of our fragments or acknowledgements is being sent. */
+static bool data_frame_in_air;
+
+/** Set when a UWB event lets the data transfer make progress. */
+static bool data_link_wakeup;
+
+static struct {
+    bool pending;
+    uint16_t dst_mac;
+    uint8_t payload[UWB_FRAGMENT_ACK_SIZE];
+} data_ack;
 
 static struct {
     parameter_namespace_t ns;
     parameter_t mac_addr;
     parameter_t pan_id;
     parameter_t antenna_delay;
+    parameter_t broadcast_poll;
+    parameter_t clock_offset_correction;
     struct {
         parameter_namespace_t ns;
         parameter_t is_anchor;
@@ -76,13 +146,46 @@ static struct {
             parameter_t x, y, z;
         } position;
     } anchor;
+    struct {
+        parameter_namespace_t ns;
+        parameter_t slot_count;
+        parameter_t slot_duration_ms;
+        parameter_t slot;
+        parameter_t coordinator;
+    } tdma;
+    struct {
+        parameter_namespace_t ns;
+        parameter_t enabled;
+        parameter_t samples;
+        struct {
+            parameter_namespace_t ns;
+            parameter_t x, y, z;
+        } position;
+        struct {
+            parameter_namespace_t ns;
+            char name[4];
+            parameter_t mac_addr;
+            parameter_t offset;
+        } anchors[UWB_CALIBRATION_PARAM_ENTRIES];
+    } calibration;
 } uwb_params;
 
 static void ranging_thread(void* p);
 static void ranging_found_cb(uint16_t addr, uint64_t time);
 static void anchor_position_received_cb(uint16_t addr, float x, float y, float z);
 static void data_packet_received_cb(const uint8_t* msg, size_t size, uint16_t src, uint16_t dst);
+static void data_fragment_received_cb(const uint8_t* payload, size_t size, uint16_t src, uint16_t dst);
+static void data_ack_received_cb(const uint8_t* payload, size_t size, uint16_t src);
+static void data_link_spin(uint8_t* frame);
 static void tag_position_received_cb(uint16_t addr, float x, float y);
+static void tdma_beacon_received_cb(uint16_t addr, uint8_t slot_count, uint32_t slot_duration_us);
+static void tdma_configure_from_parameters(unsigned slot_count, uint32_t slot_duration_us);
+static void schedule_next_exchange(void);
+static uint32_t exchange_duration(void);
+static void publish_ranging_stats(void);
+static void calibration_update_from_parameters(void);
+static void calibration_save_to_parameters(void);
+static uint32_t now_us(void);
 static void topics_init(void);
 static void parameters_init(void);
 static void hardware_init(void);
@@ -91,6 +194,9 @@ static void events_init(void);
 static void advertise_timer_cb(void* t);
 static void anchor_position_timer_cb(void* t);
 static void tag_position_timer_cb(void* t);
+static void tdma_beacon_timer_cb(void* t);
+static void poll_final_timer_cb(void* t);
+static void data_tx_timer_cb(void* t);
 static void frame_tx_done_cb(const dwt_cb_data_t* data);
 static void frame_rx_cb(const dwt_cb_data_t* data);
 static void frame_rx_timeout_cb(const dwt_cb_data_t* data);
@@ -98,7 +204,10 @@ static void frame_rx_error_cb(const dwt_cb_data_t* data);
 
 void ranging_start(void)
 {
-    static THD_WORKING_AREA(ranging_wa, 512);
+    /* Runs the TDMA schedule, the broadcast polls, the calibration and the
+     * data link on top of the DW1000 callbacks. Check the headroom with the
+     * stack shell command after changing what runs here. */
+    static THD_WORKING_AREA(ranging_wa, 2048);
     chThdCreateStatic(ranging_wa, sizeof(ranging_wa), HIGHPRIO, ranging_thread, NULL);
 }
 
@@ -112,6 +221,14 @@ static void ranging_thread(void* p)
     handler.anchor_position_received_cb = anchor_position_received_cb;
     handler.tag_position_received_cb = tag_position_received_cb;
     handler.user_data_received_cb = data_packet_received_cb;
+    handler.data_fragment_received_cb = data_fragment_received_cb;
+    handler.data_ack_received_cb = data_ack_received_cb;
+    handler.tdma_beacon_received_cb = tdma_beacon_received_cb;
+
+    tdma_init(&tdma);
+    uwb_calibration_init(&calibration);
+    uwb_fragment_tx_init(&data_tx);
+    uwb_fragment_rx_init(&data_rx);
 
     parameters_init();
     topics_init();
@@ -120,10 +237,6 @@ static void ranging_thread(void* p)
 
     static uint8_t frame[1024];
 
-    int current_anchor_mac_index = 0;
-    uint16_t anchor_macs[] = {7, 10, 11, 14};
-    int nb_anchor_macs = sizeof(anchor_macs) / sizeof(anchor_macs[0]);
-
     while (1) {
         /* Wait for an interrupt coming from the UWB module. */
         eventmask_t flags = chEvtWaitOne(ALL_EVENTS);
@@ -137,50 +250,102 @@ static void ranging_thread(void* p)
             dwt_setrxantennadelay(parameter_integer_get(&uwb_params.antenna_delay));
         }
 
+        if (parameter_namespace_contains_changed(&uwb_params.calibration.ns)) {
+            calibration_update_from_parameters();
+        }
+
+        if (parameter_namespace_contains_changed(&uwb_params.tdma.ns)) {
+            tdma_configure_from_parameters(parameter_integer_get(&uwb_params.tdma.slot_count),
+                                           parameter_integer_get(&uwb_params.tdma.slot_duration_ms) * 1000);
+        }
+
         if (flags & EVENT_ADVERTISE_TIMER) {
-            if (!handler.is_anchor && nb_anchor_macs > 0) {
+            uint16_t anchor_addr;
+
+            tdma_expire_anchors(&tdma, now_us());
+
+            if (handler.is_anchor || !tdma_can_start_exchange(&tdma, now_us(), exchange_duration())) {
+                /* Not our turn */
+            } else if (parameter_boolean_get(&uwb_params.broadcast_poll)) {
+                uint16_t anchors[UWB_POLL_MAX_ANCHORS];
+                unsigned anchor_count = tdma_anchor_list(&tdma, anchors, UWB_POLL_MAX_ANCHORS);
+
+                if (anchor_count > 0) {
+                    dwt_forcetrxoff();
+
+                    /* Range with all anchors at once */
+                    uwb_send_poll(&handler, anchors, anchor_count, frame);
+                    chVTSet(&poll_final_timer,
+                            TIME_US2I(UWB_POLL_FINAL_TIMEOUT_US(anchor_count)),
+                            poll_final_timer_cb,
+                            NULL);
+                }
+            } else if (tdma_next_anchor(&tdma, &anchor_addr)) {
                 /* First disable transceiver */
                 dwt_forcetrxoff();
 
                 /* Initiate measurement sequence */
-                uwb_initiate_measurement(&handler, frame, anchor_macs[current_anchor_mac_index]);
+                uwb_initiate_measurement(&handler, frame, anchor_addr);
+            }
 
-                current_anchor_mac_index++;
-                if (current_anchor_mac_index == nb_anchor_macs) {
-                    current_anchor_mac_index = 0;
-                }
+            schedule_next_exchange();
+        }
+
+        if (flags & EVENT_POLL_FINAL_TIMER) {
+            /* The last anchor did not answer, finish the poll with the
+             * responses we got. */
+            if (handler.poll.pending) {
+                dwt_forcetrxoff();
+                uwb_send_poll_final(&handler, frame);
             }
         }
 
-        if (flags & EVENT_ANCHOR_POSITION_TIMER) {
-            /* Make sure we are an anchor before we send an anchor position
-             * message. */
-            if (!handler.is_anchor) {
-                continue;
+        if (flags & EVENT_TDMA_BEACON_TIMER) {
+            if (handler.is_anchor && parameter_boolean_get(&uwb_params.tdma.coordinator)) {
+                dwt_forcetrxoff();
+
+                uwb_send_tdma_beacon(&handler, tdma.slot_count, tdma.slot_duration, frame);
+
+                /* The coordinator uses its own beacon as superframe start. */
+                tdma_synchronize(&tdma, now_us());
             }
+        }
+
+        if (flags & EVENT_ANCHOR_POSITION_TIMER) {
+            /* This period is also used to publish the ranging statistics. */
+            publish_ranging_stats();
 
-            /* First disable transceiver */
-            dwt_forcetrxoff();
+            if (handler.is_anchor) {
+                /* First disable transceiver */
+                dwt_forcetrxoff();
 
-            float x, y, z;
-            x = parameter_scalar_get(&uwb_params.anchor.position.x);
-            y = parameter_scalar_get(&uwb_params.anchor.position.y);
-            z = parameter_scalar_get(&uwb_params.anchor.position.z);
+                float x, y, z;
+                x = parameter_scalar_get(&uwb_params.anchor.position.x);
+                y = parameter_scalar_get(&uwb_params.anchor.position.y);
+                z = parameter_scalar_get(&uwb_params.anchor.position.z);
 
-            uwb_send_anchor_position(&handler, x, y, z, frame);
+                uwb_send_anchor_position(&handler, x, y, z, frame);
+            }
         }
 
-        if (flags & EVENT_DATA_PACKET_READY) {
-            dwt_forcetrxoff();
-            uwb_send_data_packet(&handler, data_packet_dst_mac, data_packet, data_packet_size, frame);
+        if (flags & EVENT_DATA_TX_TIMER) {
+            /* Recovers from a TX done event lost to a forced TX off. */
+            data_frame_in_air = false;
+        }
 
-            chBSemSignal(&data_packet_sent);
+        if (flags & (EVENT_DATA_PACKET_READY | EVENT_DATA_TX_TIMER)) {
+            data_link_wakeup = true;
         }
 
         if (flags & EVENT_UWB_INT) {
             /* Process the interrupt. */
             dwt_isr();
         }
+
+        if (data_link_wakeup) {
+            data_link_wakeup = false;
+            data_link_spin(frame);
+        }
     }
 }
 
@@ -188,6 +353,12 @@ static void frame_tx_done_cb(const dwt_cb_data_t* data)
 {
     (void)data;
     trace(TRACE_POINT_UWB_TX_DONE);
+
+    /* The next fragment can only be written once the previous one is out. */
+    if (data_frame_in_air) {
+        data_frame_in_air = false;
+        data_link_wakeup = true;
+    }
 }
 
 /* TODO: Handle RX errors as well, especially timeouts. */
@@ -195,11 +366,20 @@ static void frame_rx_cb(const dwt_cb_data_t* data)
 {
     static uint8_t frame[1024];
     trace(TRACE_POINT_UWB_RX);
-    uint64_t rx_ts = decawave_get_rx_timestamp_u64();
+    decawave_rx_info_t rx_info;
 
+    decawave_read_rx_info(&rx_info);
     dwt_readrxdata(frame, data->datalength, 0);
 
-    uwb_process_incoming_frame(&handler, frame, data->datalength, rx_ts);
+    handler.rx_clock_offset = dwt_readcarrierintegrator() * CARRIER_INTEGRATOR_TO_CLOCK_OFFSET;
+    handler.rx_clock_offset_valid = parameter_boolean_read(&uwb_params.clock_offset_correction);
+
+    last_rx_power_ratio = range_filter_power_ratio(rx_info.fp_ampl1,
+                                                   rx_info.fp_ampl2,
+                                                   rx_info.fp_ampl3,
+                                                   rx_info.cir_power);
+
+    uwb_process_incoming_frame(&handler, frame, data->datalength, rx_info.timestamp);
 
     dwt_rxenable(DWT_START_RX_IMMEDIATE);
 }
@@ -220,6 +400,118 @@ static void frame_rx_error_cb(const dwt_cb_data_t* data)
     dwt_rxenable(DWT_START_RX_IMMEDIATE);
 }
 
+static uint32_t now_us(void)
+{
+    /* TODO: For some reason the macro ST2US creates an overflow. */
+    return chVTGetSystemTime() * (1000000 / CH_CFG_ST_FREQUENCY);
+}
+
+/** Time the next ranging exchange keeps the channel busy, used to check that
+ * it ends within our TDMA slot. */
+static uint32_t exchange_duration(void)
+{
+    if (parameter_boolean_get(&uwb_params.broadcast_poll)) {
+        return UWB_POLL_EXCHANGE_DURATION_US(tdma.anchor_count) + TDMA_GUARD_TIME_US;
+    }
+
+    return UWB_TWR_EXCHANGE_DURATION_US + TDMA_GUARD_TIME_US;
+}
+
+/** Arms the advertise timer for the next ranging exchange, waiting for our
+ * next TDMA slot if the current one is over. */
+static void schedule_next_exchange(void)
+{
+    uint32_t period = parameter_integer_get(&uwb_params.anchor.advertisement_period_ms) * 1000;
+    uint32_t next = now_us() + period;
+    uint32_t delay = period;
+
+    if (!tdma_can_start_exchange(&tdma, next, exchange_duration())) {
+        delay += tdma_time_until_own_slot(&tdma, next);
+    }
+
+    chVTSet(&advertise_timer, TIME_US2I(delay), advertise_timer_cb, NULL);
+}
+
+static void tdma_configure_from_parameters(unsigned slot_count, uint32_t slot_duration_us)
+{
+    int slot = parameter_integer_get(&uwb_params.tdma.slot);
+
+    /* Negative slots mean the slot is derived from the MAC address. */
+    if (slot < 0) {
+        slot = parameter_integer_get(&uwb_params.mac_addr);
+    }
+
+    tdma_configure(&tdma, slot_count, slot_duration_us, slot);
+}
+
+static void tdma_beacon_received_cb(uint16_t addr, uint8_t slot_count, uint32_t slot_duration_us)
+{
+    (void)addr;
+
+    /* The layout sent by the coordinator has precedence over our parameters. */
+    tdma_configure_from_parameters(slot_count, slot_duration_us);
+    tdma_synchronize(&tdma, now_us());
+}
+
+static void publish_ranging_stats(void)
+{
+    ranging_stats_msg_t msg;
+
+    msg.timestamp = now_us();
+    msg.tag_addr = handler.address;
+    msg.update_rate = tdma_update_rate(&tdma, msg.timestamp);
+    msg.anchor_count = tdma.anchor_count;
+    msg.slot = tdma.slot;
+
+    chMtxLock(&data_packet_lock);
+    msg.data_packets_dropped = data_packet_queue.dropped + data_tx.packets_dropped;
+    chMtxUnlock(&data_packet_lock);
+
+    messagebus_topic_publish(&ranging_stats_topic, &msg, sizeof(msg));
+}
+
+static void calibration_update_from_parameters(void)
+{
+    for (int i = 0; i < UWB_CALIBRATION_PARAM_ENTRIES; i++) {
+        int32_t mac_addr = parameter_integer_get(&uwb_params.calibration.anchors[i].mac_addr);
+        float offset = parameter_scalar_get(&uwb_params.calibration.anchors[i].offset);
+
+        if (mac_addr >= 0) {
+            uwb_calibration_set_offset(&calibration, mac_addr, offset);
+        }
+    }
+
+    float position[3];
+    position[0] = parameter_scalar_get(&uwb_params.calibration.position.x);
+    position[1] = parameter_scalar_get(&uwb_params.calibration.position.y);
+    position[2] = parameter_scalar_get(&uwb_params.calibration.position.z);
+    uint32_t samples = parameter_integer_get(&uwb_params.calibration.samples);
+
+    if (!parameter_boolean_get(&uwb_params.calibration.enabled)) {
+        calibration.calibrating = false;
+    } else if (!calibration.calibrating) {
+        uwb_calibration_start(&calibration, position, samples);
+    }
+}
+
+/** Stores the result of the calibration, so that it can be saved to flash. */
+static void calibration_save_to_parameters(void)
+{
+    int entry = 0;
+
+    for (unsigned i = 0; i < calibration.anchor_count && entry < UWB_CALIBRATION_PARAM_ENTRIES; i++) {
+        if (!calibration.anchors[i].position_known) {
+            continue;
+        }
+
+        parameter_integer_set(&uwb_params.calibration.anchors[entry].mac_addr, calibration.anchors[i].addr);
+        parameter_scalar_set(&uwb_params.calibration.anchors[entry].offset, calibration.anchors[i].offset);
+        entry++;
+    }
+
+    parameter_boolean_set(&uwb_params.calibration.enabled, false);
+}
+
 static void anchor_position_received_cb(uint16_t addr, float x, float y, float z)
 {
     anchor_position_msg_t msg;
@@ -233,6 +525,9 @@ static void anchor_position_received_cb(uint16_t addr, float x, float y, float z
     msg.y = y;
     msg.z = z;
 
+    tdma_anchor_seen(&tdma, addr, ts);
+    uwb_calibration_anchor_position(&calibration, addr, x, y, z);
+
     messagebus_topic_publish(&anchor_position_topic, &msg, sizeof(msg));
 }
 
@@ -257,9 +552,18 @@ static void ranging_found_cb(uint16_t addr, uint64_t time)
     /* TODO: For some reason the macro ST2US creates an overflow. */
     uint32_t ts = chVTGetSystemTime() * (1000000 / CH_CFG_ST_FREQUENCY);
 
+    float range = time * SPEED_OF_LIGHT;
+
+    if (uwb_calibration_add_range(&calibration, addr, range)) {
+        calibration_save_to_parameters();
+    }
+
     msg.timestamp = ts;
     msg.anchor_addr = addr;
-    msg.range = time * SPEED_OF_LIGHT;
+    msg.range = uwb_calibration_correct_range(&calibration, addr, range);
+    msg.power_ratio = last_rx_power_ratio;
+
+    tdma_range_received(&tdma, ts);
 
     messagebus_topic_publish(&ranging_topic, &msg, sizeof(msg));
 }
@@ -276,13 +580,88 @@ static void data_packet_received_cb(const uint8_t* data, size_t size, uint16_t s
     messagebus_topic_publish(&data_packet_topic, &msg, sizeof(msg));
 }
 
+static void data_fragment_received_cb(const uint8_t* payload, size_t size, uint16_t src, uint16_t dst)
+{
+    uwb_fragment_rx_result_t result;
+
+    uwb_fragment_rx_process(&data_rx, src, dst, payload, size, now_us(), &result);
+
+    if (result.packet) {
+        data_packet_received_cb(result.packet, result.packet_size, src, result.dst_addr);
+    }
+
+    if (result.ack_needed) {
+        data_ack.pending = true;
+        data_ack.dst_mac = src;
+        memcpy(data_ack.payload, result.ack, sizeof(data_ack.payload));
+        data_link_wakeup = true;
+    }
+}
+
+static void data_ack_received_cb(const uint8_t* payload, size_t size, uint16_t src)
+{
+    uwb_fragment_tx_ack(&data_tx, src, payload, size);
+    data_link_wakeup = true;
+}
+
+/** Sends the next acknowledgement or fragment, one frame at a time. */
+static void data_link_spin(uint8_t* frame)
+{
+    static uint8_t payload[UWB_FRAGMENT_MAX_SIZE];
+    uint16_t dst_mac;
+    size_t size;
+
+    if (data_frame_in_air) {
+        return;
+    }
+
+    /* Turning the transceiver off to send now would abort the exchange. */
+    if (uwb_ranging_in_progress(&handler, uwb_timestamp_get())) {
+        chVTSet(&data_tx_timer, TIME_US2I(DATA_LINK_RANGING_BACKOFF_US), data_tx_timer_cb, NULL);
+        return;
+    }
+
+    /* Acknowledgements go first, as the sender waits for them. */
+    if (data_ack.pending) {
+        data_ack.pending = false;
+        dwt_forcetrxoff();
+        uwb_send_data_ack(&handler, data_ack.dst_mac, data_ack.payload, sizeof(data_ack.payload), frame);
+        data_frame_in_air = true;
+        return;
+    }
+
+    bool queue_empty;
+    chMtxLock(&data_packet_lock);
+    if (!uwb_fragment_tx_busy(&data_tx) && data_packet_queue.count > 0) {
+        unsigned head = data_packet_queue.head;
+        uwb_fragment_tx_start(&data_tx, data_packet_queue.packets[head].dst_mac,
+                              data_packet_queue.packets[head].data, data_packet_queue.packets[head].size);
+        data_packet_queue.head = (head + 1) % DATA_PACKET_QUEUE_LEN;
+        data_packet_queue.count--;
+    }
+    queue_empty = data_packet_queue.count == 0;
+    chMtxUnlock(&data_packet_lock);
+
+    size = uwb_fragment_tx_next(&data_tx, now_us(), payload, &dst_mac);
+    if (size > 0) {
+        dwt_forcetrxoff();
+        uwb_send_data_fragment(&handler, dst_mac, payload, size, frame);
+        data_frame_in_air = true;
+    }
+
+    /* Wakes us up for retransmissions, or to start the next packet if this
+     * one is done. */
+    if (uwb_fragment_tx_busy(&data_tx) || !queue_empty) {
+        chVTSet(&data_tx_timer, TIME_US2I(UWB_FRAGMENT_ACK_TIMEOUT_US), data_tx_timer_cb, NULL);
+    }
+}
+
 static void advertise_timer_cb(void* t)
 {
-    virtual_timer_t* timer = (virtual_timer_t*)t;
+    (void)t;
 
+    /* The ranging thread rearms the timer according to the TDMA schedule. */
     chSysLockFromISR();
-    int period = uwb_params.anchor.advertisement_period_ms.value.i;
-    chVTSetI(timer, TIME_MS2I(period), advertise_timer_cb, t);
     chEvtBroadcastI(&advertise_timer_event);
     chSysUnlockFromISR();
 }
@@ -307,6 +686,34 @@ static void tag_position_timer_cb(void* t)
     chSysUnlockFromISR();
 }
 
+static void tdma_beacon_timer_cb(void* t)
+{
+    virtual_timer_t* timer = (virtual_timer_t*)t;
+
+    chSysLockFromISR();
+    chVTSetI(timer, UWB_TDMA_BEACON_TIMER_PERIOD, tdma_beacon_timer_cb, t);
+    chEvtBroadcastI(&tdma_beacon_timer_event);
+    chSysUnlockFromISR();
+}
+
+static void poll_final_timer_cb(void* t)
+{
+    (void)t;
+
+    chSysLockFromISR();
+    chEvtBroadcastI(&poll_final_timer_event);
+    chSysUnlockFromISR();
+}
+
+static void data_tx_timer_cb(void* t)
+{
+    (void)t;
+
+    chSysLockFromISR();
+    chEvtBroadcastI(&data_tx_timer_event);
+    chSysUnlockFromISR();
+}
+
 static void parameters_init(void)
 {
     /* Prepare parameters. */
@@ -317,6 +724,15 @@ static void parameters_init(void)
                                            &uwb_params.ns,
                                            "antenna_delay",
                                            RX_ANT_DLY);
+    /* Opt-in, as all the anchors must run a firmware answering polls. */
+    parameter_boolean_declare_with_default(&uwb_params.broadcast_poll,
+                                           &uwb_params.ns,
+                                           "broadcast_poll",
+                                           false);
+    parameter_boolean_declare_with_default(&uwb_params.clock_offset_correction,
+                                           &uwb_params.ns,
+                                           "clock_offset_correction",
+                                           true);
 
     parameter_namespace_declare(&uwb_params.anchor.ns, &uwb_params.ns, "anchor");
     parameter_boolean_declare_with_default(&uwb_params.anchor.is_anchor,
@@ -341,6 +757,70 @@ static void parameters_init(void)
                                           &uwb_params.anchor.position.ns,
                                           "z",
                                           0.);
+
+    parameter_namespace_declare(&uwb_params.tdma.ns, &uwb_params.ns, "tdma");
+    parameter_integer_declare_with_default(&uwb_params.tdma.slot_count,
+                                           &uwb_params.tdma.ns,
+                                           "slot_count",
+                                           1);
+    parameter_integer_declare_with_default(&uwb_params.tdma.slot_duration_ms,
+                                           &uwb_params.tdma.ns,
+                                           "slot_duration_ms",
+                                           100);
+    parameter_integer_declare_with_default(&uwb_params.tdma.slot,
+                                           &uwb_params.tdma.ns,
+                                           "slot",
+                                           -1);
+    parameter_boolean_declare_with_default(&uwb_params.tdma.coordinator,
+                                           &uwb_params.tdma.ns,
+                                           "coordinator",
+                                           false);
+
+    parameter_namespace_declare(&uwb_params.calibration.ns, &uwb_params.ns, "calibration");
+    parameter_boolean_declare_with_default(&uwb_params.calibration.enabled,
+                                           &uwb_params.calibration.ns,
+                                           "enabled",
+                                           false);
+    parameter_integer_declare_with_default(&uwb_params.calibration.samples,
+                                           &uwb_params.calibration.ns,
+                                           "samples",
+                                           200);
+
+    /* Known position of this beacon during calibration. */
+    parameter_namespace_declare(&uwb_params.calibration.position.ns,
+                                &uwb_params.calibration.ns,
+                                "position");
+    parameter_scalar_declare_with_default(&uwb_params.calibration.position.x,
+                                          &uwb_params.calibration.position.ns,
+                                          "x",
+                                          0.);
+    parameter_scalar_declare_with_default(&uwb_params.calibration.position.y,
+                                          &uwb_params.calibration.position.ns,
+                                          "y",
+                                          0.);
+    parameter_scalar_declare_with_default(&uwb_params.calibration.position.z,
+                                          &uwb_params.calibration.position.ns,
+                                          "z",
+                                          0.);
+
+    /* Range offset of each anchor, a negative MAC address marks unused
+     * entries. */
+    for (int i = 0; i < UWB_CALIBRATION_PARAM_ENTRIES; i++) {
+        snprintf(uwb_params.calibration.anchors[i].name,
+                 sizeof(uwb_params.calibration.anchors[i].name),
+                 "%d", i);
+        parameter_namespace_declare(&uwb_params.calibration.anchors[i].ns,
+                                    &uwb_params.calibration.ns,
+                                    uwb_params.calibration.anchors[i].name);
+        parameter_integer_declare_with_default(&uwb_params.calibration.anchors[i].mac_addr,
+                                               &uwb_params.calibration.anchors[i].ns,
+                                               "mac_addr",
+                                               -1);
+        parameter_scalar_declare_with_default(&uwb_params.calibration.anchors[i].offset,
+                                              &uwb_params.calibration.anchors[i].ns,
+                                              "offset",
+                                              0.);
+    }
 }
 
 static void topics_init(void)
@@ -373,6 +853,14 @@ static void topics_init(void)
                           &data_packet_topic_buffer,
                           sizeof(data_packet_topic_buffer));
     messagebus_advertise_topic(&bus, &data_packet_topic, "/uwb_data");
+
+    /* Prepare topic for the ranging rate of this tag */
+    messagebus_topic_init(&ranging_stats_topic,
+                          &ranging_stats_topic_lock,
+                          &ranging_stats_topic_condvar,
+                          &ranging_stats_topic_buffer,
+                          sizeof(ranging_stats_topic_buffer));
+    messagebus_advertise_topic(&bus, &ranging_stats_topic, "/ranging_stats");
 }
 
 static void hardware_init(void)
@@ -391,9 +879,10 @@ static void hardware_init(void)
 static void events_init(void)
 {
     /* Setup a virtual timer to schedule measurement advertisement. */
-    static virtual_timer_t advertise_timer;
     chVTObjectInit(&advertise_timer);
-    chVTSet(&advertise_timer, TIME_MS2I(500), advertise_timer_cb, &advertise_timer);
+    chVTSet(&advertise_timer, TIME_MS2I(500), advertise_timer_cb, NULL);
+    chVTObjectInit(&poll_final_timer);
+    chVTObjectInit(&data_tx_timer);
 
     /* Setup a virtual timer to schedule anchor position broadcasts. */
     static virtual_timer_t anchor_position_timer;
@@ -405,9 +894,15 @@ static void events_init(void)
     chVTObjectInit(&tag_position_timer);
     chVTSet(&tag_position_timer, TIME_MS2I(400), tag_position_timer_cb, &tag_position_timer);
 
+    /* Setup a virtual timer to schedule the TDMA beacon. */
+    static virtual_timer_t tdma_beacon_timer;
+    chVTObjectInit(&tdma_beacon_timer);
+    chVTSet(&tdma_beacon_timer, TIME_MS2I(700), tdma_beacon_timer_cb, &tdma_beacon_timer);
+
     /* Register event listeners */
     static event_listener_t uwb_int_listener, advertise_timer_listener, anchor_position_listener,
-        tag_position_listener, data_packet_ready_listener;
+        tag_position_listener, data_packet_ready_listener, tdma_beacon_listener,
+        poll_final_listener, data_tx_timer_listener;
     chEvtRegisterMask(&uwb_event, &uwb_int_listener, EVENT_UWB_INT);
     chEvtRegisterMask(&advertise_timer_event, &advertise_timer_listener, EVENT_ADVERTISE_TIMER);
     chEvtRegisterMask(&anchor_position_timer_event,
@@ -419,22 +914,39 @@ static void events_init(void)
     chEvtRegisterMask(&tag_position_timer_event,
                       &tag_position_listener,
                       EVENT_TAG_POSITION_TIMER);
+
+    chEvtRegisterMask(&tdma_beacon_timer_event, &tdma_beacon_listener, EVENT_TDMA_BEACON_TIMER);
+    chEvtRegisterMask(&poll_final_timer_event, &poll_final_listener, EVENT_POLL_FINAL_TIMER);
+    chEvtRegisterMask(&data_tx_timer_event, &data_tx_timer_listener, EVENT_DATA_TX_TIMER);
 }
 
-void ranging_send_data_packet(const uint8_t* data, size_t data_size, uint16_t dst_mac)
+bool ranging_send_data_packet(const uint8_t* data, size_t data_size, uint16_t dst_mac)
 {
-    chMtxLock(&data_packet_lock);
-
-    data_packet = data;
-    data_packet_size = data_size;
+    bool queued = false;
 
-    data_packet_dst_mac = dst_mac;
+    if (data_size > UWB_FRAGMENT_MAX_PACKET_SIZE) {
+        return false;
+    }
 
-    /* Tell the ranging thread that we want to send a packet. */
-    chEvtBroadcast(&data_packet_ready_event);
+    chMtxLock(&data_packet_lock);
 
-    /* wait for the data packet to be handled by the module */
-    chBSemWait(&data_packet_sent);
+    if (data_packet_queue.count < DATA_PACKET_QUEUE_LEN) {
+        unsigned tail = (data_packet_queue.head + data_packet_queue.count) % DATA_PACKET_QUEUE_LEN;
+        memcpy(data_packet_queue.packets[tail].data, data, data_size);
+        data_packet_queue.packets[tail].size = data_size;
+        data_packet_queue.packets[tail].dst_mac = dst_mac;
+        data_packet_queue.count++;
+        queued = true;
+    } else {
+        data_packet_queue.dropped++;
+    }
 
     chMtxUnlock(&data_packet_lock);
+
+    if (queued) {
+        /* Tell the ranging thread that we want to send a packet. */
+        chEvtBroadcast(&data_packet_ready_event);
+    }
+
+    return queued;
 }
@@ -7,11 +7,13 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdbool.h>
 
 typedef struct {
     uint32_t timestamp; ///< Time at which the ranging solution was found (in us since boot)
     uint16_t anchor_addr; ///< Address of the anchor with which the measurement was done
     float range; ///< Distance to the anchor, in meters
+    float power_ratio; ///< Total received power over first path power, in dB. High values hint at NLOS.
 } range_msg_t;
 
 typedef struct {
@@ -37,14 +39,27 @@ typedef struct {
     uint8_t data[1024];
 } data_packet_msg_t;
 
+/** Ranging statistics, published on /ranging_stats. */
+typedef struct {
+    uint32_t timestamp;
+    uint16_t tag_addr;
+    float update_rate; ///< Ranging solutions per second, all anchors included
+    uint8_t anchor_count; ///< Number of anchors the tag is ranging with
+    uint8_t slot; ///< TDMA slot used by the tag
+    uint32_t data_packets_dropped; ///< Data packets dropped because the queue was full or they were not acknowledged
+} ranging_stats_msg_t;
+
 void ranging_start(void);
 
 /** Asks the ranging thread to send this data packet when possible.
  *
- * Blocks until the packet is sent to the DWM1000 (returns before the packet is
- * actually transmitted).
+ * The packet is copied and sent in fragments, see uwb_fragmentation.h. A few
+ * packets can wait while the previous one is being transferred.
+ *
+ * @returns false if the packet was dropped because the queue is full. Drops
+ * are counted in the ranging statistics.
  */
-void ranging_send_data_packet(const uint8_t* data, size_t data_size, uint16_t dst_mac);
+bool ranging_send_data_packet(const uint8_t* data, size_t data_size, uint16_t dst_mac);
 
 #ifdef __cplusplus
 }
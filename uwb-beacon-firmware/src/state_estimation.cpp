@@ -1,38 +1,11 @@
 #include "state_estimation.hpp"
-#include "ekf.hpp"
-
-struct UWBOnlyModel : EKF::Corrector<3, 1> {
-    Eigen::Vector3f anchor_pos;
-    UWBOnlyModel(float bx, float by, float bz, float variance)
-        : EKF::Corrector<3, 1>(Measurement::Identity() * variance)
-        , anchor_pos(bx, by, bz)
-    {
-    }
-
-    Measurement h(State mu)
-    {
-        float dst = (mu - anchor_pos).norm();
-        return dst * Measurement::Identity();
-    }
-
-    Jacobian H(State mu)
-    {
-        float dst = (mu - anchor_pos).norm();
-        return (mu - anchor_pos).transpose() * 1 / dst;
-    }
-};
-
-struct IdentityPredictor : EKF::Predictor<3, 0> {
-    IdentityPredictor(float variance)
-        : EKF::Predictor<3, 0>(variance * Covariance::Identity())
-    {
-    }
-};
 
 RadioPositionEstimator::RadioPositionEstimator()
-    : covariance(Eigen::Matrix3f::Identity())
+    : state(State::Zero())
+    , covariance(Covariance::Identity())
     , measurementVariance(0.05 * 0.05)
     , processVariance(0.001)
+    , accelerationVariance(0.5)
 {
     setPosition(1.0, 1.0, -0.5);
 }
@@ -52,16 +25,105 @@ std::tuple<float, float, float> RadioPositionEstimator::getPosition()
 void RadioPositionEstimator::processDistanceMeasurement(const float anchor_position[3],
                                                         float distance)
 {
-    UWBOnlyModel m(anchor_position[0], anchor_position[1], anchor_position[2], measurementVariance);
-    Eigen::Matrix<float, 1, 1> z;
-    z << distance;
-    std::tie(state, covariance) = m.correct(state, covariance, z);
+    processDistanceMeasurements(reinterpret_cast<const float(*)[3]>(anchor_position), &distance, 1);
+}
+
+float RadioPositionEstimator::rangeInnovation(const float anchor_position[3],
+                                              float distance,
+                                              float* variance) const
+{
+    Eigen::Map<const Eigen::Vector3f> anchor(anchor_position);
+    Eigen::Vector3f delta = state.head<3>() - anchor;
+    float predicted = delta.norm();
+
+    *variance = measurementVariance;
+
+    if (predicted < 1e-3f) {
+        return 0.f;
+    }
+
+    Eigen::Vector3f H = delta / predicted;
+    *variance += H.dot(covariance.topLeftCorner<3, 3>() * H);
+
+    return distance - predicted;
+}
+
+void RadioPositionEstimator::processDistanceMeasurements(const float anchor_positions[][3],
+                                                         const float distances[],
+                                                         int count)
+{
+    /* Fixed maximum sizes keep everything on the stack. The ranges only
+     * depend on the position, so only the first three columns of the
+     * measurement Jacobian are stored. */
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 1, 0, MaxRanges, 1> Innovation;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor, MaxRanges, 3> Jacobian;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 6, Eigen::RowMajor, MaxRanges, 6> Gain;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, 0, MaxRanges, MaxRanges> InnovationCovariance;
+
+    if (count > MaxRanges) {
+        count = MaxRanges;
+    }
+
+    if (count <= 0) {
+        return;
+    }
+
+    Innovation y(count);
+    Jacobian H(count, 3);
+
+    for (int i = 0; i < count; i++) {
+        Eigen::Map<const Eigen::Vector3f> anchor(anchor_positions[i]);
+        Eigen::Vector3f delta = state.head<3>() - anchor;
+        float predicted = delta.norm();
+
+        /* On top of the anchor, the range does not carry any direction. */
+        if (predicted < 1e-3f) {
+            H.row(i).setZero();
+            y(i) = 0.f;
+        } else {
+            H.row(i) = delta.transpose() / predicted;
+            y(i) = distances[i] - predicted;
+        }
+    }
+
+    /* H * P, with H only acting on the position rows of P. */
+    Gain HP(count, 6);
+    HP.noalias() = H * covariance.topRows<3>();
+
+    InnovationCovariance S(count, count);
+    S.noalias() = HP.leftCols<3>() * H.transpose();
+    S.diagonal().array() += measurementVariance;
+
+    /* K^T = S^-1 * H * P, as S and P are symmetric. */
+    Gain Kt = S.llt().solve(HP);
+
+    state.noalias() += Kt.transpose() * y;
+    covariance.noalias() -= Kt.transpose() * HP;
 }
 
 void RadioPositionEstimator::predict(void)
 {
-    IdentityPredictor p(processVariance);
-    Eigen::Matrix<float, 0, 1> u;
+    covariance.diagonal().head<3>().array() += processVariance;
+}
+
+void RadioPositionEstimator::predict(float dt, const float acceleration[3])
+{
+    Eigen::Map<const Eigen::Vector3f> a(acceleration);
+    const float dt2 = dt * dt;
+
+    state.head<3>() += dt * state.tail<3>() + 0.5f * dt2 * a;
+    state.tail<3>() += dt * a;
+
+    /* F * P * F^T, with F = [I, dt * I; 0, I], done block by block. */
+    covariance.topLeftCorner<3, 3>() += dt * (covariance.topRightCorner<3, 3>() + covariance.bottomLeftCorner<3, 3>())
+                                        + dt2 * covariance.bottomRightCorner<3, 3>();
+    covariance.topRightCorner<3, 3>() += dt * covariance.bottomRightCorner<3, 3>();
+    covariance.bottomLeftCorner<3, 3>() = covariance.topRightCorner<3, 3>().transpose();
 
-    std::tie(state, covariance) = p.predict(state, covariance, u);
+    /* Acceleration noise, integrated over the period. */
+    const float q = accelerationVariance;
+    covariance.topLeftCorner<3, 3>().diagonal().array() += q * dt2 * dt2 / 4 + processVariance;
+    covariance.topRightCorner<3, 3>().diagonal().array() += q * dt2 * dt / 2;
+    covariance.bottomLeftCorner<3, 3>().diagonal().array() += q * dt2 * dt / 2;
+    covariance.bottomRightCorner<3, 3>().diagonal().array() += q * dt2;
 }
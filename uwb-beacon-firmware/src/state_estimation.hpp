@@ -1,18 +1,48 @@
 #include <utility>
-#include "ekf.hpp"
+#include <tuple>
+#include <Eigen/Dense>
 
 class RadioPositionEstimator {
 public:
-    typedef Eigen::Matrix<float, 3, 1> State;
+    /** Maximum number of ranges fused in a single correction. */
+    static const int MaxRanges = 8;
+
+    /** Position followed by velocity, in meters and meters per second. */
+    typedef Eigen::Matrix<float, 6, 1> State;
+    typedef Eigen::Matrix<float, 6, 6> Covariance;
+
     State state;
-    Eigen::Matrix3f covariance;
+    Covariance covariance;
     float measurementVariance;
+
+    /** Variance added to the position at each prediction. */
     float processVariance;
 
+    /** Variance of the acceleration input, in (m/s^2)^2. */
+    float accelerationVariance;
+
     RadioPositionEstimator();
     void setPosition(float x, float y, float z);
     std::tuple<float, float, float> getPosition();
 
-    void processDistanceMeasurement(const float anchor_position[2], float distance);
+    void processDistanceMeasurement(const float anchor_position[3], float distance);
+
+    /** Returns the difference between the measured and predicted range to an
+     * anchor, and its predicted variance, for outlier rejection. */
+    float rangeInnovation(const float anchor_position[3], float distance, float* variance) const;
+
+    /** Fuses the ranges of one ranging round in a single correction.
+     *
+     * @note Only the first MaxRanges ranges are used.
+     */
+    void processDistanceMeasurements(const float anchor_positions[][3],
+                                     const float distances[],
+                                     int count);
+
+    /** Prediction without any motion, only increasing the uncertainty. */
     void predict(void);
+
+    /** Constant velocity prediction driven by the given acceleration, in the
+     * world frame and without gravity. */
+    void predict(float dt, const float acceleration[3]);
 };
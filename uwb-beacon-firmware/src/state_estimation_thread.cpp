@@ -6,28 +6,99 @@
 #include "state_estimation_thread.h"
 #include "anchor_position_cache.h"
 #include "imu_thread.h"
+#include "ahrs_thread.h"
+#include "range_filter.h"
+
+#define STANDARD_GRAVITY 9.81f
+
+/** Longest gap between two IMU samples, to avoid large jumps after an IMU
+ * dropout. */
+#define MAX_SAMPLE_DT 0.05f
 
 /** Parameters for this service. */
 static struct {
     parameter_namespace_t ns;
     parameter_t process_variance;
     parameter_t range_variance;
+    parameter_t acceleration_variance;
+    parameter_t prediction_rate;
+    struct {
+        parameter_namespace_t ns;
+        parameter_t gate;
+        parameter_t nlos_threshold;
+        parameter_t max_consecutive_rejections;
+    } outliers;
 } params;
 
+/** Ranges received since the last correction, fused together after the next
+ * prediction. */
+static struct {
+    float anchor_positions[RadioPositionEstimator::MaxRanges][3];
+    float distances[RadioPositionEstimator::MaxRanges];
+    uint16_t anchor_addrs[RadioPositionEstimator::MaxRanges];
+    int count;
+} pending_ranges;
+
+/** Time between two predictions, in seconds. */
+static float prediction_period;
+
+/** Set once ranges were fused: from then on the position only comes from UWB. */
+static bool ranges_fused;
+
 /** Creates the parameters. */
 static void parameters_init(parameter_namespace_t* parent);
 
-static THD_WORKING_AREA(state_estimation_wa, 1024);
+/** Copies the parameters to the estimator and the outlier filter if they
+ * changed. */
+static void parameters_update(RadioPositionEstimator& estimator, range_filter_t& filter);
+
+/** Runs a single correction with all the buffered ranges. */
+static void flush_ranges(RadioPositionEstimator& estimator)
+{
+    estimator.processDistanceMeasurements(pending_ranges.anchor_positions,
+                                          pending_ranges.distances,
+                                          pending_ranges.count);
+    pending_ranges.count = 0;
+    ranges_fused = true;
+}
+
+/** Returns the acceleration in the world frame without gravity, or zero if the
+ * attitude is not known yet. */
+static void world_acceleration(const attitude_msg_t* attitude,
+                               const imu_msg_t& imu_msg,
+                               float acc[3])
+{
+    if (attitude == NULL) {
+        acc[0] = acc[1] = acc[2] = 0.f;
+        return;
+    }
+
+    Eigen::Quaternionf q(attitude->q.w, attitude->q.x, attitude->q.y, attitude->q.z);
+    Eigen::Vector3f body(imu_msg.acc.x, imu_msg.acc.y, imu_msg.acc.z);
+    Eigen::Vector3f world = q * body;
+
+    acc[0] = world.x();
+    acc[1] = world.y();
+    acc[2] = world.z() - STANDARD_GRAVITY;
+}
+
+static THD_WORKING_AREA(state_estimation_wa, 2048);
 static THD_FUNCTION(state_estimation_thd, arg)
 {
     (void)arg;
 
-    messagebus_topic_t *range_topic, *imu_topic;
+    messagebus_topic_t *range_topic, *imu_topic, *attitude_topic;
+    uint32_t last_imu_timestamp = 0;
+    bool imu_received = false;
+
+    /* IMU samples since the last prediction. */
+    float prediction_dt = 0.f;
+    float prediction_acc[3] = {0.f, 0.f, 0.f};
     struct {
         mutex_t lock;
         condition_variable_t cv;
         messagebus_watchgroup_t group;
-        messagebus_watcher_t watchers[2];
+        messagebus_watcher_t watchers[3];
     } watchgroup;
 
     messagebus_topic_t state_estimation_topic;
@@ -35,19 +106,44 @@ static THD_FUNCTION(state_estimation_thd, arg)
     CONDVAR_DECL(state_estimation_topic_condvar);
     position_estimation_msg_t state_estimation_topic_content;
 
+    messagebus_topic_t initial_position_topic;
+    MUTEX_DECL(initial_position_topic_lock);
+    CONDVAR_DECL(initial_position_topic_condvar);
+    position_estimation_msg_t initial_position_topic_content;
+
+    messagebus_topic_t rejection_topic;
+    MUTEX_DECL(rejection_topic_lock);
+    CONDVAR_DECL(rejection_topic_condvar);
+    range_rejection_msg_t rejection_topic_content;
+
     messagebus_topic_init(&state_estimation_topic,
                           &state_estimation_topic_lock,
                           &state_estimation_topic_condvar, &state_estimation_topic_content,
                           sizeof(state_estimation_topic_content));
     messagebus_advertise_topic(&bus, &state_estimation_topic, "/ekf/state");
 
+    messagebus_topic_init(&initial_position_topic,
+                          &initial_position_topic_lock,
+                          &initial_position_topic_condvar, &initial_position_topic_content,
+                          sizeof(initial_position_topic_content));
+    messagebus_advertise_topic(&bus, &initial_position_topic, "/ekf/initial_position");
+
+    messagebus_topic_init(&rejection_topic,
+                          &rejection_topic_lock,
+                          &rejection_topic_condvar, &rejection_topic_content,
+                          sizeof(rejection_topic_content));
+    messagebus_advertise_topic(&bus, &rejection_topic, "/ekf/rejected_ranges");
+
     parameters_init(&parameter_root);
 
-    // TODO configure variance
     RadioPositionEstimator estimator;
+    static range_filter_t outlier_filter;
+    range_filter_init(&outlier_filter);
+    parameters_update(estimator, outlier_filter);
 
     range_topic = messagebus_find_topic_blocking(&bus, "/range");
-    imu_topic = messagebus_find_topic_blocking(&bus, "/imu");
+    imu_topic = messagebus_find_topic_blocking(&bus, "/imu/batch");
+    attitude_topic = NULL;
 
     /* Prepare to listen on all groups. */
     chMtxObjectInit(&watchgroup.lock);
@@ -59,6 +155,9 @@ static THD_FUNCTION(state_estimation_thd, arg)
     messagebus_watchgroup_watch(&watchgroup.watchers[1],
                                 &watchgroup.group,
                                 imu_topic);
+    messagebus_watchgroup_watch(&watchgroup.watchers[2],
+                                &watchgroup.group,
+                                &initial_position_topic);
 
     while (true) {
         messagebus_topic_t* topic;
@@ -77,24 +176,126 @@ static THD_FUNCTION(state_estimation_thd, arg)
                 continue;
             }
 
-            estimator.measurementVariance = parameter_scalar_read(&params.range_variance);
-
             anchor_pos = anchor_position_cache_get(msg.anchor_addr);
 
-            if (anchor_pos) {
-                float pos[3] = {anchor_pos->x, anchor_pos->y, anchor_pos->z};
-                estimator.processDistanceMeasurement(pos, msg.range);
+            if (!anchor_pos) {
+                continue;
+            }
+
+            float anchor[3] = {anchor_pos->x, anchor_pos->y, anchor_pos->z};
+            float innovation_variance;
+            float innovation = estimator.rangeInnovation(anchor, msg.range, &innovation_variance);
+            range_filter_result_t result = range_filter_check(&outlier_filter,
+                                                              msg.anchor_addr,
+                                                              innovation,
+                                                              innovation_variance,
+                                                              msg.power_ratio);
+
+            range_rejection_msg_t rejection_msg;
+            rejection_msg.timestamp = msg.timestamp;
+            rejection_msg.rejected_gate = outlier_filter.rejected_gate;
+            rejection_msg.rejected_nlos = outlier_filter.rejected_nlos;
+            rejection_msg.accepted = outlier_filter.accepted;
+            messagebus_topic_publish(&rejection_topic, &rejection_msg, sizeof(rejection_msg));
+
+            if (result != RANGE_FILTER_ACCEPTED) {
+                continue;
+            }
+
+            /* A second range to the same anchor means a new ranging round
+             * started, fuse the previous one first. */
+            for (int i = 0; i < pending_ranges.count; i++) {
+                if (pending_ranges.anchor_addrs[i] == msg.anchor_addr) {
+                    flush_ranges(estimator);
+                    break;
+                }
+            }
+
+            if (pending_ranges.count == RadioPositionEstimator::MaxRanges) {
+                flush_ranges(estimator);
+            }
+
+            int i = pending_ranges.count++;
+            pending_ranges.anchor_positions[i][0] = anchor[0];
+            pending_ranges.anchor_positions[i][1] = anchor[1];
+            pending_ranges.anchor_positions[i][2] = anchor[2];
+            pending_ranges.distances[i] = msg.range;
+            pending_ranges.anchor_addrs[i] = msg.anchor_addr;
+
+        } else if (topic == &initial_position_topic) {
+            position_estimation_msg_t msg;
+            messagebus_topic_read(topic, &msg, sizeof(msg));
+
+            /* Only a starting point for the first ranges. Afterwards it would
+             * overwrite the UWB estimate with a position coming from
+             * elsewhere, which would then be published as ours. */
+            if (!ranges_fused) {
+                estimator.setPosition(msg.x, msg.y, estimator.state(2));
             }
 
         } else if (topic == imu_topic) {
             // TODO: Better source of periodic interrupts than IMU?
-            imu_msg_t imu_msg;
-            messagebus_topic_read(topic, &imu_msg, sizeof(imu_msg));
+            static imu_batch_msg_t batch;
+            messagebus_topic_read(topic, &batch, sizeof(batch));
+
+            parameters_update(estimator, outlier_filter);
+
+            /* The AHRS thread might start after us. */
+            if (attitude_topic == NULL) {
+                attitude_topic = messagebus_find_topic(&bus, "/attitude");
+            }
+
+            /* The attitude barely changes during a batch, use the latest one
+             * for all the samples. */
+            attitude_msg_t attitude;
+            bool attitude_known = attitude_topic != NULL
+                                  && messagebus_topic_read(attitude_topic, &attitude, sizeof(attitude));
+
+            /* Samples are integrated until the next prediction, which runs at
+             * a lower rate than the IMU. */
+            for (unsigned i = 0; i < batch.count; i++) {
+                const imu_msg_t& imu_msg = batch.samples[i];
+
+                if (imu_received) {
+                    float dt = (imu_msg.timestamp - last_imu_timestamp) * 1e-6f;
+                    if (dt > MAX_SAMPLE_DT) {
+                        dt = MAX_SAMPLE_DT;
+                    }
+
+                    float acc[3];
+                    world_acceleration(attitude_known ? &attitude : NULL, imu_msg, acc);
+                    for (int j = 0; j < 3; j++) {
+                        prediction_acc[j] += acc[j] * dt;
+                    }
+                    prediction_dt += dt;
+                }
+                last_imu_timestamp = imu_msg.timestamp;
+                imu_received = true;
+            }
+
+            if (prediction_dt <= 0.f || prediction_dt < prediction_period) {
+                continue;
+            }
+
+            /* Predict with the mean acceleration over the period. */
+            for (int j = 0; j < 3; j++) {
+                prediction_acc[j] /= prediction_dt;
+            }
+            estimator.predict(prediction_dt, prediction_acc);
+            prediction_dt = 0.f;
+            prediction_acc[0] = prediction_acc[1] = prediction_acc[2] = 0.f;
+
+            if (pending_ranges.count > 0) {
+                flush_ranges(estimator);
+            }
+
+            /* Before any range, the position is only a guess. */
+            if (!ranges_fused) {
+                continue;
+            }
 
-            estimator.processVariance = parameter_scalar_read(&params.process_variance);
-            estimator.predict();
             position_estimation_msg_t pos_msg;
-            pos_msg.timestamp = imu_msg.timestamp;
+            pos_msg.timestamp = last_imu_timestamp;
             pos_msg.x = estimator.state(0);
             pos_msg.y = estimator.state(1);
             pos_msg.z = estimator.state(2);
@@ -124,4 +325,50 @@ static void parameters_init(parameter_namespace_t* parent)
                                           4e-6);
     parameter_scalar_declare_with_default(&params.range_variance, &params.ns, "range_variance",
                                           9e-4);
+    parameter_scalar_declare_with_default(&params.acceleration_variance,
+                                          &params.ns,
+                                          "acceleration_variance",
+                                          0.5);
+    /* In Hz, capped by the IMU batch rate (50 Hz). */
+    parameter_scalar_declare_with_default(&params.prediction_rate,
+                                          &params.ns,
+                                          "prediction_rate",
+                                          50.);
+
+    parameter_namespace_declare(&params.outliers.ns, &params.ns, "outliers");
+    parameter_scalar_declare_with_default(&params.outliers.gate,
+                                          &params.outliers.ns,
+                                          "gate",
+                                          9.);
+    /* Disabled by default, about 10 dB is a good start when enabled. */
+    parameter_scalar_declare_with_default(&params.outliers.nlos_threshold,
+                                          &params.outliers.ns,
+                                          "nlos_threshold_db",
+                                          0.);
+    parameter_integer_declare_with_default(&params.outliers.max_consecutive_rejections,
+                                           &params.outliers.ns,
+                                           "max_consecutive_rejections",
+                                           20);
+}
+
+static void parameters_update(RadioPositionEstimator& estimator, range_filter_t& filter)
+{
+    if (!parameter_namespace_contains_changed(&params.ns)) {
+        return;
+    }
+
+    filter.gate = parameter_scalar_get(&params.outliers.gate);
+    filter.nlos_threshold_db = parameter_scalar_get(&params.outliers.nlos_threshold);
+
+    /* A negative count would wrap around, and a rejected anchor would never be
+     * accepted again. */
+    int32_t max_rejections = parameter_integer_get(&params.outliers.max_consecutive_rejections);
+    filter.max_consecutive_rejections = max_rejections > 0 ? max_rejections : 0;
+
+    estimator.processVariance = parameter_scalar_get(&params.process_variance);
+    estimator.measurementVariance = parameter_scalar_get(&params.range_variance);
+    estimator.accelerationVariance = parameter_scalar_get(&params.acceleration_variance);
+
+    float rate = parameter_scalar_get(&params.prediction_rate);
+    prediction_period = rate > 0 ? 1.f / rate : 0.f;
 }
@@ -8,6 +8,10 @@ extern "C" {
 #include <stdint.h>
 #include "lru_cache.h"
 
+/** Tag position in meters, published on /ekf/state once ranges were fused.
+ *
+ * A position known from elsewhere, for example the robot odometry, can be
+ * published on /ekf/initial_position to start the estimator from it. */
 typedef struct {
     uint32_t timestamp;
     float x;
@@ -18,6 +22,15 @@ typedef struct {
     float variance_z;
 } position_estimation_msg_t;
 
+/** Counters of the ranges dropped before the estimator, published on
+ * /ekf/rejected_ranges. */
+typedef struct {
+    uint32_t timestamp;
+    uint32_t rejected_gate; ///< Ranges failing the innovation gate
+    uint32_t rejected_nlos; ///< Ranges flagged as NLOS by the receive diagnostics
+    uint32_t accepted;
+} range_rejection_msg_t;
+
 void state_estimation_start(void);
 
 #ifdef __cplusplus
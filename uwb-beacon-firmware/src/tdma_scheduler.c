@@ -0,0 +1,170 @@
+#include <string.h>
+#include "tdma_scheduler.h"
+
+static uint32_t superframe_duration(const tdma_scheduler_t* s)
+{
+    return s->slot_count * s->slot_duration;
+}
+
+/** Time elapsed since the beginning of the current superframe. */
+static uint32_t superframe_offset(const tdma_scheduler_t* s, uint32_t now)
+{
+    return (now - s->superframe_start) % superframe_duration(s);
+}
+
+static void rate_window_update(tdma_scheduler_t* s, uint32_t now)
+{
+    uint32_t elapsed = now - s->rate.window_start;
+
+    if (elapsed < TDMA_RATE_WINDOW_US) {
+        return;
+    }
+
+    /* If we missed several windows, the count is averaged over all of them. */
+    s->rate.update_rate = s->rate.count * 1e6f / elapsed;
+    s->rate.count = 0;
+    s->rate.window_start = now;
+}
+
+void tdma_init(tdma_scheduler_t* s)
+{
+    memset(s, 0, sizeof(tdma_scheduler_t));
+    tdma_configure(s, 1, 100000, 0);
+}
+
+void tdma_configure(tdma_scheduler_t* s, unsigned slot_count, uint32_t slot_duration, unsigned slot)
+{
+    if (slot_count == 0) {
+        slot_count = 1;
+    }
+
+    if (slot_duration == 0) {
+        slot_duration = 1;
+    }
+
+    s->slot_count = slot_count;
+    s->slot_duration = slot_duration;
+    s->slot = slot % slot_count;
+}
+
+void tdma_synchronize(tdma_scheduler_t* s, uint32_t now)
+{
+    s->superframe_start = now;
+}
+
+void tdma_anchor_seen(tdma_scheduler_t* s, uint16_t addr, uint32_t now)
+{
+    unsigned i, oldest = 0;
+
+    for (i = 0; i < s->anchor_count; i++) {
+        if (s->anchors[i].addr == addr) {
+            s->anchors[i].last_seen = now;
+            return;
+        }
+
+        if (now - s->anchors[i].last_seen > now - s->anchors[oldest].last_seen) {
+            oldest = i;
+        }
+    }
+
+    if (s->anchor_count < TDMA_MAX_ANCHORS) {
+        i = s->anchor_count++;
+    } else {
+        i = oldest;
+    }
+
+    s->anchors[i].addr = addr;
+    s->anchors[i].last_seen = now;
+}
+
+void tdma_expire_anchors(tdma_scheduler_t* s, uint32_t now)
+{
+    unsigned i = 0;
+
+    while (i < s->anchor_count) {
+        if (now - s->anchors[i].last_seen > TDMA_ANCHOR_TIMEOUT_US) {
+            /* Order does not matter, move the last anchor in the hole. */
+            s->anchor_count--;
+            s->anchors[i] = s->anchors[s->anchor_count];
+        } else {
+            i++;
+        }
+    }
+}
+
+unsigned tdma_current_slot(const tdma_scheduler_t* s, uint32_t now)
+{
+    return superframe_offset(s, now) / s->slot_duration;
+}
+
+bool tdma_can_start_exchange(const tdma_scheduler_t* s, uint32_t now, uint32_t exchange_duration)
+{
+    /* A single slot means there is no time division at all. */
+    if (s->slot_count == 1) {
+        return true;
+    }
+
+    uint32_t offset = superframe_offset(s, now);
+    uint32_t slot_start = s->slot * s->slot_duration;
+
+    if (offset < slot_start) {
+        return false;
+    }
+
+    return offset - slot_start + exchange_duration <= s->slot_duration;
+}
+
+uint32_t tdma_time_until_own_slot(const tdma_scheduler_t* s, uint32_t now)
+{
+    if (s->slot_count == 1) {
+        return 0;
+    }
+
+    uint32_t offset = superframe_offset(s, now);
+    uint32_t slot_start = s->slot * s->slot_duration;
+
+    if (offset <= slot_start) {
+        return slot_start - offset;
+    }
+
+    return superframe_duration(s) - offset + slot_start;
+}
+
+bool tdma_next_anchor(tdma_scheduler_t* s, uint16_t* addr)
+{
+    if (s->anchor_count == 0) {
+        return false;
+    }
+
+    if (s->next_anchor >= s->anchor_count) {
+        s->next_anchor = 0;
+    }
+
+    *addr = s->anchors[s->next_anchor].addr;
+    s->next_anchor++;
+
+    return true;
+}
+
+unsigned tdma_anchor_list(const tdma_scheduler_t* s, uint16_t* addrs, unsigned max)
+{
+    unsigned i;
+
+    for (i = 0; i < s->anchor_count && i < max; i++) {
+        addrs[i] = s->anchors[i].addr;
+    }
+
+    return i;
+}
+
+void tdma_range_received(tdma_scheduler_t* s, uint32_t now)
+{
+    rate_window_update(s, now);
+    s->rate.count++;
+}
+
+float tdma_update_rate(tdma_scheduler_t* s, uint32_t now)
+{
+    rate_window_update(s, now);
+    return s->rate.update_rate;
+}
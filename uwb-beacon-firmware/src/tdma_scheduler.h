@@ -0,0 +1,124 @@
+#ifndef TDMA_SCHEDULER_H
+#define TDMA_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @file tdma_scheduler.h
+ *
+ * Time division scheduling of the ranging exchanges started by a tag.
+ *
+ * Time is split in superframes of slot_count slots. Each tag only starts
+ * two way ranging exchanges during its own slot, which prevents exchanges
+ * from different tags overlapping on the air. The superframe start is
+ * aligned on the reception of the beacon frame sent by the coordinator
+ * anchor.
+ *
+ * The scheduler also keeps the list of anchors to range with, discovered from
+ * the anchor position broadcasts, and measures the rate at which the tag gets
+ * ranging results.
+ *
+ * All times are in microseconds and are allowed to wrap around.
+ */
+
+/** Maximum number of anchors a tag ranges with. */
+#define TDMA_MAX_ANCHORS 8
+
+/** Anchors which were not heard for that long are dropped from the list. */
+#define TDMA_ANCHOR_TIMEOUT_US 5000000
+
+/** Margin to add to the duration of an exchange, covering the synchronization
+ * error between tags and the latency of the timer starting the exchange. */
+#define TDMA_GUARD_TIME_US 1000
+
+/** Length of the window used to measure the ranging update rate. */
+#define TDMA_RATE_WINDOW_US 1000000
+
+typedef struct {
+    uint16_t addr;
+    uint32_t last_seen;
+} tdma_anchor_t;
+
+typedef struct {
+    unsigned slot_count;
+    uint32_t slot_duration;
+    unsigned slot;
+    uint32_t superframe_start;
+
+    tdma_anchor_t anchors[TDMA_MAX_ANCHORS];
+    unsigned anchor_count;
+    unsigned next_anchor;
+
+    struct {
+        uint32_t window_start;
+        uint32_t count;
+        float update_rate;
+    } rate;
+} tdma_scheduler_t;
+
+/** Initializes a scheduler with a single slot, so that the tag is always
+ * allowed to transmit. */
+void tdma_init(tdma_scheduler_t* s);
+
+/** Changes the superframe layout and the slot owned by this tag.
+ *
+ * @note slot is taken modulo slot_count, a zero slot_count is treated as 1.
+ */
+void tdma_configure(tdma_scheduler_t* s, unsigned slot_count, uint32_t slot_duration, unsigned slot);
+
+/** Aligns the start of the superframe on the given time, typically the
+ * reception time of the coordinator beacon. */
+void tdma_synchronize(tdma_scheduler_t* s, uint32_t now);
+
+/** Records that an anchor was heard, adding it to the list if needed.
+ *
+ * If the list is full, the anchor which was not heard for the longest time
+ * is replaced.
+ */
+void tdma_anchor_seen(tdma_scheduler_t* s, uint16_t addr, uint32_t now);
+
+/** Drops the anchors which were not heard for TDMA_ANCHOR_TIMEOUT_US. */
+void tdma_expire_anchors(tdma_scheduler_t* s, uint32_t now);
+
+/** Returns the index of the slot running at the given time. */
+unsigned tdma_current_slot(const tdma_scheduler_t* s, uint32_t now);
+
+/** Returns true if an exchange lasting exchange_duration started now ends
+ * before the end of our slot.
+ *
+ * @note With a single slot per superframe, exchanges are always allowed.
+ */
+bool tdma_can_start_exchange(const tdma_scheduler_t* s, uint32_t now, uint32_t exchange_duration);
+
+/** Returns the time until the beginning of our next slot, 0 if we are at the
+ * very start of it. */
+uint32_t tdma_time_until_own_slot(const tdma_scheduler_t* s, uint32_t now);
+
+/** Picks the next anchor to range with, in round robin order.
+ *
+ * @returns false if no anchor is known.
+ */
+bool tdma_next_anchor(tdma_scheduler_t* s, uint16_t* addr);
+
+/** Copies the addresses of the known anchors, up to max of them.
+ *
+ * @returns The number of addresses copied.
+ */
+unsigned tdma_anchor_list(const tdma_scheduler_t* s, uint16_t* addrs, unsigned max);
+
+/** Records that a ranging result was obtained and updates the rate. */
+void tdma_range_received(tdma_scheduler_t* s, uint32_t now);
+
+/** Returns the number of ranging results per second over the last complete
+ * window. */
+float tdma_update_rate(tdma_scheduler_t* s, uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
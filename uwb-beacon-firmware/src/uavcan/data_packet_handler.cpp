@@ -14,7 +14,9 @@ static void data_packet_cb(const uavcan::ReceivedDataStructure<DataPacket>& msg)
         data[i] = msg.data[i];
     }
 
-    ranging_send_data_packet(data, msg.data.size(), msg.dst_addr);
+    /* Packets dropped because the queue is full are counted in the ranging
+     * statistics, the IP stack of the sender retransmits them. */
+    (void)ranging_send_data_packet(data, msg.data.size(), msg.dst_addr);
 }
 
 int data_packet_handler_init(Node& node)
@@ -13,7 +13,9 @@ using TagPosition = cvra::uwb_beacon::TagPosition;
 
 static void tag_pos_cb(const ReceivedDataStructure<TagPosition>& msg)
 {
-    auto topic = messagebus_find_topic(&bus, "/ekf/state");
+    /* The position comes from another node, not from our own ranges. It is
+     * not published as our estimate, only used as a starting point. */
+    auto topic = messagebus_find_topic(&bus, "/ekf/initial_position");
 
     if (topic == nullptr) {
         return;
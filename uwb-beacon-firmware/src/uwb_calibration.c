@@ -0,0 +1,114 @@
+#include <math.h>
+#include <string.h>
+#include "uwb_calibration.h"
+
+static uwb_calibration_anchor_t* find_anchor(uwb_calibration_t* cal, uint16_t addr, bool create)
+{
+    for (unsigned i = 0; i < cal->anchor_count; i++) {
+        if (cal->anchors[i].addr == addr) {
+            return &cal->anchors[i];
+        }
+    }
+
+    if (!create || cal->anchor_count == UWB_CALIBRATION_MAX_ANCHORS) {
+        return NULL;
+    }
+
+    uwb_calibration_anchor_t* anchor = &cal->anchors[cal->anchor_count++];
+    memset(anchor, 0, sizeof(uwb_calibration_anchor_t));
+    anchor->addr = addr;
+
+    return anchor;
+}
+
+static float distance_to(const float a[3], const float b[3])
+{
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+void uwb_calibration_init(uwb_calibration_t* cal)
+{
+    memset(cal, 0, sizeof(uwb_calibration_t));
+}
+
+void uwb_calibration_set_offset(uwb_calibration_t* cal, uint16_t anchor_addr, float offset)
+{
+    uwb_calibration_anchor_t* anchor = find_anchor(cal, anchor_addr, true);
+
+    if (anchor) {
+        anchor->offset = offset;
+    }
+}
+
+float uwb_calibration_offset(const uwb_calibration_t* cal, uint16_t anchor_addr)
+{
+    for (unsigned i = 0; i < cal->anchor_count; i++) {
+        if (cal->anchors[i].addr == anchor_addr) {
+            return cal->anchors[i].offset;
+        }
+    }
+
+    return 0.f;
+}
+
+float uwb_calibration_correct_range(const uwb_calibration_t* cal, uint16_t anchor_addr, float range)
+{
+    return range - uwb_calibration_offset(cal, anchor_addr);
+}
+
+void uwb_calibration_start(uwb_calibration_t* cal, const float position[3], uint32_t samples_needed)
+{
+    memcpy(cal->position, position, sizeof(cal->position));
+    cal->samples_needed = samples_needed > 0 ? samples_needed : 1;
+    cal->calibrating = true;
+
+    for (unsigned i = 0; i < cal->anchor_count; i++) {
+        cal->anchors[i].error_sum = 0.f;
+        cal->anchors[i].sample_count = 0;
+    }
+}
+
+void uwb_calibration_anchor_position(uwb_calibration_t* cal, uint16_t anchor_addr, float x, float y, float z)
+{
+    uwb_calibration_anchor_t* anchor = find_anchor(cal, anchor_addr, true);
+
+    if (anchor == NULL) {
+        return;
+    }
+
+    anchor->position[0] = x;
+    anchor->position[1] = y;
+    anchor->position[2] = z;
+    anchor->position_known = true;
+}
+
+bool uwb_calibration_add_range(uwb_calibration_t* cal, uint16_t anchor_addr, float range)
+{
+    uwb_calibration_anchor_t* anchor = find_anchor(cal, anchor_addr, false);
+
+    if (!cal->calibrating || anchor == NULL || !anchor->position_known) {
+        return false;
+    }
+
+    if (anchor->sample_count < cal->samples_needed) {
+        anchor->error_sum += range - distance_to(anchor->position, cal->position);
+        anchor->sample_count++;
+    }
+
+    for (unsigned i = 0; i < cal->anchor_count; i++) {
+        if (cal->anchors[i].position_known && cal->anchors[i].sample_count < cal->samples_needed) {
+            return false;
+        }
+    }
+
+    for (unsigned i = 0; i < cal->anchor_count; i++) {
+        if (cal->anchors[i].position_known) {
+            cal->anchors[i].offset = cal->anchors[i].error_sum / cal->anchors[i].sample_count;
+        }
+    }
+
+    cal->calibrating = false;
+
+    return true;
+}
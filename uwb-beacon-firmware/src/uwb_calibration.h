@@ -0,0 +1,82 @@
+#ifndef UWB_CALIBRATION_H
+#define UWB_CALIBRATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @file uwb_calibration.h
+ *
+ * Per anchor range corrections.
+ *
+ * The measured range to an anchor is biased by the antenna delays of both
+ * beacons. The bias of each anchor is kept in a table and removed from the
+ * ranges before they are published.
+ *
+ * The table can be filled automatically: in calibration mode, a beacon is
+ * placed at a known position and ranges with the anchors, whose positions
+ * are known from their broadcasts. The bias of each anchor is the mean
+ * difference between the measured and the true distance.
+ */
+
+/** Maximum number of anchors in the calibration table. */
+#define UWB_CALIBRATION_MAX_ANCHORS 16
+
+typedef struct {
+    uint16_t addr;
+    float offset; ///< Range bias, in meters, removed from measured ranges
+
+    /* Calibration data */
+    bool position_known;
+    float position[3];
+    float error_sum;
+    uint32_t sample_count;
+} uwb_calibration_anchor_t;
+
+typedef struct {
+    uwb_calibration_anchor_t anchors[UWB_CALIBRATION_MAX_ANCHORS];
+    unsigned anchor_count;
+
+    /* Calibration mode */
+    bool calibrating;
+    float position[3]; ///< Known position of the calibrating beacon
+    uint32_t samples_needed; ///< Ranges to average per anchor
+} uwb_calibration_t;
+
+/** Initializes an empty table, with calibration mode off. */
+void uwb_calibration_init(uwb_calibration_t* cal);
+
+/** Sets the range bias of the given anchor, in meters. */
+void uwb_calibration_set_offset(uwb_calibration_t* cal, uint16_t anchor_addr, float offset);
+
+/** Returns the range bias of the given anchor, or zero if it is unknown. */
+float uwb_calibration_offset(const uwb_calibration_t* cal, uint16_t anchor_addr);
+
+/** Removes the bias of the given anchor from a measured range. */
+float uwb_calibration_correct_range(const uwb_calibration_t* cal, uint16_t anchor_addr, float range);
+
+/** Starts the calibration mode, with the beacon at the given position.
+ *
+ * @note Previous calibration samples are discarded, the offsets are kept
+ * until the calibration completes.
+ */
+void uwb_calibration_start(uwb_calibration_t* cal, const float position[3], uint32_t samples_needed);
+
+/** Records the position of an anchor, received from its broadcast. */
+void uwb_calibration_anchor_position(uwb_calibration_t* cal, uint16_t anchor_addr, float x, float y, float z);
+
+/** Feeds a raw (uncorrected) range to the calibration.
+ *
+ * @returns true when every anchor with a known position got enough samples.
+ * The offsets are then updated and the calibration mode stops.
+ */
+bool uwb_calibration_add_range(uwb_calibration_t* cal, uint16_t anchor_addr, float range);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
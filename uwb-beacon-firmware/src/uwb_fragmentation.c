@@ -0,0 +1,257 @@
+#include <string.h>
+#include "uwb_fragmentation.h"
+#include "uwb_protocol.h"
+
+#define FRAGMENT_FLAG_ACK_REQUEST (1 << 0)
+
+static bool deadline_passed(uint32_t now_us, uint32_t deadline_us)
+{
+    return (int32_t)(now_us - deadline_us) >= 0;
+}
+
+static uint16_t all_fragments(uint8_t count)
+{
+    return (uint16_t)((1u << count) - 1);
+}
+
+static unsigned popcount(uint16_t mask)
+{
+    unsigned n = 0;
+    for (; mask; mask &= mask - 1) {
+        n++;
+    }
+    return n;
+}
+
+void uwb_fragment_tx_init(uwb_fragment_tx_t* tx)
+{
+    memset(tx, 0, sizeof(uwb_fragment_tx_t));
+}
+
+bool uwb_fragment_tx_start(uwb_fragment_tx_t* tx, uint16_t dst_addr, const uint8_t* data, size_t size)
+{
+    if (tx->active || size == 0 || size > UWB_FRAGMENT_MAX_PACKET_SIZE) {
+        return false;
+    }
+
+    memcpy(tx->data, data, size);
+    tx->size = size;
+    tx->dst_addr = dst_addr;
+    tx->packet_id++;
+    tx->fragment_count = (size + UWB_FRAGMENT_DATA_SIZE - 1) / UWB_FRAGMENT_DATA_SIZE;
+    tx->acked = 0;
+    tx->in_flight = 0;
+    tx->sent = 0;
+    tx->waiting_ack = false;
+    tx->retries = 0;
+    tx->active = true;
+
+    return true;
+}
+
+bool uwb_fragment_tx_busy(const uwb_fragment_tx_t* tx)
+{
+    return tx->active;
+}
+
+size_t uwb_fragment_tx_next(uwb_fragment_tx_t* tx, uint32_t now_us, uint8_t* payload, uint16_t* dst_addr)
+{
+    bool broadcast = tx->dst_addr == MAC_802_15_4_BROADCAST_ADDR;
+
+    if (!tx->active) {
+        return 0;
+    }
+
+    if (tx->waiting_ack) {
+        if (!deadline_passed(now_us, tx->ack_deadline_us)) {
+            return 0;
+        }
+
+        if (++tx->retries > UWB_FRAGMENT_MAX_RETRIES) {
+            tx->active = false;
+            tx->packets_dropped++;
+            return 0;
+        }
+
+        /* Send the unacknowledged fragments again. */
+        tx->waiting_ack = false;
+        tx->in_flight = 0;
+    }
+
+    uint16_t pending = all_fragments(tx->fragment_count) & ~tx->acked & ~tx->in_flight;
+    if (!pending) {
+        return 0;
+    }
+
+    unsigned index = 0;
+    while (!(pending & (1 << index))) {
+        index++;
+    }
+
+    if (tx->sent & (1 << index)) {
+        tx->retransmissions++;
+    }
+    tx->sent |= 1 << index;
+    tx->in_flight |= 1 << index;
+    pending &= ~(1 << index);
+
+    /* The last fragment of a burst asks for an acknowledgement. */
+    uint8_t flags = 0;
+    if (broadcast) {
+        if (!pending) {
+            tx->active = false;
+            tx->packets_sent++;
+        }
+    } else if (!pending || popcount(tx->in_flight) == UWB_FRAGMENT_WINDOW) {
+        flags |= FRAGMENT_FLAG_ACK_REQUEST;
+        tx->waiting_ack = true;
+        tx->ack_deadline_us = now_us + UWB_FRAGMENT_ACK_TIMEOUT_US;
+    }
+
+    size_t offset = index * UWB_FRAGMENT_DATA_SIZE;
+    size_t len = tx->size - offset;
+    if (len > UWB_FRAGMENT_DATA_SIZE) {
+        len = UWB_FRAGMENT_DATA_SIZE;
+    }
+
+    payload[0] = tx->packet_id;
+    payload[1] = index;
+    payload[2] = tx->fragment_count;
+    payload[3] = flags;
+    memcpy(&payload[UWB_FRAGMENT_HEADER_SIZE], &tx->data[offset], len);
+
+    *dst_addr = tx->dst_addr;
+
+    return UWB_FRAGMENT_HEADER_SIZE + len;
+}
+
+void uwb_fragment_tx_ack(uwb_fragment_tx_t* tx, uint16_t src_addr, const uint8_t* ack, size_t size)
+{
+    if (!tx->active || size < UWB_FRAGMENT_ACK_SIZE || src_addr != tx->dst_addr || ack[0] != tx->packet_id) {
+        return;
+    }
+
+    tx->acked |= (ack[1] | (ack[2] << 8)) & all_fragments(tx->fragment_count);
+    tx->in_flight = 0;
+    tx->waiting_ack = false;
+    tx->retries = 0;
+
+    if (tx->acked == all_fragments(tx->fragment_count)) {
+        tx->active = false;
+        tx->packets_sent++;
+    }
+}
+
+void uwb_fragment_rx_init(uwb_fragment_rx_t* rx)
+{
+    memset(rx, 0, sizeof(uwb_fragment_rx_t));
+}
+
+static uwb_fragment_rx_slot_t* find_slot(uwb_fragment_rx_t* rx, uint16_t src_addr, uint32_t now_us)
+{
+    uwb_fragment_rx_slot_t* best = NULL;
+
+    for (int i = 0; i < UWB_FRAGMENT_MAX_SOURCES; i++) {
+        uwb_fragment_rx_slot_t* slot = &rx->slots[i];
+        if ((slot->active || slot->delivered) && slot->src_addr == src_addr) {
+            return slot;
+        }
+    }
+
+    /* Otherwise take a free slot, or the one idle for the longest time. */
+    for (int i = 0; i < UWB_FRAGMENT_MAX_SOURCES; i++) {
+        uwb_fragment_rx_slot_t* slot = &rx->slots[i];
+        if (!slot->active && !slot->delivered) {
+            best = slot;
+            break;
+        }
+        if (best == NULL || (now_us - slot->last_rx_us) > (now_us - best->last_rx_us)) {
+            best = slot;
+        }
+    }
+
+    best->active = false;
+    best->delivered = false;
+    best->src_addr = src_addr;
+
+    return best;
+}
+
+static void write_ack(const uwb_fragment_rx_slot_t* slot, uwb_fragment_rx_result_t* result)
+{
+    result->ack_needed = true;
+    result->ack[0] = slot->packet_id;
+    result->ack[1] = slot->received & 0xff;
+    result->ack[2] = slot->received >> 8;
+}
+
+void uwb_fragment_rx_process(uwb_fragment_rx_t* rx,
+                             uint16_t src_addr,
+                             uint16_t dst_addr,
+                             const uint8_t* payload,
+                             size_t size,
+                             uint32_t now_us,
+                             uwb_fragment_rx_result_t* result)
+{
+    memset(result, 0, sizeof(uwb_fragment_rx_result_t));
+
+    if (size <= UWB_FRAGMENT_HEADER_SIZE || size > UWB_FRAGMENT_MAX_SIZE) {
+        return;
+    }
+
+    uint8_t packet_id = payload[0];
+    uint8_t index = payload[1];
+    uint8_t count = payload[2];
+    bool ack_requested = (payload[3] & FRAGMENT_FLAG_ACK_REQUEST) && dst_addr != MAC_802_15_4_BROADCAST_ADDR;
+    size_t len = size - UWB_FRAGMENT_HEADER_SIZE;
+
+    /* Only the last fragment can be shorter, and it must not go past the end
+     * of the largest packet. */
+    if (count == 0 || count > UWB_FRAGMENT_MAX_COUNT || index >= count
+        || (index < count - 1 && len != UWB_FRAGMENT_DATA_SIZE)
+        || index * UWB_FRAGMENT_DATA_SIZE + len > UWB_FRAGMENT_MAX_PACKET_SIZE) {
+        return;
+    }
+
+    uwb_fragment_rx_slot_t* slot = find_slot(rx, src_addr, now_us);
+    bool stale = deadline_passed(now_us, slot->last_rx_us + UWB_FRAGMENT_RX_TIMEOUT_US);
+
+    /* Fragment of a packet we already delivered, our acknowledgement was
+     * probably lost. */
+    if (slot->delivered && slot->packet_id == packet_id && !stale) {
+        if (ack_requested) {
+            write_ack(slot, result);
+        }
+        return;
+    }
+
+    if (!slot->active || slot->packet_id != packet_id || slot->fragment_count != count || stale) {
+        slot->active = true;
+        slot->delivered = false;
+        slot->packet_id = packet_id;
+        slot->fragment_count = count;
+        slot->received = 0;
+        slot->size = 0;
+    }
+
+    slot->dst_addr = dst_addr;
+    slot->last_rx_us = now_us;
+    memcpy(&slot->data[index * UWB_FRAGMENT_DATA_SIZE], &payload[UWB_FRAGMENT_HEADER_SIZE], len);
+    slot->received |= 1 << index;
+
+    if (index == count - 1) {
+        slot->size = index * UWB_FRAGMENT_DATA_SIZE + len;
+    }
+
+    if (slot->received == all_fragments(count)) {
+        slot->active = false;
+        slot->delivered = true;
+        result->packet = slot->data;
+        result->packet_size = slot->size;
+        result->dst_addr = slot->dst_addr;
+    }
+
+    if (ack_requested) {
+        write_ack(slot, result);
+    }
+}
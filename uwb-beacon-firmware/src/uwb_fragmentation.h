@@ -0,0 +1,155 @@
+#ifndef UWB_FRAGMENTATION_H
+#define UWB_FRAGMENTATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @file uwb_fragmentation.h
+ *
+ * Transfer of user packets larger than a UWB frame.
+ *
+ * A packet is cut into fragments small enough to fit in a standard 127 bytes
+ * 802.15.4 frame. The sender transmits up to UWB_FRAGMENT_WINDOW fragments
+ * back to back and asks for an acknowledgement on the last one. The receiver
+ * answers with the set of fragments it got so far (selective
+ * acknowledgement), and the sender then continues with the missing ones. If
+ * the acknowledgement does not come, the unacknowledged fragments are sent
+ * again, up to UWB_FRAGMENT_MAX_RETRIES times.
+ *
+ * Broadcast packets cannot be acknowledged: each fragment is sent once and
+ * the receivers only deliver complete packets.
+ *
+ * Both sides are pure state machines: they produce and consume fragment and
+ * acknowledgement payloads, which are carried in frames by uwb_protocol.h.
+ */
+
+/** Largest user packet. */
+#define UWB_FRAGMENT_MAX_PACKET_SIZE 1024
+
+/** User data in a fragment. */
+#define UWB_FRAGMENT_DATA_SIZE 100
+
+/** Fragment header: packet ID, fragment index, fragment count, flags. */
+#define UWB_FRAGMENT_HEADER_SIZE 4
+
+/** Largest fragment payload, header included. */
+#define UWB_FRAGMENT_MAX_SIZE (UWB_FRAGMENT_HEADER_SIZE + UWB_FRAGMENT_DATA_SIZE)
+
+/** Acknowledgement payload: packet ID and 16 bits mask of received fragments. */
+#define UWB_FRAGMENT_ACK_SIZE 3
+
+#define UWB_FRAGMENT_MAX_COUNT \
+    ((UWB_FRAGMENT_MAX_PACKET_SIZE + UWB_FRAGMENT_DATA_SIZE - 1) / UWB_FRAGMENT_DATA_SIZE)
+
+/** Maximum number of fragments sent before waiting for an acknowledgement. */
+#define UWB_FRAGMENT_WINDOW 4
+
+/** Time to wait for an acknowledgement before sending again. A window of 4
+ * fragments takes about 1 ms of air time at 6.8 Mbps. */
+#define UWB_FRAGMENT_ACK_TIMEOUT_US 5000
+
+/** Number of times a window is sent again before the packet is dropped. */
+#define UWB_FRAGMENT_MAX_RETRIES 5
+
+/** Incomplete packets older than this are dropped by the receiver. */
+#define UWB_FRAGMENT_RX_TIMEOUT_US 200000
+
+/** Number of senders the receiver reassembles packets from at once. */
+#define UWB_FRAGMENT_MAX_SOURCES 2
+
+typedef struct {
+    bool active;
+    uint8_t data[UWB_FRAGMENT_MAX_PACKET_SIZE];
+    size_t size;
+    uint16_t dst_addr;
+    uint8_t packet_id;
+    uint8_t fragment_count;
+    uint16_t acked; ///< Fragments acknowledged by the receiver
+    uint16_t in_flight; ///< Fragments sent since the last acknowledgement
+    uint16_t sent; ///< Fragments sent at least once
+    bool waiting_ack;
+    uint32_t ack_deadline_us;
+    unsigned retries;
+
+    /* Statistics */
+    uint32_t packets_sent;
+    uint32_t packets_dropped;
+    uint32_t retransmissions;
+} uwb_fragment_tx_t;
+
+typedef struct {
+    bool active; ///< A packet is being reassembled
+    bool delivered; ///< The last packet from this source was delivered
+    uint16_t src_addr;
+    uint16_t dst_addr;
+    uint8_t packet_id;
+    uint8_t fragment_count;
+    uint16_t received;
+    size_t size;
+    uint32_t last_rx_us;
+    uint8_t data[UWB_FRAGMENT_MAX_PACKET_SIZE];
+} uwb_fragment_rx_slot_t;
+
+typedef struct {
+    uwb_fragment_rx_slot_t slots[UWB_FRAGMENT_MAX_SOURCES];
+} uwb_fragment_rx_t;
+
+/** Outcome of the reception of a fragment. */
+typedef struct {
+    /** If true, ack must be sent back to the source of the fragment. */
+    bool ack_needed;
+    uint8_t ack[UWB_FRAGMENT_ACK_SIZE];
+
+    /** Complete packet, or NULL. Valid until the next fragment from the same
+     * source is processed. */
+    const uint8_t* packet;
+    size_t packet_size;
+    uint16_t dst_addr;
+} uwb_fragment_rx_result_t;
+
+void uwb_fragment_tx_init(uwb_fragment_tx_t* tx);
+
+/** Starts sending a packet.
+ *
+ * @returns false if a packet is still being sent or if it is too large.
+ */
+bool uwb_fragment_tx_start(uwb_fragment_tx_t* tx, uint16_t dst_addr, const uint8_t* data, size_t size);
+
+/** Returns true while a packet is being sent. */
+bool uwb_fragment_tx_busy(const uwb_fragment_tx_t* tx);
+
+/** Prepares the next fragment to transmit, if any.
+ *
+ * Must be called again after each transmission, and periodically while
+ * waiting for an acknowledgement to handle timeouts.
+ *
+ * @param [out] payload At least UWB_FRAGMENT_MAX_SIZE bytes.
+ * @param [out] dst_addr Destination of the fragment.
+ * @returns The payload size, or zero if nothing must be sent now.
+ */
+size_t uwb_fragment_tx_next(uwb_fragment_tx_t* tx, uint32_t now_us, uint8_t* payload, uint16_t* dst_addr);
+
+/** Processes an acknowledgement received from src_addr. */
+void uwb_fragment_tx_ack(uwb_fragment_tx_t* tx, uint16_t src_addr, const uint8_t* ack, size_t size);
+
+void uwb_fragment_rx_init(uwb_fragment_rx_t* rx);
+
+/** Processes a received fragment payload. */
+void uwb_fragment_rx_process(uwb_fragment_rx_t* rx,
+                             uint16_t src_addr,
+                             uint16_t dst_addr,
+                             const uint8_t* payload,
+                             size_t size,
+                             uint32_t now_us,
+                             uwb_fragment_rx_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,3 +1,4 @@
+#include <math.h>
 #include <string.h>
 #include "uwb_protocol.h"
 
@@ -15,13 +16,36 @@
 #define UWB_SEQ_NUM_ANCHOR_POSITION 3
 #define UWB_SEQ_NUM_TAG_POSITION 4
 #define UWB_SEQ_NUM_INITIATE_MEASUREMENT 5
+#define UWB_SEQ_NUM_TDMA_BEACON 6
+#define UWB_SEQ_NUM_POLL 7
+#define UWB_SEQ_NUM_POLL_RESPONSE 8
+#define UWB_SEQ_NUM_POLL_FINAL 9
 #define UWB_SEQ_NUM_USER_DATA 100
+#define UWB_SEQ_NUM_DATA_FRAGMENT 101
+#define UWB_SEQ_NUM_DATA_ACK 102
 
 #define UWB_DELAY (1000 * 65536)
+
+/** Spacing between the responses of two anchors to a broadcast poll. */
+#define UWB_POLL_SLOT_DELAY (500 * 65536)
+
+/** Time during which an exchange is still in progress after the expected
+ * arrival of the answer to our last ranging frame. Covers its air time. */
+#define UWB_EXCHANGE_MARGIN UWB_DELAY
+
+/** Upper bound of the time between now and the end of an exchange. */
+#define UWB_EXCHANGE_MAX_DURATION (4 * UWB_DELAY + UWB_POLL_MAX_ANCHORS * UWB_POLL_SLOT_DELAY)
+
+#define UWB_POLL_RESPONSE_LEN 15
+#define UWB_POLL_FINAL_HDR_LEN 12
+#define UWB_POLL_FINAL_ENTRY_LEN 7
 #define MASK_40BIT 0xfffffffe00
 
 static void write_40bit_int(uint64_t val, uint8_t* bytes);
 static uint64_t read_40bit_int(uint8_t* bytes);
+static void process_poll(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts);
+static void process_poll_response(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts);
+static void process_poll_final(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts);
 
 size_t uwb_mac_encapsulate_frame(uint16_t pan_id,
                                  uint16_t src_addr,
@@ -111,28 +135,92 @@ static uint64_t substract_40bit_int(uint64_t a, uint64_t b)
     return res;
 }
 
+/** Sends a frame belonging to a ranging exchange, which stays in progress
+ * until the answer to it had time to arrive, answer_delay after it is sent. */
+static void transmit_ranging_frame(uwb_protocol_handler_t* handler,
+                                   uint64_t tx_ts,
+                                   uint64_t answer_delay,
+                                   uint8_t* frame,
+                                   size_t frame_size)
+{
+    handler->exchange_pending = true;
+    handler->exchange_deadline = (tx_ts + answer_delay + UWB_EXCHANGE_MARGIN) & MASK_40BIT;
+
+    uwb_transmit_frame(tx_ts, frame, frame_size);
+}
+
+/** Computes the double sided two way ranging propagation time from the round
+ * trip and reply durations of both sides.
+ *
+ * tround0 and treply1 are measured by the remote clock, tround1 and treply0 by
+ * ours. When the offset of the remote clock is known, its durations are
+ * converted to our clock and the symmetric formula only needs additions.
+ * Otherwise the asymmetric formula cancels the drift to the first order, at
+ * the cost of two 64 bit products and a 64 bit division.
+ */
+static uint64_t ds_twr_propagation_time(const uwb_protocol_handler_t* handler,
+                                        uint64_t tround0,
+                                        uint64_t tround1,
+                                        uint64_t treply0,
+                                        uint64_t treply1)
+{
+    if (handler->rx_clock_offset_valid) {
+        int64_t remote = (int64_t)tround0 - (int64_t)treply1;
+        int64_t local = (int64_t)tround1 - (int64_t)treply0;
+
+        /* The correction is small, a float product is precise enough. */
+        remote -= llroundf(remote * handler->rx_clock_offset);
+
+        return (uint64_t)(remote + local) / 4;
+    }
+
+    return (tround0 * tround1 - treply0 * treply1) / (tround0 + tround1 + treply0 + treply1);
+}
+
+static void write_16bit_int(uint16_t val, uint8_t* bytes)
+{
+    bytes[0] = val & 0xff;
+    bytes[1] = val >> 8;
+}
+
+static uint16_t read_16bit_int(const uint8_t* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static void write_32bit_int(uint32_t val, uint8_t* bytes)
+{
+    bytes[0] = (val >> 0) & 0xff;
+    bytes[1] = (val >> 8) & 0xff;
+    bytes[2] = (val >> 16) & 0xff;
+    bytes[3] = (val >> 24) & 0xff;
+}
+
+static uint32_t read_32bit_int(const uint8_t* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
 void uwb_protocol_handler_init(uwb_protocol_handler_t* handler)
 {
     memset(handler, 0, sizeof(uwb_protocol_handler_t));
 }
 
-size_t uwb_protocol_prepare_measurement_advertisement(uwb_protocol_handler_t* handler,
-                                                      uint64_t tx_timestamp,
-                                                      uint8_t* frame)
+static size_t prepare_advertisement(uwb_protocol_handler_t* handler,
+                                    uint16_t dst_addr,
+                                    uint64_t tx_timestamp,
+                                    uint8_t* frame)
 {
-    size_t size;
     write_40bit_int(tx_timestamp, frame);
-    size = uwb_mac_encapsulate_frame(handler->pan_id,
+    return uwb_mac_encapsulate_frame(handler->pan_id,
                                      handler->address,
-                                     MAC_802_15_4_BROADCAST_ADDR,
+                                     dst_addr,
                                      UWB_SEQ_NUM_ADVERTISEMENT,
                                      frame,
                                      5);
-
-    return size;
 }
 
-void uwb_send_measurement_advertisement(uwb_protocol_handler_t* handler, uint8_t* buffer)
+static void send_advertisement(uwb_protocol_handler_t* handler, uint16_t dst_addr, uint8_t* buffer)
 {
     uint64_t ts = uwb_timestamp_get();
     size_t frame_size;
@@ -140,8 +228,20 @@ void uwb_send_measurement_advertisement(uwb_protocol_handler_t* handler, uint8_t
     ts += UWB_DELAY;
     ts &= MASK_40BIT;
 
-    frame_size = uwb_protocol_prepare_measurement_advertisement(handler, ts, buffer);
-    uwb_transmit_frame(ts, buffer, frame_size);
+    frame_size = prepare_advertisement(handler, dst_addr, ts, buffer);
+    transmit_ranging_frame(handler, ts, UWB_DELAY, buffer, frame_size);
+}
+
+size_t uwb_protocol_prepare_measurement_advertisement(uwb_protocol_handler_t* handler,
+                                                      uint64_t tx_timestamp,
+                                                      uint8_t* frame)
+{
+    return prepare_advertisement(handler, MAC_802_15_4_BROADCAST_ADDR, tx_timestamp, frame);
+}
+
+void uwb_send_measurement_advertisement(uwb_protocol_handler_t* handler, uint8_t* buffer)
+{
+    send_advertisement(handler, MAC_802_15_4_BROADCAST_ADDR, buffer);
 }
 
 size_t uwb_protocol_prepare_anchor_position(uwb_protocol_handler_t* handler,
@@ -197,6 +297,64 @@ size_t uwb_protocol_prepare_data_packet(uwb_protocol_handler_t* handler,
                                      msg_size);
 }
 
+size_t uwb_protocol_prepare_data_fragment(uwb_protocol_handler_t* handler,
+                                          uint16_t dst_addr,
+                                          const uint8_t* payload,
+                                          size_t size,
+                                          uint8_t* frame)
+{
+    memcpy(frame, payload, size);
+    return uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     dst_addr,
+                                     UWB_SEQ_NUM_DATA_FRAGMENT,
+                                     frame,
+                                     size);
+}
+
+size_t uwb_protocol_prepare_data_ack(uwb_protocol_handler_t* handler,
+                                     uint16_t dst_addr,
+                                     const uint8_t* payload,
+                                     size_t size,
+                                     uint8_t* frame)
+{
+    memcpy(frame, payload, size);
+    return uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     dst_addr,
+                                     UWB_SEQ_NUM_DATA_ACK,
+                                     frame,
+                                     size);
+}
+
+size_t uwb_protocol_prepare_tdma_beacon(uwb_protocol_handler_t* handler,
+                                        uint8_t slot_count,
+                                        uint32_t slot_duration_us,
+                                        uint8_t* frame)
+{
+    frame[0] = slot_count;
+    write_32bit_int(slot_duration_us, &frame[1]);
+
+    return uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     MAC_802_15_4_BROADCAST_ADDR,
+                                     UWB_SEQ_NUM_TDMA_BEACON,
+                                     frame,
+                                     5);
+}
+
+void uwb_send_tdma_beacon(uwb_protocol_handler_t* handler,
+                          uint8_t slot_count,
+                          uint32_t slot_duration_us,
+                          uint8_t* frame)
+{
+    size_t size;
+
+    size = uwb_protocol_prepare_tdma_beacon(handler, slot_count, slot_duration_us, frame);
+
+    uwb_transmit_frame(UWB_TX_TIMESTAMP_IMMEDIATE, frame, size);
+}
+
 void uwb_send_anchor_position(uwb_protocol_handler_t* handler,
                               float x,
                               float y,
@@ -228,6 +386,20 @@ void uwb_send_data_packet(uwb_protocol_handler_t* handler, uint16_t dst_addr, co
     uwb_transmit_frame(UWB_TX_TIMESTAMP_IMMEDIATE, frame, size);
 }
 
+void uwb_send_data_fragment(uwb_protocol_handler_t* handler, uint16_t dst_addr, const uint8_t* payload, size_t size, uint8_t* frame)
+{
+    size = uwb_protocol_prepare_data_fragment(handler, dst_addr, payload, size, frame);
+
+    uwb_transmit_frame(UWB_TX_TIMESTAMP_IMMEDIATE, frame, size);
+}
+
+void uwb_send_data_ack(uwb_protocol_handler_t* handler, uint16_t dst_addr, const uint8_t* payload, size_t size, uint8_t* frame)
+{
+    size = uwb_protocol_prepare_data_ack(handler, dst_addr, payload, size, frame);
+
+    uwb_transmit_frame(UWB_TX_TIMESTAMP_IMMEDIATE, frame, size);
+}
+
 void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
                                 uint8_t* frame,
                                 size_t frame_size,
@@ -258,7 +430,9 @@ void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
     /* Measurement advertisement */
     if (seq_num == UWB_SEQ_NUM_ADVERTISEMENT) {
         if (handler->is_anchor == false) {
-            // TODO how to properly handle this delay
+            /* The TX antenna delay is left at zero, so the scheduled time is
+             * the actual TX timestamp. All the antenna delays are accounted
+             * for in the RX delay and the per anchor calibration. */
             uint64_t reply_ts = rx_ts + UWB_DELAY;
 
             reply_ts &= MASK_40BIT;
@@ -279,10 +453,10 @@ void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
                                                    frame,
                                                    frame_size);
             /* Sends the answer. */
-            uwb_transmit_frame(reply_ts, frame, frame_size);
+            transmit_ranging_frame(handler, reply_ts, UWB_DELAY, frame, frame_size);
         }
     } else if (seq_num == UWB_SEQ_NUM_REPLY) {
-        // TODO how to properly handle this delay
+        /* Same delay handling as for the reply. */
         uint64_t reply_ts = rx_ts + UWB_DELAY;
 
         reply_ts &= MASK_40BIT;
@@ -302,8 +476,8 @@ void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
                                                UWB_SEQ_NUM_FINALIZATION,
                                                frame,
                                                frame_size);
-        /* Sends the answer. */
-        uwb_transmit_frame(reply_ts, frame, frame_size);
+        /* Sends the answer, which is not answered anymore. */
+        transmit_ranging_frame(handler, reply_ts, 0, frame, frame_size);
 
     } else if (seq_num == UWB_SEQ_NUM_FINALIZATION) {
         uint64_t advertisement_tx_ts = read_40bit_int(&frame[0]);
@@ -322,7 +496,8 @@ void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
         treply[0] = substract_40bit_int(reply_tx_ts, advertisement_rx_ts);
         treply[1] = substract_40bit_int(final_tx_ts, reply_rx_ts);
 
-        t_propag = (tround[0] * tround[1] - treply[0] * treply[1]) / (tround[0] + tround[1] + treply[0] + treply[1]);
+        t_propag = ds_twr_propagation_time(handler, tround[0], tround[1], treply[0], treply[1]);
+        handler->exchange_pending = false;
 
         if (handler->ranging_found_cb) {
             handler->ranging_found_cb(src_addr, t_propag);
@@ -339,11 +514,32 @@ void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
         memcpy(&y, &frame[4], sizeof(float));
         handler->tag_position_received_cb(src_addr, x, y);
     } else if (seq_num == UWB_SEQ_NUM_INITIATE_MEASUREMENT) {
-        uwb_send_measurement_advertisement(handler, frame);
+        /* Only the tag which asked for the measurement must answer, otherwise
+         * every tag in range would reply at the same time. */
+        send_advertisement(handler, src_addr, frame);
+    } else if (seq_num == UWB_SEQ_NUM_TDMA_BEACON) {
+        uint32_t slot_duration_us = read_32bit_int(&frame[1]);
+        if (handler->tdma_beacon_received_cb) {
+            handler->tdma_beacon_received_cb(src_addr, frame[0], slot_duration_us);
+        }
+    } else if (seq_num == UWB_SEQ_NUM_POLL) {
+        process_poll(handler, src_addr, frame, frame_size, rx_ts);
+    } else if (seq_num == UWB_SEQ_NUM_POLL_RESPONSE) {
+        process_poll_response(handler, src_addr, frame, frame_size, rx_ts);
+    } else if (seq_num == UWB_SEQ_NUM_POLL_FINAL) {
+        process_poll_final(handler, src_addr, frame, frame_size, rx_ts);
     } else if (seq_num == UWB_SEQ_NUM_USER_DATA) {
         if (handler->user_data_received_cb) {
             handler->user_data_received_cb(frame, frame_size, src_addr, dst_addr);
         }
+    } else if (seq_num == UWB_SEQ_NUM_DATA_FRAGMENT) {
+        if (handler->data_fragment_received_cb) {
+            handler->data_fragment_received_cb(frame, frame_size, src_addr, dst_addr);
+        }
+    } else if (seq_num == UWB_SEQ_NUM_DATA_ACK) {
+        if (handler->data_ack_received_cb) {
+            handler->data_ack_received_cb(frame, frame_size, src_addr);
+        }
     }
 }
 
@@ -362,5 +558,281 @@ void uwb_initiate_measurement(uwb_protocol_handler_t* handler, uint8_t* buffer,
     ts += UWB_DELAY;
     ts &= MASK_40BIT;
 
-    uwb_transmit_frame(ts, buffer, size);
+    transmit_ranging_frame(handler, ts, UWB_DELAY, buffer, size);
+}
+
+bool uwb_ranging_in_progress(uwb_protocol_handler_t* handler, uint64_t now)
+{
+    /* The deadline is never far ahead, a larger difference means the clock
+     * went past it. */
+    if (handler->exchange_pending
+        && substract_40bit_int(handler->exchange_deadline, now) > UWB_EXCHANGE_MAX_DURATION) {
+        handler->exchange_pending = false;
+    }
+
+    return handler->exchange_pending;
+}
+
+size_t uwb_protocol_prepare_poll(uwb_protocol_handler_t* handler,
+                                 uint8_t round,
+                                 const uint16_t* anchors,
+                                 size_t anchor_count,
+                                 uint8_t* frame)
+{
+    frame[0] = round;
+    frame[1] = anchor_count;
+    for (size_t i = 0; i < anchor_count; i++) {
+        write_16bit_int(anchors[i], &frame[2 + 2 * i]);
+    }
+
+    return uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     MAC_802_15_4_BROADCAST_ADDR,
+                                     UWB_SEQ_NUM_POLL,
+                                     frame,
+                                     2 + 2 * anchor_count);
+}
+
+void uwb_send_poll(uwb_protocol_handler_t* handler,
+                   const uint16_t* anchors,
+                   size_t anchor_count,
+                   uint8_t* buffer)
+{
+    uwb_poll_initiator_t* poll = &handler->poll;
+    uint64_t ts = uwb_timestamp_get();
+    size_t size;
+
+    if (anchor_count > UWB_POLL_MAX_ANCHORS) {
+        anchor_count = UWB_POLL_MAX_ANCHORS;
+    }
+
+    ts += UWB_DELAY;
+    ts &= MASK_40BIT;
+
+    poll->pending = true;
+    poll->round++;
+    poll->poll_tx_ts = ts;
+    poll->anchor_count = anchor_count;
+    memcpy(poll->anchors, anchors, anchor_count * sizeof(uint16_t));
+    memset(poll->response_received, 0, sizeof(poll->response_received));
+
+    /* The last anchor answers in the last response slot. */
+    size = uwb_protocol_prepare_poll(handler, poll->round, anchors, anchor_count, buffer);
+    transmit_ranging_frame(handler, ts, UWB_DELAY + (uint64_t)anchor_count * UWB_POLL_SLOT_DELAY, buffer, size);
+}
+
+static void send_poll_final(uwb_protocol_handler_t* handler, uint64_t tx_ts, uint8_t* frame)
+{
+    uwb_poll_initiator_t* poll = &handler->poll;
+    size_t size = UWB_POLL_FINAL_HDR_LEN;
+    uint8_t count = 0;
+
+    poll->pending = false;
+
+    for (unsigned i = 0; i < poll->anchor_count; i++) {
+        if (!poll->response_received[i]) {
+            continue;
+        }
+        write_16bit_int(poll->anchors[i], &frame[size]);
+        write_40bit_int(poll->response_rx_ts[i], &frame[size + 2]);
+        size += UWB_POLL_FINAL_ENTRY_LEN;
+        count++;
+    }
+
+    frame[0] = poll->round;
+    write_40bit_int(poll->poll_tx_ts, &frame[1]);
+    write_40bit_int(tx_ts, &frame[6]);
+    frame[11] = count;
+
+    size = uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     MAC_802_15_4_BROADCAST_ADDR,
+                                     UWB_SEQ_NUM_POLL_FINAL,
+                                     frame,
+                                     size);
+    transmit_ranging_frame(handler, tx_ts, 0, frame, size);
+}
+
+void uwb_send_poll_final(uwb_protocol_handler_t* handler, uint8_t* buffer)
+{
+    uint64_t ts = uwb_timestamp_get();
+
+    if (!handler->poll.pending) {
+        return;
+    }
+
+    ts += UWB_DELAY;
+    ts &= MASK_40BIT;
+
+    send_poll_final(handler, ts, buffer);
+}
+
+/** Returns the broadcast poll state kept for the given tag, recycling the
+ * oldest entry if the tag is unknown. */
+static uwb_poll_responder_t* poll_responder_get(uwb_protocol_handler_t* handler, uint16_t tag_addr)
+{
+    uwb_poll_responder_t* responder;
+
+    for (unsigned i = 0; i < UWB_POLL_MAX_TAGS; i++) {
+        responder = &handler->poll_responders[i];
+        if (responder->valid && responder->tag_addr == tag_addr) {
+            return responder;
+        }
+    }
+
+    responder = &handler->poll_responders[handler->next_poll_responder];
+    handler->next_poll_responder = (handler->next_poll_responder + 1) % UWB_POLL_MAX_TAGS;
+
+    memset(responder, 0, sizeof(uwb_poll_responder_t));
+    responder->valid = true;
+    responder->tag_addr = tag_addr;
+    responder->report = UWB_POLL_NO_REPORT;
+
+    return responder;
+}
+
+static void process_poll(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts)
+{
+    uint8_t round = frame[0];
+    size_t anchor_count = frame[1];
+    uwb_poll_responder_t* responder;
+    uint64_t reply_ts;
+    size_t size;
+    unsigned slot;
+
+    if (!handler->is_anchor || frame_size < 2 + 2 * anchor_count) {
+        return;
+    }
+
+    /* Our position in the list gives our response slot. */
+    for (slot = 0; slot < anchor_count; slot++) {
+        if (read_16bit_int(&frame[2 + 2 * slot]) == handler->address) {
+            break;
+        }
+    }
+
+    if (slot == anchor_count) {
+        return;
+    }
+
+    reply_ts = rx_ts + UWB_DELAY + (uint64_t)slot * UWB_POLL_SLOT_DELAY;
+    reply_ts &= MASK_40BIT;
+
+    responder = poll_responder_get(handler, src_addr);
+    responder->round = round;
+    responder->poll_rx_ts = rx_ts;
+    responder->response_tx_ts = reply_ts;
+
+    frame[0] = round;
+    write_40bit_int(rx_ts, &frame[1]);
+    write_40bit_int(reply_ts, &frame[6]);
+    write_32bit_int(responder->report, &frame[11]);
+
+    /* A report is only sent once. */
+    responder->report = UWB_POLL_NO_REPORT;
+
+    size = uwb_mac_encapsulate_frame(handler->pan_id,
+                                     handler->address,
+                                     src_addr,
+                                     UWB_SEQ_NUM_POLL_RESPONSE,
+                                     frame,
+                                     UWB_POLL_RESPONSE_LEN);
+
+    /* The final frame comes after the responses of the anchors after us. */
+    transmit_ranging_frame(handler,
+                           reply_ts,
+                           UWB_DELAY + (uint64_t)(anchor_count - slot) * UWB_POLL_SLOT_DELAY,
+                           frame,
+                           size);
+}
+
+static void process_poll_response(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts)
+{
+    uwb_poll_initiator_t* poll = &handler->poll;
+    uint32_t report;
+    unsigned i;
+
+    if (frame_size < UWB_POLL_RESPONSE_LEN) {
+        return;
+    }
+
+    /* The report refers to the previous poll, so it is valid even if this
+     * response is late. */
+    report = read_32bit_int(&frame[11]);
+    if (report != UWB_POLL_NO_REPORT && handler->ranging_found_cb) {
+        handler->ranging_found_cb(src_addr, report);
+    }
+
+    if (!poll->pending || frame[0] != poll->round) {
+        return;
+    }
+
+    for (i = 0; i < poll->anchor_count; i++) {
+        if (poll->anchors[i] == src_addr) {
+            break;
+        }
+    }
+
+    if (i == poll->anchor_count) {
+        return;
+    }
+
+    poll->response_rx_ts[i] = rx_ts;
+    poll->response_received[i] = true;
+
+    /* The last anchor answered, no need to wait any longer. */
+    if (i == poll->anchor_count - 1u) {
+        send_poll_final(handler, (rx_ts + UWB_DELAY) & MASK_40BIT, frame);
+    }
+}
+
+static void process_poll_final(uwb_protocol_handler_t* handler, uint16_t src_addr, uint8_t* frame, size_t frame_size, uint64_t rx_ts)
+{
+    uwb_poll_responder_t* responder = NULL;
+    uint64_t poll_tx_ts, final_tx_ts, response_rx_ts;
+    uint64_t tround[2], treply[2];
+    size_t count;
+    unsigned i;
+
+    if (!handler->is_anchor || frame_size < UWB_POLL_FINAL_HDR_LEN) {
+        return;
+    }
+
+    for (i = 0; i < UWB_POLL_MAX_TAGS; i++) {
+        if (handler->poll_responders[i].valid && handler->poll_responders[i].tag_addr == src_addr) {
+            responder = &handler->poll_responders[i];
+        }
+    }
+
+    if (responder == NULL || responder->round != frame[0]) {
+        return;
+    }
+
+    /* The final frame ends the exchange, even if we are not listed in it. */
+    handler->exchange_pending = false;
+
+    poll_tx_ts = read_40bit_int(&frame[1]);
+    final_tx_ts = read_40bit_int(&frame[6]);
+    count = frame[11];
+
+    if (frame_size < UWB_POLL_FINAL_HDR_LEN + count * UWB_POLL_FINAL_ENTRY_LEN) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        uint8_t* entry = &frame[UWB_POLL_FINAL_HDR_LEN + i * UWB_POLL_FINAL_ENTRY_LEN];
+        if (read_16bit_int(entry) != handler->address) {
+            continue;
+        }
+
+        response_rx_ts = read_40bit_int(&entry[2]);
+
+        tround[0] = substract_40bit_int(response_rx_ts, poll_tx_ts);
+        tround[1] = substract_40bit_int(rx_ts, responder->response_tx_ts);
+        treply[0] = substract_40bit_int(responder->response_tx_ts, responder->poll_rx_ts);
+        treply[1] = substract_40bit_int(final_tx_ts, response_rx_ts);
+
+        responder->report = ds_twr_propagation_time(handler, tround[0], tround[1], treply[0], treply[1]);
+        break;
+    }
 }
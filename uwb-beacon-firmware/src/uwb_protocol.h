@@ -16,6 +16,44 @@ extern "C" {
  * sent as soon as possible. */
 #define UWB_TX_TIMESTAMP_IMMEDIATE UINT64_MAX
 
+/** Maximum number of anchors answering a single broadcast poll. */
+#define UWB_POLL_MAX_ANCHORS 8
+
+/** Number of tags an anchor keeps broadcast poll state for. */
+#define UWB_POLL_MAX_TAGS 8
+
+/** Duration of a two way ranging exchange started by
+ * uwb_initiate_measurement(), until the final frame is out. Each of its 4
+ * frames is sent about 1 ms after the previous one. */
+#define UWB_TWR_EXCHANGE_DURATION_US 4500
+
+/** Duration of a broadcast poll exchange with the given number of anchors. */
+#define UWB_POLL_EXCHANGE_DURATION_US(anchor_count) (3000 + 520 * (anchor_count))
+
+/** Marks a poll response which does not carry a ranging report. */
+#define UWB_POLL_NO_REPORT UINT32_MAX
+
+/** State of the broadcast poll started by a tag. */
+typedef struct {
+    bool pending; ///< True until the final frame is sent
+    uint8_t round;
+    uint64_t poll_tx_ts;
+    uint8_t anchor_count;
+    uint16_t anchors[UWB_POLL_MAX_ANCHORS];
+    uint64_t response_rx_ts[UWB_POLL_MAX_ANCHORS];
+    bool response_received[UWB_POLL_MAX_ANCHORS];
+} uwb_poll_initiator_t;
+
+/** State kept by an anchor for each tag polling it. */
+typedef struct {
+    bool valid;
+    uint16_t tag_addr;
+    uint8_t round;
+    uint64_t poll_rx_ts;
+    uint64_t response_tx_ts;
+    uint32_t report; ///< Last propagation time to the tag, sent in the next response
+} uwb_poll_responder_t;
+
 /** Object handling all the UWB protocol interactions. */
 typedef struct {
     uint16_t pan_id;
@@ -24,7 +62,25 @@ typedef struct {
     void (*anchor_position_received_cb)(uint16_t anchor_addr, float x, float y, float z);
     void (*tag_position_received_cb)(uint16_t tag_addr, float x, float y);
     void (*user_data_received_cb)(const uint8_t* msg, size_t size, uint16_t src, uint16_t dst);
+    void (*data_fragment_received_cb)(const uint8_t* payload, size_t size, uint16_t src, uint16_t dst);
+    void (*data_ack_received_cb)(const uint8_t* payload, size_t size, uint16_t src);
+    void (*tdma_beacon_received_cb)(uint16_t anchor_addr, uint8_t slot_count, uint32_t slot_duration_us);
     bool is_anchor;
+
+    /** Clock offset of the sender of the frame being processed, relative to
+     * ours (1e-6 is 1 ppm), as measured by the DW1000 carrier integrator.
+     * Positive when the remote clock runs faster. */
+    float rx_clock_offset;
+    bool rx_clock_offset_valid;
+
+    uwb_poll_initiator_t poll;
+    uwb_poll_responder_t poll_responders[UWB_POLL_MAX_TAGS];
+    unsigned next_poll_responder;
+
+    /** Set while one of our ranging frames is scheduled or its answer is
+     * expected, see uwb_ranging_in_progress(). */
+    bool exchange_pending;
+    uint64_t exchange_deadline;
 } uwb_protocol_handler_t;
 
 /** Encapsulate frame data into a 802.15.4 MAC data frame.
@@ -85,9 +141,22 @@ void uwb_send_anchor_position(uwb_protocol_handler_t* handler,
 /** Broadcasts the tag's position to every connected beacon. */
 void uwb_send_tag_position(uwb_protocol_handler_t* handler, float x, float y, uint8_t* buffer);
 
+/** Broadcasts the TDMA superframe layout. Receivers align the start of their
+ * superframe on the reception of this frame. */
+void uwb_send_tdma_beacon(uwb_protocol_handler_t* handler,
+                          uint8_t slot_count,
+                          uint32_t slot_duration_us,
+                          uint8_t* frame);
+
 /** Sends a packet containing user defined packet */
 void uwb_send_data_packet(uwb_protocol_handler_t* handler, uint16_t dst_addr, const uint8_t* msg, size_t msg_size, uint8_t* frame);
 
+/** Sends a fragment of a user packet, see uwb_fragmentation.h. */
+void uwb_send_data_fragment(uwb_protocol_handler_t* handler, uint16_t dst_addr, const uint8_t* payload, size_t size, uint8_t* frame);
+
+/** Acknowledges the fragments of a user packet, see uwb_fragmentation.h. */
+void uwb_send_data_ack(uwb_protocol_handler_t* handler, uint16_t dst_addr, const uint8_t* payload, size_t size, uint8_t* frame);
+
 void uwb_process_incoming_frame(uwb_protocol_handler_t* handler,
                                 uint8_t* frame,
                                 size_t frame_size,
@@ -112,6 +181,15 @@ size_t uwb_protocol_prepare_tag_position(uwb_protocol_handler_t* handler,
                                          float y,
                                          uint8_t* frame);
 
+/** Prepares a frame used to transmit the TDMA superframe layout.
+ *
+ * @returns Number of bytes in frame.
+ */
+size_t uwb_protocol_prepare_tdma_beacon(uwb_protocol_handler_t* handler,
+                                        uint8_t slot_count,
+                                        uint32_t slot_duration_us,
+                                        uint8_t* frame);
+
 /** Creates a packet containing application specific data.
  *
  * @note The maximum size of a UWB packet is 1023 bytes. Given the header, this
@@ -125,10 +203,86 @@ size_t uwb_protocol_prepare_data_packet(uwb_protocol_handler_t* handler,
                                         size_t msg_size,
                                         uint8_t* frame);
 
+/** Creates a frame carrying a fragment of a user packet.
+ *
+ * @returns Size of frame in bytes
+ */
+size_t uwb_protocol_prepare_data_fragment(uwb_protocol_handler_t* handler,
+                                          uint16_t dst_addr,
+                                          const uint8_t* payload,
+                                          size_t size,
+                                          uint8_t* frame);
+
+/** Creates a frame acknowledging fragments of a user packet.
+ *
+ * @returns Size of frame in bytes
+ */
+size_t uwb_protocol_prepare_data_ack(uwb_protocol_handler_t* handler,
+                                     uint16_t dst_addr,
+                                     const uint8_t* payload,
+                                     size_t size,
+                                     uint8_t* frame);
+
 void uwb_initiate_measurement(uwb_protocol_handler_t* handler,
                               uint8_t* buffer,
                               uint16_t anchor_addr);
 
+/** Returns true while a ranging exchange we take part in is going on.
+ *
+ * This covers the time from the scheduling of one of our ranging frames until
+ * the answer to it is received. Other frames must not be sent meanwhile, as
+ * turning the transceiver off to send them would abort the exchange.
+ *
+ * @param [in] now Current value of the UWB module clock.
+ */
+bool uwb_ranging_in_progress(uwb_protocol_handler_t* handler, uint64_t now);
+
+/** @group Broadcast poll ranging
+ *
+ * @brief Ranges with several anchors at once.
+ *
+ * The tag broadcasts a poll listing the anchors it wants to range with. The
+ * anchor at index i in the list answers at poll RX time + UWB_DELAY + i *
+ * UWB_POLL_SLOT_DELAY. Once the last response is received, the tag broadcasts
+ * a single final frame carrying the RX timestamps of all responses. Each
+ * anchor then computes a double sided two way ranging solution, which it
+ * reports back to the tag in its response to the next poll.
+ *
+ * This gives N ranges in N + 2 frames, with a latency of one poll period.
+ * @{
+ */
+
+/** Prepares a broadcast poll frame.
+ *
+ * @returns Number of bytes in frame.
+ */
+size_t uwb_protocol_prepare_poll(uwb_protocol_handler_t* handler,
+                                 uint8_t round,
+                                 const uint16_t* anchors,
+                                 size_t anchor_count,
+                                 uint8_t* frame);
+
+/** Broadcasts a poll to the given anchors.
+ *
+ * @note At most UWB_POLL_MAX_ANCHORS anchors are polled, the other ones are
+ * ignored.
+ */
+void uwb_send_poll(uwb_protocol_handler_t* handler,
+                   const uint16_t* anchors,
+                   size_t anchor_count,
+                   uint8_t* buffer);
+
+/** Sends the final frame of the current poll with the responses received so
+ * far.
+ *
+ * This is done automatically when the response of the last anchor is
+ * received. It should be called after a timeout in case that response gets
+ * lost. Does nothing if the final frame was already sent.
+ */
+void uwb_send_poll_final(uwb_protocol_handler_t* handler, uint8_t* buffer);
+
+/** @} */
+
 /** @group UWB Board specific API
  *
  * @brief Those functions must be provided on a per-board basis to interface
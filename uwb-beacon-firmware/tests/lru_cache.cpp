@@ -1,6 +1,8 @@
 #include <CppUTest/TestHarness.h>
 #include <CppUTestExt/MockSupport.h>
 #include <cstring>
+#include <list>
+#include <algorithm>
 #include "lru_cache.h"
 
 TEST_GROUP (LeastRecentlyUsedCacheTestGroup) {
@@ -96,3 +98,109 @@ TEST(LeastRecentlyUsedCacheTestGroup, SimpleDemo)
     // Therefore we wont find anything in the cache
     POINTERS_EQUAL(NULL, cache_entry_get(&cache, 2));
 }
+
+TEST(LeastRecentlyUsedCacheTestGroup, UsedListIsDoublyLinked)
+{
+    auto a = cache_entry_allocate(&cache, 1);
+    auto b = cache_entry_allocate(&cache, 2);
+    auto c = cache_entry_allocate(&cache, 3);
+
+    POINTERS_EQUAL(c, cache.used_list);
+    POINTERS_EQUAL(a, cache.used_list_tail);
+    POINTERS_EQUAL(NULL, c->prev);
+    POINTERS_EQUAL(c, b->prev);
+    POINTERS_EQUAL(b, a->prev);
+
+    cache_entry_get(&cache, 1);
+    POINTERS_EQUAL(a, cache.used_list);
+    POINTERS_EQUAL(b, cache.used_list_tail);
+    POINTERS_EQUAL(NULL, b->next);
+}
+
+TEST(LeastRecentlyUsedCacheTestGroup, AllocatingAnExistingKeyReusesItsEntry)
+{
+    auto entry = cache_entry_allocate(&cache, 42);
+    cache_entry_allocate(&cache, 43);
+
+    POINTERS_EQUAL(entry, cache_entry_allocate(&cache, 42));
+    POINTERS_EQUAL(entry, cache.used_list);
+    POINTERS_EQUAL(&entries[2], cache.free_list);
+}
+
+TEST(LeastRecentlyUsedCacheTestGroup, CanRemoveEntries)
+{
+    cache_entry_allocate(&cache, 1);
+    auto entry = cache_entry_allocate(&cache, 2);
+    cache_entry_allocate(&cache, 3);
+
+    cache_entry_remove(&cache, 2);
+    POINTERS_EQUAL(NULL, cache_entry_get(&cache, 2));
+    CHECK_EQUAL(3, cache.used_list->key);
+    CHECK_EQUAL(1, cache.used_list->next->key);
+
+    // The entry is back in the free list and reused before evicting anything
+    POINTERS_EQUAL(entry, cache_entry_allocate(&cache, 4));
+    CHECK(cache_entry_get(&cache, 1) != NULL);
+
+    // Removing an unknown key does nothing
+    cache_entry_remove(&cache, 100);
+}
+
+TEST(LeastRecentlyUsedCacheTestGroup, KeysInTheSameBucket)
+{
+    // With more keys than buckets, some of them have to share a bucket
+    cache_entry_t many_entries[CACHE_HASH_BUCKETS + 1];
+    cache_init(&cache, many_entries, CACHE_HASH_BUCKETS + 1);
+
+    for (auto i = 0u; i <= CACHE_HASH_BUCKETS; i++) {
+        cache_entry_allocate(&cache, i * 1000)->payload = (void*)(uintptr_t)i;
+    }
+
+    for (auto i = 0u; i <= CACHE_HASH_BUCKETS; i++) {
+        auto entry = cache_entry_get(&cache, i * 1000);
+        CHECK(entry != NULL);
+        CHECK_EQUAL((void*)(uintptr_t)i, entry->payload);
+    }
+
+    cache_entry_remove(&cache, 5000);
+    POINTERS_EQUAL(NULL, cache_entry_get(&cache, 5000));
+    CHECK(cache_entry_get(&cache, 6000) != NULL);
+}
+
+TEST(LeastRecentlyUsedCacheTestGroup, BehavesLikeAReferenceLRU)
+{
+    // Neighbour table sized cache, compared against a naive implementation
+    const int size = 12;
+    cache_entry_t many_entries[size];
+    cache_init(&cache, many_entries, size);
+
+    std::list<uint32_t> reference;
+    uint32_t seed = 1;
+
+    for (auto i = 0; i < 5000; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t key = (seed >> 16) % 20;
+
+        auto it = std::find(reference.begin(), reference.end(), key);
+        auto entry = cache_entry_get(&cache, key);
+
+        if (it != reference.end()) {
+            CHECK(entry != NULL);
+            reference.erase(it);
+        } else {
+            POINTERS_EQUAL(NULL, entry);
+            if (reference.size() == size) {
+                reference.pop_back();
+            }
+            cache_entry_allocate(&cache, key);
+        }
+        reference.push_front(key);
+    }
+
+    auto entry = cache.used_list;
+    for (auto key : reference) {
+        CHECK_EQUAL(key, entry->key);
+        entry = entry->next;
+    }
+    POINTERS_EQUAL(NULL, entry);
+}
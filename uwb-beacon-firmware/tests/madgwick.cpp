@@ -42,3 +42,24 @@ TEST(MadgwickTestGroup, CanSetFrequency)
     madgwick_filter_set_sample_frequency(&f, 250.f);
     CHECK_EQUAL(250.f, f.sample_frequency);
 }
+
+TEST(MadgwickTestGroup, BatchUpdateIsTheSameAsSingleUpdates)
+{
+    madgwick_filter_t g;
+    madgwick_filter_init(&g);
+
+    madgwick_sample_t samples[5];
+    for (int i = 0; i < 5; i++) {
+        madgwick_sample_t s = {{0.1f * i, 0.2f, -0.1f}, {0.5f, 0, -9.81f}, {10, 10 + i, 0}};
+        samples[i] = s;
+        madgwick_filter_update(&f, s.gyro[0], s.gyro[1], s.gyro[2],
+                               s.acc[0], s.acc[1], s.acc[2],
+                               s.mag[0], s.mag[1], s.mag[2]);
+    }
+
+    madgwick_filter_update_batch(&g, samples, 5);
+
+    for (int i = 0; i < 4; i++) {
+        DOUBLES_EQUAL(f.q[i], g.q[i], 1e-7);
+    }
+}
@@ -0,0 +1,130 @@
+#include <CppUTest/TestHarness.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "MadgwickAHRS.h"
+#include "madgwick_fast.h"
+
+/* Synthetic IMU data for a slowly tumbling board, with a bit of noise. */
+static std::vector<madgwick_sample_t> tumbling_board(int count, bool with_mag)
+{
+    std::vector<madgwick_sample_t> samples(count);
+
+    for (int i = 0; i < count; i++) {
+        float t = i / 250.f;
+        madgwick_sample_t& s = samples[i];
+
+        s.gyro[0] = 0.5f * std::sin(t);
+        s.gyro[1] = 0.3f * std::cos(0.7f * t);
+        s.gyro[2] = 0.2f + 0.01f * std::sin(i * 1.3f);
+        s.acc[0] = 0.8f * std::sin(0.5f * t);
+        s.acc[1] = 0.4f * std::cos(t) + 0.05f * std::sin(i * 2.1f);
+        s.acc[2] = -9.7f;
+        s.mag[0] = with_mag ? 20.f * std::cos(0.2f * t) : 0.f;
+        s.mag[1] = with_mag ? 20.f * std::sin(0.2f * t) : 0.f;
+        s.mag[2] = with_mag ? -40.f : 0.f;
+    }
+
+    return samples;
+}
+
+TEST_GROUP (MadgwickFastTestGroup) {
+    madgwick_filter_t reference, fast;
+
+    void setup(void)
+    {
+        madgwick_filter_init(&reference);
+        madgwick_filter_init(&fast);
+    }
+
+    void check_same_output(const std::vector<madgwick_sample_t>& samples)
+    {
+        for (const auto& s : samples) {
+            madgwick_filter_update(&reference,
+                                   s.gyro[0], s.gyro[1], s.gyro[2],
+                                   s.acc[0], s.acc[1], s.acc[2],
+                                   s.mag[0], s.mag[1], s.mag[2]);
+            madgwick_fast_update(&fast, &s);
+
+            for (int i = 0; i < 4; i++) {
+                DOUBLES_EQUAL(reference.q[i], fast.q[i], 1e-4);
+            }
+        }
+    }
+};
+
+TEST(MadgwickFastTestGroup, SameAsReferenceWithMagnetometer)
+{
+    check_same_output(tumbling_board(2500, true));
+}
+
+TEST(MadgwickFastTestGroup, SameAsReferenceWithoutMagnetometer)
+{
+    check_same_output(tumbling_board(2500, false));
+}
+
+TEST(MadgwickFastTestGroup, SameAsReferenceWithHighGain)
+{
+    madgwick_filter_set_gain(&reference, 1.);
+    madgwick_filter_set_gain(&fast, 1.);
+    check_same_output(tumbling_board(500, true));
+}
+
+TEST(MadgwickFastTestGroup, InvalidAccelerometerOnlyIntegratesGyro)
+{
+    madgwick_sample_t s = {{0.1f, 0.2f, 0.3f}, {0, 0, 0}, {10, 10, 0}};
+
+    check_same_output(std::vector<madgwick_sample_t>(10, s));
+}
+
+TEST(MadgwickFastTestGroup, SameDataAsReferenceSmokeTest)
+{
+    // Same as MadgwickTestGroup.SimpleData
+    madgwick_sample_t s = {{0, 0, 0}, {0, 0, -9.81f}, {10, 10, 0}};
+    madgwick_filter_set_gain(&fast, 1.);
+
+    madgwick_fast_update_batch(&fast, std::vector<madgwick_sample_t>(10, s).data(), 10);
+
+    DOUBLES_EQUAL(0.999, fast.q[0], 0.001);
+    DOUBLES_EQUAL(0, fast.q[1], 0.001);
+    DOUBLES_EQUAL(0, fast.q[2], 0.001);
+    DOUBLES_EQUAL(-0.039, fast.q[3], 0.001);
+}
+
+TEST(MadgwickFastTestGroup, InverseSquareRoot)
+{
+    for (float x = 1e-3; x < 1e4; x *= 1.7) {
+        DOUBLES_EQUAL(1 / std::sqrt(x), madgwick_inv_sqrt(x), 5e-6 / std::sqrt(x));
+    }
+}
+
+/* Timing on the host, for comparison only. The numbers on the board are
+ * given by the "ahrs bench" shell command. */
+TEST(MadgwickFastTestGroup, Benchmark)
+{
+    auto samples = tumbling_board(25000, true);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& s : samples) {
+        madgwick_filter_update(&reference,
+                               s.gyro[0], s.gyro[1], s.gyro[2],
+                               s.acc[0], s.acc[1], s.acc[2],
+                               s.mag[0], s.mag[1], s.mag[2]);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    madgwick_fast_update_batch(&fast, samples.data(), samples.size());
+    auto end = std::chrono::steady_clock::now();
+
+    double reference_ns = std::chrono::duration<double, std::nano>(middle - start).count() / samples.size();
+    double fast_ns = std::chrono::duration<double, std::nano>(end - middle).count() / samples.size();
+
+    char report[128];
+    snprintf(report, sizeof(report), "reference: %.1f ns/update, fast: %.1f ns/update",
+             reference_ns, fast_ns);
+    UT_PRINT(report);
+
+    for (int i = 0; i < 4; i++) {
+        DOUBLES_EQUAL(reference.q[i], fast.q[i], 1e-4);
+    }
+}
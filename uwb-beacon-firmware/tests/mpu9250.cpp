@@ -141,6 +141,145 @@ TEST(MPU9250Protocol, ReadAccData)
     DOUBLES_EQUAL(z * gain, mes_z, 0.01);
 }
 
+TEST(MPU9250Protocol, BurstReadAllSensors)
+{
+    const float acc_gain = 9.81 / 8192;
+    const float gyro_gain = 1 / 65.5 * 3.14 / 180;
+    const float mag_gain = 4912. / 32760;
+
+    // INT_STATUS up to EXT_SENS_DATA_06
+    std::array<uint8_t, 22> regs{{
+        0x01, // interrupt status
+        0x03, 0xe8, 0x01, 0xf4, 0xff, 0x38, // accelerometer, 1000, 500, -200
+        0x03, 0xe8, // temperature, 1000
+        0xfc, 0x18, 0x00, 0x64, 0x00, 0x0a, // gyro, -1000, 100, 10
+        0x2c, 0x01, 0x9c, 0xff, 0x0a, 0x00, // magnetometer (little endian), 300, -100, 10
+        0x10, // magnetometer ST2, 16 bit output
+    }};
+    uint8_t reg = 0x3a | 0x80;
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", regs.size()).withOutputParameterReturning("buf", regs.data(), regs.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    mpu9250_data_t data;
+    mpu9250_burst_read(&dev, &data);
+
+    CHECK_EQUAL(0x01, data.interrupt_status);
+    DOUBLES_EQUAL(1000 * acc_gain, data.acc[0], 0.01);
+    DOUBLES_EQUAL(500 * acc_gain, data.acc[1], 0.01);
+    DOUBLES_EQUAL(-200 * acc_gain, data.acc[2], 0.01);
+    DOUBLES_EQUAL(1000 / 333.87 + 21, data.temperature, 0.01);
+    DOUBLES_EQUAL(-1000 * gyro_gain, data.gyro[0], 0.01);
+    DOUBLES_EQUAL(100 * gyro_gain, data.gyro[1], 0.01);
+    DOUBLES_EQUAL(10 * gyro_gain, data.gyro[2], 0.01);
+    DOUBLES_EQUAL(300 * mag_gain, data.mag[0], 0.01);
+    DOUBLES_EQUAL(-100 * mag_gain, data.mag[1], 0.01);
+    DOUBLES_EQUAL(10 * mag_gain, data.mag[2], 0.01);
+}
+
+TEST(MPU9250Protocol, EnableFIFO)
+{
+    expect_write(35, 0xf9); // temperature, gyro, accelerometer and magnetometer
+    expect_write(56, 0x00); // no data ready interrupt
+
+    // Reset the FIFO, keeping the I2C master enabled
+    expect_read(106, 0x70);
+    expect_write(106, 0x74);
+
+    mpu9250_fifo_enable(&dev);
+}
+
+TEST(MPU9250Protocol, ReadFIFO)
+{
+    const float acc_gain = 9.81 / 8192;
+    const float gyro_gain = 1 / 65.5 * 3.14 / 180;
+    const float mag_gain = 4912. / 32760;
+
+    std::array<uint8_t, 2> count{{0x00, 42}};
+    uint8_t count_reg = 0x72 | 0x80;
+    std::array<uint8_t, 42> fifo{{
+        0x03, 0xe8, 0x01, 0xf4, 0xff, 0x38, // accelerometer, 1000, 500, -200
+        0x03, 0xe8, // temperature, 1000
+        0xfc, 0x18, 0x00, 0x64, 0x00, 0x0a, // gyro, -1000, 100, 10
+        0x2c, 0x01, 0x9c, 0xff, 0x0a, 0x00, // magnetometer (little endian), 300, -100, 10
+        0x10, // magnetometer ST2
+        0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, // accelerometer, 10, 0, 0
+        0x00, 0x00, // temperature
+        0x00, 0x00, 0x00, 0x00, 0xff, 0xff, // gyro, 0, 0, -1
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // magnetometer
+        0x10, // magnetometer ST2
+    }};
+    uint8_t fifo_reg = 0x74 | 0x80;
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &count_reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", count.size()).withOutputParameterReturning("buf", count.data(), count.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &fifo_reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", fifo.size()).withOutputParameterReturning("buf", fifo.data(), fifo.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    mpu9250_data_t data[4];
+    CHECK_EQUAL(2, mpu9250_fifo_read(&dev, data, 4));
+
+    DOUBLES_EQUAL(1000 * acc_gain, data[0].acc[0], 0.01);
+    DOUBLES_EQUAL(500 * acc_gain, data[0].acc[1], 0.01);
+    DOUBLES_EQUAL(-200 * acc_gain, data[0].acc[2], 0.01);
+    DOUBLES_EQUAL(1000 / 333.87 + 21, data[0].temperature, 0.01);
+    DOUBLES_EQUAL(-1000 * gyro_gain, data[0].gyro[0], 0.01);
+    DOUBLES_EQUAL(100 * gyro_gain, data[0].gyro[1], 0.01);
+    DOUBLES_EQUAL(10 * gyro_gain, data[0].gyro[2], 0.01);
+    DOUBLES_EQUAL(300 * mag_gain, data[0].mag[0], 0.01);
+    DOUBLES_EQUAL(-100 * mag_gain, data[0].mag[1], 0.01);
+    DOUBLES_EQUAL(10 * mag_gain, data[0].mag[2], 0.01);
+
+    DOUBLES_EQUAL(10 * acc_gain, data[1].acc[0], 0.001);
+    DOUBLES_EQUAL(-1 * gyro_gain, data[1].gyro[2], 0.0001);
+}
+
+TEST(MPU9250Protocol, ReadFIFOIsLimitedToBufferSize)
+{
+    std::array<uint8_t, 2> count{{0x00, 63}};
+    uint8_t count_reg = 0x72 | 0x80;
+    std::array<uint8_t, 21> fifo{};
+    uint8_t fifo_reg = 0x74 | 0x80;
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &count_reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", count.size()).withOutputParameterReturning("buf", count.data(), count.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &fifo_reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", fifo.size()).withOutputParameterReturning("buf", fifo.data(), fifo.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    mpu9250_data_t data[1];
+    CHECK_EQUAL(1, mpu9250_fifo_read(&dev, data, 1));
+}
+
+TEST(MPU9250Protocol, FIFOOverflowResetsIt)
+{
+    // A full FIFO (512 bytes) is not a whole number of samples
+    std::array<uint8_t, 2> count{{0x02, 0x00}};
+    uint8_t count_reg = 0x72 | 0x80;
+
+    mock("spi").expectOneCall("select").withPointerParameter("drv", &drv);
+    mock("spi").expectOneCall("send").withPointerParameter("drv", &drv).withMemoryBufferParameter("buf", &count_reg, 1);
+    mock("spi").expectOneCall("receive").withPointerParameter("drv", &drv).withParameter("n", count.size()).withOutputParameterReturning("buf", count.data(), count.size());
+    mock("spi").expectOneCall("unselect").withPointerParameter("drv", &drv);
+
+    expect_read(106, 0x70);
+    expect_write(106, 0x74);
+
+    mpu9250_data_t data[4];
+    CHECK_EQUAL(0, mpu9250_fifo_read(&dev, data, 4));
+}
+
 TEST(MPU9250Protocol, ReadTemperatureData)
 {
     int16_t mes = 1000;
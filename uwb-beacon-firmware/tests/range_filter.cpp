@@ -0,0 +1,176 @@
+#include <CppUTest/TestHarness.h>
+#include <cmath>
+#include "range_filter.h"
+#include "state_estimation.hpp"
+
+TEST_GROUP (RangeFilterTestGroup) {
+    range_filter_t filter;
+
+    void setup(void)
+    {
+        range_filter_init(&filter);
+    }
+};
+
+TEST(RangeFilterTestGroup, AcceptsRangesInsideTheGate)
+{
+    // 2 standard deviations
+    auto res = range_filter_check(&filter, 42, 0.2, 0.01, 0.);
+
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, res);
+    CHECK_EQUAL(1, filter.accepted);
+}
+
+TEST(RangeFilterTestGroup, RejectsRangesOutsideTheGate)
+{
+    // 4 standard deviations
+    auto res = range_filter_check(&filter, 42, 0.4, 0.01, 0.);
+
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, res);
+    CHECK_EQUAL(1, filter.rejected_gate);
+    CHECK_EQUAL(1, range_filter_anchor_stats(&filter, 42)->rejected);
+}
+
+TEST(RangeFilterTestGroup, NegativeInnovationsAreGatedToo)
+{
+    auto res = range_filter_check(&filter, 42, -0.4, 0.01, 0.);
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, res);
+}
+
+TEST(RangeFilterTestGroup, NLOSCheckIsDisabledByDefault)
+{
+    auto res = range_filter_check(&filter, 42, 0., 0.01, 20.);
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, res);
+}
+
+TEST(RangeFilterTestGroup, RejectsWeakFirstPath)
+{
+    filter.nlos_threshold_db = 10.;
+
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, range_filter_check(&filter, 42, 0., 0.01, 5.));
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_NLOS, range_filter_check(&filter, 42, 0., 0.01, 12.));
+    CHECK_EQUAL(1, filter.rejected_nlos);
+}
+
+TEST(RangeFilterTestGroup, AnchorIsAcceptedAgainAfterTooManyRejections)
+{
+    filter.max_consecutive_rejections = 3;
+
+    for (int i = 0; i < 3; i++) {
+        CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, range_filter_check(&filter, 42, 1., 0.01, 0.));
+    }
+
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, range_filter_check(&filter, 42, 1., 0.01, 0.));
+    CHECK_EQUAL(0, range_filter_anchor_stats(&filter, 42)->consecutive_rejections);
+
+    // Other anchors are not affected
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, range_filter_check(&filter, 43, 1., 0.01, 0.));
+}
+
+TEST(RangeFilterTestGroup, RunningStatistics)
+{
+    for (int i = 0; i < 200; i++) {
+        range_filter_check(&filter, 42, (i % 2) ? 0.15 : 0.05, 0.01, 0.);
+    }
+
+    auto stats = range_filter_anchor_stats(&filter, 42);
+    CHECK_EQUAL(200, stats->count);
+    DOUBLES_EQUAL(0.1, stats->innovation_mean, 0.01);
+    DOUBLES_EQUAL(0.0025, stats->innovation_variance, 0.0005);
+}
+
+TEST(RangeFilterTestGroup, NoisyAnchorsGetAWiderGate)
+{
+    // The estimator expects 3 cm of noise, but this anchor has 30 cm. It
+    // only gets into the statistics after a series of rejections.
+    filter.max_consecutive_rejections = 3;
+    for (int i = 0; i < 400; i++) {
+        float innovation = 0.3 * std::sin(i * 1.3);
+        range_filter_check(&filter, 42, innovation, 0.001, 0.);
+    }
+
+    filter.max_consecutive_rejections = 1000;
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, range_filter_check(&filter, 42, 0.5, 0.001, 0.));
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, range_filter_check(&filter, 43, 0.5, 0.001, 0.));
+}
+
+TEST(RangeFilterTestGroup, UnknownAnchorHasNoStats)
+{
+    POINTERS_EQUAL(NULL, range_filter_anchor_stats(&filter, 42));
+}
+
+TEST(RangeFilterTestGroup, FullTableStillChecksRanges)
+{
+    for (int i = 0; i < RANGE_FILTER_MAX_ANCHORS; i++) {
+        range_filter_check(&filter, i, 0., 0.01, 0.);
+    }
+
+    CHECK_EQUAL(RANGE_FILTER_REJECTED_GATE, range_filter_check(&filter, 1000, 1., 0.01, 0.));
+    CHECK_EQUAL(RANGE_FILTER_ACCEPTED, range_filter_check(&filter, 1000, 0., 0.01, 0.));
+    POINTERS_EQUAL(NULL, range_filter_anchor_stats(&filter, 1000));
+}
+
+TEST(RangeFilterTestGroup, PowerRatio)
+{
+    // Example values from a line of sight measurement, about 3 dB
+    DOUBLES_EQUAL(3.2, range_filter_power_ratio(8000, 9000, 7500, 3200), 0.1);
+
+    // Halving the first path amplitudes costs 6 dB
+    DOUBLES_EQUAL(9.2, range_filter_power_ratio(4000, 4500, 3750, 3200), 0.1);
+
+    // Invalid diagnostics
+    DOUBLES_EQUAL(0., range_filter_power_ratio(0, 0, 0, 3200), 1e-6);
+}
+
+/* Tag at a fixed position, with 10% of the ranges delayed by a reflection. */
+TEST_GROUP (RangeFilterReplay) {
+    const float anchors[4][3] = {{0., 0., 0.5}, {3., 0., 1.5}, {3., 2., 0.5}, {0., 2., 1.5}};
+    const float tag[3] = {1.2, 0.7, 0.4};
+
+    float error(bool use_filter)
+    {
+        RadioPositionEstimator est;
+        range_filter_t filter;
+        range_filter_init(&filter);
+
+        est.measurementVariance = 9e-4;
+        est.processVariance = 4e-6;
+        est.setPosition(tag[0], tag[1], tag[2]);
+
+        for (int i = 0; i < 2000; i++) {
+            int a = i % 4;
+            float dx = tag[0] - anchors[a][0];
+            float dy = tag[1] - anchors[a][1];
+            float dz = tag[2] - anchors[a][2];
+            float range = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+            // Bounded noise and reflections
+            range += 0.02 * std::sin(i * 1.7);
+            if (i % 10 == 3) {
+                range += 0.8;
+            }
+
+            est.predict();
+
+            float variance;
+            float innovation = est.rangeInnovation(anchors[a], range, &variance);
+            if (use_filter && range_filter_check(&filter, a, innovation, variance, 0.) != RANGE_FILTER_ACCEPTED) {
+                continue;
+            }
+
+            est.processDistanceMeasurement(anchors[a], range);
+        }
+
+        float ex = est.state(0) - tag[0], ey = est.state(1) - tag[1];
+        return std::sqrt(ex * ex + ey * ey);
+    }
+};
+
+TEST(RangeFilterReplay, ReflectionsAreRemoved)
+{
+    auto unfiltered = error(false);
+    auto filtered = error(true);
+
+    CHECK(filtered < 0.02);
+    CHECK(unfiltered > 2 * filtered);
+}
@@ -2,6 +2,9 @@
 #include <CppUTest/TestHarness.h>
 #include <CppUTestExt/MockSupport.h>
 #include <utility>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 
 TEST_GROUP (StateEstimationTestGroup) {
 };
@@ -66,6 +69,236 @@ TEST(StateEstimationTestGroup, Converges)
     DOUBLES_EQUAL(1., z, 0.1);
 }
 
+TEST(StateEstimationTestGroup, BatchConverges)
+{
+    RadioPositionEstimator est;
+    const float anchors[4][3] = {{1., 2, 1}, {3., 2, 1}, {2., 1, 1}, {2., 3, 1}};
+    const float distances[4] = {1., 1., 1., 1.};
+
+    for (int i = 0; i < 100; i++) {
+        est.predict();
+        est.processDistanceMeasurements(anchors, distances, 4);
+    }
+
+    float x, y, z;
+    std::tie(x, y, z) = est.getPosition();
+    DOUBLES_EQUAL(2., x, 0.1);
+    DOUBLES_EQUAL(2., y, 0.1);
+    DOUBLES_EQUAL(1., z, 0.1);
+}
+
+TEST(StateEstimationTestGroup, ExtraRangesAreIgnored)
+{
+    RadioPositionEstimator est, reference;
+    float anchors[RadioPositionEstimator::MaxRanges + 1][3] = {};
+    float distances[RadioPositionEstimator::MaxRanges + 1] = {};
+
+    for (int i = 0; i < RadioPositionEstimator::MaxRanges; i++) {
+        anchors[i][0] = i;
+        distances[i] = 1.;
+    }
+    distances[RadioPositionEstimator::MaxRanges] = 1000.;
+
+    est.processDistanceMeasurements(anchors, distances, RadioPositionEstimator::MaxRanges + 1);
+    reference.processDistanceMeasurements(anchors, distances, RadioPositionEstimator::MaxRanges);
+
+    CHECK(est.state.isApprox(reference.state));
+}
+
+TEST(StateEstimationTestGroup, ConstantVelocityPrediction)
+{
+    RadioPositionEstimator est;
+    const float acc[3] = {0., 0., 0.};
+
+    est.setPosition(0, 0, 0);
+    est.state.tail<3>() << 1., 2., 0.;
+    est.predict(0.5, acc);
+
+    float x, y, z;
+    std::tie(x, y, z) = est.getPosition();
+    DOUBLES_EQUAL(0.5, x, 1e-6);
+    DOUBLES_EQUAL(1.0, y, 1e-6);
+    DOUBLES_EQUAL(0.0, z, 1e-6);
+
+    // Uncertainty on the velocity leaks into the position
+    CHECK(est.covariance(0, 0) > 1.25);
+}
+
+TEST(StateEstimationTestGroup, AccelerationIsIntegrated)
+{
+    RadioPositionEstimator est;
+    const float acc[3] = {2., 0., -1.};
+
+    est.setPosition(0, 0, 0);
+    est.predict(1., acc);
+
+    DOUBLES_EQUAL(1., est.state(0), 1e-6);
+    DOUBLES_EQUAL(-0.5, est.state(2), 1e-6);
+    DOUBLES_EQUAL(2., est.state(3), 1e-6);
+    DOUBLES_EQUAL(-1., est.state(5), 1e-6);
+}
+
+TEST(StateEstimationTestGroup, CovarianceStaysSymmetric)
+{
+    RadioPositionEstimator est;
+    const float anchors[3][3] = {{0., 0, 1}, {3., 0, 2}, {0., 2, 0.5}};
+    const float distances[3] = {1.2, 2.5, 1.7};
+    const float acc[3] = {0.1, 0.2, 0.};
+
+    for (int i = 0; i < 50; i++) {
+        est.predict(0.004, acc);
+        est.processDistanceMeasurements(anchors, distances, 3);
+    }
+
+    CHECK(est.covariance.isApprox(est.covariance.transpose(), 1e-4));
+}
+
+/* Replays ranges along a circular trajectory, using the noise recorded on a
+ * real anchor (doc/report/experiments/range_noise.csv, static tag, range
+ * minus mean, in mm). */
+TEST_GROUP (StateEstimationBenchmark) {
+    const float range_noise_mm[256] = {
+    3.1, -34.5, 17.3, -1.3, -6.1, -43.7, 22.2, 12.4, -15.4, 22.2,
+        26.6, -6.1, 59.8, 35.8, 22.2, -11.0, 3.1, -1.3, -1.3, 17.3,
+        12.4, 35.8, -24.7, 17.3, -6.1, 22.2, 3.1, 31.4, 31.4, 50.0,
+        -11.0, 12.4, -1.3, 3.1, -1.3, 31.4, 17.3, 8.0, 12.4, -15.4,
+        31.4, -6.1, -24.7, 26.6, -6.1, 17.3, -15.4, 12.4, -34.5, 35.8,
+        35.8, 22.2, -34.5, -6.1, 12.4, 31.4, -34.5, 22.2, 3.1, 22.2,
+        8.0, 12.4, 12.4, 17.3, 35.8, -11.0, 8.0, 26.6, -6.1, -11.0,
+        -20.3, 12.4, 3.1, 8.0, 8.0, 12.4, 17.3, 8.0, 12.4, 40.7,
+        17.3, 40.7, -6.1, 31.4, 3.1, 26.6, -15.4, 12.4, -20.3, 31.4,
+        -1.3, -1.3, 8.0, -6.1, -15.4, 12.4, -11.0, 12.4, -20.3, 17.3,
+        50.0, 3.1, 3.1, -11.0, -6.1, 17.3, 8.0, 3.1, -29.6, 12.4,
+        -20.3, 26.6, 8.0, 22.2, 3.1, 22.2, 35.8, -6.1, -11.0, -72.1,
+        -1.3, 8.0, -6.1, 3.1, -20.3, -6.1, -38.9, -11.0, 40.7, 17.3,
+        8.0, 17.3, 8.0, -1.3, -24.7, -6.1, -1.3, 35.8, -11.0, -15.4,
+        -24.7, -6.1, 8.0, 8.0, -34.5, -6.1, -1.3, -1.3, 12.4, 12.4,
+        26.6, 31.4, -20.3, -34.5, -20.3, 17.3, 17.3, 12.4, -1.3, -20.3,
+        8.0, -1.3, -11.0, 12.4, -20.3, 3.1, 31.4, 17.3, 35.8, 12.4,
+        3.1, -11.0, -1.3, -24.7, 35.8, 8.0, 3.1, 8.0, 31.4, -6.1,
+        -6.1, 3.1, 17.3, -43.7, -11.0, -20.3, -29.6, 3.1, 8.0, 26.6,
+        26.6, -1.3, 26.6, -1.3, 17.3, -15.4, -6.1, 3.1, -11.0, 3.1,
+        12.4, 3.1, 3.1, 26.6, 8.0, 22.2, -15.4, -6.1, 8.0, 35.8,
+        -6.1, -1.3, 12.4, 12.4, 40.7, 35.8, 22.2, -1.3, -11.0, 17.3,
+        17.3, 3.1, -1.3, 17.3, 12.4, 3.1, -1.3, 26.6, 22.2, -11.0,
+        3.1, 3.1, 17.3, 17.3, -24.7, 3.1, -1.3, -20.3, 17.3, 12.4,
+        -1.3, -38.9, 12.4, 8.0, 8.0, -6.1, 17.3, -1.3, 59.8, 3.1,
+        -38.9, -6.1, -6.1, -11.0, -20.3, -1.3,
+    };
+
+    const float anchors[4][3] = {{0., 0., 0.5}, {3., 0., 1.5}, {3., 2., 0.5}, {0., 2., 1.5}};
+
+    const float imu_rate = 250;
+    const int imu_ticks_per_round = 5; // ranging rounds at 50 Hz
+    const float duration = 20;
+
+    /* Deterministic IMU noise */
+    uint32_t random_state = 1;
+    float imu_noise(void)
+    {
+        random_state = random_state * 1103515245 + 12345;
+        return ((int)((random_state >> 8) % 2001) - 1000) * 1e-4f;
+    }
+
+    void truth(float t, float pos[3], float acc[3])
+    {
+        const float radius = 0.5, omega = 0.6;
+        pos[0] = 1.5 + radius * std::cos(omega * t);
+        pos[1] = 1.0 + radius * std::sin(omega * t);
+        pos[2] = 0.4;
+        acc[0] = -omega * omega * radius * std::cos(omega * t);
+        acc[1] = -omega * omega * radius * std::sin(omega * t);
+        acc[2] = 0;
+    }
+
+    struct Result {
+        float rms_error;
+        double update_us;
+    };
+
+    Result replay(RadioPositionEstimator & est, bool batch)
+    {
+        float pos[3], acc[3];
+        truth(0, pos, acc);
+        est.setPosition(pos[0], pos[1], pos[2]);
+
+        int noise_index = 0;
+        double squared_error = 0;
+        int error_count = 0;
+        double update_time = 0;
+        int update_count = 0;
+        const float dt = 1 / imu_rate;
+
+        for (int tick = 0; tick < duration * imu_rate; tick++) {
+            float t = tick * dt;
+            truth(t, pos, acc);
+
+            if (batch) {
+                float imu_acc[3] = {acc[0] + imu_noise(), acc[1] + imu_noise(), acc[2] + imu_noise()};
+                est.predict(dt, imu_acc);
+            } else {
+                est.predict();
+            }
+
+            if (tick % imu_ticks_per_round != 0) {
+                continue;
+            }
+
+            float distances[4];
+            for (int i = 0; i < 4; i++) {
+                float dx = pos[0] - anchors[i][0];
+                float dy = pos[1] - anchors[i][1];
+                float dz = pos[2] - anchors[i][2];
+                distances[i] = std::sqrt(dx * dx + dy * dy + dz * dz)
+                               + range_noise_mm[noise_index++ % 256] * 1e-3f;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            if (batch) {
+                est.processDistanceMeasurements(anchors, distances, 4);
+            } else {
+                for (int i = 0; i < 4; i++) {
+                    est.processDistanceMeasurement(anchors[i], distances[i]);
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            update_time += std::chrono::duration<double, std::micro>(end - start).count();
+            update_count++;
+
+            // Skip the convergence phase
+            if (t > 2) {
+                float ex = est.state(0) - pos[0], ey = est.state(1) - pos[1];
+                squared_error += ex * ex + ey * ey;
+                error_count++;
+            }
+        }
+
+        return {(float)std::sqrt(squared_error / error_count), update_time / update_count};
+    }
+};
+
+TEST(StateEstimationBenchmark, BatchUpdateWithIMUIsMoreAccurate)
+{
+    RadioPositionEstimator sequential, batch;
+
+    // Same settings as the firmware defaults
+    sequential.processVariance = batch.processVariance = 4e-6;
+    sequential.measurementVariance = batch.measurementVariance = 9e-4;
+
+    auto sequential_result = replay(sequential, false);
+    auto batch_result = replay(batch, true);
+
+    char report[128];
+    snprintf(report, sizeof(report),
+             "sequential: %.1f mm RMS, %.2f us/round; batch: %.1f mm RMS, %.2f us/round",
+             sequential_result.rms_error * 1e3, sequential_result.update_us,
+             batch_result.rms_error * 1e3, batch_result.update_us);
+    UT_PRINT(report);
+
+    CHECK(batch_result.rms_error < sequential_result.rms_error);
+    CHECK(batch_result.rms_error < 0.03);
+}
+
 TEST(StateEstimationTestGroup, SetVariance)
 {
     RadioPositionEstimator est;
@@ -0,0 +1,160 @@
+#include <CppUTest/TestHarness.h>
+#include "tdma_scheduler.h"
+
+TEST_GROUP (TDMASchedulerTestGroup) {
+    tdma_scheduler_t tdma;
+
+    void setup(void)
+    {
+        tdma_init(&tdma);
+
+        // 4 slots of 10 ms, we own the third one
+        tdma_configure(&tdma, 4, 10000, 2);
+    }
+};
+
+TEST(TDMASchedulerTestGroup, SingleSlotAlwaysAllowsExchanges)
+{
+    tdma_init(&tdma);
+
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 0, 5000));
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 99999, 5000));
+    CHECK_EQUAL(0, tdma_time_until_own_slot(&tdma, 1234));
+}
+
+TEST(TDMASchedulerTestGroup, SlotIsTakenModuloSlotCount)
+{
+    tdma_configure(&tdma, 4, 10000, 7);
+    CHECK_EQUAL(3, tdma.slot);
+
+    tdma_configure(&tdma, 0, 10000, 7);
+    CHECK_EQUAL(1, tdma.slot_count);
+    CHECK_EQUAL(0, tdma.slot);
+}
+
+TEST(TDMASchedulerTestGroup, CurrentSlot)
+{
+    CHECK_EQUAL(0, tdma_current_slot(&tdma, 0));
+    CHECK_EQUAL(0, tdma_current_slot(&tdma, 9999));
+    CHECK_EQUAL(1, tdma_current_slot(&tdma, 10000));
+    CHECK_EQUAL(3, tdma_current_slot(&tdma, 39999));
+    CHECK_EQUAL(0, tdma_current_slot(&tdma, 40000));
+}
+
+TEST(TDMASchedulerTestGroup, ExchangesOnlyStartInOwnSlot)
+{
+    CHECK_FALSE(tdma_can_start_exchange(&tdma, 19999, 5000));
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 20000, 5000));
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 25000, 5000));
+
+    // The exchange would overflow into the next slot
+    CHECK_FALSE(tdma_can_start_exchange(&tdma, 25001, 5000));
+    CHECK_FALSE(tdma_can_start_exchange(&tdma, 30000, 5000));
+
+    // Next superframe
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 60000, 5000));
+}
+
+TEST(TDMASchedulerTestGroup, TimeUntilOwnSlot)
+{
+    CHECK_EQUAL(20000, tdma_time_until_own_slot(&tdma, 0));
+    CHECK_EQUAL(0, tdma_time_until_own_slot(&tdma, 20000));
+    CHECK_EQUAL(35000, tdma_time_until_own_slot(&tdma, 25000));
+    CHECK_EQUAL(10000, tdma_time_until_own_slot(&tdma, 50000));
+}
+
+TEST(TDMASchedulerTestGroup, SynchronizationMovesTheSuperframe)
+{
+    tdma_synchronize(&tdma, 1000);
+
+    CHECK_FALSE(tdma_can_start_exchange(&tdma, 20000, 5000));
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 21000, 5000));
+    CHECK_EQUAL(1000, tdma_time_until_own_slot(&tdma, 20000));
+}
+
+TEST(TDMASchedulerTestGroup, WrapAround)
+{
+    // Our slot starts 20 ms after the superframe start, just before the
+    // clock wraps around
+    tdma_synchronize(&tdma, UINT32_MAX - 19999);
+
+    CHECK_TRUE(tdma_can_start_exchange(&tdma, 0, 5000));
+    CHECK_EQUAL(2, tdma_current_slot(&tdma, 0));
+}
+
+TEST(TDMASchedulerTestGroup, NoAnchorsKnown)
+{
+    uint16_t addr;
+    CHECK_FALSE(tdma_next_anchor(&tdma, &addr));
+}
+
+TEST(TDMASchedulerTestGroup, AnchorsAreRangedInRoundRobin)
+{
+    uint16_t addr;
+    tdma_anchor_seen(&tdma, 7, 0);
+    tdma_anchor_seen(&tdma, 10, 0);
+    tdma_anchor_seen(&tdma, 7, 10);
+
+    CHECK_EQUAL(2, tdma.anchor_count);
+
+    CHECK_TRUE(tdma_next_anchor(&tdma, &addr));
+    CHECK_EQUAL(7, addr);
+    CHECK_TRUE(tdma_next_anchor(&tdma, &addr));
+    CHECK_EQUAL(10, addr);
+    CHECK_TRUE(tdma_next_anchor(&tdma, &addr));
+    CHECK_EQUAL(7, addr);
+}
+
+TEST(TDMASchedulerTestGroup, AnchorList)
+{
+    uint16_t addrs[2];
+    tdma_anchor_seen(&tdma, 7, 0);
+    tdma_anchor_seen(&tdma, 10, 0);
+    tdma_anchor_seen(&tdma, 11, 0);
+
+    CHECK_EQUAL(2, tdma_anchor_list(&tdma, addrs, 2));
+    CHECK_EQUAL(7, addrs[0]);
+    CHECK_EQUAL(10, addrs[1]);
+}
+
+TEST(TDMASchedulerTestGroup, SilentAnchorsExpire)
+{
+    uint16_t addr;
+    tdma_anchor_seen(&tdma, 7, 0);
+    tdma_anchor_seen(&tdma, 10, 1000000);
+
+    tdma_expire_anchors(&tdma, TDMA_ANCHOR_TIMEOUT_US + 1);
+
+    CHECK_EQUAL(1, tdma.anchor_count);
+    CHECK_TRUE(tdma_next_anchor(&tdma, &addr));
+    CHECK_EQUAL(10, addr);
+}
+
+TEST(TDMASchedulerTestGroup, OldestAnchorIsReplacedWhenFull)
+{
+    for (auto i = 0; i < TDMA_MAX_ANCHORS; i++) {
+        tdma_anchor_seen(&tdma, i, 100 + i);
+    }
+
+    // Anchor 0 was refreshed, so anchor 1 is the oldest one
+    tdma_anchor_seen(&tdma, 0, 1000);
+    tdma_anchor_seen(&tdma, 42, 1001);
+
+    CHECK_EQUAL(TDMA_MAX_ANCHORS, tdma.anchor_count);
+    CHECK_EQUAL(42, tdma.anchors[1].addr);
+}
+
+TEST(TDMASchedulerTestGroup, UpdateRate)
+{
+    // 50 ranging results spread over the first window
+    for (auto i = 0; i < 50; i++) {
+        tdma_range_received(&tdma, i * 20000);
+    }
+
+    // The rate is only known once the window is complete
+    DOUBLES_EQUAL(0., tdma_update_rate(&tdma, 990000), 1e-3);
+    DOUBLES_EQUAL(50., tdma_update_rate(&tdma, 1000000), 1e-3);
+
+    // No results in the second window
+    DOUBLES_EQUAL(0., tdma_update_rate(&tdma, 2000000), 1e-3);
+}
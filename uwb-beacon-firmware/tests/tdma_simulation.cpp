@@ -0,0 +1,452 @@
+#include <CppUTest/TestHarness.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "uwb_protocol.h"
+#include "tdma_scheduler.h"
+#include "uwb_medium.hpp"
+
+/* Host simulation of several tags ranging with several anchors, all sharing
+ * the same radio channel. It runs the real protocol handlers and TDMA
+ * scheduler, and models frame collisions: a frame is lost if any other
+ * transmission overlaps it in time. */
+
+namespace {
+const double DW_TICKS_PER_US = 128 * 499.2;
+const double METERS_PER_DW_TICK = 299792458.0 / (128 * 499.2e6);
+
+/* Latency of the timers starting the exchanges of the tags. */
+const uint32_t TIMER_LATENCY_US = 200;
+
+/* Rough frame duration at 6.8 Mbps with a 128 symbols preamble. */
+uint64_t airtime_us(size_t frame_size)
+{
+    return 180 + frame_size;
+}
+
+struct Node {
+    uwb_protocol_handler_t handler;
+    tdma_scheduler_t tdma;
+    bool is_anchor;
+    float x, y;
+
+    /* Tags have a local clock with an unknown offset, only synchronized
+     * through the TDMA beacon. */
+    uint32_t clock_offset;
+    unsigned slot;
+    uint32_t exchange_period;
+    uint64_t next_event;
+    unsigned broadcast_count;
+
+    int ranges;
+    double max_range_error;
+};
+
+struct Transmission {
+    unsigned id;
+    size_t src;
+    uint64_t tx_ticks;
+    uint64_t start, end;
+    std::vector<uint8_t> frame;
+    bool cancelled;
+};
+
+class Simulation : public UWBMedium {
+public:
+    std::vector<Node> nodes;
+    std::vector<Transmission> transmissions;
+    uint64_t now = 0;
+    size_t current = 0;
+    unsigned transmission_count = 0;
+    int collisions = 0;
+
+    unsigned slot_count = 1;
+    uint32_t slot_duration = 100000;
+    bool send_beacons = false;
+    bool broadcast_poll = false;
+
+    uint32_t random_state = 42;
+
+    uint32_t random(uint32_t max)
+    {
+        random_state = random_state * 1103515245 + 12345;
+        return (random_state >> 8) % max;
+    }
+
+    void add_anchor(uint16_t addr, float x, float y)
+    {
+        Node n;
+        memset(&n, 0, sizeof(n));
+        uwb_protocol_handler_init(&n.handler);
+        n.handler.address = addr;
+        n.handler.is_anchor = true;
+        n.handler.anchor_position_received_cb = ignore_anchor_position;
+        n.is_anchor = true;
+        n.x = x;
+        n.y = y;
+        n.next_event = random(100000);
+        nodes.push_back(n);
+    }
+
+    void add_tag(uint16_t addr, float x, float y, unsigned slot, uint32_t exchange_period)
+    {
+        Node n;
+        memset(&n, 0, sizeof(n));
+        uwb_protocol_handler_init(&n.handler);
+        n.handler.address = addr;
+        n.handler.ranging_found_cb = ranging_found_cb;
+        n.handler.anchor_position_received_cb = anchor_position_received_cb;
+        n.handler.tdma_beacon_received_cb = tdma_beacon_received_cb;
+        n.x = x;
+        n.y = y;
+        n.slot = slot;
+        n.exchange_period = exchange_period;
+        n.clock_offset = random(1000000);
+        n.next_event = random(exchange_period);
+        tdma_init(&n.tdma);
+        tdma_configure(&n.tdma, slot_count, slot_duration, slot);
+        nodes.push_back(n);
+    }
+
+    uint32_t local_time(const Node& n)
+    {
+        return (uint32_t)now + n.clock_offset;
+    }
+
+    uint64_t timestamp_get() override
+    {
+        return (uint64_t)(now * DW_TICKS_PER_US) & ((1ULL << 40) - 1);
+    }
+
+    void transmit(uint64_t tx_timestamp, uint8_t* frame, size_t frame_size) override
+    {
+        Transmission t;
+        t.id = transmission_count++;
+        t.src = current;
+        t.cancelled = false;
+
+        if (tx_timestamp == UWB_TX_TIMESTAMP_IMMEDIATE) {
+            t.tx_ticks = timestamp_get();
+            t.start = now;
+        } else {
+            t.tx_ticks = tx_timestamp;
+            t.start = tx_timestamp / DW_TICKS_PER_US;
+        }
+
+        t.end = t.start + airtime_us(frame_size);
+        t.frame.assign(frame, frame + frame_size);
+
+        /* The transceiver has a single TX buffer, so a new frame replaces the
+         * one which was not sent yet. */
+        for (auto& other : transmissions) {
+            if (other.src == current && other.end > now) {
+                other.cancelled = true;
+            }
+        }
+
+        transmissions.push_back(t);
+    }
+
+    static void ignore_anchor_position(uint16_t, float, float, float)
+    {
+    }
+
+    static void ranging_found_cb(uint16_t anchor_addr, uint64_t time);
+    static void anchor_position_received_cb(uint16_t anchor_addr, float x, float y, float z);
+    static void tdma_beacon_received_cb(uint16_t anchor_addr, uint8_t slot_count, uint32_t slot_duration_us);
+
+    bool collides(const Transmission& t)
+    {
+        for (const auto& other : transmissions) {
+            if (other.id == t.id || other.cancelled) {
+                continue;
+            }
+            if (other.start < t.end && t.start < other.end) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void deliver(const Transmission& t)
+    {
+        if (collides(t)) {
+            collisions++;
+            return;
+        }
+
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (i == t.src) {
+                continue;
+            }
+
+            auto& src = nodes[t.src];
+            auto& dst = nodes[i];
+            double distance = std::hypot(src.x - dst.x, src.y - dst.y);
+            uint64_t rx_ts = t.tx_ticks + (uint64_t)std::round(distance / METERS_PER_DW_TICK);
+
+            std::vector<uint8_t> frame(t.frame);
+            frame.resize(1024);
+            current = i;
+            uwb_process_incoming_frame(&dst.handler, frame.data(), t.frame.size(), rx_ts);
+        }
+    }
+
+    void run_node(size_t i)
+    {
+        auto& n = nodes[i];
+        current = i;
+        uint8_t frame[1024];
+
+        if (n.is_anchor) {
+            /* The first anchor is the TDMA coordinator, it sends its beacon
+             * between two position broadcasts. */
+            if (send_beacons && i == 0 && n.broadcast_count % 2) {
+                uwb_send_tdma_beacon(&n.handler, slot_count, slot_duration, frame);
+                n.next_event = now + 100000;
+            } else {
+                uwb_send_anchor_position(&n.handler, n.x, n.y, 0, frame);
+                n.next_event = now + (send_beacons && i == 0 ? 100000 : 200000);
+            }
+            n.broadcast_count++;
+            return;
+        }
+
+        /* Same logic as the ranging thread. */
+        uint16_t anchor;
+        uint32_t exchange_duration = UWB_TWR_EXCHANGE_DURATION_US + TDMA_GUARD_TIME_US;
+        if (broadcast_poll) {
+            exchange_duration = UWB_POLL_EXCHANGE_DURATION_US(n.tdma.anchor_count) + TDMA_GUARD_TIME_US;
+        }
+
+        tdma_expire_anchors(&n.tdma, local_time(n));
+        if (!tdma_can_start_exchange(&n.tdma, local_time(n), exchange_duration)) {
+            /* Not our turn */
+        } else if (broadcast_poll) {
+            uint16_t anchors[UWB_POLL_MAX_ANCHORS];
+            unsigned anchor_count = tdma_anchor_list(&n.tdma, anchors, UWB_POLL_MAX_ANCHORS);
+            if (anchor_count > 0) {
+                uwb_send_poll(&n.handler, anchors, anchor_count, frame);
+            }
+        } else if (tdma_next_anchor(&n.tdma, &anchor)) {
+            uwb_initiate_measurement(&n.handler, frame, anchor);
+        }
+
+        uint32_t delay = n.exchange_period;
+        uint32_t next = local_time(n) + delay;
+        if (!tdma_can_start_exchange(&n.tdma, next, exchange_duration)) {
+            delay += tdma_time_until_own_slot(&n.tdma, next);
+        }
+
+        /* Timers never fire exactly on time. */
+        n.next_event = now + delay + random(TIMER_LATENCY_US);
+    }
+
+    void run(uint64_t duration)
+    {
+        while (now < duration) {
+            /* Find the next thing to happen, either a node timer or the end of a
+             * transmission. */
+            uint64_t next = UINT64_MAX;
+            size_t next_node = nodes.size();
+            for (size_t i = 0; i < nodes.size(); i++) {
+                if (nodes[i].next_event < next) {
+                    next = nodes[i].next_event;
+                    next_node = i;
+                }
+            }
+
+            Transmission* next_tx = nullptr;
+            for (auto& t : transmissions) {
+                if (!t.cancelled && t.end > now && t.end <= next) {
+                    if (next_tx == nullptr || t.end < next_tx->end) {
+                        next_tx = &t;
+                    }
+                }
+            }
+
+            if (next_tx) {
+                now = next_tx->end;
+                Transmission t = *next_tx;
+                deliver(t);
+            } else {
+                now = next;
+                run_node(next_node);
+            }
+
+            /* Forget about old transmissions, they cannot collide anymore. */
+            auto it = transmissions.begin();
+            while (it != transmissions.end()) {
+                if (it->end + 10000 < now) {
+                    it = transmissions.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    double total_update_rate()
+    {
+        double sum = 0;
+        for (auto& n : nodes) {
+            if (!n.is_anchor) {
+                sum += tdma_update_rate(&n.tdma, local_time(n));
+            }
+        }
+        return sum;
+    }
+};
+
+Simulation* sim;
+
+void Simulation::ranging_found_cb(uint16_t anchor_addr, uint64_t time)
+{
+    auto& tag = sim->nodes[sim->current];
+    for (auto& anchor : sim->nodes) {
+        if (anchor.is_anchor && anchor.handler.address == anchor_addr) {
+            double distance = std::hypot(anchor.x - tag.x, anchor.y - tag.y);
+            double error = std::fabs(time * METERS_PER_DW_TICK - distance);
+            tag.max_range_error = std::fmax(tag.max_range_error, error);
+        }
+    }
+    tag.ranges++;
+    tdma_range_received(&tag.tdma, sim->local_time(tag));
+}
+
+void Simulation::anchor_position_received_cb(uint16_t anchor_addr, float x, float y, float z)
+{
+    (void)x;
+    (void)y;
+    (void)z;
+    auto& tag = sim->nodes[sim->current];
+    tdma_anchor_seen(&tag.tdma, anchor_addr, sim->local_time(tag));
+}
+
+void Simulation::tdma_beacon_received_cb(uint16_t anchor_addr, uint8_t slot_count, uint32_t slot_duration_us)
+{
+    (void)anchor_addr;
+    auto& tag = sim->nodes[sim->current];
+    tdma_configure(&tag.tdma, slot_count, slot_duration_us, tag.slot);
+    tdma_synchronize(&tag.tdma, sim->local_time(tag));
+}
+} // namespace
+
+TEST_GROUP (TDMASimulation) {
+    Simulation simulation;
+    const int tag_count = 4;
+    const int anchor_count = 4;
+
+    void setup(void)
+    {
+        sim = &simulation;
+        uwb_medium = &simulation;
+    }
+
+    void teardown(void)
+    {
+        uwb_medium = nullptr;
+        sim = nullptr;
+    }
+
+    void add_nodes(uint32_t exchange_period)
+    {
+        const float anchors[][2] = {{0, 0}, {3, 0}, {3, 2}, {0, 2}};
+        for (auto i = 0; i < anchor_count; i++) {
+            simulation.add_anchor(10 + i, anchors[i][0], anchors[i][1]);
+        }
+        for (auto i = 0; i < tag_count; i++) {
+            simulation.add_tag(100 + i, 0.5 + 0.6 * i, 1.0, i, exchange_period);
+        }
+    }
+};
+
+TEST(TDMASimulation, TDMAScheduleGivesEveryTagItsShare)
+{
+    // 4 slots of 10 ms, and two exchanges per slot: the second one must start
+    // early enough to end before the slot does
+    simulation.slot_count = tag_count;
+    simulation.slot_duration = 10000;
+    simulation.send_beacons = true;
+    add_nodes(4000);
+
+    simulation.run(3000000);
+
+    for (auto& n : simulation.nodes) {
+        if (n.is_anchor) {
+            continue;
+        }
+
+        // Two exchanges every 40 ms superframe, minus the few ones lost to
+        // anchor position broadcasts
+        auto rate = tdma_update_rate(&n.tdma, simulation.local_time(n));
+        CHECK(rate > 40);
+        CHECK(rate < 51);
+        CHECK(n.max_range_error < 0.01);
+    }
+}
+
+TEST(TDMASimulation, ExchangePeriodCanBeAsLongAsASlot)
+{
+    // One exchange per slot, started a bit late by the timers
+    simulation.slot_count = tag_count;
+    simulation.slot_duration = 10000;
+    simulation.send_beacons = true;
+    add_nodes(10000);
+
+    simulation.run(3000000);
+
+    for (auto& n : simulation.nodes) {
+        if (n.is_anchor) {
+            continue;
+        }
+
+        // One exchange every 40 ms superframe
+        auto rate = tdma_update_rate(&n.tdma, simulation.local_time(n));
+        CHECK(rate > 20);
+        CHECK(rate < 26);
+    }
+}
+
+TEST(TDMASimulation, UncoordinatedTagsCollide)
+{
+    // Same offered load as the TDMA case, but without time division
+    add_nodes(20000);
+    simulation.run(3000000);
+
+    double worst_rate = 1000;
+    for (auto& n : simulation.nodes) {
+        if (!n.is_anchor) {
+            worst_rate = std::fmin(worst_rate, tdma_update_rate(&n.tdma, simulation.local_time(n)));
+        }
+    }
+
+    // Exchanges overlap, and the unlucky tags barely get any range
+    CHECK(simulation.collisions > 0);
+    CHECK(worst_rate < 25);
+    CHECK(simulation.total_update_rate() < 0.8 * 50 * tag_count);
+}
+
+TEST(TDMASimulation, BroadcastPollRangesAllAnchorsInOneExchange)
+{
+    // A poll with 4 anchors lasts longer than a single exchange, slots are
+    // made a bit longer to still fit two of them
+    simulation.slot_count = tag_count;
+    simulation.slot_duration = 12000;
+    simulation.send_beacons = true;
+    simulation.broadcast_poll = true;
+    add_nodes(5200);
+
+    simulation.run(3000000);
+
+    for (auto& n : simulation.nodes) {
+        if (n.is_anchor) {
+            continue;
+        }
+
+        // Each exchange now gives a range to every anchor, instead of one
+        auto rate = tdma_update_rate(&n.tdma, simulation.local_time(n));
+        CHECK(rate > 3 * 40);
+        CHECK(n.max_range_error < 0.01);
+    }
+}
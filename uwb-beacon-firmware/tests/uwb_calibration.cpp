@@ -0,0 +1,101 @@
+#include <CppUTest/TestHarness.h>
+#include <cmath>
+#include "uwb_calibration.h"
+
+TEST_GROUP (UWBCalibrationTestGroup) {
+    uwb_calibration_t cal;
+    const float position[3] = {1., 1., 0.};
+
+    void setup(void)
+    {
+        uwb_calibration_init(&cal);
+    }
+};
+
+TEST(UWBCalibrationTestGroup, UnknownAnchorIsNotCorrected)
+{
+    DOUBLES_EQUAL(0., uwb_calibration_offset(&cal, 42), 1e-6);
+    DOUBLES_EQUAL(3.2, uwb_calibration_correct_range(&cal, 42, 3.2), 1e-6);
+}
+
+TEST(UWBCalibrationTestGroup, OffsetIsRemovedFromRanges)
+{
+    uwb_calibration_set_offset(&cal, 42, 0.25);
+    uwb_calibration_set_offset(&cal, 43, -0.1);
+
+    DOUBLES_EQUAL(2.95, uwb_calibration_correct_range(&cal, 42, 3.2), 1e-6);
+    DOUBLES_EQUAL(3.3, uwb_calibration_correct_range(&cal, 43, 3.2), 1e-6);
+
+    // Setting it again overwrites it
+    uwb_calibration_set_offset(&cal, 42, 0.5);
+    DOUBLES_EQUAL(0.5, uwb_calibration_offset(&cal, 42), 1e-6);
+    CHECK_EQUAL(2, cal.anchor_count);
+}
+
+TEST(UWBCalibrationTestGroup, RangesAreIgnoredOutsideCalibration)
+{
+    uwb_calibration_anchor_position(&cal, 42, 4., 5., 0.);
+    CHECK_FALSE(uwb_calibration_add_range(&cal, 42, 5.));
+    CHECK_EQUAL(0, cal.anchors[0].sample_count);
+}
+
+TEST(UWBCalibrationTestGroup, AnchorsWithoutPositionAreIgnored)
+{
+    uwb_calibration_start(&cal, position, 1);
+    CHECK_FALSE(uwb_calibration_add_range(&cal, 42, 5.));
+}
+
+TEST(UWBCalibrationTestGroup, EstimatesTheOffsetOfEachAnchor)
+{
+    // Both anchors are 5 meters away
+    uwb_calibration_anchor_position(&cal, 42, 4., 5., 0.);
+    uwb_calibration_anchor_position(&cal, 43, -2., -3., 0.);
+    uwb_calibration_start(&cal, position, 10);
+
+    bool done = false;
+    for (int i = 0; i < 10; i++) {
+        // Symmetric noise around the bias
+        float noise = (i % 2) ? 0.02 : -0.02;
+        CHECK_FALSE(done);
+        done = uwb_calibration_add_range(&cal, 42, 5.3 + noise);
+        if (!done) {
+            done = uwb_calibration_add_range(&cal, 43, 4.9 + noise);
+        }
+    }
+    done = done || uwb_calibration_add_range(&cal, 43, 4.9);
+
+    CHECK_TRUE(done);
+    CHECK_FALSE(cal.calibrating);
+    DOUBLES_EQUAL(0.3, uwb_calibration_offset(&cal, 42), 1e-3);
+    DOUBLES_EQUAL(-0.1, uwb_calibration_offset(&cal, 43), 1e-2);
+}
+
+TEST(UWBCalibrationTestGroup, CalibrationWaitsForAllAnchors)
+{
+    uwb_calibration_anchor_position(&cal, 42, 4., 5., 0.);
+    uwb_calibration_anchor_position(&cal, 43, -2., -3., 0.);
+    uwb_calibration_start(&cal, position, 2);
+
+    for (int i = 0; i < 10; i++) {
+        CHECK_FALSE(uwb_calibration_add_range(&cal, 42, 5.3));
+    }
+
+    // The offsets are only updated at the end
+    DOUBLES_EQUAL(0., uwb_calibration_offset(&cal, 42), 1e-6);
+
+    CHECK_FALSE(uwb_calibration_add_range(&cal, 43, 5.));
+    CHECK_TRUE(uwb_calibration_add_range(&cal, 43, 5.));
+    DOUBLES_EQUAL(0.3, uwb_calibration_offset(&cal, 42), 1e-5);
+}
+
+TEST(UWBCalibrationTestGroup, RestartingDiscardsPreviousSamples)
+{
+    uwb_calibration_anchor_position(&cal, 42, 4., 5., 0.);
+    uwb_calibration_start(&cal, position, 2);
+    uwb_calibration_add_range(&cal, 42, 10.);
+
+    uwb_calibration_start(&cal, position, 2);
+    CHECK_FALSE(uwb_calibration_add_range(&cal, 42, 5.2));
+    CHECK_TRUE(uwb_calibration_add_range(&cal, 42, 5.2));
+    DOUBLES_EQUAL(0.2, uwb_calibration_offset(&cal, 42), 1e-5);
+}
@@ -0,0 +1,379 @@
+#include <CppUTest/TestHarness.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "uwb_fragmentation.h"
+#include "uwb_protocol.h"
+
+static std::vector<uint8_t> make_packet(size_t size, int seed = 0)
+{
+    std::vector<uint8_t> packet(size);
+    for (size_t i = 0; i < size; i++) {
+        packet[i] = (i * 7 + seed) & 0xff;
+    }
+    return packet;
+}
+
+TEST_GROUP (UWBFragmentTx) {
+    uwb_fragment_tx_t tx;
+    uint8_t payload[UWB_FRAGMENT_MAX_SIZE];
+    uint16_t dst;
+
+    void setup()
+    {
+        uwb_fragment_tx_init(&tx);
+    }
+
+    void ack(uint8_t packet_id, uint16_t mask, uint16_t src = 42)
+    {
+        uint8_t ack[] = {packet_id, (uint8_t)(mask & 0xff), (uint8_t)(mask >> 8)};
+        uwb_fragment_tx_ack(&tx, src, ack, sizeof(ack));
+    }
+};
+
+TEST(UWBFragmentTx, SmallPacketIsASingleFragment)
+{
+    auto packet = make_packet(10);
+    CHECK_TRUE(uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size()));
+
+    CHECK_EQUAL(UWB_FRAGMENT_HEADER_SIZE + 10, uwb_fragment_tx_next(&tx, 0, payload, &dst));
+    CHECK_EQUAL(42, dst);
+    CHECK_EQUAL(0, payload[1]); // index
+    CHECK_EQUAL(1, payload[2]); // count
+    CHECK_EQUAL(1, payload[3]); // ack requested
+    MEMCMP_EQUAL(packet.data(), &payload[UWB_FRAGMENT_HEADER_SIZE], 10);
+
+    // Waiting for the acknowledgement
+    CHECK_EQUAL(0, uwb_fragment_tx_next(&tx, 100, payload, &dst));
+    CHECK_TRUE(uwb_fragment_tx_busy(&tx));
+
+    ack(payload[0], 0x1);
+    CHECK_FALSE(uwb_fragment_tx_busy(&tx));
+    CHECK_EQUAL(1, tx.packets_sent);
+}
+
+TEST(UWBFragmentTx, RefusesNewPacketWhileBusy)
+{
+    auto packet = make_packet(10);
+    CHECK_TRUE(uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size()));
+    CHECK_FALSE(uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size()));
+}
+
+TEST(UWBFragmentTx, RefusesTooLargePacket)
+{
+    auto packet = make_packet(UWB_FRAGMENT_MAX_PACKET_SIZE + 1);
+    CHECK_FALSE(uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size()));
+}
+
+TEST(UWBFragmentTx, SendsAWindowOfFragments)
+{
+    auto packet = make_packet(1000);
+    uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size());
+
+    for (int i = 0; i < UWB_FRAGMENT_WINDOW; i++) {
+        CHECK_EQUAL(UWB_FRAGMENT_MAX_SIZE, uwb_fragment_tx_next(&tx, 0, payload, &dst));
+        CHECK_EQUAL(i, payload[1]);
+        CHECK_EQUAL(10, payload[2]);
+        CHECK_EQUAL(i == UWB_FRAGMENT_WINDOW - 1 ? 1 : 0, payload[3]);
+    }
+
+    CHECK_EQUAL(0, uwb_fragment_tx_next(&tx, 0, payload, &dst));
+}
+
+TEST(UWBFragmentTx, SelectiveAckOnlyResendsMissingFragments)
+{
+    auto packet = make_packet(1000);
+    uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size());
+
+    for (int i = 0; i < UWB_FRAGMENT_WINDOW; i++) {
+        uwb_fragment_tx_next(&tx, 0, payload, &dst);
+    }
+
+    // Fragment 1 was lost
+    ack(payload[0], 0b1101);
+
+    uwb_fragment_tx_next(&tx, 0, payload, &dst);
+    CHECK_EQUAL(1, payload[1]);
+    uwb_fragment_tx_next(&tx, 0, payload, &dst);
+    CHECK_EQUAL(4, payload[1]);
+    CHECK_EQUAL(1, tx.retransmissions);
+}
+
+TEST(UWBFragmentTx, IgnoresAckForOtherPackets)
+{
+    auto packet = make_packet(10);
+    uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size());
+    uwb_fragment_tx_next(&tx, 0, payload, &dst);
+
+    ack(payload[0] + 1, 0x1);
+    ack(payload[0], 0x1, 43);
+
+    CHECK_TRUE(uwb_fragment_tx_busy(&tx));
+}
+
+TEST(UWBFragmentTx, ResendsAfterTimeout)
+{
+    auto packet = make_packet(150);
+    uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size());
+    uwb_fragment_tx_next(&tx, 0, payload, &dst);
+    uwb_fragment_tx_next(&tx, 0, payload, &dst);
+
+    CHECK_EQUAL(0, uwb_fragment_tx_next(&tx, UWB_FRAGMENT_ACK_TIMEOUT_US - 1, payload, &dst));
+
+    CHECK_EQUAL(UWB_FRAGMENT_MAX_SIZE, uwb_fragment_tx_next(&tx, UWB_FRAGMENT_ACK_TIMEOUT_US, payload, &dst));
+    CHECK_EQUAL(0, payload[1]);
+    CHECK_EQUAL(UWB_FRAGMENT_HEADER_SIZE + 50, uwb_fragment_tx_next(&tx, UWB_FRAGMENT_ACK_TIMEOUT_US, payload, &dst));
+    CHECK_EQUAL(1, payload[1]);
+    CHECK_EQUAL(1, payload[3]);
+}
+
+TEST(UWBFragmentTx, DropsPacketAfterTooManyRetries)
+{
+    auto packet = make_packet(10);
+    uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size());
+
+    uint32_t now = 0;
+    for (int i = 0; i <= UWB_FRAGMENT_MAX_RETRIES; i++) {
+        CHECK_TRUE(uwb_fragment_tx_next(&tx, now, payload, &dst) > 0);
+        now += UWB_FRAGMENT_ACK_TIMEOUT_US;
+    }
+
+    CHECK_EQUAL(0, uwb_fragment_tx_next(&tx, now, payload, &dst));
+    CHECK_FALSE(uwb_fragment_tx_busy(&tx));
+    CHECK_EQUAL(1, tx.packets_dropped);
+}
+
+TEST(UWBFragmentTx, BroadcastIsNotAcknowledged)
+{
+    auto packet = make_packet(250);
+    uwb_fragment_tx_start(&tx, MAC_802_15_4_BROADCAST_ADDR, packet.data(), packet.size());
+
+    for (int i = 0; i < 3; i++) {
+        CHECK_TRUE(uwb_fragment_tx_next(&tx, 0, payload, &dst) > 0);
+        CHECK_EQUAL(0, payload[3]);
+    }
+
+    CHECK_FALSE(uwb_fragment_tx_busy(&tx));
+    CHECK_EQUAL(0, uwb_fragment_tx_next(&tx, 0, payload, &dst));
+}
+
+TEST_GROUP (UWBFragmentRx) {
+    uwb_fragment_rx_t rx;
+    uwb_fragment_rx_result_t result;
+
+    void setup()
+    {
+        uwb_fragment_rx_init(&rx);
+    }
+
+    void receive(uint16_t src, uint8_t id, uint8_t index, uint8_t count, size_t len, bool ack, uint32_t now = 0)
+    {
+        uint8_t payload[UWB_FRAGMENT_MAX_SIZE] = {id, index, count, (uint8_t)(ack ? 1 : 0)};
+        for (size_t i = 0; i < len; i++) {
+            payload[UWB_FRAGMENT_HEADER_SIZE + i] = index;
+        }
+        uwb_fragment_rx_process(&rx, src, 1, payload, UWB_FRAGMENT_HEADER_SIZE + len, now, &result);
+    }
+};
+
+TEST(UWBFragmentRx, ReassemblesOutOfOrderFragments)
+{
+    receive(42, 7, 2, 3, 10, false);
+    POINTERS_EQUAL(NULL, result.packet);
+    receive(42, 7, 0, 3, UWB_FRAGMENT_DATA_SIZE, false);
+    receive(42, 7, 1, 3, UWB_FRAGMENT_DATA_SIZE, true);
+
+    CHECK(result.packet != NULL);
+    CHECK_EQUAL(2 * UWB_FRAGMENT_DATA_SIZE + 10, result.packet_size);
+    CHECK_EQUAL(0, result.packet[0]);
+    CHECK_EQUAL(1, result.packet[UWB_FRAGMENT_DATA_SIZE]);
+    CHECK_EQUAL(2, result.packet[2 * UWB_FRAGMENT_DATA_SIZE]);
+
+    CHECK_TRUE(result.ack_needed);
+    CHECK_EQUAL(7, result.ack[0]);
+    CHECK_EQUAL(0b111, result.ack[1]);
+}
+
+TEST(UWBFragmentRx, AcksOnlyWhenRequested)
+{
+    receive(42, 7, 0, 3, UWB_FRAGMENT_DATA_SIZE, false);
+    CHECK_FALSE(result.ack_needed);
+
+    receive(42, 7, 2, 3, 10, true);
+    CHECK_TRUE(result.ack_needed);
+    CHECK_EQUAL(0b101, result.ack[1]);
+}
+
+TEST(UWBFragmentRx, DuplicatesAreAckedButNotDelivered)
+{
+    receive(42, 7, 0, 1, 10, true);
+    CHECK(result.packet != NULL);
+
+    receive(42, 7, 0, 1, 10, true);
+    POINTERS_EQUAL(NULL, result.packet);
+    CHECK_TRUE(result.ack_needed);
+    CHECK_EQUAL(0b1, result.ack[1]);
+}
+
+TEST(UWBFragmentRx, NewPacketRestartsReassembly)
+{
+    receive(42, 7, 0, 2, UWB_FRAGMENT_DATA_SIZE, false);
+    receive(42, 8, 1, 2, 10, true);
+
+    CHECK_EQUAL(0b10, result.ack[1]);
+}
+
+TEST(UWBFragmentRx, IncompletePacketsExpire)
+{
+    receive(42, 7, 0, 2, UWB_FRAGMENT_DATA_SIZE, false, 0);
+    receive(42, 7, 1, 2, 10, true, UWB_FRAGMENT_RX_TIMEOUT_US + 1);
+
+    POINTERS_EQUAL(NULL, result.packet);
+    CHECK_EQUAL(0b10, result.ack[1]);
+}
+
+TEST(UWBFragmentRx, SeveralSourcesAtOnce)
+{
+    receive(42, 7, 0, 2, UWB_FRAGMENT_DATA_SIZE, false);
+    receive(43, 3, 0, 2, UWB_FRAGMENT_DATA_SIZE, false);
+    receive(42, 7, 1, 2, 10, false);
+    CHECK(result.packet != NULL);
+    receive(43, 3, 1, 2, 10, false);
+    CHECK(result.packet != NULL);
+}
+
+TEST(UWBFragmentRx, RejectsInvalidFragments)
+{
+    receive(42, 7, 2, 2, 10, true); // index out of range
+    CHECK_FALSE(result.ack_needed);
+
+    receive(42, 7, 0, 2, 10, true); // short fragment which is not the last
+    CHECK_FALSE(result.ack_needed);
+
+    receive(42, 7, 0, UWB_FRAGMENT_MAX_COUNT + 1, UWB_FRAGMENT_DATA_SIZE, true);
+    CHECK_FALSE(result.ack_needed);
+
+    receive(42, 7, 0, 1, 0, true); // empty
+    CHECK_FALSE(result.ack_needed);
+}
+
+TEST(UWBFragmentRx, RejectsFragmentsPastTheLargestPacket)
+{
+    const uint8_t last = UWB_FRAGMENT_MAX_COUNT - 1;
+    const size_t room = UWB_FRAGMENT_MAX_PACKET_SIZE - last * UWB_FRAGMENT_DATA_SIZE;
+
+    receive(42, 7, last, UWB_FRAGMENT_MAX_COUNT, room + 1, true);
+    CHECK_FALSE(result.ack_needed);
+
+    receive(42, 7, last, UWB_FRAGMENT_MAX_COUNT, room, true);
+    CHECK_TRUE(result.ack_needed);
+}
+
+TEST(UWBFragmentRx, BroadcastIsNeverAcked)
+{
+    uint8_t payload[] = {7, 0, 1, 1, 0xaa};
+    uwb_fragment_rx_process(&rx, 42, MAC_802_15_4_BROADCAST_ADDR, payload, sizeof(payload), 0, &result);
+
+    CHECK_FALSE(result.ack_needed);
+    CHECK(result.packet != NULL);
+    CHECK_EQUAL(MAC_802_15_4_BROADCAST_ADDR, result.dst_addr);
+}
+
+/* Transfers packets over a link losing frames in both directions. */
+TEST_GROUP (UWBFragmentLink) {
+    uwb_fragment_tx_t tx;
+    uwb_fragment_rx_t rx;
+    uint32_t rng = 1;
+
+    void setup()
+    {
+        uwb_fragment_tx_init(&tx);
+        uwb_fragment_rx_init(&rx);
+    }
+
+    bool lost(int loss_percent)
+    {
+        rng = rng * 1103515245 + 12345;
+        return (int)((rng >> 16) % 100) < loss_percent;
+    }
+
+    /* Returns the number of frames sent, or -1 if the packet did not get
+     * through. */
+    int transfer(const std::vector<uint8_t>& packet, int loss_percent, uint32_t& now)
+    {
+        uint8_t payload[UWB_FRAGMENT_MAX_SIZE];
+        uwb_fragment_rx_result_t result;
+        uint16_t dst;
+        bool delivered = false;
+        int frames = 0;
+
+        CHECK_TRUE(uwb_fragment_tx_start(&tx, 42, packet.data(), packet.size()));
+
+        while (uwb_fragment_tx_busy(&tx)) {
+            size_t size = uwb_fragment_tx_next(&tx, now, payload, &dst);
+            if (size == 0) {
+                now += 500;
+                continue;
+            }
+
+            /* 100 bytes at 6.8 Mbps, plus preamble. */
+            now += 250;
+            frames++;
+
+            if (lost(loss_percent)) {
+                continue;
+            }
+
+            uwb_fragment_rx_process(&rx, 1, dst, payload, size, now, &result);
+            if (result.packet) {
+                CHECK_FALSE(delivered);
+                CHECK_EQUAL(packet.size(), result.packet_size);
+                MEMCMP_EQUAL(packet.data(), result.packet, packet.size());
+                delivered = true;
+            }
+
+            if (result.ack_needed) {
+                now += 150;
+                frames++;
+                if (!lost(loss_percent)) {
+                    uwb_fragment_tx_ack(&tx, 42, result.ack, sizeof(result.ack));
+                }
+            }
+        }
+
+        return delivered ? frames : -1;
+    }
+};
+
+TEST(UWBFragmentLink, PerfectLink)
+{
+    uint32_t now = 0;
+    auto packet = make_packet(1000);
+
+    // 10 fragments and 3 acknowledgements
+    CHECK_EQUAL(13, transfer(packet, 0, now));
+    CHECK_EQUAL(0, tx.retransmissions);
+}
+
+TEST(UWBFragmentLink, LossyLink)
+{
+    uint32_t now = 0;
+    int frames = 0;
+    const int packet_count = 100;
+
+    for (int i = 0; i < packet_count; i++) {
+        auto packet = make_packet(1 + (i * 97) % UWB_FRAGMENT_MAX_PACKET_SIZE, i);
+        int n = transfer(packet, 10, now);
+        CHECK(n > 0);
+        frames += n;
+    }
+
+    char report[128];
+    snprintf(report, sizeof(report), "10%% loss: %d frames, %u retransmissions, %.1f kB/s",
+             frames, (unsigned)tx.retransmissions,
+             packet_count * (UWB_FRAGMENT_MAX_PACKET_SIZE / 2) / (now * 1e-6) / 1e3);
+    UT_PRINT(report);
+
+    CHECK_EQUAL(packet_count, tx.packets_sent);
+    CHECK_EQUAL(0, tx.packets_dropped);
+}
@@ -0,0 +1,17 @@
+#ifndef UWB_MEDIUM_HPP
+#define UWB_MEDIUM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+/** Replaces the UWB board API mocks when set, allowing several protocol
+ * handlers to talk to each other in simulation. */
+class UWBMedium {
+public:
+    virtual uint64_t timestamp_get() = 0;
+    virtual void transmit(uint64_t tx_timestamp, uint8_t* frame, size_t frame_size) = 0;
+};
+
+extern UWBMedium* uwb_medium;
+
+#endif
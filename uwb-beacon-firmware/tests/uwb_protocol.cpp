@@ -1,7 +1,9 @@
 #include <CppUTest/TestHarness.h>
 #include <CppUTestExt/MockSupport.h>
 #include <cstring>
+#include <vector>
 #include "uwb_protocol.h"
+#include "uwb_medium.hpp"
 
 #define UWB_TX_DELAY 1000
 
@@ -136,13 +138,22 @@ TEST(RangingProtocol, Helpers)
     LONGS_EQUAL(0xfdecacafe, res);
 }
 
+UWBMedium* uwb_medium = nullptr;
+
 extern "C" uint64_t uwb_timestamp_get(void)
 {
+    if (uwb_medium) {
+        return uwb_medium->timestamp_get();
+    }
     return mock().actualCall("uwb_timestamp_get").returnIntValue();
 }
 
 extern "C" void uwb_transmit_frame(uint64_t tx_timestamp, uint8_t* frame, size_t frame_size)
 {
+    if (uwb_medium) {
+        uwb_medium->transmit(tx_timestamp, frame, frame_size);
+        return;
+    }
     mock().actualCall("uwb_transmit_frame").withUnsignedLongIntParameter("timestamp", tx_timestamp).withMemoryBufferParameter("frame", frame, frame_size);
 }
 
@@ -304,6 +315,38 @@ TEST(RangingProtocol, RangingSolutionIsComputedFinally)
     uwb_process_incoming_frame(&handler, final_frame, final_size, final_rx_ts);
 }
 
+TEST(RangingProtocol, ClockOffsetIsCorrected)
+{
+    // The anchor clock runs 20 ppm faster than ours, and the two reply delays
+    // are very different, so the drift has to be corrected
+    const double offset = 20e-6;
+    const uint64_t tof = 1000;
+    const uint64_t advertisement_tx_ts = 0;
+    const uint64_t advertisement_rx_ts = 5000;
+    const uint64_t reply_tx_ts = advertisement_rx_ts + 10000000;
+    const uint64_t reply_rx_ts = advertisement_tx_ts + (uint64_t)((2 * tof + 10000000) / (1 - offset));
+    const uint64_t final_tx_ts = reply_rx_ts + 60000000;
+    const uint64_t final_rx_ts = reply_tx_ts + 2 * tof + (uint64_t)(60000000 * (1 - offset));
+
+    write_40bit_uint(advertisement_tx_ts, &final_frame[0]);
+    write_40bit_uint(advertisement_rx_ts, &final_frame[5]);
+    write_40bit_uint(reply_tx_ts, &final_frame[10]);
+    write_40bit_uint(reply_rx_ts, &final_frame[15]);
+    write_40bit_uint(final_tx_ts, &final_frame[20]);
+    size_t final_size = uwb_mac_encapsulate_frame(tx_handler.pan_id,
+                                                  tx_handler.address,
+                                                  handler.address,
+                                                  2, // sequence number
+                                                  final_frame,
+                                                  25);
+
+    handler.ranging_found_cb = ranging_cb;
+    handler.rx_clock_offset = offset;
+    handler.rx_clock_offset_valid = true;
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", tx_handler.address).withIntParameter("time", tof);
+    uwb_process_incoming_frame(&handler, final_frame, final_size, final_rx_ts);
+}
+
 TEST(RangingProtocol, BadPANIDs)
 {
     // Change the PAN IDs so that they don't match anymore
@@ -349,6 +392,31 @@ TEST(RangingProtocol, DoNotReplyToadvertisementWhenWeAreAnAnchor)
     uwb_process_incoming_frame(&handler, advertisement_frame, rx_size, ts);
 }
 
+TEST(RangingProtocol, InitiateMeasurementIsAnsweredOnlyToTheInitiator)
+{
+    uint8_t frame[64];
+    uint64_t ts = 1600;
+
+    // The tag (handler) asks the anchor (tx_handler) to start a measurement
+    auto size = uwb_mac_encapsulate_frame(handler.pan_id, handler.address, tx_handler.address, 5, frame, 0);
+
+    // The advertisement is addressed to the tag, so that other tags stay quiet
+    uint64_t tx_ts = (ts + (UWB_TX_DELAY * 65536ULL)) & ~(0x1FFULL);
+    write_40bit_uint(tx_ts, advertisement_frame);
+    auto adv_size = uwb_mac_encapsulate_frame(tx_handler.pan_id,
+                                              tx_handler.address,
+                                              handler.address,
+                                              0, // sequence number
+                                              advertisement_frame,
+                                              5);
+
+    tx_handler.is_anchor = true;
+    mock().expectOneCall("uwb_timestamp_get").andReturnValue((int)ts);
+    mock().expectOneCall("uwb_transmit_frame").withMemoryBufferParameter("frame", advertisement_frame, adv_size).withUnsignedLongIntParameter("timestamp", tx_ts);
+    uwb_process_incoming_frame(&tx_handler, frame, size, ts);
+    mock().checkExpectations();
+}
+
 // TODO: If we are an anchor we should not answer to advertisement
 #define UINT40_MAX ((1UL << 40) - 1)
 TEST(RangingProtocol, Overflow)
@@ -469,6 +537,64 @@ TEST(AnchorPositionBroadcast, ReceiveAnchorPosition)
     uwb_process_incoming_frame(&handler, frame, size, 0);
 }
 
+TEST_GROUP (TDMABeacon) {
+    uwb_protocol_handler_t handler;
+    uint8_t frame[128];
+    uint16_t src, dst, pan_id;
+    uint8_t seq;
+    size_t size;
+
+    void setup(void)
+    {
+        uwb_protocol_handler_init(&handler);
+        handler.address = 1234;
+        handler.pan_id = 4321;
+        memset(frame, 0, sizeof(frame));
+    }
+};
+
+TEST(TDMABeacon, BeaconIsBroadcastWithTheSuperframeLayout)
+{
+    size = uwb_protocol_prepare_tdma_beacon(&handler, 8, 0x12345678, frame);
+    size = uwb_mac_decapsulate_frame(&pan_id, &src, &dst, &seq, frame, size);
+
+    CHECK_EQUAL(5, size);
+    CHECK_EQUAL(6, seq);
+    CHECK_EQUAL(0xffff, dst);
+    CHECK_EQUAL(1234, src);
+
+    // Slot count, followed by the slot duration in little endian
+    BYTES_EQUAL(8, frame[0]);
+    BYTES_EQUAL(0x78, frame[1]);
+    BYTES_EQUAL(0x56, frame[2]);
+    BYTES_EQUAL(0x34, frame[3]);
+    BYTES_EQUAL(0x12, frame[4]);
+}
+
+TEST(TDMABeacon, SendBeacon)
+{
+    size = uwb_protocol_prepare_tdma_beacon(&handler, 8, 10000, frame);
+    mock().expectOneCall("uwb_transmit_frame").withMemoryBufferParameter("frame", frame, size).withUnsignedLongIntParameter("timestamp", UWB_TX_TIMESTAMP_IMMEDIATE);
+
+    uint8_t buffer[64];
+    uwb_send_tdma_beacon(&handler, 8, 10000, buffer);
+}
+
+static void tdma_beacon_received_cb(uint16_t anchor_addr, uint8_t slot_count, uint32_t slot_duration_us)
+{
+    mock().actualCall("tdma_beacon_cb").withIntParameter("anchor_addr", anchor_addr).withIntParameter("slot_count", slot_count).withUnsignedIntParameter("slot_duration", slot_duration_us);
+}
+
+TEST(TDMABeacon, ReceiveBeacon)
+{
+    size = uwb_protocol_prepare_tdma_beacon(&handler, 8, 100000, frame);
+
+    mock().expectOneCall("tdma_beacon_cb").withIntParameter("anchor_addr", handler.address).withIntParameter("slot_count", 8).withUnsignedIntParameter("slot_duration", 100000u);
+    handler.tdma_beacon_received_cb = tdma_beacon_received_cb;
+
+    uwb_process_incoming_frame(&handler, frame, size, 1);
+}
+
 TEST_GROUP (TagPositionBroadcast) {
     uwb_protocol_handler_t handler;
     uint8_t frame[128];
@@ -587,3 +713,377 @@ TEST(DataPacket, CanReceiveDataPacket)
     mock().expectOneCall("data_rx").withMemoryBufferParameter("data", msg_buf, 6).withIntParameter("src", handler.address).withIntParameter("dst", MAC_802_15_4_BROADCAST_ADDR);
     uwb_process_incoming_frame(&handler, frame, size, 1);
 }
+
+static void data_fragment_received_cb(const uint8_t* data, size_t size, uint16_t src, uint16_t dst)
+{
+    mock().actualCall("fragment_rx").withMemoryBufferParameter("data", data, size).withIntParameter("src", src).withIntParameter("dst", dst);
+}
+
+static void data_ack_received_cb(const uint8_t* data, size_t size, uint16_t src)
+{
+    mock().actualCall("ack_rx").withMemoryBufferParameter("data", data, size).withIntParameter("src", src);
+}
+
+TEST(DataPacket, CanReceiveDataFragment)
+{
+    const uint8_t payload[] = {1, 0, 1, 1, 0xaa, 0xbb};
+    size = uwb_protocol_prepare_data_fragment(&handler, 1234, payload, sizeof(payload), frame);
+
+    handler.data_fragment_received_cb = data_fragment_received_cb;
+    handler.user_data_received_cb = user_data_packet_received_cb;
+
+    mock().expectOneCall("fragment_rx").withMemoryBufferParameter("data", payload, sizeof(payload)).withIntParameter("src", 1234).withIntParameter("dst", 1234);
+    uwb_process_incoming_frame(&handler, frame, size, 1);
+}
+
+TEST(DataPacket, CanReceiveDataAck)
+{
+    const uint8_t payload[] = {1, 0xff, 0x03};
+    size = uwb_protocol_prepare_data_ack(&handler, 1234, payload, sizeof(payload), frame);
+
+    handler.data_ack_received_cb = data_ack_received_cb;
+    handler.data_fragment_received_cb = data_fragment_received_cb;
+
+    mock().expectOneCall("ack_rx").withMemoryBufferParameter("data", payload, sizeof(payload)).withIntParameter("src", 1234);
+    uwb_process_incoming_frame(&handler, frame, size, 1);
+}
+
+TEST(DataPacket, FragmentsAreIgnoredWithoutCallback)
+{
+    const uint8_t payload[] = {1, 0, 1, 1, 0xaa};
+    size = uwb_protocol_prepare_data_fragment(&handler, 1234, payload, sizeof(payload), frame);
+    uwb_process_incoming_frame(&handler, frame, size, 1);
+}
+
+TEST_GROUP (BroadcastPoll) {
+    struct CapturedFrame {
+        uint64_t timestamp;
+        std::vector<uint8_t> data;
+    };
+
+    /* Captures the frames sent by the protocol handlers instead of mocking
+     * them, so that a complete exchange can be replayed. */
+    struct CaptureMedium : public UWBMedium {
+        uint64_t now = 0;
+        std::vector<CapturedFrame> frames;
+
+        uint64_t timestamp_get() override
+        {
+            return now;
+        }
+
+        void transmit(uint64_t ts, uint8_t* frame, size_t size) override
+        {
+            frames.push_back({ts, std::vector<uint8_t>(frame, frame + size)});
+        }
+    };
+
+    CaptureMedium medium;
+    uwb_protocol_handler_t tag;
+    uwb_protocol_handler_t anchors[2];
+    uint16_t anchor_addrs[2] = {10, 11};
+    uint8_t frame[128];
+
+    /* Clock offset of each anchor relative to the tag, and the propagation
+     * time between them, in DW1000 ticks. */
+    uint64_t clock_offset[2] = {123456789, 987654321};
+    uint64_t propagation[2] = {1000, 2000};
+
+    void setup(void)
+    {
+        uwb_protocol_handler_init(&tag);
+        tag.pan_id = 0xaabb;
+        tag.address = 100;
+        for (auto i = 0; i < 2; i++) {
+            uwb_protocol_handler_init(&anchors[i]);
+            anchors[i].pan_id = tag.pan_id;
+            anchors[i].address = anchor_addrs[i];
+            anchors[i].is_anchor = true;
+        }
+        medium.now = 1600;
+        uwb_medium = &medium;
+    }
+
+    void teardown(void)
+    {
+        uwb_medium = nullptr;
+    }
+
+    uint64_t wrap(uint64_t ts)
+    {
+        return ts & ((1ULL << 40) - 1);
+    }
+
+    uint64_t read_40bit_uint(uint8_t * bytes)
+    {
+        uint64_t res = 0;
+        for (int i = 0; i < 5; i++) {
+            res = (res << 8) | bytes[i];
+        }
+        return res;
+    }
+
+    void deliver(const CapturedFrame& f, uwb_protocol_handler_t* dst, uint64_t rx_ts)
+    {
+        uint8_t rx_frame[128];
+        memcpy(rx_frame, f.data.data(), f.data.size());
+        medium.now = rx_ts;
+        uwb_process_incoming_frame(dst, rx_frame, f.data.size(), rx_ts);
+    }
+
+    /* Runs a complete poll, responses, final exchange with both anchors. */
+    void run_exchange(void)
+    {
+        uwb_send_poll(&tag, anchor_addrs, 2, frame);
+        auto poll = medium.frames.back();
+
+        CapturedFrame responses[2];
+        for (auto i = 0; i < 2; i++) {
+            deliver(poll, &anchors[i], wrap(poll.timestamp + clock_offset[i] + propagation[i]));
+            responses[i] = medium.frames.back();
+        }
+
+        for (auto i = 0; i < 2; i++) {
+            deliver(responses[i], &tag, wrap(responses[i].timestamp - clock_offset[i] + propagation[i]));
+        }
+
+        auto final = medium.frames.back();
+        for (auto i = 0; i < 2; i++) {
+            deliver(final, &anchors[i], wrap(final.timestamp + clock_offset[i] + propagation[i]));
+        }
+    }
+};
+
+TEST(BroadcastPoll, PollFrameListsAnchors)
+{
+    uint16_t src, dst, pan_id;
+    uint8_t seq;
+
+    auto size = uwb_protocol_prepare_poll(&tag, 42, anchor_addrs, 2, frame);
+    size = uwb_mac_decapsulate_frame(&pan_id, &src, &dst, &seq, frame, size);
+
+    CHECK_EQUAL(6, size);
+    CHECK_EQUAL(7, seq);
+    CHECK_EQUAL(MAC_802_15_4_BROADCAST_ADDR, dst);
+    CHECK_EQUAL(tag.address, src);
+
+    // Round number, anchor count, then the anchor addresses
+    BYTES_EQUAL(42, frame[0]);
+    BYTES_EQUAL(2, frame[1]);
+    BYTES_EQUAL(10, frame[2]);
+    BYTES_EQUAL(0, frame[3]);
+    BYTES_EQUAL(11, frame[4]);
+    BYTES_EQUAL(0, frame[5]);
+}
+
+TEST(BroadcastPoll, PollIsSentWithADelay)
+{
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+
+    CHECK_EQUAL(1, medium.frames.size());
+    CHECK_EQUAL((1600 + UWB_TX_DELAY * 65536ULL) & ~0x1FFULL, medium.frames[0].timestamp);
+    CHECK_TRUE(tag.poll.pending);
+}
+
+TEST(BroadcastPoll, AnchorsAnswerInTheirSlot)
+{
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    auto poll = medium.frames.back();
+    const uint64_t rx_ts = 1000000;
+
+    for (auto i = 0; i < 2; i++) {
+        deliver(poll, &anchors[i], rx_ts);
+
+        auto response = medium.frames.back();
+        uint64_t expected_ts = rx_ts + UWB_TX_DELAY * 65536ULL + i * 500 * 65536ULL;
+        CHECK_EQUAL(expected_ts & ~0x1FFULL, response.timestamp);
+    }
+
+    CHECK_EQUAL(3, medium.frames.size());
+}
+
+TEST(BroadcastPoll, ResponseContent)
+{
+    uint16_t src, dst, pan_id;
+    uint8_t seq;
+    const uint64_t rx_ts = 1000000;
+
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    deliver(medium.frames.back(), &anchors[0], rx_ts);
+
+    auto response = medium.frames.back();
+    memcpy(frame, response.data.data(), response.data.size());
+    auto size = uwb_mac_decapsulate_frame(&pan_id, &src, &dst, &seq, frame, response.data.size());
+
+    CHECK_EQUAL(15, size);
+    CHECK_EQUAL(8, seq);
+    CHECK_EQUAL(tag.address, dst);
+    CHECK_EQUAL(anchor_addrs[0], src);
+
+    // Round, poll RX & response TX timestamps, followed by an empty report
+    BYTES_EQUAL(tag.poll.round, frame[0]);
+    LONGS_EQUAL(rx_ts, read_40bit_uint(&frame[1]));
+    LONGS_EQUAL(response.timestamp, read_40bit_uint(&frame[6]));
+    for (auto i = 11; i < 15; i++) {
+        BYTES_EQUAL(0xff, frame[i]);
+    }
+}
+
+TEST(BroadcastPoll, AnchorsWhichAreNotPolledStayQuiet)
+{
+    uwb_send_poll(&tag, anchor_addrs, 1, frame);
+    deliver(medium.frames.back(), &anchors[1], 1000000);
+
+    CHECK_EQUAL(1, medium.frames.size());
+}
+
+TEST(BroadcastPoll, TagsDoNotAnswerPolls)
+{
+    uwb_protocol_handler_t other_tag;
+    uwb_protocol_handler_init(&other_tag);
+    other_tag.pan_id = tag.pan_id;
+    other_tag.address = anchor_addrs[0];
+
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    deliver(medium.frames.back(), &other_tag, 1000000);
+
+    CHECK_EQUAL(1, medium.frames.size());
+}
+
+TEST(BroadcastPoll, ExchangeTakesTwoFramesMoreThanAnchors)
+{
+    run_exchange();
+
+    // Poll, two responses and the final frame
+    CHECK_EQUAL(4, medium.frames.size());
+    CHECK_FALSE(tag.poll.pending);
+}
+
+TEST(BroadcastPoll, FinalIsSentAfterTheLastResponse)
+{
+    run_exchange();
+
+    auto response = medium.frames[2];
+    auto final = medium.frames[3];
+    uint64_t response_rx = wrap(response.timestamp - clock_offset[1] + propagation[1]);
+
+    CHECK_EQUAL((response_rx + UWB_TX_DELAY * 65536ULL) & ~0x1FFULL, final.timestamp);
+}
+
+static void poll_ranging_cb(uint16_t anchor_addr, uint64_t propagation_time)
+{
+    mock().actualCall("ranging_cb").withIntParameter("anchor", anchor_addr).withIntParameter("time", propagation_time);
+}
+
+TEST(BroadcastPoll, RangesAreReportedInTheNextResponses)
+{
+    tag.ranging_found_cb = poll_ranging_cb;
+
+    // The first exchange does not produce any range at the tag
+    run_exchange();
+    mock().checkExpectations();
+
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", 10).withIntParameter("time", 1000);
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", 11).withIntParameter("time", 2000);
+    run_exchange();
+}
+
+TEST(BroadcastPoll, RangesAreCorrectAcrossClockWrapAround)
+{
+    tag.ranging_found_cb = poll_ranging_cb;
+
+    // The anchors clocks wrap around during the exchange
+    clock_offset[0] = (1ULL << 40) - 3000000;
+    clock_offset[1] = (1ULL << 40) - 70000000;
+
+    run_exchange();
+
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", 10).withIntParameter("time", 1000);
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", 11).withIntParameter("time", 2000);
+    run_exchange();
+}
+
+TEST(BroadcastPoll, ReportIsOnlySentOnce)
+{
+    tag.ranging_found_cb = poll_ranging_cb;
+    run_exchange();
+
+    // Second poll gets the report, but the tag does not send its final
+    mock().expectOneCall("ranging_cb").withIntParameter("anchor", 10).withIntParameter("time", 1000);
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    auto poll = medium.frames.back();
+    deliver(poll, &anchors[0], wrap(poll.timestamp + clock_offset[0] + propagation[0]));
+    deliver(medium.frames.back(), &tag, 5000000000);
+    mock().checkExpectations();
+
+    // Third poll does not carry any report anymore
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    poll = medium.frames.back();
+    deliver(poll, &anchors[0], wrap(poll.timestamp + clock_offset[0] + propagation[0]));
+    deliver(medium.frames.back(), &tag, 6000000000);
+}
+
+TEST(BroadcastPoll, FinalCanBeForcedWhenAResponseIsLost)
+{
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    auto poll = medium.frames.back();
+
+    // Only the first anchor answers
+    deliver(poll, &anchors[0], wrap(poll.timestamp + clock_offset[0] + propagation[0]));
+    auto response = medium.frames.back();
+    deliver(response, &tag, wrap(response.timestamp - clock_offset[0] + propagation[0]));
+    CHECK_TRUE(tag.poll.pending);
+
+    uwb_send_poll_final(&tag, frame);
+    CHECK_FALSE(tag.poll.pending);
+    CHECK_EQUAL(3, medium.frames.size());
+
+    // The final frame only lists the anchor which answered
+    auto final = medium.frames.back();
+    memcpy(frame, final.data.data(), final.data.size());
+    uint16_t src, dst, pan_id;
+    uint8_t seq;
+    auto size = uwb_mac_decapsulate_frame(&pan_id, &src, &dst, &seq, frame, final.data.size());
+    CHECK_EQUAL(9, seq);
+    CHECK_EQUAL(12 + 7, size);
+    BYTES_EQUAL(1, frame[11]);
+    BYTES_EQUAL(10, frame[12]);
+
+    // Calling it again does not send anything
+    uwb_send_poll_final(&tag, frame);
+    CHECK_EQUAL(3, medium.frames.size());
+}
+
+TEST(BroadcastPoll, ExchangeIsInProgressUntilTheFinalIsReceived)
+{
+    CHECK_FALSE(uwb_ranging_in_progress(&tag, medium.now));
+
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    auto poll = medium.frames.back();
+    CHECK_TRUE(uwb_ranging_in_progress(&tag, medium.now));
+
+    deliver(poll, &anchors[0], wrap(poll.timestamp + clock_offset[0] + propagation[0]));
+    CHECK_TRUE(uwb_ranging_in_progress(&anchors[0], medium.now));
+
+    run_exchange();
+    for (auto i = 0; i < 2; i++) {
+        CHECK_FALSE(uwb_ranging_in_progress(&anchors[i], medium.now));
+    }
+
+    // The tag waits until its final frame is out
+    auto final = medium.frames.back();
+    CHECK_TRUE(uwb_ranging_in_progress(&tag, final.timestamp));
+    CHECK_FALSE(uwb_ranging_in_progress(&tag, wrap(final.timestamp + 2 * UWB_TX_DELAY * 65536ULL)));
+}
+
+TEST(BroadcastPoll, ExchangeEndsWhenTheResponsesAreLost)
+{
+    medium.now = (1ULL << 40) - 1000;
+    uwb_send_poll(&tag, anchor_addrs, 2, frame);
+    auto poll = medium.frames.back();
+
+    // The poll is sent after the clock wrapped around
+    CHECK_TRUE(uwb_ranging_in_progress(&tag, medium.now));
+    CHECK_TRUE(uwb_ranging_in_progress(&tag, poll.timestamp));
+    CHECK_FALSE(uwb_ranging_in_progress(&tag, wrap(poll.timestamp + 10 * UWB_TX_DELAY * 65536ULL)));
+}